@@ -110,6 +110,12 @@
         addShard: {skip: isUnrelated},
         addShardToZone: {skip: isUnrelated},
         aggregate: {command: {aggregate: "view", pipeline: [{$match: {}}], cursor: {}}},
+        analyze: {
+            command: {analyze: "view"},
+            expectFailure: true,
+            expectedErrorCode: ErrorCodes.CommandNotSupportedOnView,
+            skipSharded: true,
+        },
         appendOplogNote: {skip: isUnrelated},
         applyOps: {
             command: {applyOps: [{op: "i", o: {_id: 1}, ns: "test.view"}]},
@@ -0,0 +1,84 @@
+// Tests that an aggregation whose leading $match, $project, $addFields and $group stages run on
+// several threads returns the same results as when they run on the client's thread.
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({setParameter: "internalQueryAggregationParallelism=4"});
+    assert.neq(null, conn, "mongod was unable to start up");
+    const testDB = conn.getDB("aggregation_parallelism");
+    const coll = testDB.getCollection("test");
+
+    const kNumDocs = 20000;
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < kNumDocs; ++i) {
+        bulk.insert({_id: i, a: i % 17, b: i, c: i % 3 === 0 ? "x" : "y"});
+    }
+    assert.writeOK(bulk.execute());
+
+    function setParallelism(parallelism) {
+        assert.commandWorked(testDB.adminCommand(
+            {setParameter: 1, internalQueryAggregationParallelism: parallelism}));
+    }
+
+    function runWithEachParallelism(pipeline, options) {
+        setParallelism(1);
+        const serial = coll.aggregate(pipeline, options).toArray();
+        setParallelism(4);
+        const parallel = coll.aggregate(pipeline, options).toArray();
+        assert.sameMembers(serial, parallel, tojson(pipeline));
+        return parallel;
+    }
+
+    const results = runWithEachParallelism([
+        {$match: {b: {$gte: 100}}},
+        {$addFields: {d: {$multiply: ["$b", 2]}}},
+        {$project: {a: 1, c: 1, d: 1}},
+        {
+          $group: {
+              _id: {a: "$a", c: "$c"},
+              count: {$sum: 1},
+              total: {$sum: "$d"},
+              avg: {$avg: "$d"},
+              min: {$min: "$d"},
+              max: {$max: "$d"},
+              cs: {$addToSet: "$c"}
+          }
+        },
+        {$sort: {_id: 1}}
+    ]);
+    assert.eq(34, results.length, tojson(results));
+    assert.eq(kNumDocs - 100, results.reduce((sum, group) => sum + group.count, 0));
+
+    // Pipelines with order-sensitive accumulators, and explain, are unaffected.
+    runWithEachParallelism([{$sort: {b: 1}}, {$group: {_id: "$a", first: {$first: "$b"}}}]);
+    runWithEachParallelism([{$group: {_id: "$a", bs: {$push: "$b"}}}]);
+    const explain = coll.explain().aggregate([{$group: {_id: "$a", count: {$sum: 1}}}]);
+    assert.eq(-1, tojson(explain).indexOf("$_internalParallel"), tojson(explain));
+
+    // Errors raised on the worker threads are returned to the client.
+    assert.commandWorked(coll.insert({_id: kNumDocs, a: 1, b: "not a number"}));
+    assert.commandFailedWithCode(testDB.runCommand({
+        aggregate: coll.getName(),
+        pipeline: [{$group: {_id: "$a", total: {$sum: {$add: ["$b", 1]}}}}],
+        cursor: {}
+    }),
+                                 16554);
+    assert.commandWorked(coll.remove({_id: kNumDocs}));
+
+    // The workers' $groups share the $group memory limit. They spill to disk when 'allowDiskUse'
+    // is specified, and fail otherwise.
+    assert.commandWorked(testDB.adminCommand(
+        {setParameter: 1, internalDocumentSourceGroupMaxMemoryBytes: 64 * 1024}));
+    runWithEachParallelism([{$group: {_id: "$b", count: {$sum: 1}}}], {allowDiskUse: true});
+    for (let parallelism of [1, 4]) {
+        setParallelism(parallelism);
+        assert.commandFailedWithCode(testDB.runCommand({
+            aggregate: coll.getName(),
+            pipeline: [{$group: {_id: "$b", count: {$sum: 1}}}],
+            cursor: {}
+        }),
+                                     16945);
+    }
+
+    MongoRunner.stopMongod(conn);
+}());
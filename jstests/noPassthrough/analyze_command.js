@@ -0,0 +1,123 @@
+// Tests that the 'analyze' command stores sampled cardinality statistics in 'system.statistics',
+// keyed by collection UUID, and that the planner uses them to avoid racing indexes which are far
+// less selective than others.
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod was unable to start up");
+    const testDB = conn.getDB("analyze_command");
+    const coll = testDB.getCollection("test");
+
+    const kNumDocs = 1000;
+    function populate(collection) {
+        const bulk = collection.initializeUnorderedBulkOp();
+        for (let i = 0; i < kNumDocs; ++i) {
+            bulk.insert({_id: i, a: i, b: i % 2, c: {d: i % 10}});
+        }
+        assert.writeOK(bulk.execute());
+        assert.commandWorked(collection.createIndex({a: 1}));
+        assert.commandWorked(collection.createIndex({b: 1}));
+    }
+    populate(coll);
+
+    function getUUID(collection) {
+        return testDB.getCollectionInfos({name: collection.getName()})[0].info.uuid;
+    }
+
+    // Invalid arguments are rejected.
+    assert.commandFailedWithCode(testDB.runCommand({analyze: "missing"}),
+                                 ErrorCodes.NamespaceNotFound);
+    assert.commandFailedWithCode(testDB.runCommand({analyze: coll.getName(), sampleSize: 0}),
+                                 ErrorCodes.BadValue);
+    assert.commandFailedWithCode(testDB.runCommand({analyze: coll.getName(), sampleSize: "1"}),
+                                 ErrorCodes.TypeMismatch);
+    assert.commandFailedWithCode(testDB.runCommand({analyze: coll.getName(), keys: "a"}),
+                                 ErrorCodes.TypeMismatch);
+    assert.commandFailedWithCode(testDB.runCommand({analyze: coll.getName(), keys: ["$a"]}),
+                                 ErrorCodes.BadValue);
+    assert.commandFailedWithCode(testDB.runCommand({analyze: "system.statistics"}),
+                                 ErrorCodes.InvalidNamespace);
+
+    function getPlanCacheSize() {
+        return coll.aggregate([{$planCacheStats: {}}]).itcount();
+    }
+
+    // Populate the plan cache so that we can check that analyzing the collection clears it.
+    assert.eq(1, coll.find({a: 5, b: 1}).itcount());
+    assert.eq(1, getPlanCacheSize());
+
+    // By default the fields of the indexes are analyzed.
+    let res = assert.commandWorked(testDB.runCommand({analyze: coll.getName()}));
+    assert.eq(kNumDocs, res.numRecords, tojson(res));
+    assert.eq(kNumDocs, res.sampleSize, tojson(res));
+    assert.sameMembers(["_id", "a", "b"], res.keys, tojson(res));
+    assert.eq(0, getPlanCacheSize());
+
+    let statsDoc = testDB.system.statistics.findOne({_id: getUUID(coll)});
+    assert.neq(null, statsDoc);
+    assert.eq(["_id", "a", "b"], statsDoc.fields.map(field => field.path), tojson(statsDoc));
+
+    // The index on 'b' examines half of the collection and is not considered, while the planner
+    // would otherwise race it against the index on 'a'.
+    let explain = coll.find({a: 5, b: 1}).explain("allPlansExecution");
+    assert.eq(0, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+    assert.eq(1, explain.executionStats.nReturned, tojson(explain));
+
+    // A query which requests a sort is planned as before.
+    explain = coll.find({a: 5, b: 1}).sort({b: 1}).explain();
+    assert.eq(1, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+
+    // Pruning can be disabled.
+    assert.commandWorked(
+        testDB.adminCommand({setParameter: 1, internalQueryPlannerStatisticsPruningRatio: 0}));
+    explain = coll.find({a: 5, b: 1}).explain();
+    assert.eq(1, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+    assert.commandWorked(
+        testDB.adminCommand({setParameter: 1, internalQueryPlannerStatisticsPruningRatio: 10}));
+
+    // Explicit paths, including dotted ones, and a smaller sample can be requested. The new
+    // statistics replace the old ones.
+    res = assert.commandWorked(
+        testDB.runCommand({analyze: coll.getName(), keys: ["c.d"], sampleSize: 100}));
+    assert.eq(kNumDocs, res.numRecords, tojson(res));
+    assert.eq(100, res.sampleSize, tojson(res));
+    statsDoc = testDB.system.statistics.findOne({_id: getUUID(coll)});
+    assert.eq(["c.d"], statsDoc.fields.map(field => field.path), tojson(statsDoc));
+    assert.eq(1, testDB.system.statistics.find().itcount());
+
+    // Without statistics for 'a' and 'b', both indexes are considered again.
+    explain = coll.find({a: 5, b: 1}).explain();
+    assert.eq(1, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+
+    // Removing the statistics also restores the default behavior.
+    assert.commandWorked(testDB.runCommand({analyze: coll.getName()}));
+    explain = coll.find({a: 5, b: 1}).explain();
+    assert.eq(0, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+    assert.commandWorked(testDB.system.statistics.remove({_id: getUUID(coll)}));
+    explain = coll.find({a: 5, b: 1}).explain();
+    assert.eq(1, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+
+    // The statistics follow their collection when it is renamed within its database.
+    assert.commandWorked(testDB.runCommand({analyze: coll.getName()}));
+    assert.commandWorked(coll.renameCollection("renamed"));
+    const renamed = testDB.getCollection("renamed");
+    explain = renamed.find({a: 5, b: 1}).explain();
+    assert.eq(0, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+
+    // A new collection with the name of a dropped one does not use the dropped one's statistics.
+    assert(renamed.drop());
+    populate(renamed);
+    explain = renamed.find({a: 5, b: 1}).explain();
+    assert.eq(1, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+
+    // Dropping 'system.statistics' discards the cached statistics.
+    assert.commandWorked(testDB.runCommand({analyze: renamed.getName()}));
+    explain = renamed.find({a: 5, b: 1}).explain();
+    assert.eq(0, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+    assert(testDB.system.statistics.drop());
+    explain = renamed.find({a: 5, b: 1}).explain();
+    assert.eq(1, explain.queryPlanner.rejectedPlans.length, tojson(explain));
+
+    MongoRunner.stopMongod(conn);
+}());
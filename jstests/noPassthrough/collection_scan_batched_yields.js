@@ -0,0 +1,82 @@
+/**
+ * Tests that a collection scan which reads records from storage in batches returns the same results
+ * as an unbatched scan, for a variety of filters, when the scan yields while records of the current
+ * batch have not been examined yet.
+ */
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod();
+    assert.neq(null, conn, "mongod was unable to start up");
+    const testDB = conn.getDB("test");
+    const coll = testDB.getCollection(jsTest.name());
+
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < 1000; ++i) {
+        bulk.insert({
+            _id: i,
+            a: i,
+            b: (i % 3 === 0) ? "x" : "y",
+            c: {d: i % 7},
+            arr: [i % 5, i % 11],
+            str: "s" + (i % 13),
+        });
+    }
+    // Give some of the documents fields that others lack, so that missing fields are exercised.
+    for (let i = 1000; i < 1100; ++i) {
+        bulk.insert({_id: i, b: "x"});
+    }
+    assert.writeOK(bulk.execute());
+
+    const filters = [
+        {},
+        {a: {$gt: 500}},
+        {a: {$gte: 10, $lt: 900}},
+        {b: "x"},
+        {"c.d": 3},
+        {arr: 4},
+        {arr: {$elemMatch: {$gt: 3, $lt: 10}}},
+        {a: {$in: [1, 99, 555, 999, 1500]}},
+        {a: {$exists: false}},
+        {str: /^s1/},
+        {$or: [{a: {$lt: 20}}, {"c.d": 6}]},
+        {$and: [{b: "y"}, {a: {$mod: [4, 1]}}]},
+        {$nor: [{b: "x"}, {a: {$lt: 100}}]},
+        {a: {$not: {$gt: 10}}},
+    ];
+
+    function setParameters(params) {
+        assert.commandWorked(testDB.adminCommand(Object.assign({setParameter: 1}, params)));
+    }
+
+    function runScan(filter, direction) {
+        // Fetch the results in small batches so that the scan is also saved and restored across
+        // getMores.
+        return coll.find(filter).hint({$natural: direction}).batchSize(7).toArray();
+    }
+
+    // Yield after every work cycle, so that each yield leaves unexamined records in the batch.
+    setParameters({internalQueryExecYieldIterations: 1, internalQueryExecYieldPeriodMS: 0});
+
+    for (let filter of filters) {
+        for (let direction of [1, -1]) {
+            setParameters({internalQueryCollectionScanBatchSize: 1});
+            const expected = runScan(filter, direction);
+
+            for (let batchSize of [2, 16, 128, 5000]) {
+                setParameters({internalQueryCollectionScanBatchSize: batchSize});
+                assert.eq(expected,
+                          runScan(filter, direction),
+                          "filter: " + tojson(filter) + ", direction: " + direction +
+                              ", batch size: " + batchSize);
+            }
+        }
+    }
+
+    // Verify that the batched scan did yield.
+    setParameters({internalQueryCollectionScanBatchSize: 128});
+    const explain = coll.find({a: {$gt: 500}}).hint({$natural: 1}).explain("executionStats");
+    assert.gt(explain.executionStats.executionStages.saveState, 0, tojson(explain));
+
+    MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,50 @@
+/**
+ * Tests that a new member started with 'initialSyncFileCopySource' seeds its data directory with a
+ * copy of the sync source's data files, and then catches up through regular oplog replication.
+ * @tags: [requires_persistence, requires_replication, requires_wiredtiger]
+ */
+(function() {
+    "use strict";
+
+    load("jstests/libs/check_log.js");
+
+    const name = "file_copy_initial_sync";
+    const rst = new ReplSetTest({name: name, nodes: 1});
+    rst.startSet();
+    rst.initiate();
+
+    const primary = rst.getPrimary();
+    const primaryDB = primary.getDB(name);
+    const kNumDocs = 1000;
+    const bulk = primaryDB.coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < kNumDocs; ++i) {
+        bulk.insert({_id: i, x: i});
+    }
+    assert.writeOK(bulk.execute());
+    assert.commandWorked(primaryDB.coll.createIndex({x: 1}));
+    assert.commandWorked(primary.adminCommand({fsync: 1}));
+
+    // The new member copies the primary's data files instead of running a logical initial sync.
+    const secondary = rst.add({setParameter: {initialSyncFileCopySource: primary.host}});
+    rst.reInitiate();
+    rst.awaitSecondaryNodes();
+    checkLog.contains(secondary, "Copied data files from " + primary.host);
+
+    // Writes made after the copy reach the new member through oplog replication.
+    assert.writeOK(primaryDB.coll.insert({_id: kNumDocs, x: kNumDocs}, {writeConcern: {w: 2}}));
+    rst.awaitReplication();
+
+    const secondaryDB = secondary.getDB(name);
+    assert.eq(kNumDocs + 1, secondaryDB.coll.find().itcount());
+    assert.eq(2, secondaryDB.coll.getIndexes().length, tojson(secondaryDB.coll.getIndexes()));
+    rst.checkReplicatedDataHashes();
+
+    // The backup cursor on the source was closed once the copy finished, so another one can be
+    // opened.
+    const res = assert.commandWorked(
+        primary.adminCommand({aggregate: 1, pipeline: [{$backupCursor: {}}], cursor: {}}));
+    assert.commandWorked(primary.adminCommand(
+        {killCursors: "$cmd.aggregate", cursors: [res.cursor.id]}));
+
+    rst.stopSet();
+})();
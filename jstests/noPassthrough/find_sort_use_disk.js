@@ -0,0 +1,64 @@
+// Tests that a blocking SORT stage in a find command can spill to disk when 'allowDiskUse' is
+// specified, and that it fails when it exceeds its memory limit otherwise.
+(function() {
+    "use strict";
+
+    const kMemLimit = 1024 * 1024;
+    const conn = MongoRunner.runMongod(
+        {setParameter: "internalQueryExecMaxBlockingSortBytes=" + kMemLimit});
+    assert.neq(null, conn, "mongod was unable to start up");
+    const testDB = conn.getDB("find_sort_use_disk");
+    const coll = testDB.getCollection("test");
+
+    // Insert ~3MB of data so that an unindexed sort overflows the 1MB limit.
+    const largeStr = "x".repeat(32 * 1024);
+    const kNumDocs = 100;
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < kNumDocs; ++i) {
+        bulk.insert({_id: i, a: (i * 37) % kNumDocs, b: largeStr});
+    }
+    assert.writeOK(bulk.execute());
+
+    // Without 'allowDiskUse' the sort fails once it runs out of memory.
+    assert.commandFailedWithCode(testDB.runCommand({find: coll.getName(), sort: {a: 1}}),
+                                 ErrorCodes.OperationFailed);
+    assert.commandFailedWithCode(
+        testDB.runCommand({find: coll.getName(), sort: {a: 1}, allowDiskUse: false}),
+        ErrorCodes.OperationFailed);
+
+    // 'allowDiskUse' must be a boolean.
+    assert.commandFailedWithCode(
+        testDB.runCommand({find: coll.getName(), sort: {a: 1}, allowDiskUse: 1}),
+        ErrorCodes.FailedToParse);
+
+    function assertSortedAscending(docs, expectedCount) {
+        assert.eq(expectedCount, docs.length);
+        for (let i = 0; i < docs.length; ++i) {
+            assert.eq(i, docs[i].a, tojson(docs[i]));
+        }
+    }
+
+    // With 'allowDiskUse' the results are spilled and merged back in sorted order.
+    let res = assert.commandWorked(
+        testDB.runCommand({find: coll.getName(), sort: {a: 1}, allowDiskUse: true, batchSize: 0}));
+    let cursor = new DBCommandCursor(testDB, res);
+    assertSortedAscending(cursor.toArray(), kNumDocs);
+
+    // A limit larger than what fits in memory also spills.
+    res = assert.commandWorked(testDB.runCommand(
+        {find: coll.getName(), sort: {a: 1}, limit: 60, allowDiskUse: true, batchSize: 0}));
+    cursor = new DBCommandCursor(testDB, res);
+    assertSortedAscending(cursor.toArray(), 60);
+
+    // Explain reports that the sort stage used disk.
+    const explain = assert.commandWorked(testDB.runCommand({
+        explain: {find: coll.getName(), sort: {a: 1}, allowDiskUse: true},
+        verbosity: "executionStats"
+    }));
+    const execStages = explain.executionStats.executionStages;
+    const sortStage = execStages.stage === "SORT" ? execStages : execStages.inputStage;
+    assert.eq("SORT", sortStage.stage, tojson(explain));
+    assert.eq(true, sortStage.usedDisk, tojson(explain));
+
+    MongoRunner.stopMongod(conn);
+}());
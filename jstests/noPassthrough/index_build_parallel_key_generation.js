@@ -0,0 +1,56 @@
+// Tests that index builds which generate their keys on several threads build the same indexes as
+// those which generate them on the build's own thread.
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({setParameter: "maxIndexBuildKeyGenerationThreads=4"});
+    assert.neq(null, conn, "mongod was unable to start up");
+    const testDB = conn.getDB("index_build_parallel_key_generation");
+    const coll = testDB.getCollection("test");
+
+    // The knob is validated.
+    assert.commandFailed(
+        testDB.adminCommand({setParameter: 1, maxIndexBuildKeyGenerationThreads: 0}));
+    assert.commandFailed(
+        testDB.adminCommand({setParameter: 1, maxIndexBuildKeyGenerationThreads: 65}));
+
+    // Enough documents to fill several batches, with array values which make some indexes
+    // multikey.
+    const kNumDocs = 10000;
+    const bulk = coll.initializeUnorderedBulkOp();
+    for (let i = 0; i < kNumDocs; ++i) {
+        bulk.insert({_id: i, a: i % 100, b: [i, -i], c: {d: "str" + i}, e: i % 2});
+    }
+    assert.writeOK(bulk.execute());
+
+    assert.commandWorked(coll.createIndexes([
+        {a: 1},
+        {b: 1},
+        {"c.d": 1, a: -1},
+        {"$**": 1},
+    ]));
+    assert.commandWorked(coll.createIndex({a: 1, e: 1}, {partialFilterExpression: {e: 1}}));
+    assert.commandWorked(coll.createIndex({"c.d": 1}, {unique: true}));
+
+    assert.eq(kNumDocs / 100, coll.find({a: 7}).hint({a: 1}).itcount());
+    assert.eq(1, coll.find({b: -42}).hint({b: 1}).itcount());
+    assert.eq(kNumDocs / 200, coll.find({a: 7, e: 1}).hint({a: 1, e: 1}).itcount());
+    assert.eq(1, coll.find({"c.d": "str5"}).hint({"c.d": 1}).itcount());
+
+    const explain = coll.find({b: 1}).hint({b: 1}).explain();
+    assert.eq(true, explain.queryPlanner.winningPlan.inputStage.isMultiKey, tojson(explain));
+
+    // Duplicate keys and key generation errors fail the build.
+    assert.commandWorked(coll.dropIndex({"c.d": 1}));
+    assert.commandWorked(coll.insert({_id: kNumDocs, c: {d: "str1"}}));
+    assert.commandFailedWithCode(coll.createIndex({"c.d": -1}, {unique: true}),
+                                 ErrorCodes.DuplicateKey);
+    assert.commandWorked(
+        coll.insert({_id: kNumDocs + 1, loc: {type: "Point", coordinates: [500, 500]}}));
+    assert.commandFailedWithCode(coll.createIndex({loc: "2dsphere"}), 16755);
+
+    const res = assert.commandWorked(coll.validate({full: true}));
+    assert(res.valid, tojson(res));
+
+    MongoRunner.stopMongod(conn);
+}());
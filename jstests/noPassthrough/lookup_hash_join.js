@@ -0,0 +1,129 @@
+// Tests that a $lookup on 'localField' and 'foreignField' returns the same results when it joins
+// against a hash table of the foreign collection as when it queries the foreign collection for
+// each input document, and that it falls back to querying once the table grows too large.
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod was unable to start up");
+    const testDB = conn.getDB("lookup_hash_join");
+    const local = testDB.getCollection("local");
+    const foreign = testDB.getCollection("foreign");
+
+    assert.writeOK(local.insert([
+        {_id: 0, a: 1},
+        {_id: 1, a: [1, 2]},
+        {_id: 2, a: null},
+        {_id: 3},
+        {_id: 4, a: NumberDecimal("2")},
+        {_id: 5, a: "abc"},
+        {_id: 6, a: "ABC"},
+        {_id: 7, a: /^a/},
+        {_id: 8, a: [[1, 2]]},
+        {_id: 9, a: {x: 1}},
+        {_id: 10, b: [{c: 3}, {c: 4}]},
+    ]));
+    assert.writeOK(foreign.insert([
+        {_id: 0, b: 1},
+        {_id: 1, b: 2.0},
+        {_id: 2, b: [1, 3]},
+        {_id: 3, b: null},
+        {_id: 4},
+        {_id: 5, b: "abc"},
+        {_id: 6, b: /^a/},
+        {_id: 7, b: [[1, 2]]},
+        {_id: 8, b: {x: 1}},
+        {_id: 9, b: [{c: 3}, {d: 1}]},
+        {_id: 10, b: [null, 4]},
+    ]));
+
+    function setHashJoinMaxMemoryBytes(bytes) {
+        assert.commandWorked(testDB.adminCommand(
+            {setParameter: 1, internalDocumentSourceLookupHashJoinMaxMemoryBytes: bytes}));
+    }
+
+    function runPipelines(localField, foreignField, options) {
+        const lookup = {
+            $lookup: {
+                from: foreign.getName(),
+                localField: localField,
+                foreignField: foreignField,
+                as: "joined"
+            }
+        };
+        const results = {};
+        results.lookup = local.aggregate([lookup, {$sort: {_id: 1}}], options).toArray();
+        results.unwind =
+            local
+                .aggregate([
+                    lookup,
+                    {$unwind: {path: "$joined", includeArrayIndex: "idx"}},
+                    {$sort: {_id: 1, idx: 1}}
+                ],
+                           options)
+                .toArray();
+        results.unwindMatch =
+            local
+                .aggregate([
+                    lookup,
+                    {$unwind: {path: "$joined", preserveNullAndEmptyArrays: true}},
+                    {$match: {"joined._id": {$lt: 5}}},
+                    {$sort: {_id: 1, "joined._id": 1}}
+                ],
+                           options)
+                .toArray();
+        return results;
+    }
+
+    // The order in which foreign documents are joined depends on the plan used to find them, so
+    // optionally ignore it.
+    function ignoreForeignOrder(results) {
+        const byForeignId = (x, y) => bsonWoCompare({_id: x._id}, {_id: y._id});
+        results.lookup.forEach(doc => doc.joined.sort(byForeignId));
+        results.unwind.forEach(doc => delete doc.idx);
+        results.unwind.sort((x, y) => bsonWoCompare({_id: x._id, j: x.joined._id},
+                                                    {_id: y._id, j: y.joined._id}));
+        return results;
+    }
+
+    function assertSameResults(localField, foreignField, options, ignoreOrder) {
+        const normalize = ignoreOrder ? ignoreForeignOrder : (results => results);
+        setHashJoinMaxMemoryBytes(0);
+        const expected = normalize(runPipelines(localField, foreignField, options));
+        setHashJoinMaxMemoryBytes(1024 * 1024);
+        const actual = normalize(runPipelines(localField, foreignField, options));
+        assert.eq(expected, actual);
+    }
+
+    assertSameResults("a", "b");
+    assertSameResults("b.c", "b.c");
+    assertSameResults("a", "b", {collation: {locale: "en_US", strength: 2}});
+
+    // An index on the foreign field does not change which documents are joined.
+    assert.commandWorked(foreign.createIndex({b: 1}));
+    assertSameResults("a", "b", {}, true);
+    assert.commandWorked(foreign.dropIndex({b: 1}));
+
+    // A local value of undefined is rejected, as it is by the query on the foreign collection.
+    assert.writeOK(local.insert({_id: 11, a: undefined}));
+    setHashJoinMaxMemoryBytes(1024 * 1024);
+    assert.throws(() => local
+                            .aggregate([{
+                                $lookup: {
+                                    from: foreign.getName(),
+                                    localField: "a",
+                                    foreignField: "b",
+                                    as: "joined"
+                                }
+                            }])
+                            .itcount());
+    assert.writeOK(local.remove({_id: 11}));
+
+    // When the foreign collection does not fit in the hash table, the results are unchanged.
+    setHashJoinMaxMemoryBytes(100);
+    const expected = runPipelines("a", "b");
+    setHashJoinMaxMemoryBytes(0);
+    assert.eq(expected, runPipelines("a", "b"));
+
+    MongoRunner.stopMongod(conn);
+}());
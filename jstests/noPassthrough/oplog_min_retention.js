@@ -0,0 +1,32 @@
+/**
+ * Tests that the 'oplogMinRetentionHours' parameter is validated and that serverStatus reports how
+ * the oplog has been truncated.
+ *
+ * @tags: [requires_replication, requires_wiredtiger]
+ */
+(function() {
+    "use strict";
+
+    const replSet = new ReplSetTest({nodes: 1});
+    replSet.startSet();
+    replSet.initiate();
+
+    const primary = replSet.getPrimary();
+    const adminDB = primary.getDB("admin");
+
+    const res =
+        assert.commandWorked(adminDB.runCommand({getParameter: 1, oplogMinRetentionHours: 1}));
+    assert.eq(0, res.oplogMinRetentionHours, tojson(res));
+    assert.commandWorked(adminDB.runCommand({setParameter: 1, oplogMinRetentionHours: 1.5}));
+    assert.commandFailed(adminDB.runCommand({setParameter: 1, oplogMinRetentionHours: -1}));
+    assert.commandWorked(adminDB.runCommand({setParameter: 1, oplogMinRetentionHours: 0}));
+
+    const status = assert.commandWorked(adminDB.runCommand({serverStatus: 1})).oplogTruncation;
+    assert.neq(undefined, status);
+    assert.contains(status.processingMethod, ["scanning", "sampling"], tojson(status));
+    assert.gte(status.totalTimeProcessingMicros, 0, tojson(status));
+    assert.gte(status.totalTimeTruncatingMicros, 0, tojson(status));
+    assert.gte(status.truncateCount, 0, tojson(status));
+
+    replSet.stopSet();
+})();
@@ -0,0 +1,63 @@
+/**
+ * Tests that $planCacheStats reports the execution statistics gathered for each cached query shape.
+ */
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod();
+    assert.neq(null, conn, "mongod was unable to start up");
+    const testDB = conn.getDB("plan_cache_stats_runtime_stats");
+    const coll = testDB.getCollection("test");
+
+    for (let i = 0; i < 100; ++i) {
+        assert.writeOK(coll.insert({a: i, b: i % 10}));
+    }
+    assert.commandWorked(coll.createIndex({a: 1}));
+    assert.commandWorked(coll.createIndex({b: 1}));
+
+    function getRuntimeStats() {
+        const entries = coll.aggregate([{$planCacheStats: {}}]).toArray();
+        assert.eq(1, entries.length, tojson(entries));
+        assert(entries[0].hasOwnProperty("planningWorks"), tojson(entries[0]));
+        return entries[0].runtimeStats;
+    }
+
+    // The first execution creates an inactive cache entry and the second activates it. Both are
+    // multi-planned, so neither is attributed to the shape. Each of the queries below matches the
+    // ten documents with the given value of 'b'.
+    assert.eq(10, coll.find({a: {$gte: 5}, b: 5}).itcount());
+    assert.eq(10, coll.find({a: {$gte: 5}, b: 5}).itcount());
+    let runtimeStats = getRuntimeStats();
+    assert.eq(0, runtimeStats.numExecutions, tojson(runtimeStats));
+
+    // Executions of the cached plan are recorded, including those with different constants.
+    assert.eq(10, coll.find({a: {$gte: 5}, b: 5}).itcount());
+    runtimeStats = getRuntimeStats();
+    assert.eq(1, runtimeStats.numExecutions, tojson(runtimeStats));
+    assert.eq(10, runtimeStats.totalReturned, tojson(runtimeStats));
+    assert.eq(0, runtimeStats.numReplans, tojson(runtimeStats));
+
+    assert.eq(10, coll.find({a: {$gte: 3}, b: 3}).itcount());
+    assert.eq(10, coll.find({a: {$gte: 7}, b: 7}).itcount());
+    runtimeStats = getRuntimeStats();
+    assert.eq(3, runtimeStats.numExecutions, tojson(runtimeStats));
+    assert.eq(30, runtimeStats.totalReturned, tojson(runtimeStats));
+    assert.gt(runtimeStats.totalKeysExamined, 0, tojson(runtimeStats));
+    assert.gte(runtimeStats.averageLatencyMicros, 0, tojson(runtimeStats));
+    assert.eq(runtimeStats.totalDocsExamined / runtimeStats.totalReturned,
+              runtimeStats.docsExaminedPerReturned,
+              tojson(runtimeStats));
+
+    // A query whose results span several getMores is recorded once, with all of its results.
+    assert.eq(10, coll.find({a: {$gte: 1}, b: 1}).batchSize(2).itcount());
+    runtimeStats = getRuntimeStats();
+    assert.eq(4, runtimeStats.numExecutions, tojson(runtimeStats));
+    assert.eq(40, runtimeStats.totalReturned, tojson(runtimeStats));
+
+    // Explains are not attributed to the shape.
+    assert.commandWorked(coll.find({a: {$gte: 2}, b: 2}).explain("executionStats"));
+    runtimeStats = getRuntimeStats();
+    assert.eq(4, runtimeStats.numExecutions, tojson(runtimeStats));
+
+    MongoRunner.stopMongod(conn);
+}());
@@ -14,13 +14,16 @@
         internalQueryPlanEvaluationWorks: 10000,
         internalQueryPlanEvaluationCollFraction: 0.3,
         internalQueryPlanEvaluationMaxResults: 101,
+        internalQueryPlanEvaluationAbandonRatio: 0.0,
         internalQueryCacheSize: 5000,
+        internalQueryCacheEvictionWindow: 16,
         internalQueryCacheFeedbacksStored: 20,
         internalQueryCacheEvictionRatio: 10.0,
         internalQueryCacheWorksGrowthCoefficient: 2.0,
         internalQueryCacheDisableInactiveEntries: false,
         internalQueryCacheListPlansNewOutput: false,
         internalQueryPlannerMaxIndexedSolutions: 64,
+        internalQueryPlannerStatisticsPruningRatio: 10.0,
         internalQueryEnumerationMaxOrSolutions: 10,
         internalQueryEnumerationMaxIntersectPerAnd: 3,
         internalQueryForceIntersectionPlans: false,
@@ -29,16 +32,22 @@
         internalQueryPlanOrChildrenIndependently: true,
         internalQueryMaxScansToExplode: 200,
         internalQueryExecMaxBlockingSortBytes: 32 * 1024 * 1024,
+        internalQueryMaxSortThreads: 1,
         internalQueryExecYieldIterations: 128,
         internalQueryExecYieldPeriodMS: 10,
+        internalQueryCollectionScanBatchSize: 128,
         internalQueryFacetBufferSizeBytes: 100 * 1024 * 1024,
         internalDocumentSourceCursorBatchSizeBytes: 4 * 1024 * 1024,
         internalDocumentSourceLookupCacheSizeBytes: 100 * 1024 * 1024,
+        internalDocumentSourceLookupHashJoinMaxMemoryBytes: 0,
         internalDocumentSourceSortMaxBlockingSortBytes: 100 * 1024 * 1024,
         internalLookupStageIntermediateDocumentMaxSizeBytes: 100 * 1024 * 1024,
         internalDocumentSourceGroupMaxMemoryBytes: 100 * 1024 * 1024,
+        internalDocumentSourceGroupSpillPartitions: 16,
+        internalQueryAggregationParallelism: 1,
         // Should be half the value of 'internalQueryExecYieldIterations' parameter.
         internalInsertMaxBatchSize: 64,
+        internalUpdateMaxDeltaFraction: 0.5,
         internalQueryPlannerGenerateCoveredWholeIndexScans: false,
         internalQueryIgnoreUnknownJSONSchemaKeywords: false,
         internalQueryProhibitBlockingMergeOnMongoS: false,
@@ -85,10 +94,17 @@
     assertSetParameterSucceeds("internalQueryPlanEvaluationMaxResults", 0);
     assertSetParameterFails("internalQueryPlanEvaluationMaxResults", -1);
 
+    assertSetParameterSucceeds("internalQueryPlanEvaluationAbandonRatio", 4.0);
+    assertSetParameterSucceeds("internalQueryPlanEvaluationAbandonRatio", 0.0);
+    assertSetParameterFails("internalQueryPlanEvaluationAbandonRatio", -1.0);
+
     assertSetParameterSucceeds("internalQueryCacheSize", 1);
     assertSetParameterSucceeds("internalQueryCacheSize", 0);
     assertSetParameterFails("internalQueryCacheSize", -1);
 
+    assertSetParameterSucceeds("internalQueryCacheEvictionWindow", 1);
+    assertSetParameterFails("internalQueryCacheEvictionWindow", 0);
+
     assertSetParameterSucceeds("internalQueryCacheFeedbacksStored", 1);
     assertSetParameterSucceeds("internalQueryCacheFeedbacksStored", 0);
     assertSetParameterFails("internalQueryCacheFeedbacksStored", -1);
@@ -105,6 +121,10 @@
     assertSetParameterSucceeds("internalQueryPlannerMaxIndexedSolutions", 0);
     assertSetParameterFails("internalQueryPlannerMaxIndexedSolutions", -1);
 
+    assertSetParameterSucceeds("internalQueryPlannerStatisticsPruningRatio", 2.5);
+    assertSetParameterSucceeds("internalQueryPlannerStatisticsPruningRatio", 0.0);
+    assertSetParameterFails("internalQueryPlannerStatisticsPruningRatio", -1.0);
+
     assertSetParameterSucceeds("internalQueryEnumerationMaxOrSolutions", 11);
     assertSetParameterSucceeds("internalQueryEnumerationMaxOrSolutions", 0);
     assertSetParameterFails("internalQueryEnumerationMaxOrSolutions", -1);
@@ -121,6 +141,11 @@
     assertSetParameterSucceeds("internalQueryExecMaxBlockingSortBytes", 0);
     assertSetParameterFails("internalQueryExecMaxBlockingSortBytes", -1);
 
+    assertSetParameterSucceeds("internalQueryMaxSortThreads", 1);
+    assertSetParameterSucceeds("internalQueryMaxSortThreads", 64);
+    assertSetParameterFails("internalQueryMaxSortThreads", 0);
+    assertSetParameterFails("internalQueryMaxSortThreads", 65);
+
     assertSetParameterSucceeds("internalQueryExecYieldIterations", 10);
     assertSetParameterSucceeds("internalQueryExecYieldIterations", 0);
     assertSetParameterSucceeds("internalQueryExecYieldIterations", -1);
@@ -133,6 +158,11 @@
     assertSetParameterSucceeds("internalQueryExecYieldPeriodMS", 0);
     assertSetParameterFails("internalQueryExecYieldPeriodMS", -1);
 
+    assertSetParameterSucceeds("internalQueryCollectionScanBatchSize", 1);
+    assertSetParameterSucceeds("internalQueryCollectionScanBatchSize", 1000);
+    assertSetParameterFails("internalQueryCollectionScanBatchSize", 0);
+    assertSetParameterFails("internalQueryCollectionScanBatchSize", -1);
+
     assertSetParameterSucceeds("internalQueryFacetBufferSizeBytes", 1);
     assertSetParameterFails("internalQueryFacetBufferSizeBytes", 0);
     assertSetParameterFails("internalQueryFacetBufferSizeBytes", -1);
@@ -145,6 +175,16 @@
     assertSetParameterFails("internalDocumentSourceGroupMaxMemoryBytes", 0);
     assertSetParameterFails("internalDocumentSourceGroupMaxMemoryBytes", -1);
 
+    assertSetParameterSucceeds("internalDocumentSourceGroupSpillPartitions", 1);
+    assertSetParameterSucceeds("internalDocumentSourceGroupSpillPartitions", 1024);
+    assertSetParameterFails("internalDocumentSourceGroupSpillPartitions", 0);
+    assertSetParameterFails("internalDocumentSourceGroupSpillPartitions", 1025);
+
+    assertSetParameterSucceeds("internalQueryAggregationParallelism", 1);
+    assertSetParameterSucceeds("internalQueryAggregationParallelism", 64);
+    assertSetParameterFails("internalQueryAggregationParallelism", 0);
+    assertSetParameterFails("internalQueryAggregationParallelism", 65);
+
     // Internal BSON max object size is slightly larger than the max user object size, to
     // accommodate command metadata.
     const bsonUserSizeLimit = assert.commandWorked(testDB.isMaster()).maxBsonObjectSize;
@@ -158,6 +198,12 @@
     assertSetParameterFails("internalInsertMaxBatchSize", 0);
     assertSetParameterFails("internalInsertMaxBatchSize", -1);
 
+    assertSetParameterSucceeds("internalUpdateMaxDeltaFraction", 0.25);
+    assertSetParameterSucceeds("internalUpdateMaxDeltaFraction", 0.0);
+    assertSetParameterSucceeds("internalUpdateMaxDeltaFraction", 1.0);
+    assertSetParameterFails("internalUpdateMaxDeltaFraction", -0.1);
+    assertSetParameterFails("internalUpdateMaxDeltaFraction", 1.1);
+
     assertSetParameterSucceeds("internalDocumentSourceCursorBatchSizeBytes", 11);
     assertSetParameterSucceeds("internalDocumentSourceCursorBatchSizeBytes", 0);
     assertSetParameterFails("internalDocumentSourceCursorBatchSizeBytes", -1);
@@ -166,6 +212,10 @@
     assertSetParameterSucceeds("internalDocumentSourceLookupCacheSizeBytes", 0);
     assertSetParameterFails("internalDocumentSourceLookupCacheSizeBytes", -1);
 
+    assertSetParameterSucceeds("internalDocumentSourceLookupHashJoinMaxMemoryBytes", 11);
+    assertSetParameterSucceeds("internalDocumentSourceLookupHashJoinMaxMemoryBytes", 0);
+    assertSetParameterFails("internalDocumentSourceLookupHashJoinMaxMemoryBytes", -1);
+
     MongoRunner.stopMongod(conn);
 
 })();
\ No newline at end of file
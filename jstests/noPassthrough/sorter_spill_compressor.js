@@ -0,0 +1,39 @@
+// Tests that external sorts can spill with each of the compressors selectable by the
+// 'sorterSpillCompressor' server parameter, and that an unknown compressor is rejected.
+(function() {
+    "use strict";
+
+    assert.eq(null,
+              MongoRunner.runMongod({setParameter: {sorterSpillCompressor: "lz4"}}),
+              "mongod started with an unknown spill compressor");
+
+    const kMemLimit = 1024 * 1024;
+    const kNumDocs = 200;
+    const largeStr = "x".repeat(16 * 1024);
+
+    for (let compressor of ["none", "snappy", "zstd"]) {
+        const conn = MongoRunner.runMongod({
+            setParameter: {
+                sorterSpillCompressor: compressor,
+                internalDocumentSourceSortMaxBlockingSortBytes: kMemLimit
+            }
+        });
+        assert.neq(null, conn, "mongod was unable to start up with compressor " + compressor);
+        const coll = conn.getDB("test").getCollection("sorter_spill_compressor");
+
+        const bulk = coll.initializeUnorderedBulkOp();
+        for (let i = 0; i < kNumDocs; ++i) {
+            bulk.insert({_id: i, a: (i * 37) % kNumDocs, b: largeStr});
+        }
+        assert.writeOK(bulk.execute());
+
+        const results =
+            coll.aggregate([{$sort: {a: 1}}, {$project: {a: 1}}], {allowDiskUse: true}).toArray();
+        assert.eq(kNumDocs, results.length, compressor);
+        for (let i = 0; i < results.length; ++i) {
+            assert.eq(i, results[i].a, compressor + ": " + tojson(results[i]));
+        }
+
+        MongoRunner.stopMongod(conn);
+    }
+}());
@@ -0,0 +1,57 @@
+// Tests that updates which change a small part of a large document are written to storage as
+// deltas, even when they grow or shrink the document, and that the results are correct.
+(function() {
+    "use strict";
+
+    const conn = MongoRunner.runMongod({});
+    assert.neq(null, conn, "mongod was unable to start up");
+    const testDB = conn.getDB("update_delta_writes");
+    const coll = testDB.getCollection("test");
+
+    function getDeltaUpdates() {
+        return testDB.serverStatus().metrics.record.deltaUpdates;
+    }
+
+    const padding = "x".repeat(100 * 1024);
+    assert.writeOK(
+        coll.insert({_id: 0, padding: padding, arr: [], nested: {s: "short", n: NumberInt(1)}}));
+
+    // Appending to an array, growing a string and widening a number all change the size of the
+    // document.
+    const before = getDeltaUpdates();
+    for (let i = 0; i < 10; ++i) {
+        assert.writeOK(coll.update({_id: 0}, {$push: {arr: i}}));
+    }
+    assert.writeOK(coll.update({_id: 0}, {$set: {"nested.s": "a much longer string"}}));
+    assert.writeOK(coll.update({_id: 0}, {$inc: {"nested.n": NumberLong(1)}}));
+    assert.writeOK(coll.update({_id: 0}, {$unset: {"nested.s": 1}, $set: {added: true}}));
+
+    const storageEngine = testDB.serverStatus().storageEngine.name;
+    if (storageEngine === "wiredTiger" || storageEngine === "ephemeralForTest") {
+        assert.eq(before + 13, getDeltaUpdates());
+    }
+
+    let doc = coll.findOne({_id: 0});
+    assert.eq([0, 1, 2, 3, 4, 5, 6, 7, 8, 9], doc.arr, tojson(doc.arr));
+    assert.eq({n: NumberLong(2)}, doc.nested, tojson(doc.nested));
+    assert.eq(true, doc.added);
+    assert.eq(padding, doc.padding);
+
+    // An update which rewrites most of the document is written in full.
+    const beforeRewrite = getDeltaUpdates();
+    assert.writeOK(coll.update({_id: 0}, {$set: {padding: "y".repeat(100 * 1024)}}));
+    assert.eq(beforeRewrite, getDeltaUpdates());
+    assert.eq("y".repeat(100 * 1024), coll.findOne({_id: 0}).padding);
+
+    // Delta updates can be disabled.
+    assert.commandWorked(
+        testDB.adminCommand({setParameter: 1, internalUpdateMaxDeltaFraction: 0}));
+    assert.writeOK(coll.update({_id: 0}, {$push: {arr: 10}}));
+    assert.eq(beforeRewrite, getDeltaUpdates());
+    assert.eq(11, coll.findOne({_id: 0}).arr.length);
+
+    // The collection validates after the updates.
+    assert.commandWorked(coll.validate(true));
+
+    MongoRunner.stopMongod(conn);
+}());
@@ -0,0 +1,44 @@
+/**
+ * Tests that initial sync clones all collections and their indexes correctly when several
+ * collections of a database are cloned at the same time.
+ */
+
+(function() {
+    "use strict";
+
+    const name = "initial_sync_concurrent_collection_clones";
+    const replSet = new ReplSetTest({name: name, nodes: 2});
+    replSet.startSet();
+    replSet.initiate();
+
+    const primaryDB = replSet.getPrimary().getDB(name);
+    const kNumCollections = 10;
+    const kNumDocs = 100;
+    for (let i = 0; i < kNumCollections; ++i) {
+        const coll = primaryDB.getCollection("coll" + i);
+        const bulk = coll.initializeUnorderedBulkOp();
+        for (let j = 0; j < kNumDocs; ++j) {
+            bulk.insert({_id: j, x: i * j});
+        }
+        assert.writeOK(bulk.execute());
+        assert.commandWorked(coll.createIndex({x: 1}));
+    }
+
+    // Resync the secondary, cloning up to four collections at a time.
+    let secondary = replSet.getSecondary();
+    secondary = replSet.restart(
+        secondary,
+        {startClean: true, setParameter: {initialSyncMaxConcurrentCollectionClones: 4}});
+    replSet.awaitSecondaryNodes();
+    replSet.awaitReplication();
+
+    const secondaryDB = secondary.getDB(name);
+    for (let i = 0; i < kNumCollections; ++i) {
+        const coll = secondaryDB.getCollection("coll" + i);
+        assert.eq(kNumDocs, coll.find().itcount(), coll.getFullName());
+        assert.eq(2, coll.getIndexes().length, tojson(coll.getIndexes()));
+    }
+    replSet.checkReplicatedDataHashes();
+
+    replSet.stopSet();
+})();
@@ -0,0 +1,158 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/mutable/damage_calculator.h"
+
+#include <cstring>
+#include <vector>
+
+namespace mongo {
+namespace mutablebson {
+
+namespace {
+
+bool sameBytes(const BSONElement& lhs, const BSONElement& rhs) {
+    return lhs.size() == rhs.size() && std::memcmp(lhs.rawdata(), rhs.rawdata(), lhs.size()) == 0;
+}
+
+std::vector<BSONElement> getElements(const BSONObj& obj) {
+    std::vector<BSONElement> elements;
+    for (auto&& elem : obj) {
+        elements.push_back(elem);
+    }
+    return elements;
+}
+
+/**
+ * Returns the start of the element at 'index' of 'elements', the elements of 'obj', or the end of
+ * its last element if 'index' is past them.
+ */
+const char* getElementStart(const BSONObj& obj,
+                            const std::vector<BSONElement>& elements,
+                            size_t index) {
+    return index < elements.size() ? elements[index].rawdata() : obj.objdata() + obj.objsize() - 1;
+}
+
+class DamageCalculator {
+public:
+    DamageCalculator(const char* newRoot, size_t maxDamagedBytes, DamageVector* damages)
+        : _newRoot(newRoot), _maxDamagedBytes(maxDamagedBytes), _damages(damages) {}
+
+    /**
+     * Appends the damage events which transform 'oldObj' into 'newObj', an object within the new
+     * root object. Returns false if the damage budget is exceeded.
+     */
+    bool diff(const BSONObj& oldObj, const BSONObj& newObj) {
+        if (oldObj.objsize() != newObj.objsize() &&
+            !addDamage(newObj.objdata(), sizeof(int32_t), sizeof(int32_t))) {
+            return false;
+        }
+
+        const auto oldElements = getElements(oldObj);
+        const auto newElements = getElements(newObj);
+
+        // Skip the elements which are unchanged at the start and end of the object.
+        size_t prefix = 0;
+        while (prefix < oldElements.size() && prefix < newElements.size() &&
+               sameBytes(oldElements[prefix], newElements[prefix])) {
+            ++prefix;
+        }
+        size_t oldEnd = oldElements.size();
+        size_t newEnd = newElements.size();
+        while (oldEnd > prefix && newEnd > prefix &&
+               sameBytes(oldElements[oldEnd - 1], newElements[newEnd - 1])) {
+            --oldEnd;
+            --newEnd;
+        }
+        if (oldEnd == prefix && newEnd == prefix) {
+            return true;
+        }
+
+        // A single embedded object or array which changed is described by the changes within it.
+        if (oldEnd - prefix == 1 && newEnd - prefix == 1) {
+            const BSONElement& oldElem = oldElements[prefix];
+            const BSONElement& newElem = newElements[prefix];
+            if (oldElem.type() == newElem.type() &&
+                (oldElem.type() == BSONType::Object || oldElem.type() == BSONType::Array) &&
+                oldElem.fieldNameStringData() == newElem.fieldNameStringData()) {
+                return diff(oldElem.embeddedObject(), newElem.embeddedObject());
+            }
+        }
+
+        const char* oldStart = getElementStart(oldObj, oldElements, prefix);
+        const char* oldStop = getElementStart(oldObj, oldElements, oldEnd);
+        const char* newStart = getElementStart(newObj, newElements, prefix);
+        const char* newStop = getElementStart(newObj, newElements, newEnd);
+        return addDamage(newStart, newStop - newStart, oldStop - oldStart);
+    }
+
+private:
+    /**
+     * Records that the 'oldSize' bytes at the position of 'newData' in the target are replaced by
+     * the 'newSize' bytes at 'newData'. Damage events are produced in order of their position, so
+     * the target offset is the position in the new object.
+     */
+    bool addDamage(const char* newData, size_t newSize, size_t oldSize) {
+        _damagedBytes += newSize;
+        if (_damagedBytes > _maxDamagedBytes) {
+            return false;
+        }
+
+        DamageEvent event;
+        event.sourceOffset = newData - _newRoot;
+        event.targetOffset = event.sourceOffset;
+        event.size = newSize;
+        if (oldSize != newSize) {
+            event.targetSize = oldSize;
+        }
+        _damages->push_back(event);
+        return true;
+    }
+
+    const char* const _newRoot;
+    const size_t _maxDamagedBytes;
+    DamageVector* const _damages;
+    size_t _damagedBytes = 0;
+};
+
+}  // namespace
+
+bool computeDamages(const BSONObj& oldObj,
+                    const BSONObj& newObj,
+                    size_t maxDamagedBytes,
+                    DamageVector* damages) {
+    damages->clear();
+    return DamageCalculator(newObj.objdata(), maxDamagedBytes, damages).diff(oldObj, newObj);
+}
+
+}  // namespace mutablebson
+}  // namespace mongo
@@ -0,0 +1,58 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/mutable/damage_vector.h"
+
+namespace mongo {
+namespace mutablebson {
+
+/**
+ * Computes damage events which transform the BSON object 'oldObj' into 'newObj', reading their
+ * replacement data from 'newObj.objdata()'. Unlike the damage events of an in-place update, these
+ * may grow or shrink the target, so an update which adds, removes or resizes fields is described
+ * by the byte ranges it changes rather than by the whole new object.
+ *
+ * The objects are compared element by element, descending into a single embedded object or array
+ * which differs in place of the whole element. The size of each object whose length changes is
+ * rewritten as a damage event of its own.
+ *
+ * Returns false, leaving 'damages' unspecified, if the replacement data would total more than
+ * 'maxDamagedBytes' bytes.
+ */
+bool computeDamages(const BSONObj& oldObj,
+                    const BSONObj& newObj,
+                    size_t maxDamagedBytes,
+                    DamageVector* damages);
+
+}  // namespace mutablebson
+}  // namespace mongo
@@ -0,0 +1,137 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/bson/mutable/damage_calculator.h"
+
+#include <cstring>
+#include <string>
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+using mutablebson::DamageVector;
+using mutablebson::computeDamages;
+
+/**
+ * Applies 'damages' to the bytes of 'oldObj' in order, reading replacement data from 'newObj'.
+ */
+BSONObj applyDamages(const BSONObj& oldObj, const BSONObj& newObj, const DamageVector& damages) {
+    std::string data(oldObj.objdata(), oldObj.objsize());
+    for (auto&& damage : damages) {
+        data.replace(damage.targetOffset,
+                     damage.getTargetSize(),
+                     newObj.objdata() + damage.sourceOffset,
+                     damage.size);
+    }
+    return BSONObj(data.c_str()).getOwned();
+}
+
+void assertDamagesApply(const BSONObj& oldObj, const BSONObj& newObj, DamageVector* damages) {
+    ASSERT_TRUE(computeDamages(oldObj, newObj, newObj.objsize(), damages));
+    const BSONObj result = applyDamages(oldObj, newObj, *damages);
+    ASSERT_EQ(result.objsize(), newObj.objsize());
+    ASSERT_EQ(0, std::memcmp(result.objdata(), newObj.objdata(), newObj.objsize()));
+}
+
+TEST(DamageCalculatorTest, IdenticalObjectsHaveNoDamages) {
+    const BSONObj obj = fromjson("{_id: 1, a: [1, 2, 3], b: {c: 'x'}}");
+    DamageVector damages;
+    assertDamagesApply(obj, obj.copy(), &damages);
+    ASSERT(damages.empty());
+}
+
+TEST(DamageCalculatorTest, SameSizeChangeIsNotResized) {
+    DamageVector damages;
+    assertDamagesApply(
+        fromjson("{_id: 1, a: 1, b: 2}"), fromjson("{_id: 1, a: 5, b: 2}"), &damages);
+    ASSERT_EQ(1U, damages.size());
+    ASSERT_FALSE(damages[0].targetSize);
+}
+
+TEST(DamageCalculatorTest, AppendToNestedArrayOnlyDamagesTheArray) {
+    const std::string padding(10 * 1024, 'x');
+    const BSONObj oldObj =
+        BSON("_id" << 1 << "before" << padding << "obj" << BSON("arr" << BSON_ARRAY(1 << 2))
+                   << "after"
+                   << padding);
+    const BSONObj newObj =
+        BSON("_id" << 1 << "before" << padding << "obj" << BSON("arr" << BSON_ARRAY(1 << 2 << 3))
+                   << "after"
+                   << padding);
+
+    DamageVector damages;
+    assertDamagesApply(oldObj, newObj, &damages);
+
+    // The sizes of the document, the embedded object and the array, and the new array element.
+    ASSERT_EQ(4U, damages.size());
+    size_t damagedBytes = 0;
+    for (auto&& damage : damages) {
+        damagedBytes += damage.size;
+    }
+    ASSERT_LT(damagedBytes, 32U);
+}
+
+TEST(DamageCalculatorTest, GrowingAndShrinkingFields) {
+    DamageVector damages;
+    assertDamagesApply(fromjson("{_id: 1, a: 'short', b: 2, c: NumberInt(3)}"),
+                       fromjson("{_id: 1, a: 'much longer', b: 2, c: NumberLong(3)}"),
+                       &damages);
+    assertDamagesApply(fromjson("{_id: 1, a: 'much longer', b: 2, c: 3}"),
+                       fromjson("{_id: 1, a: 's', b: 2}"),
+                       &damages);
+}
+
+TEST(DamageCalculatorTest, AddingAndRemovingFields) {
+    DamageVector damages;
+    assertDamagesApply(
+        fromjson("{_id: 1, a: 1, c: 3}"), fromjson("{_id: 1, a: 1, b: 2, c: 3}"), &damages);
+    assertDamagesApply(
+        fromjson("{_id: 1, a: 1, b: 2, c: 3}"), fromjson("{_id: 1, c: 3}"), &damages);
+    assertDamagesApply(fromjson("{_id: 1}"), fromjson("{_id: 1, z: {y: [1]}}"), &damages);
+    assertDamagesApply(fromjson("{a: {b: 1}}"), fromjson("{a: [1]}"), &damages);
+    assertDamagesApply(fromjson("{a: {b: 1}}"), fromjson("{b: {b: 1}}"), &damages);
+}
+
+TEST(DamageCalculatorTest, FailsWhenOverBudget) {
+    DamageVector damages;
+    ASSERT_FALSE(computeDamages(fromjson("{_id: 1, a: 'short'}"),
+                                fromjson("{_id: 1, a: 'much much longer'}"),
+                                8,
+                                &damages));
+}
+
+}  // namespace
+}  // namespace mongo
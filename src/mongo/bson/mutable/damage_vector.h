@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <boost/optional.hpp>
 #include <cstdint>
 #include <vector>
 
@@ -39,6 +40,10 @@ namespace mutablebson {
 // 'target_offset' in some target buffer, with the replacement data being 'size' bytes of
 // data from the 'source' offset. The base addresses against which these offsets are to be
 // applied are not captured here.
+//
+// A damage event may also replace a region of the target of a different size, growing or
+// shrinking the target. Damage events are applied in order, so the target offset of such an
+// event is relative to the target as modified by the events before it.
 struct DamageEvent {
     typedef uint32_t OffsetSizeType;
 
@@ -50,6 +55,13 @@ struct DamageEvent {
 
     // Size of the damage region.
     size_t size;
+
+    // Size of the region of the target replaced by the damage region, if it differs from 'size'.
+    boost::optional<size_t> targetSize;
+
+    size_t getTargetSize() const {
+        return targetSize.value_or(size);
+    }
 };
 
 typedef std::vector<DamageEvent> DamageVector;
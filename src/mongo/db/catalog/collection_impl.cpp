@@ -38,6 +38,7 @@
 #include "mongo/base/counter.h"
 #include "mongo/base/init.h"
 #include "mongo/base/owned_pointer_map.h"
+#include "mongo/bson/mutable/damage_calculator.h"
 #include "mongo/bson/ordering.h"
 #include "mongo/bson/simple_bsonelement_comparator.h"
 #include "mongo/bson/simple_bsonobj_comparator.h"
@@ -74,6 +75,7 @@
 #include "mongo/db/query/collation/collator_factory_interface.h"
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/replication_coordinator.h"
 #include "mongo/db/server_parameters.h"
@@ -906,6 +908,42 @@ void CollectionImpl::deleteDocument(OperationContext* opCtx,
 Counter64 moveCounter;
 ServerStatusMetricField<Counter64> moveCounterDisplay("record.moves", &moveCounter);
 
+Counter64 deltaUpdateCounter;
+ServerStatusMetricField<Counter64> deltaUpdateCounterDisplay("record.deltaUpdates",
+                                                             &deltaUpdateCounter);
+
+namespace {
+
+/**
+ * Overwrites the record at 'loc', which holds 'oldDoc', with 'newDoc'. If the record store
+ * supports it and only a small part of the document changed, just the changed byte ranges are
+ * written.
+ */
+Status updateRecordWithDelta(OperationContext* opCtx,
+                             RecordStore* recordStore,
+                             const RecordId& loc,
+                             const BSONObj& oldDoc,
+                             const BSONObj& newDoc) {
+    const double maxDeltaFraction = internalUpdateMaxDeltaFraction.load();
+    if (maxDeltaFraction > 0 && recordStore->updateWithDamagesSupported()) {
+        mutablebson::DamageVector damages;
+        if (mutablebson::computeDamages(
+                oldDoc, newDoc, maxDeltaFraction * newDoc.objsize(), &damages)) {
+            const RecordData oldRec(oldDoc.objdata(), oldDoc.objsize());
+            auto status =
+                recordStore->updateWithDamages(opCtx, loc, oldRec, newDoc.objdata(), damages)
+                    .getStatus();
+            if (status.isOK()) {
+                deltaUpdateCounter.increment();
+            }
+            return status;
+        }
+    }
+    return recordStore->updateRecord(opCtx, loc, newDoc.objdata(), newDoc.objsize());
+}
+
+}  // namespace
+
 RecordId CollectionImpl::updateDocument(OperationContext* opCtx,
                                         RecordId oldLocation,
                                         const Snapshotted<BSONObj>& oldDoc,
@@ -1328,11 +1366,11 @@ RecordId CollectionImpl::updateDocument(OperationContext* opCtx,
 
     args->preImageDoc = oldDoc.value().getOwned();
 
-    Status updateStatus =
-        (isUpdated
-             ? _recordStore->updateRecord(
-                   opCtx, oldLocation, newVersionedDoc.objdata(), newVersionedDoc.objsize())
-             : _recordStore->updateRecord(opCtx, oldLocation, newDoc.objdata(), newDoc.objsize()));
+    Status updateStatus = updateRecordWithDelta(opCtx,
+                                                _recordStore,
+                                                oldLocation,
+                                                oldDoc.value(),
+                                                isUpdated ? newVersionedDoc : newDoc);
 
     if (indexesAffected) {
         int64_t keysInserted, keysDeleted;
@@ -30,6 +30,7 @@
 #pragma once
 
 #include "mongo/db/collection_index_usage_tracker.h"
+#include "mongo/db/query/collection_statistics.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/update_index_data.h"
@@ -104,6 +105,23 @@ public:
     virtual void notifyOfQuery(OperationContext* const opCtx,
                                const std::set<std::string>& indexesUsed) = 0;
 
+    /**
+     * Returns the cardinality statistics for this collection, or nullptr if it has not been
+     * analyzed. The statistics are read from the database's 'system.statistics' collection the
+     * first time they are requested after being invalidated.
+     *
+     * Callers must hold the database lock.
+     */
+    virtual std::shared_ptr<const CollectionStatistics> getStatistics(
+        OperationContext* const opCtx) = 0;
+
+    /**
+     * Discards the cached cardinality statistics, along with the cached query plans which were
+     * chosen using them. Must be called whenever this collection's document in
+     * 'system.statistics' changes.
+     */
+    virtual void invalidateStatistics() = 0;
+
     virtual void setNs(NamespaceString ns) = 0;
 };
 }  // namespace mongo
@@ -34,6 +34,8 @@
 #include "mongo/db/catalog/collection_info_cache_impl.h"
 
 #include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/database.h"
+#include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/fts/fts_spec.h"
@@ -179,6 +181,75 @@ void CollectionInfoCacheImpl::clearQueryCache() {
     }
 }
 
+std::shared_ptr<const CollectionStatistics> CollectionInfoCacheImpl::getStatistics(
+    OperationContext* opCtx) {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_statisticsMutex);
+        if (_statisticsLoaded) {
+            return _statistics;
+        }
+    }
+
+    auto statistics = loadStatistics(opCtx);
+
+    stdx::lock_guard<stdx::mutex> lk(_statisticsMutex);
+    if (!_statisticsLoaded) {
+        _statistics = std::move(statistics);
+        _statisticsLoaded = true;
+    }
+    return _statistics;
+}
+
+void CollectionInfoCacheImpl::invalidateStatistics() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_statisticsMutex);
+        _statistics.reset();
+        _statisticsLoaded = false;
+    }
+    clearQueryCache();
+}
+
+std::shared_ptr<const CollectionStatistics> CollectionInfoCacheImpl::loadStatistics(
+    OperationContext* opCtx) const {
+    dassert(opCtx->lockState()->isDbLockedForMode(_ns.db(), MODE_IS));
+
+    const auto uuid = _collection->uuid();
+    if (!uuid) {
+        return nullptr;
+    }
+    Database* db = DatabaseHolder::get(opCtx)->getDb(opCtx, _ns.db());
+    if (!db) {
+        return nullptr;
+    }
+    const NamespaceString statisticsNss(_ns.db(),
+                                        NamespaceString::kSystemDotStatisticsCollectionName);
+    Collection* statisticsColl = db->getCollection(opCtx, statisticsNss);
+    if (!statisticsColl) {
+        return nullptr;
+    }
+
+    // The statistics collection holds at most one small document per collection in the database,
+    // so a scan is cheap, and it only happens once per invalidation.
+    Lock::CollectionLock lk(opCtx->lockState(), statisticsNss.ns(), MODE_IS);
+    auto cursor = statisticsColl->getCursor(opCtx);
+    while (auto record = cursor->next()) {
+        BSONObj doc = record->data.toBson();
+        auto id = UUID::parse(doc["_id"]);
+        if (!id.isOK() || id.getValue() != *uuid) {
+            continue;
+        }
+
+        auto statistics = CollectionStatistics::parse(doc);
+        if (!statistics.isOK()) {
+            warning() << "Ignoring invalid statistics for " << _ns << ": "
+                      << statistics.getStatus();
+            return nullptr;
+        }
+        return std::make_shared<const CollectionStatistics>(std::move(statistics.getValue()));
+    }
+    return nullptr;
+}
+
 PlanCache* CollectionInfoCacheImpl::getPlanCache() const {
     return _planCache.get();
 }
@@ -35,6 +35,7 @@
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/query_settings.h"
 #include "mongo/db/update_index_data.h"
+#include "mongo/stdx/mutex.h"
 
 namespace mongo {
 
@@ -108,10 +109,20 @@ public:
      */
     void notifyOfQuery(OperationContext* opCtx, const std::set<std::string>& indexesUsed);
 
+    std::shared_ptr<const CollectionStatistics> getStatistics(OperationContext* opCtx) override;
+
+    void invalidateStatistics() override;
+
     void setNs(NamespaceString ns) override;
 
 private:
     void computeIndexKeys(OperationContext* opCtx);
+
+    /**
+     * Reads this collection's statistics from 'system.statistics'. Returns nullptr if there are
+     * none or they cannot be parsed.
+     */
+    std::shared_ptr<const CollectionStatistics> loadStatistics(OperationContext* opCtx) const;
     void updatePlanCacheIndexEntries(OperationContext* opCtx);
 
     /**
@@ -139,6 +150,13 @@ private:
     CollectionIndexUsageTracker _indexUsageTracker;
 
     bool _hasTTLIndex = false;
+
+    // Protects '_statistics' and '_statisticsLoaded'.
+    stdx::mutex _statisticsMutex;
+
+    // Cardinality statistics, valid only if '_statisticsLoaded' is true.
+    std::shared_ptr<const CollectionStatistics> _statistics;
+    bool _statisticsLoaded = false;
 };
 
 }  // namespace mongo
@@ -33,6 +33,7 @@
 
 #include "mongo/db/catalog/multi_index_block.h"
 
+#include <algorithm>
 #include <ostream>
 
 #include "mongo/base/error_codes.h"
@@ -54,6 +55,7 @@
 #include "mongo/db/storage/write_unit_of_work.h"
 #include "mongo/logger/redaction.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/fail_point.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/util/log.h"
@@ -71,6 +73,10 @@ const StringData kBuildingPhaseCompleteFieldName = "buildingPhaseComplete"_sd;
 const StringData kRunTwoPhaseIndexBuildFieldName = "runTwoPhaseIndexBuild"_sd;
 const StringData kCommitReadyMembersFieldName = "commitReadyMembers"_sd;
 
+// Limits on the documents which are buffered for their keys to be generated in parallel.
+const size_t kMaxKeyGenerationBatchDocs = 4096;
+const size_t kMaxKeyGenerationBatchBytes = 16 * 1024 * 1024;
+
 }  // namespace
 
 MONGO_FAIL_POINT_DEFINE(crashAfterStartingIndexBuild);
@@ -427,6 +433,48 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
         _method != IndexBuildMethod::kBackground && useReadOnceCursorsForIndexBuilds.load();
     opCtx->recoveryUnit()->setReadOnce(readOnce);
 
+    // When every index sorts its keys before loading them, the keys can be generated on other
+    // threads. The scan stays on this thread, buffering documents into batches for them.
+    const bool allIndexesBulk =
+        !_indexes.empty() &&
+        std::all_of(_indexes.begin(), _indexes.end(), [](const IndexToBuild& index) {
+            return !!index.bulk;
+        });
+    const size_t keyGenerationThreads =
+        allIndexesBulk ? static_cast<size_t>(maxIndexBuildKeyGenerationThreads.load()) : 1;
+    std::unique_ptr<ThreadPool> keyGenerationPool;
+    if (keyGenerationThreads > 1) {
+        ThreadPool::Options options;
+        options.poolName = "IndexBuildKeyGeneration";
+        options.minThreads = 0;
+        options.maxThreads = keyGenerationThreads;
+        keyGenerationPool = std::make_unique<ThreadPool>(options);
+        keyGenerationPool->startup();
+    }
+    ON_BLOCK_EXIT([&] {
+        if (keyGenerationPool) {
+            keyGenerationPool->shutdown();
+            keyGenerationPool->join();
+        }
+    });
+    std::vector<std::pair<BSONObj, RecordId>> batch;
+    size_t batchBytes = 0;
+
+    // Indexes the buffered documents. The keys of a batch are inserted together, so the
+    // hangAfterIndexBuildOf fail point is checked for each document once the whole batch is in.
+    auto insertBatch = [&]() -> Status {
+        Status ret = _insertBatch(opCtx, keyGenerationPool.get(), keyGenerationThreads, batch);
+        if (!ret.isOK()) {
+            return ret;
+        }
+        for (const auto& docAndLoc : batch) {
+            failPointHangDuringBuild(&hangAfterIndexBuildOf, "after", docAndLoc.first);
+        }
+        batch.clear();
+        batchBytes = 0;
+        return Status::OK();
+    };
+
     Snapshotted<BSONObj> objToIndex;
     RecordId loc;
     PlanExecutor::ExecState state;
@@ -456,6 +504,22 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
 
             failPointHangDuringBuild(&hangBeforeIndexBuildOf, "before", objToIndex.value());
 
+            if (keyGenerationPool) {
+                batch.emplace_back(objToIndex.value().getOwned(), loc);
+                batchBytes += objToIndex.value().objsize();
+                if (batch.size() >= kMaxKeyGenerationBatchDocs ||
+                    batchBytes >= kMaxKeyGenerationBatchBytes) {
+                    Status ret = insertBatch();
+                    if (!ret.isOK()) {
+                        return ret;
+                    }
+                }
+                progress->hit();
+                n++;
+                retries = 0;
+                continue;
+            }
+
             WriteUnitOfWork wunit(opCtx);
             Status ret = insert(opCtx, objToIndex.value(), loc);
             if (_method == IndexBuildMethod::kBackground)
@@ -504,6 +568,13 @@ Status MultiIndexBlock::insertAllDocumentsInCollection(OperationContext* opCtx,
         return exec->getMemberObjectStatus(objToIndex.value());
     }
 
+    if (!batch.empty()) {
+        Status ret = insertBatch();
+        if (!ret.isOK()) {
+            return ret;
+        }
+    }
+
     if (MONGO_FAIL_POINT(hangAfterStartingIndexBuildUnlocked)) {
         // Unlock before hanging so replication recognizes we've completed.
         Locker::LockSnapshot lockInfo;
@@ -561,6 +632,83 @@ Status MultiIndexBlock::insert(OperationContext* opCtx, const BSONObj& doc, cons
     return Status::OK();
 }
 
+Status MultiIndexBlock::_insertBatch(OperationContext* opCtx,
+                                     ThreadPool* pool,
+                                     size_t numThreads,
+                                     const std::vector<std::pair<BSONObj, RecordId>>& batch) {
+    if (State::kAborted == _getState()) {
+        return {ErrorCodes::IndexBuildAborted,
+                str::stream() << "Index build aborted: " << _abortReason};
+    }
+
+    struct GeneratedKeys {
+        BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+        BSONObjSet multikeyMetadataKeys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+        MultikeyPaths multikeyPaths;
+
+        // False if the document does not match the index's partial filter.
+        bool indexed = false;
+    };
+
+    // The keys of document 'd' for index 'i' are at 'd * _indexes.size() + i'.
+    std::vector<GeneratedKeys> generated(batch.size() * _indexes.size());
+
+    // Each task generates the keys of a contiguous slice of the batch.
+    const size_t numSlices = std::min(numThreads, batch.size());
+    const size_t sliceSize = (batch.size() + numSlices - 1) / numSlices;
+    std::vector<Status> sliceStatus(numSlices, Status::OK());
+    for (size_t slice = 0; slice < numSlices; ++slice) {
+        auto generateSlice = [&, slice] {
+            try {
+                const size_t end = std::min(batch.size(), (slice + 1) * sliceSize);
+                for (size_t d = slice * sliceSize; d < end; ++d) {
+                    const BSONObj& doc = batch[d].first;
+                    for (size_t i = 0; i < _indexes.size(); ++i) {
+                        auto& out = generated[d * _indexes.size() + i];
+                        if (_indexes[i].filterExpression &&
+                            !_indexes[i].filterExpression->matchesBSON(doc)) {
+                            continue;
+                        }
+                        _indexes[i].real->getKeys(doc,
+                                                  _indexes[i].options.getKeysMode,
+                                                  &out.keys,
+                                                  &out.multikeyMetadataKeys,
+                                                  &out.multikeyPaths);
+                        out.indexed = true;
+                    }
+                }
+            } catch (...) {
+                sliceStatus[slice] = exceptionToStatus();
+            }
+        };
+        Status scheduled = pool->schedule(generateSlice);
+        if (!scheduled.isOK()) {
+            pool->waitForIdle();
+            return scheduled;
+        }
+    }
+    pool->waitForIdle();
+
+    for (auto&& status : sliceStatus) {
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+
+    WriteUnitOfWork wunit(opCtx);
+    for (size_t d = 0; d < batch.size(); ++d) {
+        for (size_t i = 0; i < _indexes.size(); ++i) {
+            auto& keys = generated[d * _indexes.size() + i];
+            if (keys.indexed) {
+                _indexes[i].bulk->insertKeys(
+                    keys.keys, keys.multikeyMetadataKeys, keys.multikeyPaths, batch[d].second);
+            }
+        }
+    }
+    wunit.commit();
+    return Status::OK();
+}
+
 Status MultiIndexBlock::dumpInsertsFromBulk(OperationContext* opCtx) {
     return dumpInsertsFromBulk(opCtx, nullptr);
 }
@@ -52,6 +52,7 @@ namespace mongo {
 class Collection;
 class MatchExpression;
 class OperationContext;
+class ThreadPool;
 
 /**
  * Builds one or more indexes.
@@ -302,6 +303,16 @@ private:
     Status _dumpInsertsFromBulk(std::set<RecordId>* dupRecords,
                                 std::vector<BSONObj>* dupKeysInserted);
 
+    /**
+     * Generates the keys of the documents in 'batch' for every index, split across up to
+     * 'numThreads' tasks on 'pool', then adds them to the bulk builders in the order of 'batch'.
+     * Every index must be built with a bulk builder.
+     */
+    Status _insertBatch(OperationContext* opCtx,
+                        ThreadPool* pool,
+                        size_t numThreads,
+                        const std::vector<std::pair<BSONObj, RecordId>>& batch);
+
     /**
      * Returns the current state.
      */
@@ -213,37 +213,43 @@ void RecordStoreValidateAdaptor::traverseRecordStore(RecordStore* recordStore,
     int interruptInterval = 4096;
     RecordId prevRecordId;
 
-    while (auto record = cursor->next()) {
-        ++nrecords;
-
-        if (!(nrecords % interruptInterval)) {
-            _opCtx->checkForInterrupt();
-        }
+    // Read the records in batches to save a call into the storage engine per record.
+    const size_t kBatchSize = 128;
+    std::vector<Record> batch;
+    do {
+        cursor->nextBatch(&batch, kBatchSize);
+        for (const auto& record : batch) {
+            ++nrecords;
+
+            if (!(nrecords % interruptInterval)) {
+                _opCtx->checkForInterrupt();
+            }
 
-        auto dataSize = record->data.size();
-        dataSizeTotal += dataSize;
-        size_t validatedSize;
-        Status status = validate(record->id, record->data, &validatedSize);
+            auto dataSize = record.data.size();
+            dataSizeTotal += dataSize;
+            size_t validatedSize;
+            Status status = validate(record.id, record.data, &validatedSize);
 
-        // Checks to ensure isInRecordIdOrder() is being used properly.
-        if (prevRecordId.isValid()) {
-            invariant(prevRecordId < record->id);
-        }
+            // Checks to ensure isInRecordIdOrder() is being used properly.
+            if (prevRecordId.isValid()) {
+                invariant(prevRecordId < record.id);
+            }
 
-        // While some storage engines may use padding, we still require that they return the
-        // unpadded record data.
-        if (!status.isOK() || validatedSize != static_cast<size_t>(dataSize)) {
-            if (results->valid) {
-                // Only log once.
-                results->errors.push_back("detected one or more invalid documents (see logs)");
+            // While some storage engines may use padding, we still require that they return the
+            // unpadded record data.
+            if (!status.isOK() || validatedSize != static_cast<size_t>(dataSize)) {
+                if (results->valid) {
+                    // Only log once.
+                    results->errors.push_back("detected one or more invalid documents (see logs)");
+                }
+                nInvalid++;
+                results->valid = false;
+                log() << "document at location: " << record.id << " is corrupted";
             }
-            nInvalid++;
-            results->valid = false;
-            log() << "document at location: " << record->id << " is corrupted";
-        }
 
-        prevRecordId = record->id;
-    }
+            prevRecordId = record.id;
+        }
+    } while (batch.size() == kBatchSize);
 
     if (results->valid) {
         recordStore->updateStatsAfterRepair(_opCtx, nrecords, dataSizeTotal);
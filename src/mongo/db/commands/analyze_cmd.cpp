@@ -0,0 +1,279 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kCommand
+
+#include "mongo/platform/basic.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "mongo/db/catalog/collection.h"
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/concurrency/write_conflict_exception.h"
+#include "mongo/db/db_raii.h"
+#include "mongo/db/dbhelpers.h"
+#include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/index_names.h"
+#include "mongo/db/query/collection_statistics.h"
+#include "mongo/db/repl/replication_coordinator.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/stdx/unordered_set.h"
+#include "mongo/util/log.h"
+
+namespace mongo {
+namespace {
+
+const StringData kKeysFieldName = "keys"_sd;
+const StringData kSampleSizeFieldName = "sampleSize"_sd;
+
+const long long kDefaultSampleSize = 10000;
+const long long kMaxSampleSize = 100000;
+
+// The maximum number of histogram buckets built for each path.
+const size_t kMaxBuckets = 64;
+
+/**
+ * Returns the paths of every field of every btree index on 'collection'.
+ */
+std::vector<std::string> getIndexedPaths(OperationContext* opCtx, Collection* collection) {
+    std::set<std::string> paths;
+    std::unique_ptr<IndexCatalog::IndexIterator> ii =
+        collection->getIndexCatalog()->getIndexIterator(opCtx, false);
+    while (ii->more()) {
+        const IndexDescriptor* desc = ii->next()->descriptor();
+        const BSONObj& keyPattern = desc->keyPattern();
+        if (IndexNames::nameToType(IndexNames::findPluginName(keyPattern)) != INDEX_BTREE) {
+            continue;
+        }
+        for (auto&& elem : keyPattern) {
+            paths.insert(elem.fieldName());
+        }
+    }
+    return {paths.begin(), paths.end()};
+}
+
+/**
+ * Samples up to 'sampleSize' distinct documents from 'collection'. Uses the storage engine's
+ * random cursor when the collection is larger than the sample, as $sample does, and otherwise
+ * takes evenly spaced documents from a full scan.
+ */
+std::vector<BSONObj> sampleDocuments(OperationContext* opCtx,
+                                     Collection* collection,
+                                     long long sampleSize) {
+    const RecordStore* rs = collection->getRecordStore();
+    const long long numRecords = rs->numRecords(opCtx);
+    std::vector<BSONObj> sample;
+
+    auto randomCursor = numRecords > sampleSize ? rs->getRandomCursor(opCtx) : nullptr;
+    if (randomCursor) {
+        // A random cursor may return the same record more than once, so give up after a bounded
+        // number of attempts rather than loop on a collection with few distinct records left.
+        stdx::unordered_set<RecordId, RecordId::Hasher> seen;
+        const long long maxAttempts = 2 * sampleSize;
+        for (long long attempt = 0;
+             static_cast<long long>(sample.size()) < sampleSize && attempt < maxAttempts;
+             ++attempt) {
+            auto record = randomCursor->next();
+            if (!record) {
+                break;
+            }
+            if (!seen.insert(record->id).second) {
+                continue;
+            }
+            sample.push_back(record->data.toBson().getOwned());
+            if (sample.size() % 1000 == 0) {
+                opCtx->checkForInterrupt();
+            }
+        }
+        return sample;
+    }
+
+    const long long stride = std::max(1LL, numRecords / sampleSize);
+    auto cursor = rs->getCursor(opCtx);
+    long long position = 0;
+    while (auto record = cursor->next()) {
+        if (static_cast<long long>(sample.size()) >= sampleSize) {
+            break;
+        }
+        if (position++ % stride == 0) {
+            sample.push_back(record->data.toBson().getOwned());
+        }
+        if (position % 1000 == 0) {
+            opCtx->checkForInterrupt();
+        }
+    }
+    return sample;
+}
+
+/**
+ * Command for building cardinality statistics over a sample of a collection's documents, for use
+ * by the query planner. The statistics replace any previous ones for the collection in the
+ * database's 'system.statistics' collection.
+ *
+ * Format:
+ * {
+ *     analyze: <collection name>,
+ *     keys: [<path>, ...],  // Optional; defaults to the fields of the btree indexes.
+ *     sampleSize: <number>  // Optional; defaults to 10000.
+ * }
+ */
+class AnalyzeCmd : public BasicCommand {
+public:
+    AnalyzeCmd() : BasicCommand("analyze") {}
+
+    AllowedOnSecondary secondaryAllowed(ServiceContext*) const override {
+        return AllowedOnSecondary::kNever;
+    }
+
+    bool supportsWriteConcern(const BSONObj& cmd) const override {
+        return true;
+    }
+
+    std::string help() const override {
+        return "Builds histograms and distinct value estimates for the given paths of a "
+               "collection from a sample of its documents, for use by the query planner.\n"
+               "{ analyze: <collection>, keys: [<path>, ...], sampleSize: <number> }";
+    }
+
+    void addRequiredPrivileges(const std::string& dbname,
+                               const BSONObj& cmdObj,
+                               std::vector<Privilege>* out) const override {
+        ActionSet actions;
+        actions.addAction(ActionType::planCacheWrite);
+        out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+    }
+
+    bool run(OperationContext* opCtx,
+             const std::string& dbname,
+             const BSONObj& cmdObj,
+             BSONObjBuilder& result) override {
+        const NamespaceString nss(CommandHelpers::parseNsCollectionRequired(dbname, cmdObj));
+        uassert(ErrorCodes::InvalidNamespace,
+                str::stream() << "Cannot analyze system collection " << nss.ns(),
+                !nss.isSystem());
+
+        long long sampleSize = kDefaultSampleSize;
+        if (auto sampleSizeElem = cmdObj[kSampleSizeFieldName]) {
+            uassert(ErrorCodes::TypeMismatch,
+                    str::stream() << "'" << kSampleSizeFieldName << "' must be a number",
+                    sampleSizeElem.isNumber());
+            sampleSize = sampleSizeElem.safeNumberLong();
+            uassert(ErrorCodes::BadValue,
+                    str::stream() << "'" << kSampleSizeFieldName << "' must be between 1 and "
+                                  << kMaxSampleSize,
+                    sampleSize >= 1 && sampleSize <= kMaxSampleSize);
+        }
+
+        boost::optional<std::vector<std::string>> requestedPaths;
+        if (auto keysElem = cmdObj[kKeysFieldName]) {
+            uassert(ErrorCodes::TypeMismatch,
+                    str::stream() << "'" << kKeysFieldName << "' must be an array",
+                    keysElem.type() == BSONType::Array);
+            requestedPaths.emplace();
+            for (auto&& pathElem : keysElem.Obj()) {
+                uassert(ErrorCodes::BadValue,
+                        str::stream() << "'" << kKeysFieldName
+                                      << "' must only contain non-empty field paths, but found "
+                                      << pathElem,
+                        pathElem.type() == BSONType::String &&
+                            !pathElem.valueStringData().empty() &&
+                            pathElem.valueStringData()[0] != '$');
+                requestedPaths->push_back(pathElem.str());
+            }
+        }
+
+        // Build the statistics under a read lock, then write them out separately.
+        BSONObj statisticsDoc;
+        {
+            AutoGetCollectionForReadCommand ctx(opCtx, nss);
+            Collection* collection = ctx.getCollection();
+            if (!collection) {
+                uassert(ErrorCodes::CommandNotSupportedOnView,
+                        "Cannot analyze a view",
+                        !ctx.getView());
+                uasserted(ErrorCodes::NamespaceNotFound, "ns not found");
+            }
+
+            const auto paths =
+                requestedPaths ? *requestedPaths : getIndexedPaths(opCtx, collection);
+            const long long numRecords = collection->getRecordStore()->numRecords(opCtx);
+            const auto sample = sampleDocuments(opCtx, collection, sampleSize);
+            const auto statistics = CollectionStatistics::make(
+                sample, numRecords, paths, kMaxBuckets, Date_t::now());
+
+            // Key the statistics by UUID, so that they follow the collection when it is renamed
+            // within its database, and do not apply to a new collection of the same name.
+            const auto uuid = collection->uuid();
+            uassert(ErrorCodes::InvalidUUID,
+                    str::stream() << "Cannot analyze " << nss.ns() << " as it has no UUID",
+                    uuid);
+            BSONObjBuilder docBuilder;
+            uuid->appendToBuilder(&docBuilder, "_id");
+            statistics.serialize(&docBuilder);
+            statisticsDoc = docBuilder.obj();
+
+            result.append(CollectionStatistics::kNumRecordsFieldName, numRecords);
+            result.append(CollectionStatistics::kSampleSizeFieldName,
+                          static_cast<long long>(sample.size()));
+            result.append("keys", paths);
+        }
+        uassert(ErrorCodes::BSONObjectTooLarge,
+                str::stream() << "statistics for " << nss.ns() << " are too large to store",
+                statisticsDoc.objsize() <= BSONObjMaxUserSize);
+
+        const NamespaceString statisticsNss(nss.db(),
+                                            NamespaceString::kSystemDotStatisticsCollectionName);
+        writeConflictRetry(opCtx, "analyze", statisticsNss.ns(), [&] {
+            AutoGetOrCreateDb autoDb(opCtx, statisticsNss.db(), MODE_X);
+            uassert(ErrorCodes::NotMaster,
+                    str::stream() << "Not primary while writing statistics to "
+                                  << statisticsNss.ns(),
+                    repl::ReplicationCoordinator::get(opCtx)->canAcceptWritesFor(opCtx,
+                                                                                 statisticsNss));
+
+            // Writing the document invalidates the statistics cached for the collection, and with
+            // them its cached plans.
+            WriteUnitOfWork wuow(opCtx);
+            Helpers::upsert(opCtx, statisticsNss.ns(), statisticsDoc);
+            wuow.commit();
+        });
+
+        LOG(1) << "Analyzed " << nss << " using "
+               << statisticsDoc[CollectionStatistics::kSampleSizeFieldName].numberLong()
+               << " sampled documents";
+        return true;
+    }
+} analyzeCmd;
+
+}  // namespace
+}  // namespace mongo
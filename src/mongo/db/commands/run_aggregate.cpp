@@ -585,6 +585,9 @@ Status runAggregate(OperationContext* opCtx,
                 pipelines.emplace_back(uassertStatusOK(Pipeline::create({consumer}, expCtx)));
             }
         } else {
+            if (!liteParsedPipeline.hasChangeStream()) {
+                PipelineD::parallelizePipelinePrefix(pipeline.get());
+            }
             pipelines.emplace_back(std::move(pipeline));
         }
 
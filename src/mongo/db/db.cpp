@@ -101,6 +101,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repair_database_and_check_version.h"
 #include "mongo/db/repl/drop_pending_collection_reaper.h"
+#include "mongo/db/repl/file_copy_initial_sync.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/repl_settings.h"
 #include "mongo/db/repl/replication_consistency_markers_impl.h"
@@ -325,6 +326,17 @@ ExitCode _initAndListen(int listenPort) {
     runner->startup();
     serviceContext->setPeriodicRunner(std::move(runner));
 
+    // A new member may seed its empty data directory with a copy of another member's data files
+    // rather than run a logical initial sync. The files must be in place before the storage engine
+    // opens them.
+    if (!storageGlobalParams.readOnly && !storageGlobalParams.repair) {
+        auto status = repl::copyDataFilesFromSyncSourceIfNeeded(storageGlobalParams.dbpath);
+        if (!status.isOK()) {
+            severe() << "Failed to copy data files from the initial sync source: " << status;
+            return EXIT_BADOPTIONS;
+        }
+    }
+
     initializeStorageEngine(serviceContext, StorageEngineInitFlags::kNone);
 
 #ifdef MONGO_CONFIG_WIREDTIGER_ENABLED
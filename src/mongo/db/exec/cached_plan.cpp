@@ -41,6 +41,7 @@
 #include "mongo/db/query/explain.h"
 #include "mongo/db/query/plan_cache.h"
 #include "mongo/db/query/plan_ranker.h"
+#include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/query/plan_yield_policy.h"
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
@@ -270,6 +271,7 @@ bool CachedPlanStage::isEOF() {
 
 PlanStage::StageState CachedPlanStage::doWork(WorkingSetID* out) {
     if (isEOF()) {
+        recordExecution();
         return PlanStage::IS_EOF;
     }
 
@@ -281,7 +283,20 @@ PlanStage::StageState CachedPlanStage::doWork(WorkingSetID* out) {
     }
 
     // Nothing left in trial period buffer.
-    return child()->work(out);
+    StageState state = child()->work(out);
+    if (PlanStage::IS_EOF == state) {
+        recordExecution();
+    }
+    return state;
+}
+
+void CachedPlanStage::doDispose() {
+    // The collection is only available if we are disposed of while holding the locks it was
+    // acquired under, e.g. when a find returns its only batch without exhausting the plan. A
+    // cursor destroyed in a saved state may outlive its collection, so it goes unrecorded.
+    if (collection()) {
+        recordExecution();
+    }
 }
 
 std::unique_ptr<PlanStageStats> CachedPlanStage::getStats() {
@@ -314,4 +329,23 @@ void CachedPlanStage::updatePlanCache() {
     }
 }
 
+void CachedPlanStage::recordExecution() {
+    if (_executionRecorded || _canonicalQuery->getQueryRequest().isExplain()) {
+        return;
+    }
+    _executionRecorded = true;
+
+    PlanSummaryStats summaryStats;
+    Explain::getSummaryStats(this, &summaryStats);
+
+    PlanCache* cache = collection()->infoCache()->getPlanCache();
+    Status status = cache->recordExecution(
+        *_canonicalQuery, Milliseconds(summaryStats.executionTimeMillis), summaryStats);
+    if (!status.isOK()) {
+        LOG(5) << _canonicalQuery->ns() << ": Failed to record execution: " << redact(status)
+               << " - (query: " << redact(_canonicalQuery->getQueryObj())
+               << ") is no longer in plan cache.";
+    }
+}
+
 }  // namespace mongo
@@ -88,7 +88,19 @@ public:
      */
     Status pickBestPlan(PlanYieldPolicy* yieldPolicy);
 
+protected:
+    void doDispose() final;
+
 private:
+    /**
+     * Attributes this execution to the plan cache entry for the query's shape. Called when the
+     * plan reaches EOF or is disposed of, whichever comes first, so an execution that spans
+     * several getMores is recorded exactly once.
+     *
+     * A no-op for explains, or if the plan cache entry has since been deleted.
+     */
+    void recordExecution();
+
     /**
      * Passes stats from the trial period run of the cached plan to the plan cache.
      *
@@ -138,6 +150,9 @@ private:
 
     // Stats
     CachedPlanStats _specificStats;
+
+    // Whether this execution has already been passed to the plan cache by recordExecution().
+    bool _executionRecorded = false;
 };
 
 }  // namespace mongo
@@ -39,6 +39,7 @@
 #include "mongo/db/exec/scoped_timer.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/repl/optime.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/fail_point_service.h"
@@ -74,6 +75,14 @@ CollectionScan::CollectionScan(OperationContext* opCtx,
         _endCondition = stdx::make_unique<GTEMatchExpression>(repl::OpTime::kTimestampFieldName,
                                                               _endConditionBSON.firstElement());
     }
+
+    // Batching only applies to plain scans. Tailable and oplog scans need to observe every record
+    // they step over.
+    _scanInBatches = !_params.tailable && !_endCondition &&
+        !_params.shouldTrackLatestOplogTimestamp && !_params.stopApplyingFilterAfterFirstMatch;
+    if (_scanInBatches && _filter) {
+        _flattenedFilter = FlattenedLeafFilter::make(_filter);
+    }
 }
 
 PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
@@ -130,6 +139,8 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
 
         if (_lastSeenId.isNull() && !_params.start.isNull()) {
             record = _cursor->seekExact(_params.start);
+        } else if (_scanInBatches) {
+            return scanBatch(out);
         } else {
             record = _cursor->next();
         }
@@ -172,6 +183,46 @@ PlanStage::StageState CollectionScan::doWork(WorkingSetID* out) {
     return returnIfMatches(member, id, out);
 }
 
+PlanStage::StageState CollectionScan::scanBatch(WorkingSetID* out) {
+    if (_batchPosition == _batch.size()) {
+        // If reading the batch throws, the records read before the exception are kept and examined
+        // once the scan resumes.
+        _batchPosition = 0;
+        _batchSnapshotId = getOpCtx()->recoveryUnit()->getSnapshotId();
+        _cursor->nextBatch(&_batch, _nextBatchSize);
+        _nextBatchSize = std::min(2 * _nextBatchSize,
+                                  static_cast<size_t>(internalQueryCollectionScanBatchSize.load()));
+        if (_batch.empty()) {
+            _commonStats.isEOF = true;
+            return PlanStage::IS_EOF;
+        }
+    }
+
+    while (_batchPosition < _batch.size()) {
+        const Record& record = _batch[_batchPosition++];
+        _lastSeenId = record.id;
+        ++_specificStats.docsTested;
+
+        // The record data is only valid until the cursor is used again, which is fine since the
+        // rest of the batch is made owned before the cursor is saved.
+        const BSONObj doc = record.data.toBson();
+        const bool matches = !_filter ||
+            (_flattenedFilter ? _flattenedFilter->matches(doc) : _filter->matchesBSON(doc));
+        if (!matches) {
+            continue;
+        }
+
+        WorkingSetID id = _workingSet->allocate();
+        WorkingSetMember* member = _workingSet->get(id);
+        member->recordId = record.id;
+        member->obj = {_batchSnapshotId, doc};
+        _workingSet->transitionToRecordIdAndObj(id);
+        *out = id;
+        return PlanStage::ADVANCED;
+    }
+    return PlanStage::NEED_TIME;
+}
+
 Status CollectionScan::setLatestOplogEntryTimestamp(const Record& record) {
     auto tsElem = record.data.toBson()[repl::OpTime::kTimestampFieldName];
     if (tsElem.type() != BSONType::bsonTimestamp) {
@@ -211,6 +262,11 @@ bool CollectionScan::isEOF() {
 }
 
 void CollectionScan::doSaveStateRequiresCollection() {
+    // The records of the batch which have not been examined yet outlive the cursor's position.
+    for (size_t i = _batchPosition; i < _batch.size(); ++i) {
+        _batch[i].data.makeOwned();
+    }
+
     if (_cursor) {
         _cursor->save();
     }
@@ -34,11 +34,13 @@
 #include "mongo/db/exec/collection_scan_common.h"
 #include "mongo/db/exec/requires_collection_stage.h"
 #include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/matcher/flattened_leaf_filter.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/storage/record_store.h"
+#include "mongo/db/storage/snapshot.h"
 
 namespace mongo {
 
-struct Record;
 class SeekableRecordCursor;
 class WorkingSet;
 class OperationContext;
@@ -47,6 +49,12 @@ class OperationContext;
  * Scans over a collection, starting at the RecordId provided in params and continuing until
  * there are no more records in the collection.
  *
+ * When the scan is neither tailable nor bounded by an end condition, it reads records from the
+ * storage engine in batches of up to 'internalQueryCollectionScanBatchSize', and each call to
+ * work() examines up to a batch of records, testing the filter directly against the record data and
+ * only allocating a WorkingSetMember for a record that matches. Simple leaf predicates of the
+ * filter are evaluated through a FlattenedLeafFilter.
+ *
  * Preconditions: Valid RecordId.
  */
 class CollectionScan final : public RequiresCollectionStage {
@@ -89,6 +97,14 @@ private:
      */
     StageState returnIfMatches(WorkingSetMember* member, WorkingSetID memberID, WorkingSetID* out);
 
+    /**
+     * Examines the rest of the current batch of records, reading the next batch from '_cursor' if
+     * it is exhausted, and stops at the first record which passes the filter. Returns ADVANCED with
+     * *out set to a member for that record, NEED_TIME if none of the records examined matched, or
+     * IS_EOF if the cursor was exhausted.
+     */
+    StageState scanBatch(WorkingSetID* out);
+
     /**
      * Extracts the timestamp from the 'ts' field of 'record', and sets '_latestOplogEntryTimestamp'
      * to that time if it isn't already greater.  Returns an error if the 'ts' field cannot be
@@ -102,6 +118,19 @@ private:
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
+    // Whether records are filtered in batches by scanBatch(), and if so, the flattened form of
+    // '_filter' when it has predicates eligible for flattening.
+    bool _scanInBatches = false;
+    std::unique_ptr<FlattenedLeafFilter> _flattenedFilter;
+
+    // The records most recently read by scanBatch(), of which those from '_batchPosition' on have
+    // not been examined yet, and the snapshot they were read in. Batches start small and double in
+    // size, so that scans which stop early do not read far ahead.
+    std::vector<Record> _batch;
+    size_t _batchPosition = 0;
+    size_t _nextBatchSize = 1;
+    SnapshotId _batchSnapshotId;
+
     // If a document does not pass '_filter' but passes '_endCondition', stop scanning and return
     // IS_EOF.
     BSONObj _endConditionBSON;
@@ -107,17 +107,19 @@ PlanStage::StageState CountScan::doWork(WorkingSetID* out) {
     boost::optional<IndexKeyEntry> entry;
     const bool needInit = !_cursor;
     try {
-        // We don't care about the keys.
-        const auto kWantLoc = SortedDataInterface::Cursor::kWantLoc;
+        // We don't care about the keys, and only need the RecordIds to dedup multikey indexes.
+        // The cursor then only compares the encoded keys against the end position.
+        const auto parts = _shouldDedup ? SortedDataInterface::Cursor::kWantLoc
+                                        : SortedDataInterface::Cursor::kJustExistance;
 
         if (needInit) {
             // First call to work().  Perform cursor init.
             _cursor = indexAccessMethod()->newCursor(getOpCtx());
             _cursor->setEndPosition(_endKey, _endKeyInclusive);
 
-            entry = _cursor->seek(_startKey, _startKeyInclusive, kWantLoc);
+            entry = _cursor->seek(_startKey, _startKeyInclusive, parts);
         } else {
-            entry = _cursor->next(kWantLoc);
+            entry = _cursor->next(parts);
         }
     } catch (const WriteConflictException&) {
         if (needInit) {
@@ -57,6 +57,7 @@ FetchStage::FetchStage(OperationContext* opCtx,
     : RequiresCollectionStage(kStageType, opCtx, collection),
       _ws(ws),
       _filter(filter),
+      _flattenedFilter(FlattenedLeafFilter::make(filter)),
       _idRetrying(WorkingSet::INVALID_ID) {
     _children.emplace_back(child);
 }
@@ -173,7 +174,10 @@ PlanStage::StageState FetchStage::returnIfMatches(WorkingSetMember* member,
     // predicate.
     ++_specificStats.docsExamined;
 
-    if (Filter::passes(member, _filter)) {
+    const bool passes = _flattenedFilter && member->hasObj()
+        ? _flattenedFilter->matches(member->obj.value())
+        : Filter::passes(member, _filter);
+    if (passes) {
         *out = memberID;
         return PlanStage::ADVANCED;
     } else {
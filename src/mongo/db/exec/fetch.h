@@ -34,6 +34,7 @@
 #include "mongo/db/exec/requires_collection_stage.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/flattened_leaf_filter.h"
 #include "mongo/db/record_id.h"
 
 namespace mongo {
@@ -95,6 +96,9 @@ private:
     // The filter is not owned by us.
     const MatchExpression* _filter;
 
+    // The flattened form of '_filter', if it has any predicates eligible for flattening.
+    std::unique_ptr<FlattenedLeafFilter> _flattenedFilter;
+
     // If not Null, we use this rather than asking our child what to do next.
     WorkingSetID _idRetrying;
 
@@ -336,7 +336,7 @@ bool MultiPlanStage::workAllPlans(size_t numResults, PlanYieldPolicy* yieldPolic
 
     for (size_t ix = 0; ix < _candidates.size(); ++ix) {
         CandidatePlan& candidate = _candidates[ix];
-        if (candidate.failed) {
+        if (candidate.failed || candidate.abandoned) {
             continue;
         }
 
@@ -397,9 +397,50 @@ bool MultiPlanStage::workAllPlans(size_t numResults, PlanYieldPolicy* yieldPolic
         }
     }
 
+    if (!doneWorking) {
+        abandonUncompetitivePlans(numResults);
+    }
+
     return !doneWorking;
 }
 
+void MultiPlanStage::abandonUncompetitivePlans(size_t numResults) {
+    const double abandonRatio = internalQueryPlanEvaluationAbandonRatio.load();
+    if (abandonRatio <= 0) {
+        return;
+    }
+
+    size_t leaderResults = 0;
+    for (auto&& candidate : _candidates) {
+        if (!candidate.failed && !candidate.abandoned) {
+            leaderResults = std::max(leaderResults, candidate.results.size());
+        }
+    }
+
+    // Wait until the leader has produced a tenth of the results needed to end the trial period,
+    // so that a plan is not abandoned because of where its first few results happen to lie.
+    if (leaderResults < std::max<size_t>(numResults / 10, 1)) {
+        return;
+    }
+
+    for (auto&& candidate : _candidates) {
+        // A plan with a blocking stage produces nothing until it has consumed all of its input,
+        // and may still be the first to hit EOF.
+        if (candidate.failed || candidate.abandoned || candidate.solution->hasBlockingStage) {
+            continue;
+        }
+
+        const size_t numCandidateResults = candidate.results.size();
+        if (numCandidateResults < leaderResults &&
+            numCandidateResults * abandonRatio <= leaderResults) {
+            LOG(2) << "Abandoning candidate plan with " << numCandidateResults
+                   << " results while the leading plan has " << leaderResults << ": "
+                   << Explain::getPlanSummary(candidate.root);
+            candidate.abandoned = true;
+        }
+    }
+}
+
 bool MultiPlanStage::hasBackupPlan() const {
     return kNoSuchPlan != _backupPlanIdx;
 }
@@ -172,6 +172,13 @@ private:
      */
     bool workAllPlans(size_t numResults, PlanYieldPolicy* yieldPolicy);
 
+    /**
+     * Stops working the candidate plans which have fallen far behind the leading plan, as set by
+     * 'internalQueryPlanEvaluationAbandonRatio', so that the rest of the trial period is spent on
+     * the competitive plans.
+     */
+    void abandonUncompetitivePlans(size_t numResults);
+
     /**
      * Checks whether we need to perform either a timing-based yield or a yield for a document
      * fetch. If so, then uses 'yieldPolicy' to actually perform the yield.
@@ -489,6 +489,10 @@ struct SortStats : public SpecificStats {
     // The number of results to return from the sort.
     size_t limit = 0u;
 
+    // Whether the sort was permitted to spill to disk, and whether it actually did.
+    bool allowDiskUse = false;
+    bool usedDisk = false;
+
     // The pattern according to which we are sorting.
     BSONObj sortPattern;
 };
@@ -42,6 +42,8 @@
 #include "mongo/db/query/find_common.h"
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/log.h"
 
@@ -52,6 +54,24 @@ using std::unique_ptr;
 using std::vector;
 using stdx::make_unique;
 
+namespace {
+
+/**
+ * Generates a new file name on each call using a static, atomic and monotonically increasing
+ * number.
+ *
+ * Each user of the Sorter must implement this function to ensure that all temporary files that the
+ * Sorter instances produce are uniquely identified using a unique file name extension with separate
+ * atomic variable. This is necessary because the sorter.cpp code is separately included in multiple
+ * places, rather than compiled in one place and linked, and so cannot provide a globally unique ID.
+ */
+std::string nextFileName() {
+    static AtomicWord<unsigned> sortStageFileCounter;
+    return "extsort-sort-stage." + std::to_string(sortStageFileCounter.fetchAndAdd(1));
+}
+
+}  // namespace
+
 // static
 const char* SortStage::kStageType = "SORT";
 
@@ -68,6 +88,46 @@ bool SortStage::WorkingSetComparator::operator()(const SortableDataItem& lhs,
     return lhs.recordId < rhs.recordId;
 }
 
+void SortStage::SpilledMember::serializeForSorter(BufBuilder& buf) const {
+    obj.serializeForSorter(buf);
+    recordId.serializeForSorter(buf);
+    buf.appendChar(textScore ? 1 : 0);
+    if (textScore) {
+        buf.appendNum(*textScore);
+    }
+}
+
+SortStage::SpilledMember SortStage::SpilledMember::deserializeForSorter(
+    BufReader& buf, const SorterDeserializeSettings&) {
+    SpilledMember member;
+    member.obj = BSONObj::deserializeForSorter(buf, BSONObj::SorterDeserializeSettings());
+    member.recordId = RecordId::deserializeForSorter(buf, RecordId::SorterDeserializeSettings());
+    if (buf.read<char>()) {
+        member.textScore = buf.read<LittleEndian<double>>();
+    }
+    return member;
+}
+
+int SortStage::SpilledMember::memUsageForSorter() const {
+    return sizeof(SpilledMember) + obj.objsize();
+}
+
+SortStage::SpilledMember SortStage::SpilledMember::getOwned() const {
+    SpilledMember member(*this);
+    member.obj = obj.getOwned();
+    return member;
+}
+
+int SortStage::SpillComparator::operator()(const SpillSorter::Data& lhs,
+                                           const SpillSorter::Data& rhs) const {
+    // False means ignore field names.
+    int result = lhs.first.woCompare(rhs.first, pattern, false);
+    if (0 != result) {
+        return result;
+    }
+    return lhs.second.recordId.compare(rhs.second.recordId);
+}
+
 SortStage::SortStage(OperationContext* opCtx,
                      const SortStageParams& params,
                      WorkingSet* ws,
@@ -76,6 +136,7 @@ SortStage::SortStage(OperationContext* opCtx,
       _ws(ws),
       _pattern(params.pattern),
       _limit(params.limit),
+      _allowDiskUse(params.allowDiskUse),
       _sorted(false),
       _resultIterator(_data.end()),
       _memUsage(0) {
@@ -97,18 +158,29 @@ SortStage::~SortStage() {}
 bool SortStage::isEOF() {
     // We're done when our child has no more results, we've sorted the child's results, and
     // we've returned all sorted results.
-    return child()->isEOF() && _sorted && (_data.end() == _resultIterator);
+    if (!child()->isEOF() || !_sorted) {
+        return false;
+    }
+    return _spillIterator ? !_spillIterator->more() : (_data.end() == _resultIterator);
 }
 
 PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
     const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
     if (_memUsage > maxBytes) {
-        mongoutils::str::stream ss;
-        ss << "Sort operation used more than the maximum " << maxBytes
-           << " bytes of RAM. Add an index, or specify a smaller limit.";
-        Status status(ErrorCodes::OperationFailed, ss);
-        *out = WorkingSetCommon::allocateStatusMember(_ws, status);
-        return PlanStage::FAILURE;
+        if (!_allowDiskUse) {
+            mongoutils::str::stream ss;
+            ss << "Sort operation used more than the maximum " << maxBytes
+               << " bytes of RAM. Add an index, or specify a smaller limit.";
+            Status status(ErrorCodes::OperationFailed, ss);
+            *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+            return PlanStage::FAILURE;
+        }
+
+        Status status = spillToSorter();
+        if (!status.isOK()) {
+            *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+            return PlanStage::FAILURE;
+        }
     }
 
     if (isEOF()) {
@@ -140,14 +212,28 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
                 item.recordId = member->recordId;
             }
 
-            addToBuffer(item);
+            if (_sorter) {
+                Status status = addToSorter(item);
+                if (!status.isOK()) {
+                    *out = WorkingSetCommon::allocateStatusMember(_ws, status);
+                    return PlanStage::FAILURE;
+                }
+            } else {
+                addToBuffer(item);
+            }
 
             return PlanStage::NEED_TIME;
         } else if (PlanStage::IS_EOF == code) {
             // TODO: We don't need the lock for this.  We could ask for a yield and do this work
             // unlocked.  Also, this is performing a lot of work for one call to work(...)
-            sortBuffer();
-            _resultIterator = _data.begin();
+            if (_sorter) {
+                _spillIterator.reset(_sorter->done());
+                _specificStats.usedDisk = _sorter->usedDisk();
+                _sorter.reset();
+            } else {
+                sortBuffer();
+                _resultIterator = _data.begin();
+            }
             _sorted = true;
             return PlanStage::NEED_TIME;
         } else if (PlanStage::FAILURE == code) {
@@ -164,6 +250,12 @@ PlanStage::StageState SortStage::doWork(WorkingSetID* out) {
     }
 
     // Returning results.
+    if (_spillIterator) {
+        verify(_sorted);
+        *out = allocateFromSpillIterator();
+        return PlanStage::ADVANCED;
+    }
+
     verify(_resultIterator != _data.end());
     verify(_sorted);
     *out = _resultIterator->wsid;
@@ -178,6 +270,7 @@ unique_ptr<PlanStageStats> SortStage::getStats() {
     _specificStats.memLimit = maxBytes;
     _specificStats.memUsage = _memUsage;
     _specificStats.limit = _limit;
+    _specificStats.allowDiskUse = _allowDiskUse;
     _specificStats.sortPattern = _pattern.getOwned();
 
     unique_ptr<PlanStageStats> ret = make_unique<PlanStageStats>(_commonStats, STAGE_SORT);
@@ -292,4 +385,91 @@ void SortStage::sortBuffer() {
     }
 }
 
+Status SortStage::spillToSorter() {
+    if (!_sorter) {
+        const size_t maxBytes = static_cast<size_t>(internalQueryExecMaxBlockingSortBytes.load());
+        SortOptions opts;
+        opts.Limit(_limit)
+            .MaxMemoryUsageBytes(maxBytes)
+            .ExtSortAllowed()
+            .TempDir(storageGlobalParams.dbpath + "/_tmp")
+            .MaxThreads(static_cast<size_t>(internalQueryMaxSortThreads.load()));
+        _sorter.reset(SpillSorter::make(opts, SpillComparator(_sortKeyComparator->pattern)));
+    }
+
+    // Hand off whichever in-memory buffer is in use for the configured limit.
+    if (_dataSet) {
+        for (auto&& item : *_dataSet) {
+            Status status = addToSorter(item);
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+        _dataSet->clear();
+    }
+    for (auto&& item : _data) {
+        Status status = addToSorter(item);
+        if (!status.isOK()) {
+            return status;
+        }
+    }
+    _data.clear();
+    _resultIterator = _data.end();
+
+    // From now on the sorter does its own memory accounting.
+    _memUsage = 0;
+    return Status::OK();
+}
+
+Status SortStage::addToSorter(const SortableDataItem& item) {
+    WorkingSetMember* member = _ws->get(item.wsid);
+
+    // Only data that we know how to reconstitute on the way out may be spilled to disk.
+    if (member->hasComputed(WSM_COMPUTED_GEO_DISTANCE) ||
+        member->hasComputed(WSM_GEO_NEAR_POINT) || member->hasComputed(WSM_INDEX_KEY)) {
+        return Status(ErrorCodes::OperationFailed,
+                      "Sort operation exceeded its memory limit and the buffered results cannot "
+                      "be spilled to disk. Add an index, or specify a smaller limit.");
+    }
+
+    SpilledMember spilled;
+    spilled.obj = member->obj.value();
+    spilled.recordId = item.recordId;
+    if (member->hasComputed(WSM_COMPUTED_TEXT_SCORE)) {
+        spilled.textScore = static_cast<const TextScoreComputedData*>(
+                                member->getComputed(WSM_COMPUTED_TEXT_SCORE))
+                                ->getScore();
+    }
+
+    _sorter->add(item.sortKey, spilled);
+    _ws->free(item.wsid);
+    return Status::OK();
+}
+
+WorkingSetID SortStage::allocateFromSpillIterator() {
+    SpillSorter::Data data = _spillIterator->next();
+
+    WorkingSetID id = _ws->allocate();
+    WorkingSetMember* member = _ws->get(id);
+
+    // The snapshot the document was read in is not retained, so consumers such as update and
+    // delete stages will treat the document as possibly stale and re-check it.
+    member->obj = Snapshotted<BSONObj>(SnapshotId(), data.second.obj.getOwned());
+    if (data.second.recordId.isNormal()) {
+        member->recordId = data.second.recordId;
+        _ws->transitionToRecordIdAndObj(id);
+    } else {
+        _ws->transitionToOwnedObj(id);
+    }
+
+    member->addComputed(new SortKeyComputedData(data.first.getOwned()));
+    if (data.second.textScore) {
+        member->addComputed(new TextScoreComputedData(*data.second.textScore));
+    }
+    return id;
+}
+
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+// Explicit instantiation unneeded since we aren't exposing Sorter outside of this file.
@@ -38,6 +38,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/index_bounds.h"
 #include "mongo/db/record_id.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/stdx/unordered_map.h"
 
 namespace mongo {
@@ -54,6 +55,10 @@ public:
 
     // Equal to 0 for no limit.
     size_t limit = 0;
+
+    // Whether the stage may spill buffered results to disk once it exceeds its memory limit,
+    // rather than failing the query.
+    bool allowDiskUse = false;
 };
 
 /**
@@ -63,6 +68,10 @@ public:
  *   -- For each field in 'pattern', all inputs in the child must handle a getFieldDotted for that
  *   field.
  *   -- All WSMs produced by the child stage must have the sort key available as WSM computed data.
+ *
+ * If 'allowDiskUse' is set and the buffered data grows beyond the configured memory limit, the
+ * buffered results are handed off to an external Sorter which spills sorted runs to the temporary
+ * directory under the dbpath and merges them once the child is exhausted.
  */
 class SortStage final : public PlanStage {
 public:
@@ -99,6 +108,9 @@ private:
     // Equal to 0 for no limit.
     size_t _limit;
 
+    // Whether we may switch to an external sort once '_memUsage' exceeds the memory limit.
+    bool _allowDiskUse;
+
     //
     // Data storage
     //
@@ -131,6 +143,34 @@ private:
         BSONObj pattern;
     };
 
+    /**
+     * The portion of a buffered WorkingSetMember that is handed off to the external sorter. Only
+     * the data needed to reconstitute an equivalent member on the way out is retained.
+     */
+    struct SpilledMember {
+        struct SorterDeserializeSettings {};  // unused
+        void serializeForSorter(BufBuilder& buf) const;
+        static SpilledMember deserializeForSorter(BufReader& buf, const SorterDeserializeSettings&);
+        int memUsageForSorter() const;
+        SpilledMember getOwned() const;
+
+        BSONObj obj;
+        RecordId recordId;
+        // Carried along so that a {$meta: "textScore"} projection above us still works.
+        boost::optional<double> textScore;
+    };
+
+    using SpillSorter = Sorter<BSONObj, SpilledMember>;
+
+    // Orders spilled items the same way as WorkingSetComparator orders buffered ones.
+    struct SpillComparator {
+        explicit SpillComparator(BSONObj p) : pattern(std::move(p)) {}
+
+        int operator()(const SpillSorter::Data& lhs, const SpillSorter::Data& rhs) const;
+
+        BSONObj pattern;
+    };
+
     /**
      * Inserts one item into data buffer (vector or set).
      * If limit is exceeded, remove item with lowest key.
@@ -145,6 +185,23 @@ private:
      */
     void sortBuffer();
 
+    /**
+     * Moves everything currently buffered in memory into '_sorter', creating it if necessary, and
+     * frees the associated working set members. Subsequent calls to addToBuffer() feed the sorter
+     * directly. Returns a non-OK status if a buffered member cannot be spilled.
+     */
+    Status spillToSorter();
+
+    /**
+     * Hands a single item off to '_sorter' and frees its working set member.
+     */
+    Status addToSorter(const SortableDataItem& item);
+
+    /**
+     * Allocates a working set member holding the next result produced by the external sort.
+     */
+    WorkingSetID allocateFromSpillIterator();
+
     // Comparator for data buffer
     // Initialization follows sort key generator
     std::unique_ptr<WorkingSetComparator> _sortKeyComparator;
@@ -163,6 +220,13 @@ private:
     // Iterates through _data post-sort returning it.
     std::vector<SortableDataItem>::iterator _resultIterator;
 
+    // Only set once we have exceeded the memory limit with 'allowDiskUse' enabled. From then on
+    // every result from the child is added to the sorter rather than to _data or _dataSet.
+    std::unique_ptr<SpillSorter> _sorter;
+
+    // When the external sorter was used, iterates through its merged output post-sort.
+    std::unique_ptr<SpillSorter::Iterator> _spillIterator;
+
     SortStats _specificStats;
 
     // The usage in bytes of all buffered data that we're sorting.
@@ -70,6 +70,9 @@ namespace {
 static const RecordId kMultikeyMetadataKeyId =
     RecordId{RecordId::ReservedId::kWildcardMultikeyMetadataId};
 
+// The number of keys commitBulk() adds to the index in each WriteUnitOfWork.
+const int64_t kBulkKeysPerUnitOfWork = 1000;
+
 /**
  * Returns true if at least one prefix of any of the indexed fields causes the index to be
  * multikey, and returns false otherwise. This function returns false if the 'multikeyPaths'
@@ -530,6 +533,11 @@ public:
                   const RecordId& loc,
                   const InsertDeleteOptions& options) final;
 
+    void insertKeys(const BSONObjSet& keys,
+                    const BSONObjSet& multikeyMetadataKeys,
+                    const MultikeyPaths& multikeyPaths,
+                    const RecordId& loc) final;
+
     const MultikeyPaths& getMultikeyPaths() const final;
 
     bool isMultikey() const final;
@@ -572,7 +580,8 @@ AbstractIndexAccessMethod::BulkBuilderImpl::BulkBuilderImpl(const IndexAccessMet
           SortOptions()
               .TempDir(storageGlobalParams.dbpath + "/_tmp")
               .ExtSortAllowed()
-              .MaxMemoryUsageBytes(maxMemoryUsageBytes),
+              .MaxMemoryUsageBytes(maxMemoryUsageBytes)
+              .MaxThreads(static_cast<size_t>(maxIndexBuildSortThreads.load())),
           BtreeExternalSortComparison(descriptor->keyPattern(), descriptor->version()))),
       _real(index) {}
 
@@ -581,9 +590,20 @@ Status AbstractIndexAccessMethod::BulkBuilderImpl::insert(OperationContext* opCt
                                                           const RecordId& loc,
                                                           const InsertDeleteOptions& options) {
     BSONObjSet keys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
+    BSONObjSet multikeyMetadataKeys = SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     MultikeyPaths multikeyPaths;
 
-    _real->getKeys(obj, options.getKeysMode, &keys, &_multikeyMetadataKeys, &multikeyPaths);
+    _real->getKeys(obj, options.getKeysMode, &keys, &multikeyMetadataKeys, &multikeyPaths);
+
+    insertKeys(keys, multikeyMetadataKeys, multikeyPaths, loc);
+    return Status::OK();
+}
+
+void AbstractIndexAccessMethod::BulkBuilderImpl::insertKeys(const BSONObjSet& keys,
+                                                            const BSONObjSet& multikeyMetadataKeys,
+                                                            const MultikeyPaths& multikeyPaths,
+                                                            const RecordId& loc) {
+    _multikeyMetadataKeys.insert(multikeyMetadataKeys.begin(), multikeyMetadataKeys.end());
 
     if (!multikeyPaths.empty()) {
         if (_indexMultikeyPaths.empty()) {
@@ -602,9 +622,7 @@ Status AbstractIndexAccessMethod::BulkBuilderImpl::insert(OperationContext* opCt
     }
 
     _isMultiKey =
-        _isMultiKey || _real->shouldMarkIndexAsMultikey(keys, _multikeyMetadataKeys, multikeyPaths);
-
-    return Status::OK();
+        _isMultiKey || _real->shouldMarkIndexAsMultikey(keys, multikeyMetadataKeys, multikeyPaths);
 }
 
 const MultikeyPaths& AbstractIndexAccessMethod::BulkBuilderImpl::getMultikeyPaths() const {
@@ -657,10 +675,18 @@ Status AbstractIndexAccessMethod::commitBulk(OperationContext* opCtx,
     BSONObj previousKey;
     const Ordering ordering = Ordering::make(_descriptor->keyPattern());
 
+    // Keys are added in batches rather than in a WriteUnitOfWork of their own, as committing a
+    // unit of work for every key dominates the cost of loading them into builders which write
+    // outside of the operation's recovery unit, such as WiredTiger's bulk cursors.
+    boost::optional<WriteUnitOfWork> batchUnit;
+    int64_t keysInBatch = 0;
+
     while (it->more()) {
         opCtx->checkForInterrupt();
 
-        WriteUnitOfWork wunit(opCtx);
+        if (!batchUnit) {
+            batchUnit.emplace(opCtx);
+        }
 
         // Get the next datum and add it to the builder.
         BulkBuilder::Sorter::Data data = it->next();
@@ -710,7 +736,16 @@ Status AbstractIndexAccessMethod::commitBulk(OperationContext* opCtx,
 
         // If we're here either it's a dup and we're cool with it or the addKey went just fine.
         pm.hit();
-        wunit.commit();
+        if (++keysInBatch == kBulkKeysPerUnitOfWork) {
+            batchUnit->commit();
+            batchUnit.reset();
+            keysInBatch = 0;
+        }
+    }
+
+    if (batchUnit) {
+        batchUnit->commit();
+        batchUnit.reset();
     }
 
     pm.finished();
@@ -237,6 +237,16 @@ public:
                               const RecordId& loc,
                               const InsertDeleteOptions& options) = 0;
 
+        /**
+         * Inserts keys which were generated by getKeys() for the document at 'loc'. This is
+         * equivalent to insert(), but allows the keys to be generated elsewhere, such as on
+         * another thread.
+         */
+        virtual void insertKeys(const BSONObjSet& keys,
+                                const BSONObjSet& multikeyMetadataKeys,
+                                const MultikeyPaths& multikeyPaths,
+                                const RecordId& loc) = 0;
+
         virtual const MultikeyPaths& getMultikeyPaths() const = 0;
 
         virtual bool isMultikey() const = 0;
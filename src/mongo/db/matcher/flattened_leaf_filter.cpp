@@ -0,0 +1,400 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/flattened_leaf_filter.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+
+#include "mongo/db/matcher/expression_leaf.h"
+
+namespace mongo {
+
+namespace {
+
+// The largest magnitude at which every integer is exactly representable as a double.
+const long long kMaxExactLong = 1LL << 53;
+
+// Bounds the number of distinct fields and paths we extract from each document, so that the
+// extracted values can live on the stack. Predicates on further paths are evaluated as residuals.
+const size_t kMaxFlattenedFields = 16;
+
+/**
+ * Ranks flattened predicates by how likely they are to reject a document: equalities first, then
+ * $in lists, then ranges.
+ */
+int predicateRank(MatchExpression::MatchType matchType) {
+    switch (matchType) {
+        case MatchExpression::EQ:
+            return 0;
+        case MatchExpression::MATCH_IN:
+            return 1;
+        default:
+            return 2;
+    }
+}
+
+/**
+ * Ranks residual expressions by their evaluation cost: simple leaves first, then logical nodes
+ * which may evaluate many children, then aggregation expressions and JavaScript.
+ */
+int residualRank(const MatchExpression* expr) {
+    switch (expr->matchType()) {
+        case MatchExpression::EXPRESSION:
+        case MatchExpression::WHERE:
+            return 2;
+        default:
+            return expr->numChildren() > 0 ? 1 : 0;
+    }
+}
+
+/**
+ * If 'elem' is a number whose value is exactly representable as a double, stores it in 'out' and
+ * returns true. Numbers for which this is not the case (decimals, NaN for constants, longs beyond
+ * 2^53) must be compared through the general comparison rules instead.
+ */
+bool exactDouble(const BSONElement& elem, double* out) {
+    switch (elem.type()) {
+        case NumberInt:
+            *out = elem._numberInt();
+            return true;
+        case NumberDouble:
+            *out = elem._numberDouble();
+            return true;
+        case NumberLong: {
+            const long long value = elem._numberLong();
+            if (value > kMaxExactLong || value < -kMaxExactLong) {
+                return false;
+            }
+            *out = static_cast<double>(value);
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+/**
+ * Returns true if 'constant' can be compared against with a specialized numeric or string
+ * comparison, and sets 'isNumeric', 'number' and 'string' accordingly. String constants are only
+ * eligible when no collation is in effect.
+ */
+bool flattenConstant(const BSONElement& constant,
+                     const CollatorInterface* collator,
+                     bool* isNumeric,
+                     double* number,
+                     StringData* string) {
+    if (exactDouble(constant, number)) {
+        // NaN compares equal to NaN in the query language, unlike in C++.
+        *isNumeric = true;
+        return !std::isnan(*number);
+    }
+    if (constant.type() == String && !collator) {
+        *isNumeric = false;
+        *string = constant.valueStringData();
+        return true;
+    }
+    return false;
+}
+
+}  // namespace
+
+std::unique_ptr<FlattenedLeafFilter> FlattenedLeafFilter::make(const MatchExpression* filter) {
+    if (!filter) {
+        return nullptr;
+    }
+
+    std::unique_ptr<FlattenedLeafFilter> flattened(new FlattenedLeafFilter());
+    if (filter->matchType() == MatchExpression::AND) {
+        for (size_t i = 0; i < filter->numChildren(); ++i) {
+            const MatchExpression* child = filter->getChild(i);
+            if (!flattened->tryFlatten(child)) {
+                flattened->_residuals.push_back(child);
+            }
+        }
+    } else if (!flattened->tryFlatten(filter)) {
+        return nullptr;
+    }
+
+    if (flattened->_predicates.empty()) {
+        return nullptr;
+    }
+    flattened->orderPredicates();
+    return flattened;
+}
+
+void FlattenedLeafFilter::orderPredicates() {
+    std::stable_sort(
+        _predicates.begin(), _predicates.end(), [](const Predicate& lhs, const Predicate& rhs) {
+            return predicateRank(lhs.expr->matchType()) < predicateRank(rhs.expr->matchType());
+        });
+    std::stable_sort(_residuals.begin(),
+                     _residuals.end(),
+                     [](const MatchExpression* lhs, const MatchExpression* rhs) {
+                         return residualRank(lhs) < residualRank(rhs);
+                     });
+}
+
+bool FlattenedLeafFilter::tryFlatten(const MatchExpression* expr) {
+    Predicate pred;
+    pred.expr = expr;
+    switch (expr->matchType()) {
+        case MatchExpression::EQ:
+            pred.op = Op::kEq;
+            break;
+        case MatchExpression::LT:
+            pred.op = Op::kLt;
+            break;
+        case MatchExpression::LTE:
+            pred.op = Op::kLte;
+            break;
+        case MatchExpression::GT:
+            pred.op = Op::kGt;
+            break;
+        case MatchExpression::GTE:
+            pred.op = Op::kGte;
+            break;
+        case MatchExpression::MATCH_IN:
+            pred.op = Op::kIn;
+            break;
+        default:
+            return false;
+    }
+
+    const StringData path = expr->path();
+    if (path.empty()) {
+        return false;
+    }
+
+    if (pred.op == Op::kIn) {
+        auto in = static_cast<const InMatchExpression*>(expr);
+        if (in->hasNull() || !in->getRegexes().empty()) {
+            return false;
+        }
+        for (auto&& equality : in->getEqualities()) {
+            bool isNumeric;
+            double number;
+            StringData string;
+            if (!flattenConstant(equality, in->getCollator(), &isNumeric, &number, &string)) {
+                return false;
+            }
+            if (isNumeric) {
+                pred.numberSet.push_back(number);
+            } else {
+                pred.stringSet.push_back(string);
+            }
+        }
+        std::sort(pred.numberSet.begin(), pred.numberSet.end());
+        std::sort(pred.stringSet.begin(), pred.stringSet.end());
+    } else {
+        auto cmp = static_cast<const ComparisonMatchExpression*>(expr);
+        if (!flattenConstant(
+                cmp->getData(), cmp->getCollator(), &pred.isNumeric, &pred.number, &pred.string)) {
+            return false;
+        }
+    }
+
+    if (!slotForPath(path, &pred.pathSlot)) {
+        return false;
+    }
+    _predicates.push_back(std::move(pred));
+    return true;
+}
+
+bool FlattenedLeafFilter::slotForPath(StringData path, size_t* slot) {
+    auto pathIt = std::find(_pathNames.begin(), _pathNames.end(), path);
+    if (pathIt != _pathNames.end()) {
+        *slot = pathIt - _pathNames.begin();
+        return true;
+    }
+    if (_paths.size() == kMaxFlattenedFields) {
+        return false;
+    }
+
+    Path newPath;
+    const size_t firstDot = path.find('.');
+    const StringData fieldName = path.substr(0, firstDot);
+    for (size_t start = firstDot; start != std::string::npos;) {
+        const size_t end = path.find('.', start + 1);
+        newPath.components.push_back(path.substr(start + 1, end - (start + 1)));
+        start = end;
+    }
+
+    auto fieldIt = std::find(_fields.begin(), _fields.end(), fieldName);
+    if (fieldIt != _fields.end()) {
+        newPath.fieldSlot = fieldIt - _fields.begin();
+    } else if (_fields.size() < kMaxFlattenedFields) {
+        _fields.push_back(fieldName);
+        newPath.fieldSlot = _fields.size() - 1;
+    } else {
+        return false;
+    }
+
+    _pathNames.push_back(path);
+    _paths.push_back(std::move(newPath));
+    *slot = _paths.size() - 1;
+    return true;
+}
+
+bool FlattenedLeafFilter::matches(const BSONObj& doc) const {
+    // Extract every top-level field we need in a single pass over the document. As with path
+    // traversal, only the first occurrence of a duplicated field name is considered.
+    std::array<BSONElement, kMaxFlattenedFields> fieldValues;
+    size_t remaining = _fields.size();
+    BSONObjIterator it(doc);
+    while (remaining > 0 && it.more()) {
+        BSONElement elem = it.next();
+        const StringData fieldName = elem.fieldNameStringData();
+        for (size_t i = 0; i < _fields.size(); ++i) {
+            if (fieldValues[i].eoo() && _fields[i] == fieldName) {
+                fieldValues[i] = elem;
+                --remaining;
+                break;
+            }
+        }
+    }
+
+    // Resolve each path at most once, and only when a predicate first needs it.
+    std::array<BSONElement, kMaxFlattenedFields> pathValues;
+    std::array<bool, kMaxFlattenedFields> resolved{};
+    for (auto&& pred : _predicates) {
+        if (!resolved[pred.pathSlot]) {
+            const Path& path = _paths[pred.pathSlot];
+            BSONElement value = fieldValues[path.fieldSlot];
+            for (auto&& component : path.components) {
+                if (value.type() != Object) {
+                    // An array along the path is kept as the value so that the predicate defers to
+                    // path traversal. Any other scalar means the path is missing.
+                    if (value.type() != Array) {
+                        value = BSONElement();
+                    }
+                    break;
+                }
+                value = value.embeddedObject()[component];
+            }
+            pathValues[pred.pathSlot] = value;
+            resolved[pred.pathSlot] = true;
+        }
+
+        if (!evaluate(pred, pathValues[pred.pathSlot], doc)) {
+            return false;
+        }
+    }
+
+    for (auto&& residual : _residuals) {
+        if (!residual->matchesBSON(doc)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool FlattenedLeafFilter::evaluate(const Predicate& pred,
+                                   const BSONElement& elem,
+                                   const BSONObj& doc) {
+    // None of the flattened constants are null, so a missing field never matches.
+    if (elem.eoo()) {
+        return false;
+    }
+
+    double number;
+    switch (elem.type()) {
+        case NumberInt:
+        case NumberLong:
+        case NumberDouble: {
+            if (!exactDouble(elem, &number)) {
+                break;
+            }
+            if (pred.op == Op::kIn) {
+                // NaN is never a member of a flattened $in list, and cannot be binary searched.
+                return !std::isnan(number) &&
+                    std::binary_search(pred.numberSet.begin(), pred.numberSet.end(), number);
+            }
+            if (!pred.isNumeric) {
+                return false;
+            }
+            // A NaN value compares false against any non-NaN constant, both here and in the query
+            // language.
+            switch (pred.op) {
+                case Op::kEq:
+                    return number == pred.number;
+                case Op::kLt:
+                    return number < pred.number;
+                case Op::kLte:
+                    return number <= pred.number;
+                case Op::kGt:
+                    return number > pred.number;
+                case Op::kGte:
+                    return number >= pred.number;
+                case Op::kIn:
+                    MONGO_UNREACHABLE;
+            }
+            MONGO_UNREACHABLE;
+        }
+        case String: {
+            const StringData value = elem.valueStringData();
+            if (pred.op == Op::kIn) {
+                return std::binary_search(pred.stringSet.begin(), pred.stringSet.end(), value);
+            }
+            if (pred.isNumeric) {
+                return false;
+            }
+            const int cmp = value.compare(pred.string);
+            switch (pred.op) {
+                case Op::kEq:
+                    return cmp == 0;
+                case Op::kLt:
+                    return cmp < 0;
+                case Op::kLte:
+                    return cmp <= 0;
+                case Op::kGt:
+                    return cmp > 0;
+                case Op::kGte:
+                    return cmp >= 0;
+                case Op::kIn:
+                    MONGO_UNREACHABLE;
+            }
+            MONGO_UNREACHABLE;
+        }
+        case Array:
+            // Arrays are matched element-wise as well as as a whole, and may hold the remainder of
+            // a dotted path in each of their elements, so defer to path traversal.
+            return pred.expr->matchesBSON(doc);
+        default:
+            break;
+    }
+
+    // Every remaining scalar is compared exactly as the original leaf would compare it.
+    return pred.expr->matchesSingleElement(elem);
+}
+
+}  // namespace mongo
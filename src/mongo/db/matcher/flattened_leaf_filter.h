@@ -0,0 +1,154 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <memory>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/string_data.h"
+#include "mongo/bson/bsonelement.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/matcher/expression.h"
+
+namespace mongo {
+
+/**
+ * A flattened form of the simple leaf predicates at the top of a MatchExpression tree, which can
+ * be evaluated directly against raw BSON without walking the tree or re-resolving field paths.
+ *
+ * Only $eq, $lt, $lte, $gt, $gte and $in predicates against numeric or string constants are
+ * flattened. For each document the top-level fields referenced by these predicates are extracted
+ * in a single pass over the document, dotted paths descend from those shared top-level values
+ * once per document, and each predicate is then evaluated with a comparison specialized to the
+ * type of its constant. Values which the specialized comparisons do not handle exactly (arrays
+ * anywhere along the path, decimals, large longs, symbols, ...) fall back to the original
+ * MatchExpression, so matching semantics are identical to those of the tree.
+ *
+ * Any children of a top-level $and which cannot be flattened are kept as residual expressions and
+ * are only evaluated for documents which pass all of the flattened predicates. Predicates are
+ * ordered so that those likely to be the most selective and cheapest to evaluate run first:
+ * equalities, then $in, then ranges, and among the residuals, leaves before logical nodes before
+ * $expr and $where.
+ *
+ * The FlattenedLeafFilter refers to the constants and paths of the MatchExpression it was built
+ * from, which must outlive it.
+ */
+class FlattenedLeafFilter {
+    MONGO_DISALLOW_COPYING(FlattenedLeafFilter);
+
+public:
+    /**
+     * Returns a FlattenedLeafFilter equivalent to 'filter', or nullptr if none of the predicates in
+     * 'filter' are eligible for flattening.
+     */
+    static std::unique_ptr<FlattenedLeafFilter> make(const MatchExpression* filter);
+
+    /**
+     * Returns true if 'doc' matches the filter this object was built from.
+     */
+    bool matches(const BSONObj& doc) const;
+
+    /**
+     * Returns the number of predicates which were flattened.
+     */
+    size_t numFlattenedPredicates() const {
+        return _predicates.size();
+    }
+
+private:
+    // The type of comparison a flattened predicate performs.
+    enum class Op { kEq, kLt, kLte, kGt, kGte, kIn };
+
+    // A path read by one or more predicates, split into its first component, which is shared
+    // with all other paths starting with the same field, and the components below it.
+    struct Path {
+        // Index of the first component in '_fields'.
+        size_t fieldSlot;
+
+        std::vector<StringData> components;
+    };
+
+    struct Predicate {
+        // The original leaf, used whenever the specialized comparison cannot decide.
+        const MatchExpression* expr;
+
+        // Index of the path this predicate reads from in '_paths'.
+        size_t pathSlot;
+
+        Op op;
+
+        // For comparisons, the constant to compare against. Exactly one of these is meaningful,
+        // depending on 'isNumeric'.
+        bool isNumeric = false;
+        double number = 0;
+        StringData string;
+
+        // For $in, the sorted numeric and string members of the list.
+        std::vector<double> numberSet;
+        std::vector<StringData> stringSet;
+    };
+
+    FlattenedLeafFilter() = default;
+
+    /**
+     * Attempts to flatten 'expr', adding a predicate and returning true on success.
+     */
+    bool tryFlatten(const MatchExpression* expr);
+
+    /**
+     * Returns the slot in '_paths' for 'path', adding one (and a slot in '_fields' for its first
+     * component) if necessary. Returns false if doing so would exceed the maximum number of fields
+     * or paths which are extracted per document.
+     */
+    bool slotForPath(StringData path, size_t* slot);
+
+    /**
+     * Orders '_predicates' and '_residuals' by their estimated selectivity and cost.
+     */
+    void orderPredicates();
+
+    /**
+     * Evaluates a single flattened predicate given the value extracted for its field.
+     */
+    static bool evaluate(const Predicate& pred, const BSONElement& elem, const BSONObj& doc);
+
+    // The distinct top-level field names and full paths referenced by '_predicates'.
+    std::vector<StringData> _fields;
+    std::vector<StringData> _pathNames;
+    std::vector<Path> _paths;
+
+    std::vector<Predicate> _predicates;
+
+    // Parts of the filter which could not be flattened.
+    std::vector<const MatchExpression*> _residuals;
+};
+
+}  // namespace mongo
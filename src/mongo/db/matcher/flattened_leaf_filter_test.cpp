@@ -0,0 +1,159 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/matcher/flattened_leaf_filter.h"
+
+#include "mongo/db/json.h"
+#include "mongo/db/matcher/expression_parser.h"
+#include "mongo/db/pipeline/expression_context_for_test.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+std::unique_ptr<MatchExpression> parse(const BSONObj& query,
+                                       const CollatorInterface* collator = nullptr) {
+    boost::intrusive_ptr<ExpressionContextForTest> expCtx(new ExpressionContextForTest());
+    expCtx->setCollator(collator);
+    return unittest::assertGet(MatchExpressionParser::parse(query, std::move(expCtx)));
+}
+
+/**
+ * Asserts that 'query' can be flattened, and that the flattened filter agrees with the original
+ * MatchExpression on every document in 'docs'.
+ */
+void assertEquivalent(const BSONObj& query, const std::vector<BSONObj>& docs) {
+    auto expr = parse(query);
+    auto flattened = FlattenedLeafFilter::make(expr.get());
+    ASSERT(flattened) << query;
+    for (auto&& doc : docs) {
+        ASSERT_EQ(expr->matchesBSON(doc), flattened->matches(doc)) << query << " " << doc;
+    }
+}
+
+const std::vector<BSONObj> kDocs{
+    fromjson("{}"),
+    fromjson("{a: null}"),
+    fromjson("{a: 1}"),
+    fromjson("{a: 1.0}"),
+    fromjson("{a: 2}"),
+    fromjson("{a: NumberLong(3)}"),
+    fromjson("{a: NumberLong('9007199254740993')}"),
+    fromjson("{a: NumberDecimal('2')}"),
+    fromjson("{a: NaN}"),
+    fromjson("{a: -0.0}"),
+    fromjson("{a: 'abc'}"),
+    fromjson("{a: 'abd'}"),
+    fromjson("{a: 'ab'}"),
+    fromjson("{a: [1, 5]}"),
+    fromjson("{a: ['abc', 'x']}"),
+    fromjson("{a: {b: 1}}"),
+    fromjson("{a: true}"),
+    fromjson("{b: 1, a: 2}"),
+    fromjson("{a: 2, a: 1}"),
+    BSON("a" << BSONSymbol("abc")),
+    BSON("a" << Date_t::fromMillisSinceEpoch(1)),
+};
+
+TEST(FlattenedLeafFilterTest, NumericComparisonsMatchTreeEvaluation) {
+    for (auto&& op : {"$eq", "$lt", "$lte", "$gt", "$gte"}) {
+        assertEquivalent(BSON("a" << BSON(op << 2)), kDocs);
+        assertEquivalent(BSON("a" << BSON(op << 1.5)), kDocs);
+        assertEquivalent(BSON("a" << BSON(op << 0)), kDocs);
+        assertEquivalent(BSON("a" << BSON(op << 3LL)), kDocs);
+    }
+}
+
+TEST(FlattenedLeafFilterTest, StringComparisonsMatchTreeEvaluation) {
+    for (auto&& op : {"$eq", "$lt", "$lte", "$gt", "$gte"}) {
+        assertEquivalent(BSON("a" << BSON(op << "abc")), kDocs);
+        assertEquivalent(BSON("a" << BSON(op << "")), kDocs);
+    }
+}
+
+TEST(FlattenedLeafFilterTest, InMatchesTreeEvaluation) {
+    assertEquivalent(fromjson("{a: {$in: [1, 3, 'abc']}}"), kDocs);
+    assertEquivalent(fromjson("{a: {$in: [0, 'x']}}"), kDocs);
+    assertEquivalent(fromjson("{a: {$in: []}}"), kDocs);
+}
+
+TEST(FlattenedLeafFilterTest, ConjunctionsWithResidualsMatchTreeEvaluation) {
+    assertEquivalent(fromjson("{a: {$gte: 1}, b: 1}"), kDocs);
+    assertEquivalent(fromjson("{a: {$gte: 1, $lt: 3}}"), kDocs);
+    assertEquivalent(fromjson("{a: {$gt: 0}, 'a.b': 1}"), kDocs);
+    assertEquivalent(fromjson("{a: {$gt: 0}, $or: [{a: 1}, {a: 'abc'}]}"), kDocs);
+    assertEquivalent(fromjson("{a: {$exists: true}, b: {$in: [1, 2]}}"), kDocs);
+}
+
+TEST(FlattenedLeafFilterTest, DottedPathsMatchTreeEvaluation) {
+    const std::vector<BSONObj> docs{
+        fromjson("{}"),
+        fromjson("{a: 1}"),
+        fromjson("{a: {}}"),
+        fromjson("{a: {b: 1}}"),
+        fromjson("{a: {b: 2, c: 'x'}}"),
+        fromjson("{a: {b: {c: 1}}}"),
+        fromjson("{a: {b: [0, 1]}}"),
+        fromjson("{a: [{b: 1}, {b: 3}]}"),
+        fromjson("{a: [1, 2]}"),
+        fromjson("{a: {'0': 1}}"),
+        fromjson("{a: {b: null}}"),
+    };
+    assertEquivalent(fromjson("{'a.b': 1}"), docs);
+    assertEquivalent(fromjson("{'a.b': {$gte: 1, $lt: 3}, 'a.c': 'x'}"), docs);
+    assertEquivalent(fromjson("{'a.b.c': {$in: [1, 2]}}"), docs);
+    assertEquivalent(fromjson("{'a.0': 1}"), docs);
+    assertEquivalent(fromjson("{a: {$exists: true}, 'a.b': {$lte: 2}}"), docs);
+}
+
+TEST(FlattenedLeafFilterTest, IneligibleFiltersAreNotFlattened) {
+    ASSERT_FALSE(FlattenedLeafFilter::make(nullptr));
+    ASSERT_FALSE(FlattenedLeafFilter::make(parse(fromjson("{a: null}")).get()));
+    ASSERT_FALSE(FlattenedLeafFilter::make(parse(fromjson("{a: NaN}")).get()));
+    ASSERT_FALSE(FlattenedLeafFilter::make(parse(fromjson("{a: NumberDecimal('1')}")).get()));
+    ASSERT_FALSE(FlattenedLeafFilter::make(parse(fromjson("{a: {$in: [1, null]}}")).get()));
+    ASSERT_FALSE(FlattenedLeafFilter::make(parse(fromjson("{a: {$in: [1, /x/]}}")).get()));
+    ASSERT_FALSE(FlattenedLeafFilter::make(parse(fromjson("{$or: [{a: 1}, {b: 1}]}")).get()));
+}
+
+TEST(FlattenedLeafFilterTest, StringComparisonsAreNotFlattenedUnderACollation) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kReverseString);
+    ASSERT_FALSE(FlattenedLeafFilter::make(parse(fromjson("{a: 'abc'}"), &collator).get()));
+
+    auto expr = parse(fromjson("{a: 'abc', b: 1}"), &collator);
+    auto flattened = FlattenedLeafFilter::make(expr.get());
+    ASSERT(flattened);
+    ASSERT_EQ(1U, flattened->numFlattenedPredicates());
+}
+
+}  // namespace
+}  // namespace mongo
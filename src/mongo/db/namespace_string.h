@@ -61,6 +61,10 @@ public:
     // Name for the system views collection
     static constexpr StringData kSystemDotViewsCollectionName = "system.views"_sd;
 
+    // Name for the system statistics collection, which holds per-collection cardinality
+    // statistics produced by the 'analyze' command.
+    static constexpr StringData kSystemDotStatisticsCollectionName = "system.statistics"_sd;
+
     // Prefix for orphan collections
     static constexpr StringData kOrphanCollectionPrefix = "orphan."_sd;
     static constexpr StringData kOrphanCollectionDb = "local"_sd;
@@ -232,6 +236,9 @@ public:
     bool isSystemDotViews() const {
         return coll() == kSystemDotViewsCollectionName;
     }
+    bool isSystemDotStatistics() const {
+        return coll() == kSystemDotStatisticsCollectionName;
+    }
     bool isServerConfigurationCollection() const {
         return (db() == kAdminDb) && (coll() == "system.version");
     }
@@ -34,13 +34,16 @@
 #include "mongo/db/op_observer_impl.h"
 
 #include <limits>
+#include <vector>
 
 #include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/collection_catalog_entry.h"
 #include "mongo/db/catalog/collection_options.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
 #include "mongo/db/catalog/namespace_uuid_cache.h"
+#include "mongo/db/catalog/uuid_catalog.h"
 #include "mongo/db/commands/feature_compatibility_version.h"
 #include "mongo/db/commands/feature_compatibility_version_parser.h"
 #include "mongo/db/commands/txn_cmds_gen.h"
@@ -336,6 +339,45 @@ OpTimeBundle replLogApplyOps(OperationContext* opCtx,
     return times;
 }
 
+/**
+ * Invalidates the cardinality statistics cached for the collection described by the
+ * 'system.statistics' document with the given '_id', which is the collection's UUID, once the
+ * write to that document commits.
+ */
+void invalidateCollectionStatistics(OperationContext* opCtx, const BSONElement& id) {
+    auto uuid = UUID::parse(id);
+    if (!uuid.isOK()) {
+        return;
+    }
+    Collection* collection = UUIDCatalog::get(opCtx).lookupCollectionByUUID(uuid.getValue());
+    if (!collection) {
+        return;
+    }
+    CollectionInfoCache* infoCache = collection->infoCache();
+    opCtx->recoveryUnit()->onCommit(
+        [infoCache](boost::optional<Timestamp>) { infoCache->invalidateStatistics(); });
+}
+
+/**
+ * Invalidates the cardinality statistics cached for every collection in 'dbName', once the drop or
+ * rename of its 'system.statistics' collection commits.
+ */
+void invalidateDatabaseStatistics(OperationContext* opCtx, StringData dbName) {
+    Database* db = DatabaseHolder::get(opCtx)->getDb(opCtx, dbName);
+    if (!db) {
+        return;
+    }
+    std::vector<CollectionInfoCache*> infoCaches;
+    for (auto&& collection : *db) {
+        infoCaches.push_back(collection->infoCache());
+    }
+    opCtx->recoveryUnit()->onCommit([infoCaches](boost::optional<Timestamp>) {
+        for (auto&& infoCache : infoCaches) {
+            infoCache->invalidateStatistics();
+        }
+    });
+}
+
 }  // namespace
 
 BSONObj OpObserverImpl::getDocumentKey(OperationContext* opCtx,
@@ -546,6 +588,10 @@ void OpObserverImpl::onInserts(OperationContext* opCtx,
         Scope::storedFuncMod(opCtx);
     } else if (nss.coll() == DurableViewCatalog::viewsCollectionName()) {
         DurableViewCatalog::onExternalChange(opCtx, nss);
+    } else if (nss.isSystemDotStatistics()) {
+        for (auto it = first; it != last; it++) {
+            invalidateCollectionStatistics(opCtx, it->doc["_id"]);
+        }
     } else if (nss == NamespaceString::kServerConfigurationNamespace) {
         // We must check server configuration collection writes for featureCompatibilityVersion
         // document changes.
@@ -613,6 +659,8 @@ void OpObserverImpl::onUpdate(OperationContext* opCtx, const OplogUpdateEntryArg
         Scope::storedFuncMod(opCtx);
     } else if (args.nss.coll() == DurableViewCatalog::viewsCollectionName()) {
         DurableViewCatalog::onExternalChange(opCtx, args.nss);
+    } else if (args.nss.isSystemDotStatistics()) {
+        invalidateCollectionStatistics(opCtx, args.updateArgs.updatedDoc["_id"]);
     } else if (args.nss == NamespaceString::kServerConfigurationNamespace) {
         // We must check server configuration collection writes for featureCompatibilityVersion
         // document changes.
@@ -674,6 +722,8 @@ void OpObserverImpl::onDelete(OperationContext* opCtx,
         Scope::storedFuncMod(opCtx);
     } else if (nss.coll() == DurableViewCatalog::viewsCollectionName()) {
         DurableViewCatalog::onExternalChange(opCtx, nss);
+    } else if (nss.isSystemDotStatistics()) {
+        invalidateCollectionStatistics(opCtx, documentKey["_id"]);
     } else if (nss.isServerConfigurationCollection()) {
         auto _id = documentKey["_id"];
         if (_id.type() == BSONType::String &&
@@ -860,6 +910,8 @@ repl::OpTime OpObserverImpl::onDropCollection(OperationContext* opCtx,
 
     if (collectionName.coll() == DurableViewCatalog::viewsCollectionName()) {
         DurableViewCatalog::onExternalChange(opCtx, collectionName);
+    } else if (collectionName.isSystemDotStatistics()) {
+        invalidateDatabaseStatistics(opCtx, collectionName.db());
     } else if (collectionName == NamespaceString::kSessionTransactionsTableNamespace) {
         MongoDSessionCatalog::invalidateSessions(opCtx, boost::none);
     }
@@ -948,6 +1000,10 @@ void OpObserverImpl::postRenameCollection(OperationContext* const opCtx,
         DurableViewCatalog::onExternalChange(opCtx, fromCollection);
     if (toCollection.isSystemDotViews())
         DurableViewCatalog::onExternalChange(opCtx, toCollection);
+    if (fromCollection.isSystemDotStatistics())
+        invalidateDatabaseStatistics(opCtx, fromCollection.db());
+    if (toCollection.isSystemDotStatistics())
+        invalidateDatabaseStatistics(opCtx, toCollection.db());
 
     // Evict namespace entry from the namespace/uuid cache if it exists.
     NamespaceUUIDCache& cache = NamespaceUUIDCache::get(opCtx);
@@ -228,6 +228,8 @@ Status userAllowedCreateNS(StringData db, StringData coll) {
             return Status::OK();
         if (coll == DurableViewCatalog::viewsCollectionName())
             return Status::OK();
+        if (coll == NamespaceString::kSystemDotStatisticsCollectionName)
+            return Status::OK();
         if (db == "admin") {
             if (coll == "system.version")
                 return Status::OK();
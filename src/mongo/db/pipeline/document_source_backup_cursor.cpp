@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_backup_cursor.h"
+
+#include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+REGISTER_DOCUMENT_SOURCE(backupCursor,
+                         DocumentSourceBackupCursor::LiteParsed::parse,
+                         DocumentSourceBackupCursor::createFromBson);
+
+constexpr StringData DocumentSourceBackupCursor::kStageName;
+constexpr int DocumentSourceBackupCursor::kChunkSizeBytes;
+
+DocumentSourceBackupCursor::DocumentSourceBackupCursor(
+    const boost::intrusive_ptr<ExpressionContext>& pExpCtx)
+    : DocumentSource(pExpCtx), _buffer(new char[kChunkSizeBytes]) {}
+
+boost::intrusive_ptr<DocumentSource> DocumentSourceBackupCursor::createFromBson(
+    BSONElement spec, const boost::intrusive_ptr<ExpressionContext>& pExpCtx) {
+    uassert(ErrorCodes::FailedToParse,
+            str::stream() << kStageName << " value must be an empty object, but found: " << spec,
+            spec.type() == BSONType::Object && spec.embeddedObject().isEmpty());
+
+    uassert(ErrorCodes::IllegalOperation,
+            str::stream() << kStageName << " must be run directly against a mongod",
+            !pExpCtx->inMongos);
+
+    const NamespaceString& nss = pExpCtx->ns;
+    uassert(ErrorCodes::InvalidNamespace,
+            str::stream() << kStageName
+                          << " must be run against the 'admin' database with {aggregate: 1}",
+            nss.db() == NamespaceString::kAdminDb && nss.isCollectionlessAggregateNS());
+
+    return new DocumentSourceBackupCursor(pExpCtx);
+}
+
+DocumentSource::GetNextResult DocumentSourceBackupCursor::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    if (!_backupCursorState) {
+        _backupCursorState = pExpCtx->mongoProcessInterface->openBackupCursor(pExpCtx->opCtx);
+        if (_backupCursorState->preamble) {
+            return Document(*_backupCursorState->preamble);
+        }
+    }
+
+    if (_fileIndex == _backupCursorState->filenames.size()) {
+        return GetNextResult::makeEOF();
+    }
+    return _readNextChunk();
+}
+
+Document DocumentSourceBackupCursor::_readNextChunk() {
+    const auto& filename = _backupCursorState->filenames[_fileIndex];
+    if (!_file.is_open()) {
+        _file.open(filename, std::ios::in | std::ios::binary);
+        uassert(51113,
+                str::stream() << "Failed to open backup file " << filename,
+                _file.is_open());
+        _byteOffset = 0;
+    }
+
+    _file.read(_buffer.get(), kChunkSizeBytes);
+    uassert(51114,
+            str::stream() << "Failed to read backup file " << filename << " at offset "
+                          << _byteOffset,
+            !_file.bad());
+    const auto bytesRead = static_cast<int>(_file.gcount());
+    const bool endOfFile = _file.eof();
+
+    Document chunk{{"filename", filename},
+                   {"byteOffset", _byteOffset},
+                   {"data", BSONBinData(_buffer.get(), bytesRead, BinDataGeneral)},
+                   {"endOfFile", endOfFile}};
+
+    _byteOffset += bytesRead;
+    if (endOfFile) {
+        _file.close();
+        _file.clear();
+        ++_fileIndex;
+    }
+    return chunk;
+}
+
+void DocumentSourceBackupCursor::doDispose() {
+    _file.close();
+    if (_backupCursorState) {
+        pExpCtx->mongoProcessInterface->closeBackupCursor(pExpCtx->opCtx,
+                                                          _backupCursorState->backupId);
+        _backupCursorState = boost::none;
+    }
+}
+
+}  // namespace mongo
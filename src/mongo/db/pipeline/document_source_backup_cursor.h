@@ -0,0 +1,152 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+#include <fstream>
+#include <memory>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/storage/backup_cursor_state.h"
+
+namespace mongo {
+
+/**
+ * Opens a backup cursor on the most recent checkpoint and streams the contents of its files, so
+ * that a copy of the node's data can be made over a regular connection. The backup cursor stays
+ * open, and the checkpoint pinned, until this stage is disposed of.
+ *
+ * The first document returned is the backup cursor's preamble, {metadata: {...}}. It is followed
+ * by the contents of each file in order, in chunks of the form
+ * {filename: <path>, byteOffset: <offset>, data: <BinData>, endOfFile: <bool>}.
+ * The chunks of a file are contiguous and the last one has 'endOfFile' set.
+ *
+ * Must be run against the 'admin' database with {aggregate: 1}.
+ */
+class DocumentSourceBackupCursor final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$backupCursor"_sd;
+
+    // The maximum number of bytes of a file returned in a single document.
+    static constexpr int kChunkSizeBytes = 1024 * 1024;
+
+    class LiteParsed final : public LiteParsedDocumentSource {
+    public:
+        static std::unique_ptr<LiteParsed> parse(const AggregationRequest& request,
+                                                 const BSONElement& spec) {
+            return stdx::make_unique<LiteParsed>();
+        }
+
+        stdx::unordered_set<NamespaceString> getInvolvedNamespaces() const final {
+            return stdx::unordered_set<NamespaceString>();
+        }
+
+        PrivilegeVector requiredPrivileges(bool isMongos) const final {
+            return {Privilege(ResourcePattern::forClusterResource(), ActionType::fsync)};
+        }
+
+        bool isInitialSource() const final {
+            return true;
+        }
+
+        bool allowedToForwardFromMongos() const final {
+            // $backupCursor must be run directly against a mongod.
+            return false;
+        }
+
+        bool allowedToPassthroughFromMongos() const final {
+            // $backupCursor must be run directly against a mongod.
+            return false;
+        }
+
+        void assertSupportsReadConcern(const repl::ReadConcernArgs& readConcern) const {
+            uassert(ErrorCodes::InvalidOptions,
+                    str::stream() << "Aggregation stage " << kStageName
+                                  << " requires read concern local but found "
+                                  << readConcern.toString(),
+                    readConcern.getLevel() == repl::ReadConcernLevel::kLocalReadConcern);
+        }
+    };
+
+    static boost::intrusive_ptr<DocumentSource> createFromBson(
+        BSONElement spec, const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
+
+    GetNextResult getNext() final;
+
+    const char* getSourceName() const final {
+        return kStageName.rawData();
+    }
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        StageConstraints constraints(StreamType::kStreaming,
+                                     PositionRequirement::kFirst,
+                                     HostTypeRequirement::kLocalOnly,
+                                     DiskUseRequirement::kNoDiskUse,
+                                     FacetRequirement::kNotAllowed,
+                                     TransactionRequirement::kNotAllowed);
+
+        constraints.isIndependentOfAnyCollection = true;
+        constraints.requiresInputDocSource = false;
+        return constraints;
+    }
+
+    boost::optional<MergingLogic> mergingLogic() final {
+        return boost::none;
+    }
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final {
+        return Value(Document{{kStageName, Document()}});
+    }
+
+protected:
+    void doDispose() final;
+
+private:
+    explicit DocumentSourceBackupCursor(const boost::intrusive_ptr<ExpressionContext>& pExpCtx);
+
+    /**
+     * Returns the next chunk of the file at '_fileIndex', moving on to the next file once the end
+     * of the current one is reached.
+     */
+    Document _readNextChunk();
+
+    // Populated when the backup cursor is opened on the first call to getNext().
+    boost::optional<BackupCursorState> _backupCursorState;
+
+    // The position of the next chunk to return.
+    size_t _fileIndex = 0;
+    long long _byteOffset = 0;
+    std::ifstream _file;
+
+    std::unique_ptr<char[]> _buffer;
+};
+
+}  // namespace mongo
@@ -0,0 +1,193 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/document_source_backup_cursor.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/pipeline/stub_mongo_process_interface.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+class DocumentSourceBackupCursorTest : public AggregationContextFixture {
+public:
+    DocumentSourceBackupCursorTest()
+        : AggregationContextFixture(NamespaceString::makeCollectionlessAggregateNSS("admin")) {}
+};
+
+/**
+ * A MongoProcessInterface which opens a backup cursor on a given set of files.
+ */
+class MockMongoInterface final : public StubMongoProcessInterface {
+public:
+    explicit MockMongoInterface(std::vector<std::string> filenames)
+        : _filenames(std::move(filenames)) {}
+
+    BackupCursorState openBackupCursor(OperationContext* opCtx) override {
+        ASSERT_FALSE(openBackupId);
+        openBackupId = UUID::gen();
+        return {*openBackupId, Document{{"metadata", Document{{"dbpath", "test"_sd}}}}, _filenames};
+    }
+
+    void closeBackupCursor(OperationContext* opCtx, const UUID& backupId) override {
+        ASSERT_TRUE(openBackupId);
+        ASSERT_EQ(*openBackupId, backupId);
+        openBackupId = boost::none;
+    }
+
+    boost::optional<UUID> openBackupId;
+
+private:
+    const std::vector<std::string> _filenames;
+};
+
+std::string writeFile(const boost::filesystem::path& path, size_t size) {
+    std::string contents(size, 'x');
+    for (size_t i = 0; i < size; ++i) {
+        contents[i] = static_cast<char>(i % 251);
+    }
+    std::ofstream file(path.string(), std::ios::out | std::ios::binary);
+    file.write(contents.data(), contents.size());
+    return contents;
+}
+
+void assertChunk(const Document& chunk,
+                 const std::string& filename,
+                 const std::string& contents,
+                 long long byteOffset,
+                 size_t length,
+                 bool endOfFile) {
+    ASSERT_VALUE_EQ(Value(filename), chunk["filename"]);
+    ASSERT_VALUE_EQ(Value(byteOffset), chunk["byteOffset"]);
+    ASSERT_VALUE_EQ(Value(endOfFile), chunk["endOfFile"]);
+    const auto data = chunk["data"].getBinData();
+    ASSERT_EQ(static_cast<int>(length), data.length);
+    ASSERT_EQ(contents.substr(byteOffset, length),
+              std::string(static_cast<const char*>(data.data), data.length));
+}
+
+TEST_F(DocumentSourceBackupCursorTest, ShouldFailToParseIfSpecIsNotEmptyObject) {
+    ASSERT_THROWS_CODE(DocumentSourceBackupCursor::createFromBson(
+                           fromjson("{$backupCursor: 1}").firstElement(), getExpCtx()),
+                       AssertionException,
+                       ErrorCodes::FailedToParse);
+    ASSERT_THROWS_CODE(DocumentSourceBackupCursor::createFromBson(
+                           fromjson("{$backupCursor: {a: 1}}").firstElement(), getExpCtx()),
+                       AssertionException,
+                       ErrorCodes::FailedToParse);
+}
+
+TEST_F(DocumentSourceBackupCursorTest, ShouldFailToParseIfNotRunOnAdminWithAggregateOne) {
+    const auto spec = fromjson("{$backupCursor: {}}");
+    getExpCtx()->ns = NamespaceString::makeCollectionlessAggregateNSS("foo");
+    ASSERT_THROWS_CODE(DocumentSourceBackupCursor::createFromBson(spec.firstElement(), getExpCtx()),
+                       AssertionException,
+                       ErrorCodes::InvalidNamespace);
+    getExpCtx()->ns = NamespaceString("admin.foo");
+    ASSERT_THROWS_CODE(DocumentSourceBackupCursor::createFromBson(spec.firstElement(), getExpCtx()),
+                       AssertionException,
+                       ErrorCodes::InvalidNamespace);
+}
+
+TEST_F(DocumentSourceBackupCursorTest, ShouldStreamFileContentsInChunks) {
+    unittest::TempDir tempDir("DocumentSourceBackupCursorTest");
+    const auto largeFile = (boost::filesystem::path(tempDir.path()) / "large.wt").string();
+    const auto emptyFile = (boost::filesystem::path(tempDir.path()) / "empty.wt").string();
+    const size_t kLargeFileSize = DocumentSourceBackupCursor::kChunkSizeBytes + 10;
+    const auto largeContents = writeFile(largeFile, kLargeFileSize);
+    writeFile(emptyFile, 0);
+
+    auto mongoInterface = std::make_shared<MockMongoInterface>(
+        std::vector<std::string>{largeFile, emptyFile});
+    getExpCtx()->mongoProcessInterface = mongoInterface;
+    auto stage = DocumentSourceBackupCursor::createFromBson(
+        fromjson("{$backupCursor: {}}").firstElement(), getExpCtx());
+
+    const Document expectedPreamble{{"metadata", Document{{"dbpath", "test"_sd}}}};
+    auto next = stage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_DOCUMENT_EQ(expectedPreamble, next.releaseDocument());
+    ASSERT_TRUE(mongoInterface->openBackupId);
+
+    next = stage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    assertChunk(next.releaseDocument(),
+                largeFile,
+                largeContents,
+                0,
+                DocumentSourceBackupCursor::kChunkSizeBytes,
+                false);
+
+    next = stage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    assertChunk(next.releaseDocument(),
+                largeFile,
+                largeContents,
+                DocumentSourceBackupCursor::kChunkSizeBytes,
+                10,
+                true);
+
+    next = stage->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    assertChunk(next.releaseDocument(), emptyFile, "", 0, 0, true);
+
+    ASSERT_TRUE(stage->getNext().isEOF());
+
+    // The backup cursor is closed when the stage is disposed of.
+    ASSERT_TRUE(mongoInterface->openBackupId);
+    stage->dispose();
+    ASSERT_FALSE(mongoInterface->openBackupId);
+}
+
+TEST_F(DocumentSourceBackupCursorTest, ShouldFailIfFileCannotBeOpened) {
+    unittest::TempDir tempDir("DocumentSourceBackupCursorTest");
+    const auto missingFile = (boost::filesystem::path(tempDir.path()) / "missing.wt").string();
+    auto mongoInterface =
+        std::make_shared<MockMongoInterface>(std::vector<std::string>{missingFile});
+    getExpCtx()->mongoProcessInterface = mongoInterface;
+    auto stage = DocumentSourceBackupCursor::createFromBson(
+        fromjson("{$backupCursor: {}}").firstElement(), getExpCtx());
+
+    ASSERT_TRUE(stage->getNext().isAdvanced());
+    ASSERT_THROWS_CODE(stage->getNext(), AssertionException, 51113);
+    stage->dispose();
+    ASSERT_FALSE(mongoInterface->openBackupId);
+}
+
+}  // namespace
+}  // namespace mongo
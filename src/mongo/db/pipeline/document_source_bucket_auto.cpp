@@ -33,6 +33,7 @@
 
 #include "mongo/db/pipeline/accumulation_statement.h"
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
+#include "mongo/db/query/query_knobs_gen.h"
 
 namespace mongo {
 
@@ -133,6 +134,7 @@ DocumentSource::GetNextResult DocumentSourceBucketAuto::populateSorter() {
         if (pExpCtx->allowDiskUse && !pExpCtx->inMongos) {
             opts.extSortAllowed = true;
             opts.tempDir = pExpCtx->tempDir;
+            opts.maxThreads = static_cast<size_t>(internalQueryMaxSortThreads.load());
         }
         const auto& valueCmp = pExpCtx->getValueComparator();
         auto comparator = [valueCmp](const Sorter<Value, Document>::Data& lhs,
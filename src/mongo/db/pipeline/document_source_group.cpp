@@ -29,7 +29,9 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <boost/filesystem/operations.hpp>
+#include <numeric>
 
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pipeline/accumulation_statement.h"
@@ -41,6 +43,7 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/util/destructor_guard.h"
 
@@ -143,30 +146,45 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNext() {
         invariant(initializationResult.isEOF());
     }
 
+    if (_streaming) {
+        // A streaming $group may return in the middle of accumulating a group, so it resets the
+        // accumulators itself.
+        return getNextStreaming();
+    }
+
     for (auto&& accum : _currentAccumulators) {
         accum->reset();  // Prep accumulators for a new group.
     }
 
     if (_spilled) {
         return getNextSpilled();
-    } else if (_streaming) {
-        return getNextStreaming();
     } else {
         return getNextStandard();
     }
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
-    // We aren't streaming, and we have spilled to disk.
-    if (!_sorterIterator)
+    // We aren't streaming, and we have spilled to disk. The partitions which never spilled are
+    // still in memory, so return their groups first.
+    if (groupsIterator != _groups->end()) {
+        Document out =
+            makeDocument(groupsIterator->first, groupsIterator->second, pExpCtx->needsMerge);
+        ++groupsIterator;
+        return std::move(out);
+    }
+
+    // Then merge the sorted runs of each spilled partition in turn.
+    if (!_sorterIterator && !startMergingNextSpilledPartition()) {
+        dispose();
         return GetNextResult::makeEOF();
+    }
 
     _currentId = _firstPartOfNextGroup.first;
     const size_t numAccumulators = _accumulatedFields.size();
     while (pExpCtx->getValueComparator().evaluate(_currentId == _firstPartOfNextGroup.first)) {
         // Inside of this loop, _firstPartOfNextGroup is the current data being processed.
         // At loop exit, it is the first value to be processed in the next group.
-        switch (numAccumulators) {  // mirrors switch in spill()
+        switch (numAccumulators) {  // mirrors switch in writeSpilledRun()
             case 1:                 // Single accumulators serialize as a single Value.
                 _currentAccumulators[0]->process(_firstPartOfNextGroup.second, true);
             case 0:  // No accumulators so no Values.
@@ -180,7 +198,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextSpilled() {
         }
 
         if (!_sorterIterator->more()) {
-            dispose();
+            _sorterIterator.reset();
             break;
         }
 
@@ -204,52 +222,85 @@ DocumentSource::GetNextResult DocumentSourceGroup::getNextStandard() {
 }
 
 DocumentSource::GetNextResult DocumentSourceGroup::getNextStreaming() {
-    // Streaming optimization is active.
-    if (!_firstDocOfNextGroup) {
+    // Streaming optimization is active. The input is sorted such that documents whose group keys
+    // are neither nullish nor arrays arrive consecutively, so each such group can be returned as
+    // soon as a document with a different key arrives.
+    while (!_streamingInputExhausted) {
         auto nextInput = pSource->getNext();
-        if (!nextInput.isAdvanced()) {
+        if (nextInput.isPaused()) {
             return nextInput;
         }
-        _firstDocOfNextGroup = nextInput.releaseDocument();
-    }
 
-    Value id;
-    do {
-        // Add to the current accumulator(s).
-        for (size_t i = 0; i < _currentAccumulators.size(); i++) {
-            _currentAccumulators[i]->process(
-                _accumulatedFields[i].expression->evaluate(*_firstDocOfNextGroup), _doingMerge);
+        if (nextInput.isEOF()) {
+            _streamingInputExhausted = true;
+            prepareToOutputGroups();
+            if (_streamingGroupInProgress) {
+                _streamingGroupInProgress = false;
+                return makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+            }
+            break;
         }
 
-        // Retrieve the next document.
-        auto nextInput = pSource->getNext();
-        if (!nextInput.isAdvanced()) {
-            return nextInput;
+        auto rootDocument = nextInput.releaseDocument();
+        Value id = computeId(rootDocument);
+
+        // Documents whose keys may be interleaved with others in the input are grouped in
+        // '_groups' instead, and returned once the input is exhausted.
+        if (!canStreamDocument(rootDocument)) {
+            accumulateIntoGroups(rootDocument, std::move(id));
+            continue;
         }
 
-        _firstDocOfNextGroup = nextInput.releaseDocument();
+        boost::optional<Document> out;
+        if (_streamingGroupInProgress &&
+            !pExpCtx->getValueComparator().evaluate(_currentId == id)) {
+            out = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
+            for (auto&& accum : _currentAccumulators) {
+                accum->reset();
+            }
+        }
 
+        _currentId = std::move(id);
+        _streamingGroupInProgress = true;
+        for (size_t i = 0; i < _currentAccumulators.size(); i++) {
+            _currentAccumulators[i]->process(
+                _accumulatedFields[i].expression->evaluate(rootDocument), _doingMerge);
+        }
 
-        // Compute the id. If it does not match _currentId, we will exit the loop, leaving
-        // _firstDocOfNextGroup set for the next time getNext() is called.
-        id = computeId(*_firstDocOfNextGroup);
-    } while (pExpCtx->getValueComparator().evaluate(_currentId == id));
+        if (out) {
+            return std::move(*out);
+        }
+    }
 
-    Document out = makeDocument(_currentId, _currentAccumulators, pExpCtx->needsMerge);
-    _currentId = std::move(id);
+    // Return the groups which could not be streamed.
+    for (auto&& accum : _currentAccumulators) {
+        accum->reset();
+    }
+    return _spilled ? getNextSpilled() : getNextStandard();
+}
 
-    return std::move(out);
+bool DocumentSourceGroup::canStreamDocument(const Document& root) const {
+    // Nullish values and arrays of the sorted fields do not arrive together with the other
+    // documents in their group. For example, the input may be sorted on 'a' but have documents
+    // with {a: null}, {a: [null, 1]} and {} interleaved.
+    return std::all_of(_streamingPaths.begin(), _streamingPaths.end(), [&root](const auto& path) {
+        const Value value = root.getNestedField(path);
+        return !value.nullish() && !value.isArray();
+    });
 }
 
 void DocumentSourceGroup::doDispose() {
     // Free our resources.
     _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
     _sorterIterator.reset();
+    deleteUnmergedSpillFiles();
+    _nextPartitionToMerge = _spilledPartitions.size();
 
     // Make us look done.
     groupsIterator = _groups->end();
 
-    _firstDocOfNextGroup = boost::none;
+    _streamingGroupInProgress = false;
+    _streamingInputExhausted = true;
 }
 
 intrusive_ptr<DocumentSource> DocumentSourceGroup::optimize() {
@@ -360,21 +411,35 @@ DocumentSourceGroup::DocumentSourceGroup(const intrusive_ptr<ExpressionContext>&
       _doingMerge(false),
       _maxMemoryUsageBytes(maxMemoryUsageBytes ? *maxMemoryUsageBytes
                                                : internalDocumentSourceGroupMaxMemoryBytes.load()),
-      _inputSort(BSONObj()),
       _streaming(false),
       _initialized(false),
       _groups(pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>()),
+      _spilledPartitions(internalDocumentSourceGroupSpillPartitions.load()),
       _spilled(false),
       _allowDiskUse(pExpCtx->allowDiskUse && !pExpCtx->inMongos) {
     if (!pExpCtx->inMongos && (pExpCtx->allowDiskUse || kDebugBuild)) {
-        // We spill to disk in debug mode, regardless of allowDiskUse, to stress the system.
-        _fileName = pExpCtx->tempDir + "/" + nextFileName();
+        // We spill to disk in debug mode, regardless of allowDiskUse, to stress the system. Each
+        // partition spills to its own file, so that it can be merged on its own.
+        const std::string fileName = pExpCtx->tempDir + "/" + nextFileName();
+        for (size_t i = 0; i < _spilledPartitions.size(); i++) {
+            _spilledPartitions[i].fileName = fileName + "." + std::to_string(i);
+        }
     }
 }
 
 DocumentSourceGroup::~DocumentSourceGroup() {
-    if (_ownsFileDeletion) {
-        DESTRUCTOR_GUARD(boost::filesystem::remove(_fileName));
+    // A merge iterator deletes the file it merges, and must close it first.
+    _sorterIterator.reset();
+    deleteUnmergedSpillFiles();
+}
+
+void DocumentSourceGroup::deleteUnmergedSpillFiles() {
+    for (auto&& partition : _spilledPartitions) {
+        if (!partition.runs.empty()) {
+            partition.runs.clear();
+            boost::system::error_code ec;
+            boost::filesystem::remove(partition.fileName, ec);
+        }
     }
 }
 
@@ -515,28 +580,6 @@ bool containsOnlyFieldPathsAndConstants(ExpressionObject* expressionObj) {
     return true;
 }
 
-void getFieldPathMap(ExpressionObject* expressionObj,
-                     std::string prefix,
-                     StringMap<std::string>* fields) {
-    // Given an expression with only constant and FieldPath leaf nodes, such as {x: {y: "$a.b"}},
-    // attempt to compute a map from each FieldPath leaf to the path of that leaf. In the example,
-    // this method would return: {"a.b" : "x.y"}.
-
-    for (auto&& it : expressionObj->getChildExpressions()) {
-        intrusive_ptr<Expression> childExp = it.second;
-        ExpressionObject* expObj = dynamic_cast<ExpressionObject*>(childExp.get());
-        ExpressionFieldPath* expPath = dynamic_cast<ExpressionFieldPath*>(childExp.get());
-
-        std::string newPrefix = prefix.empty() ? it.first : prefix + "." + it.first;
-
-        if (expObj) {
-            getFieldPathMap(expObj, newPrefix, fields);
-        } else if (expPath) {
-            (*fields)[expPath->getFieldPath().tail().fullPath()] = newPrefix;
-        }
-    }
-}
-
 void getFieldPathListForSpilled(ExpressionObject* expressionObj,
                                 std::string prefix,
                                 std::vector<std::string>* fields) {
@@ -559,94 +602,34 @@ void getFieldPathListForSpilled(ExpressionObject* expressionObj,
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
-    const size_t numAccumulators = _accumulatedFields.size();
-
-    boost::optional<BSONObj> inputSort = findRelevantInputSort();
-    if (inputSort) {
-        // We can convert to streaming.
-        _streaming = true;
-        _inputSort = *inputSort;
-
-        // Set up accumulators.
-        _currentAccumulators.reserve(numAccumulators);
+    // Set up the accumulators used to build a group at a time when streaming or merging spilled
+    // groups.
+    if (_currentAccumulators.empty()) {
+        _currentAccumulators.reserve(_accumulatedFields.size());
         for (auto&& accumulatedField : _accumulatedFields) {
             _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
         }
+    }
 
-        // We only need to load the first document.
-        auto firstInput = pSource->getNext();
-        if (!firstInput.isAdvanced()) {
-            // Leave '_firstDocOfNextGroup' uninitialized and return.
-            return firstInput;
+    boost::optional<BSONObj> inputSort = findRelevantInputSort();
+    if (inputSort) {
+        // We can convert to streaming. Documents are consumed as groups are returned.
+        _streaming = true;
+        for (auto&& sortField : *inputSort) {
+            _streamingPaths.emplace_back(sortField.fieldNameStringData());
         }
-        _firstDocOfNextGroup = firstInput.releaseDocument();
-
-        // Compute the _id value.
-        _currentId = computeId(*_firstDocOfNextGroup);
         _initialized = true;
         return DocumentSource::GetNextResult::makeEOF();
     }
 
-
     // Barring any pausing, this loop exhausts 'pSource' and populates '_groups'.
     GetNextResult input = pSource->getNext();
     for (; input.isAdvanced(); input = pSource->getNext()) {
-        if (_memoryUsageBytes > _maxMemoryUsageBytes) {
-            uassert(16945,
-                    "Exceeded memory limit for $group, but didn't allow external sort."
-                    " Pass allowDiskUse:true to opt in.",
-                    _allowDiskUse);
-            _sortedFiles.push_back(spill());
-            _memoryUsageBytes = 0;
-        }
-
         // We release the result document here so that it does not outlive the end of this loop
         // iteration. Not releasing could lead to an array copy when this group follows an unwind.
         auto rootDocument = input.releaseDocument();
         Value id = computeId(rootDocument);
-
-        // Look for the _id value in the map. If it's not there, add a new entry with a blank
-        // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
-        // looking it up in '_groups' multiple times.
-        const size_t oldSize = _groups->size();
-        vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
-        const bool inserted = _groups->size() != oldSize;
-
-        if (inserted) {
-            _memoryUsageBytes += id.getApproximateSize();
-
-            // Add the accumulators
-            group.reserve(numAccumulators);
-            for (auto&& accumulatedField : _accumulatedFields) {
-                group.push_back(accumulatedField.makeAccumulator(pExpCtx));
-            }
-        } else {
-            for (auto&& groupObj : group) {
-                // subtract old mem usage. New usage added back after processing.
-                _memoryUsageBytes -= groupObj->memUsageForSorter();
-            }
-        }
-
-        /* tickle all the accumulators for the group we found */
-        dassert(numAccumulators == group.size());
-
-        for (size_t i = 0; i < numAccumulators; i++) {
-            group[i]->process(_accumulatedFields[i].expression->evaluate(rootDocument),
-                              _doingMerge);
-
-            _memoryUsageBytes += group[i]->memUsageForSorter();
-        }
-
-        if (kDebugBuild && !storageGlobalParams.readOnly) {
-            // In debug mode, spill every time we have a duplicate id to stress merge logic.
-            if (!inserted &&                 // is a dup
-                !pExpCtx->inMongos &&        // can't spill to disk in mongos
-                !_allowDiskUse &&            // don't change behavior when testing external sort
-                _sortedFiles.size() < 20) {  // don't open too many FDs
-
-                _sortedFiles.push_back(spill());
-            }
-        }
+        accumulateIntoGroups(rootDocument, std::move(id));
     }
 
     switch (input.getStatus()) {
@@ -658,34 +641,7 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
         }
         case DocumentSource::GetNextResult::ReturnStatus::kEOF: {
             // Do any final steps necessary to prepare to output results.
-            if (!_sortedFiles.empty()) {
-                _spilled = true;
-                if (!_groups->empty()) {
-                    _sortedFiles.push_back(spill());
-                }
-
-                // We won't be using groups again so free its memory.
-                _groups = pExpCtx->getValueComparator().makeUnorderedValueMap<Accumulators>();
-
-                _sorterIterator.reset(Sorter<Value, Value>::Iterator::merge(
-                    _sortedFiles,
-                    _fileName,
-                    SortOptions(),
-                    SorterComparator(pExpCtx->getValueComparator())));
-                _ownsFileDeletion = false;
-
-                // prepare current to accumulate data
-                _currentAccumulators.reserve(numAccumulators);
-                for (auto&& accumulatedField : _accumulatedFields) {
-                    _currentAccumulators.push_back(accumulatedField.makeAccumulator(pExpCtx));
-                }
-
-                verify(_sorterIterator->more());  // we put data in, we should get something out.
-                _firstPartOfNextGroup = _sorterIterator->next();
-            } else {
-                // start the group iterator
-                groupsIterator = _groups->begin();
-            }
+            prepareToOutputGroups();
 
             // This must happen last so that, unless control gets here, we will re-enter
             // initialization after getting a GetNextResult::ResultState::kPauseExecution.
@@ -696,61 +652,195 @@ DocumentSource::GetNextResult DocumentSourceGroup::initialize() {
     MONGO_UNREACHABLE;
 }
 
+void DocumentSourceGroup::accumulateIntoGroups(const Document& rootDocument, Value id) {
+    if (_memoryUsageBytes > _maxMemoryUsageBytes) {
+        uassert(16945,
+                "Exceeded memory limit for $group, but didn't allow external sort."
+                " Pass allowDiskUse:true to opt in.",
+                _allowDiskUse);
+        // Leave room for new groups, so that we do not spill again for the next one.
+        spill(_maxMemoryUsageBytes / 2);
+    }
+
+    const size_t numAccumulators = _accumulatedFields.size();
+
+    // Look for the _id value in the map. If it's not there, add a new entry with a blank
+    // accumulator. This is done in a somewhat odd way in order to avoid hashing 'id' and
+    // looking it up in '_groups' multiple times.
+    const size_t oldSize = _groups->size();
+    vector<intrusive_ptr<Accumulator>>& group = (*_groups)[id];
+    const bool inserted = _groups->size() != oldSize;
+
+    if (inserted) {
+        _memoryUsageBytes += id.getApproximateSize();
+
+        // Add the accumulators
+        group.reserve(numAccumulators);
+        for (auto&& accumulatedField : _accumulatedFields) {
+            group.push_back(accumulatedField.makeAccumulator(pExpCtx));
+        }
+    } else {
+        for (auto&& groupObj : group) {
+            // subtract old mem usage. New usage added back after processing.
+            _memoryUsageBytes -= groupObj->memUsageForSorter();
+        }
+    }
+
+    /* tickle all the accumulators for the group we found */
+    dassert(numAccumulators == group.size());
+
+    for (size_t i = 0; i < numAccumulators; i++) {
+        group[i]->process(_accumulatedFields[i].expression->evaluate(rootDocument), _doingMerge);
+
+        _memoryUsageBytes += group[i]->memUsageForSorter();
+    }
+
+    if (kDebugBuild && !storageGlobalParams.readOnly) {
+        // In debug mode, spill every time we have a duplicate id to stress merge logic.
+        if (!inserted &&                // is a dup
+            !pExpCtx->inMongos &&       // can't spill to disk in mongos
+            !_allowDiskUse &&           // don't change behavior when testing external sort
+            _numSpilledRuns < 20) {     // don't open too many FDs
+
+            spill(0);
+        }
+    }
+}
+
+void DocumentSourceGroup::prepareToOutputGroups() {
+    if (_spilled) {
+        // The spilled partitions must be merged from disk, so spill whatever part of them is
+        // still in memory as well. The other partitions are returned from memory.
+        auto partitions = partitionGroups();
+        for (size_t i = 0; i < partitions.size(); i++) {
+            if (!_spilledPartitions[i].runs.empty() && !partitions[i].groups.empty()) {
+                writeSpilledRun(i, &partitions[i].groups);
+                _memoryUsageBytes -= partitions[i].memoryUsageBytes;
+            }
+        }
+        _nextPartitionToMerge = 0;
+    }
+
+    // start the group iterator
+    groupsIterator = _groups->begin();
+}
+
 bool DocumentSourceGroup::usedDisk() {
     return _usedDisk;
 }
 
-shared_ptr<Sorter<Value, Value>::Iterator> DocumentSourceGroup::spill() {
+std::vector<DocumentSourceGroup::GroupsPartition> DocumentSourceGroup::partitionGroups() const {
+    // Partition on the same hash that '_groups' uses, so that keys which compare equal under the
+    // collation end up in the same partition.
+    const auto hasher = _groups->hash_function();
+    std::vector<GroupsPartition> partitions(_spilledPartitions.size());
+    for (auto&& group : *_groups) {
+        auto& partition = partitions[hasher(group.first) % partitions.size()];
+        partition.groups.push_back(&group);
+        partition.memoryUsageBytes += group.first.getApproximateSize();
+        for (auto&& accum : group.second) {
+            partition.memoryUsageBytes += accum->memUsageForSorter();
+        }
+    }
+    return partitions;
+}
+
+void DocumentSourceGroup::spill(size_t targetMemoryUsageBytes) {
     _usedDisk = true;
-    vector<const GroupsMap::value_type*> ptrs;  // using pointers to speed sorting
-    ptrs.reserve(_groups->size());
-    for (GroupsMap::const_iterator it = _groups->begin(), end = _groups->end(); it != end; ++it) {
-        ptrs.push_back(&*it);
+    _spilled = true;
+
+    // Spill the partitions using the most memory first, until enough memory has been freed. The
+    // partitions which are never spilled need not be read back from disk.
+    auto partitions = partitionGroups();
+    std::vector<size_t> order(partitions.size());
+    std::iota(order.begin(), order.end(), 0);
+    std::sort(order.begin(), order.end(), [&partitions](size_t lhs, size_t rhs) {
+        return partitions[lhs].memoryUsageBytes > partitions[rhs].memoryUsageBytes;
+    });
+
+    _memoryUsageBytes = 0;
+    for (auto&& partition : partitions) {
+        _memoryUsageBytes += partition.memoryUsageBytes;
+    }
+
+    for (auto i : order) {
+        if (_memoryUsageBytes <= targetMemoryUsageBytes || partitions[i].groups.empty()) {
+            break;
+        }
+        writeSpilledRun(i, &partitions[i].groups);
+        _memoryUsageBytes -= partitions[i].memoryUsageBytes;
     }
+}
 
-    stable_sort(ptrs.begin(), ptrs.end(), SpillSTLComparator(pExpCtx->getValueComparator()));
+void DocumentSourceGroup::writeSpilledRun(size_t partitionIndex,
+                                          std::vector<const GroupsMap::value_type*>* ptrs) {
+    // using pointers to speed sorting
+    stable_sort(ptrs->begin(), ptrs->end(), SpillSTLComparator(pExpCtx->getValueComparator()));
 
-    SortedFileWriter<Value, Value> writer(
-        SortOptions().TempDir(pExpCtx->tempDir), _fileName, _nextSortedFileWriterOffset);
+    auto& partition = _spilledPartitions[partitionIndex];
+    SortedFileWriter<Value, Value> writer(SortOptions().TempDir(pExpCtx->tempDir),
+                                          partition.fileName,
+                                          partition.nextFileWriterOffset);
     switch (_accumulatedFields.size()) {  // same as ptrs[i]->second.size() for all i.
         case 0:                           // no values, essentially a distinct
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first, Value());
+            for (auto&& group : *ptrs) {
+                writer.addAlreadySorted(group->first, Value());
             }
             break;
 
         case 1:  // just one value, use optimized serialization as single Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
-                writer.addAlreadySorted(ptrs[i]->first,
-                                        ptrs[i]->second[0]->getValue(/*toBeMerged=*/true));
+            for (auto&& group : *ptrs) {
+                writer.addAlreadySorted(group->first,
+                                        group->second[0]->getValue(/*toBeMerged=*/true));
             }
             break;
 
         default:  // multiple values, serialize as array-typed Value
-            for (size_t i = 0; i < ptrs.size(); i++) {
+            for (auto&& group : *ptrs) {
                 vector<Value> accums;
-                for (size_t j = 0; j < ptrs[i]->second.size(); j++) {
-                    accums.push_back(ptrs[i]->second[j]->getValue(/*toBeMerged=*/true));
+                for (size_t j = 0; j < group->second.size(); j++) {
+                    accums.push_back(group->second[j]->getValue(/*toBeMerged=*/true));
                 }
-                writer.addAlreadySorted(ptrs[i]->first, Value(std::move(accums)));
+                writer.addAlreadySorted(group->first, Value(std::move(accums)));
             }
             break;
     }
 
-    _groups->clear();
+    partition.runs.emplace_back(writer.done());
+    partition.nextFileWriterOffset = writer.getFileEndOffset();
+    ++_numSpilledRuns;
 
-    Sorter<Value, Value>::Iterator* iteratorPtr = writer.done();
-    _nextSortedFileWriterOffset = writer.getFileEndOffset();
-    return shared_ptr<Sorter<Value, Value>::Iterator>(iteratorPtr);
+    for (auto&& group : *ptrs) {
+        const Value id = group->first;
+        _groups->erase(id);
+    }
+    ptrs->clear();
 }
 
-boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
-    if (true) {
-        // Until streaming $group correctly handles nullish values, the streaming behavior is
-        // disabled. See SERVER-23318.
-        return boost::none;
+bool DocumentSourceGroup::startMergingNextSpilledPartition() {
+    invariant(!_sorterIterator);
+    while (_nextPartitionToMerge < _spilledPartitions.size()) {
+        auto& partition = _spilledPartitions[_nextPartitionToMerge++];
+        if (partition.runs.empty()) {
+            continue;
+        }
+
+        // The merge iterator takes over deleting the partition's file.
+        _sorterIterator.reset(
+            Sorter<Value, Value>::Iterator::merge(partition.runs,
+                                                  partition.fileName,
+                                                  SortOptions(),
+                                                  SorterComparator(pExpCtx->getValueComparator())));
+        partition.runs.clear();
+
+        verify(_sorterIterator->more());  // we put data in, we should get something out.
+        _firstPartOfNextGroup = _sorterIterator->next();
+        return true;
     }
+    return false;
+}
 
+boost::optional<BSONObj> DocumentSourceGroup::findRelevantInputSort() const {
     if (!pSource) {
         // Sometimes when performing an explain, or using $group as the merge point, 'pSource' will
         // not be set.
@@ -816,62 +906,18 @@ BSONObjSet DocumentSourceGroup::getOutputSorts() {
                        // False negatives are OK.
     }
 
-    if (!(_streaming || _spilled)) {
+    // The groups are only returned in order when they were all spilled to a single partition and
+    // merged back. A streaming $group returns the groups it could not stream last, so its output
+    // is not sorted either.
+    if (_streaming || !_spilled || _spilledPartitions.size() != 1) {
         return SimpleBSONObjComparator::kInstance.makeBSONObjSet();
     }
 
     BSONObjBuilder sortOrder;
 
     if (_idFieldNames.empty()) {
-        if (_spilled) {
-            sortOrder.append("_id", 1);
-        } else {
-            // We have an expression like {_id: "$a"}. Check if this is a FieldPath, and if it is,
-            // get the sort order out of it.
-            if (auto obj = dynamic_cast<ExpressionFieldPath*>(_idExpressions[0].get())) {
-                FieldPath _idSort = obj->getFieldPath();
-
-                sortOrder.append(
-                    "_id",
-                    _inputSort.getIntField(_idSort.getFieldName(_idSort.getPathLength() - 1)));
-            }
-        }
-    } else if (_streaming) {
-        // At this point, we know that _streaming is true, so _id must have only contained
-        // ExpressionObjects, ExpressionConstants or ExpressionFieldPaths. We now process each
-        // '_idExpression'.
-
-        // We populate 'fieldMap' such that each key is a field the input is sorted by, and the
-        // value is where that input field is located within the _id document. For example, if our
-        // _id object is {_id: {x: {y: "$a.b"}}}, 'fieldMap' would be: {'a.b': '_id.x.y'}.
-        StringMap<std::string> fieldMap;
-        for (size_t i = 0; i < _idFieldNames.size(); i++) {
-            intrusive_ptr<Expression> exp = _idExpressions[i];
-            if (auto obj = dynamic_cast<ExpressionObject*>(exp.get())) {
-                // _id is an object containing a nested document, such as: {_id: {x: {y: "$b"}}}.
-                getFieldPathMap(obj, "_id." + _idFieldNames[i], &fieldMap);
-            } else if (auto fieldPath = dynamic_cast<ExpressionFieldPath*>(exp.get())) {
-                FieldPath _idSort = fieldPath->getFieldPath();
-                fieldMap[_idSort.getFieldName(_idSort.getPathLength() - 1)] =
-                    "_id." + _idFieldNames[i];
-            }
-        }
-
-        // Because the order of '_inputSort' is important, we go through each field we are sorted on
-        // and append it to the BSONObjBuilder in order.
-        for (BSONElement sortField : _inputSort) {
-            std::string sortString = sortField.fieldNameStringData().toString();
-
-            auto itr = fieldMap.find(sortString);
-
-            // If our sort order is (a, b, c), we could not have converted to a streaming $group if
-            // our _id was predicated on (a, c) but not 'b'. Verify that this is true.
-            invariant(itr != fieldMap.end());
-
-            sortOrder.append(itr->second, _inputSort.getIntField(sortString));
-        }
+        sortOrder.append("_id", 1);
     } else {
-        // We are blocking and have spilled to disk.
         std::vector<std::string> outputSort;
         for (size_t i = 0; i < _idFieldNames.size(); i++) {
             intrusive_ptr<Expression> exp = _idExpressions[i];
@@ -156,6 +156,22 @@ public:
         return _streaming;
     }
 
+    const std::vector<AccumulationStatement>& getAccumulatedFields() const {
+        return _accumulatedFields;
+    }
+
+    size_t getMaxMemoryUsageBytes() const {
+        return _maxMemoryUsageBytes;
+    }
+
+    /**
+     * Changes the amount of memory this $group may use before spilling to disk, or failing if it
+     * may not. Must be called before the $group receives any input.
+     */
+    void setMaxMemoryUsageBytes(size_t maxMemoryUsageBytes) {
+        _maxMemoryUsageBytes = maxMemoryUsageBytes;
+    }
+
     /**
      * Returns true if this $group stage used disk during execution and false otherwise.
      */
@@ -186,15 +202,45 @@ private:
 
     ~DocumentSourceGroup();
 
+    /**
+     * The groups held in memory which belong to one spill partition, and the memory they use.
+     */
+    struct GroupsPartition {
+        std::vector<const GroupsMap::value_type*> groups;
+        size_t memoryUsageBytes = 0;
+    };
+
+    /**
+     * The sorted runs written to disk for one spill partition. All runs of a partition are
+     * written to the same file, and merged together once the input is exhausted.
+     */
+    struct SpilledPartition {
+        std::string fileName;
+        unsigned int nextFileWriterOffset = 0;
+        std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> runs;
+    };
+
     /**
      * getNext() dispatches to one of these three depending on what type of $group it is. All three
-     * of these methods expect '_currentAccumulators' to have been reset before being called, and
-     * also expect initialize() to have been called already.
+     * of these methods expect initialize() to have been called already. getNextSpilled() and
+     * getNextStandard() expect '_currentAccumulators' to have been reset before being called.
      */
     GetNextResult getNextStreaming();
     GetNextResult getNextSpilled();
     GetNextResult getNextStandard();
 
+    /**
+     * Returns true if the group of 'root' is guaranteed to arrive in one consecutive run of
+     * documents in a streaming $group.
+     */
+    bool canStreamDocument(const Document& root) const;
+
+    /**
+     * Starts merging the sorted runs of the next spilled partition into '_sorterIterator'. Returns
+     * false if there are no more spilled partitions.
+     */
+    bool startMergingNextSpilledPartition();
+
     /**
      * Attempt to identify an input sort order that allows us to turn into a streaming $group. If we
      * find one, return it. Otherwise, return boost::none.
@@ -214,11 +260,38 @@ private:
     GetNextResult initialize();
 
     /**
-     * Spill groups map to disk and returns an iterator to the file. Note: Since a sorted $group
-     * does not exhaust the previous stage before returning, and thus does not maintain as large a
-     * store of documents at any one time, only an unsorted group can spill to disk.
+     * Adds 'rootDocument' to its group in '_groups', spilling groups to disk first if over the
+     * memory limit.
+     */
+    void accumulateIntoGroups(const Document& rootDocument, Value id);
+
+    /**
+     * Prepares to return the groups in '_groups' once the input is exhausted. If any partition was
+     * spilled, the rest of its groups are spilled too, so that it can be merged from disk.
+     */
+    void prepareToOutputGroups();
+
+    /**
+     * Divides the groups in '_groups' into spill partitions by the hash of their key.
+     */
+    std::vector<GroupsPartition> partitionGroups() const;
+
+    /**
+     * Spills the partitions of '_groups' using the most memory to disk, until the groups left in
+     * memory use at most 'targetMemoryUsageBytes'.
+     */
+    void spill(size_t targetMemoryUsageBytes);
+
+    /**
+     * Writes the groups pointed to by 'ptrs' to disk as a sorted run of the spill partition
+     * 'partitionIndex', and removes them from '_groups'.
      */
-    std::shared_ptr<Sorter<Value, Value>::Iterator> spill();
+    void writeSpilledRun(size_t partitionIndex, std::vector<const GroupsMap::value_type*>* ptrs);
+
+    /**
+     * Deletes the files of spilled partitions which have not been handed to a merge iterator.
+     */
+    void deleteUnmergedSpillFiles();
 
     Document makeDocument(const Value& id, const Accumulators& accums, bool mergeableOutput);
 
@@ -244,17 +317,18 @@ private:
     bool _doingMerge;
     size_t _memoryUsageBytes = 0;
     size_t _maxMemoryUsageBytes;
-    std::string _fileName;
-    unsigned int _nextSortedFileWriterOffset = 0;
-    bool _ownsFileDeletion = true;  // unless a MergeIterator is made that takes over.
 
     std::vector<std::string> _idFieldNames;  // used when id is a document
     std::vector<boost::intrusive_ptr<Expression>> _idExpressions;
 
-    BSONObj _inputSort;
     bool _streaming;
     bool _initialized;
 
+    // Only used when '_streaming' is true. The paths the input is sorted on.
+    std::vector<FieldPath> _streamingPaths;
+    bool _streamingGroupInProgress = false;
+    bool _streamingInputExhausted = false;
+
     Value _currentId;
     Accumulators _currentAccumulators;
 
@@ -263,10 +337,16 @@ private:
     // definition of equality.
     boost::optional<GroupsMap> _groups;
 
-    std::vector<std::shared_ptr<Sorter<Value, Value>::Iterator>> _sortedFiles;
+    // Groups are divided into partitions by the hash of their key. When over the memory limit,
+    // only the partitions using the most memory are spilled, and each spilled partition is merged
+    // on its own once the input is exhausted.
+    std::vector<SpilledPartition> _spilledPartitions;
+    size_t _nextPartitionToMerge = 0;
+    size_t _numSpilledRuns = 0;
     bool _spilled;
 
-    // Only used when '_spilled' is false.
+    // Iterates over the groups returned from memory, which are those of the partitions that were
+    // not spilled when '_spilled' is true.
     GroupsMap::iterator groupsIterator;
 
     // Only used when '_spilled' is true.
@@ -274,8 +354,6 @@ private:
     const bool _allowDiskUse;
 
     std::pair<Value, Value> _firstPartOfNextGroup;
-    // Only used when '_sorted' is true.
-    boost::optional<Document> _firstDocOfNextGroup;
 };
 
 }  // namespace mongo
@@ -48,12 +48,14 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context_for_test.h"
 #include "mongo/db/pipeline/value_comparator.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_test_service_context.h"
 #include "mongo/dbtests/dbtests.h"
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/unordered_set.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
 
 namespace mongo {
 
@@ -140,6 +142,52 @@ TEST_F(DocumentSourceGroupTest, ShouldBeAbleToPauseLoadingWhileSpilled) {
     ASSERT_EQ(idSet.count(2), 1UL);
 }
 
+TEST_F(DocumentSourceGroupTest, ShouldMergeEachSpilledPartitionSeparately) {
+    auto expCtx = getExpCtx();
+    TempDir tempDir("DocumentSourceGroupTest");
+    expCtx->tempDir = tempDir.path();
+    expCtx->allowDiskUse = true;
+    const size_t maxMemoryUsageBytes = 1000;
+
+    const int originalNumPartitions = internalDocumentSourceGroupSpillPartitions.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupSpillPartitions.store(originalNumPartitions); });
+
+    for (int numPartitions : {1, 4}) {
+        internalDocumentSourceGroupSpillPartitions.store(numPartitions);
+
+        VariablesParseState vps = expCtx->variablesParseState;
+        AccumulationStatement pushStatement{"spaceHog",
+                                            ExpressionFieldPath::parse(expCtx, "$largeStr", vps),
+                                            AccumulationStatement::getFactory("$push")};
+        auto groupByExpression = ExpressionFieldPath::parse(expCtx, "$key", vps);
+        auto group = DocumentSourceGroup::create(
+            expCtx, groupByExpression, {pushStatement}, maxMemoryUsageBytes);
+
+        const int kNumGroups = 20;
+        const int kDocsPerGroup = 5;
+        string largeStr(100, 'x');
+        deque<DocumentSource::GetNextResult> inputs;
+        for (int i = 0; i < kNumGroups * kDocsPerGroup; ++i) {
+            inputs.push_back(Document{{"key", i % kNumGroups}, {"largeStr", largeStr}});
+        }
+        auto mock = DocumentSourceMock::create(inputs);
+        group->setSource(mock.get());
+
+        // Every group is returned once, with all of its values, whether or not it was spilled.
+        map<int, size_t> numValuesByKey;
+        for (auto result = group->getNext(); result.isAdvanced(); result = group->getNext()) {
+            Document doc = result.releaseDocument();
+            ASSERT_EQ(numValuesByKey.count(doc["_id"].coerceToInt()), 0UL);
+            numValuesByKey[doc["_id"].coerceToInt()] = doc["spaceHog"].getArrayLength();
+        }
+        ASSERT_TRUE(group->usedDisk());
+        ASSERT_EQ(numValuesByKey.size(), static_cast<size_t>(kNumGroups));
+        for (auto&& entry : numValuesByKey) {
+            ASSERT_EQ(entry.second, static_cast<size_t>(kDocsPerGroup));
+        }
+    }
+}
+
 TEST_F(DocumentSourceGroupTest, ShouldErrorIfNotAllowedToSpillToDiskAndResultSetIsTooLarge) {
     auto expCtx = getExpCtx();
     const size_t maxMemoryUsageBytes = 1000;
@@ -838,10 +886,8 @@ public:
 
         assertEOF(group());
 
-        BSONObjSet outputSort = group()->getOutputSorts();
-        ASSERT_EQUALS(outputSort.size(), 1U);
-
-        ASSERT_EQUALS(outputSort.count(BSON("_id" << 1)), 1U);
+        // Groups which cannot be streamed are returned last, so the output is not sorted.
+        ASSERT_EQUALS(group()->getOutputSorts().size(), 0U);
     }
 };
 
@@ -874,22 +920,17 @@ public:
 
         assertEOF(source);
 
-        BSONObjSet outputSort = group()->getOutputSorts();
-        ASSERT_EQUALS(outputSort.size(), 2U);
-
-        BSONObj correctSort = BSON("_id.x" << 1 << "_id.y" << -1);
-        ASSERT_EQUALS(outputSort.count(correctSort), 1U);
-
-        BSONObj prefixSort = BSON("_id.x" << 1);
-        ASSERT_EQUALS(outputSort.count(prefixSort), 1U);
+        // Groups which cannot be streamed are returned last, so the output is not sorted.
+        ASSERT_EQUALS(group()->getOutputSorts().size(), 0U);
     }
 };
 
 class StreamingWithMultipleLevels : public Base {
 public:
     void _doTest() final {
-        auto source = DocumentSourceMock::create(
-            {"{a: {b: {c: 3}}, d: 1}", "{a: {b: {c: 1}}, d: 2}", "{a: {b: {c: 1}}, d: 0}"});
+        auto source = DocumentSourceMock::create({"{a: {b: {c: 3, d: 1}}, d: 1}",
+                                                  "{a: {b: {c: 1, d: 1}}, d: 2}",
+                                                  "{a: {b: {c: 1, d: 1}}, d: 0}"});
         source->sorts = {BSON("a.b.c" << -1 << "a.b.d" << 1 << "d" << 1)};
 
         createGroup(fromjson("{_id: {x: {y: {z: '$a.b.c', q: '$a.b.d'}}, v: '$d'}}"));
@@ -907,17 +948,8 @@ public:
 
         assertEOF(source);
 
-        BSONObjSet outputSort = group()->getOutputSorts();
-        ASSERT_EQUALS(outputSort.size(), 3U);
-
-        BSONObj correctSort = fromjson("{'_id.x.y.z': -1, '_id.x.y.q': 1, '_id.v': 1}");
-        ASSERT_EQUALS(outputSort.count(correctSort), 1U);
-
-        BSONObj prefixSortTwo = fromjson("{'_id.x.y.z': -1, '_id.x.y.q': 1}");
-        ASSERT_EQUALS(outputSort.count(prefixSortTwo), 1U);
-
-        BSONObj prefixSortOne = fromjson("{'_id.x.y.z': -1}");
-        ASSERT_EQUALS(outputSort.count(prefixSortOne), 1U);
+        // Groups which cannot be streamed are returned last, so the output is not sorted.
+        ASSERT_EQUALS(group()->getOutputSorts().size(), 0U);
     }
 };
 
@@ -944,15 +976,8 @@ public:
         ASSERT_VALUE_EQ(res.getDocument().getField("a"), Value(2));
         ASSERT_VALUE_EQ(res.getDocument().getField("b"), Value(3));
 
-        BSONObjSet outputSort = group()->getOutputSorts();
-
-        ASSERT_EQUALS(outputSort.size(), 2U);
-
-        BSONObj correctSort = fromjson("{'_id.sub.z': 1}");
-        ASSERT_EQUALS(outputSort.count(correctSort), 1U);
-
-        BSONObj prefixSortTwo = fromjson("{'_id.sub.z': 1, '_id.sub.y': 1}");
-        ASSERT_EQUALS(outputSort.count(prefixSortTwo), 1U);
+        // Groups which cannot be streamed are returned last, so the output is not sorted.
+        ASSERT_EQUALS(group()->getOutputSorts().size(), 0U);
     }
 };
 
@@ -979,14 +1004,8 @@ public:
         ASSERT_VALUE_EQ(res.getDocument().getField("a"), Value(3));
         ASSERT_VALUE_EQ(res.getDocument().getField("b"), Value(1));
 
-        BSONObjSet outputSort = group()->getOutputSorts();
-        ASSERT_EQUALS(outputSort.size(), 2U);
-
-        BSONObj correctSort = fromjson("{'_id.sub.x': -1}");
-        ASSERT_EQUALS(outputSort.count(correctSort), 1U);
-
-        BSONObj prefixSortTwo = fromjson("{'_id.sub.x': -1, '_id.sub.y': 1}");
-        ASSERT_EQUALS(outputSort.count(prefixSortTwo), 1U);
+        // Groups which cannot be streamed are returned last, so the output is not sorted.
+        ASSERT_EQUALS(group()->getOutputSorts().size(), 0U);
     }
 };
 
@@ -1002,11 +1021,8 @@ public:
         group()->getNext();
         ASSERT_TRUE(group()->isStreaming());
 
-        BSONObjSet outputSort = group()->getOutputSorts();
-        ASSERT_EQUALS(outputSort.size(), 1U);
-
-        BSONObj correctSort = fromjson("{_id: 1}");
-        ASSERT_EQUALS(outputSort.count(correctSort), 1U);
+        // Groups which cannot be streamed are returned last, so the output is not sorted.
+        ASSERT_EQUALS(group()->getOutputSorts().size(), 0U);
     }
 };
 
@@ -1044,6 +1060,72 @@ public:
     }
 };
 
+class StreamingDivertsNullishAndArrayKeys : public Base {
+public:
+    void _doTest() final {
+        // Nullish and array values sort among the other values, but group separately from them.
+        auto source = DocumentSourceMock::create(
+            {"{a: null}", "{a: [0, 1]}", "{}", "{a: 1}", "{a: [1, 2]}", "{a: 1}", "{a: 2}"});
+        source->sorts = {BSON("a" << 1)};
+
+        createGroup(fromjson("{_id: '$a', count: {$sum: 1}}"));
+        group()->setSource(source.get());
+
+        // The groups of keys which can be streamed are returned first, in order.
+        auto res = group()->getNext();
+        ASSERT_TRUE(group()->isStreaming());
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_DOCUMENT_EQ(res.releaseDocument(), DOC("_id" << 1 << "count" << 2));
+
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_DOCUMENT_EQ(res.releaseDocument(), DOC("_id" << 2 << "count" << 1));
+
+        // The other groups are returned last.
+        ValueSet diverted = ValueComparator().makeOrderedValueSet();
+        for (res = group()->getNext(); res.isAdvanced(); res = group()->getNext()) {
+            Document doc = res.releaseDocument();
+            ASSERT_VALUE_EQ(doc["count"], Value(doc["_id"].nullish() ? 2 : 1));
+            diverted.insert(doc["_id"]);
+        }
+        ASSERT_TRUE(res.isEOF());
+        ASSERT_EQUALS(diverted.size(), 3U);
+        ASSERT_EQUALS(diverted.count(Value(BSONNULL)), 1U);
+        ASSERT_EQUALS(diverted.count(Value(BSON_ARRAY(0 << 1))), 1U);
+        ASSERT_EQUALS(diverted.count(Value(BSON_ARRAY(1 << 2))), 1U);
+    }
+};
+
+class StreamingCanPauseWithinAGroup : public Base {
+public:
+    void _doTest() final {
+        auto source = DocumentSourceMock::create({Document{{"a", 1}},
+                                                  DocumentSource::GetNextResult::makePauseExecution(),
+                                                  Document{{"a", 1}},
+                                                  Document{{"a", 2}},
+                                                  DocumentSource::GetNextResult::makePauseExecution(),
+                                                  Document{{"a", 2}}});
+        source->sorts = {BSON("a" << 1)};
+
+        createGroup(fromjson("{_id: '$a', count: {$sum: 1}}"));
+        group()->setSource(source.get());
+
+        ASSERT_TRUE(group()->getNext().isPaused());
+
+        auto res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_DOCUMENT_EQ(res.releaseDocument(), DOC("_id" << 1 << "count" << 2));
+
+        ASSERT_TRUE(group()->getNext().isPaused());
+
+        res = group()->getNext();
+        ASSERT_TRUE(res.isAdvanced());
+        ASSERT_DOCUMENT_EQ(res.releaseDocument(), DOC("_id" << 2 << "count" << 2));
+
+        assertEOF(group());
+    }
+};
+
 class NoOptimizationIfMissingDoubleSort : public Base {
 public:
     void _doTest() final {
@@ -1196,8 +1278,6 @@ public:
         add<Dependencies>();
         add<StringConstantIdAndAccumulatorExpressions>();
         add<ArrayConstantAccumulatorExpression>();
-#if 0
-        // Disabled tests until SERVER-23318 is implemented.
         add<StreamingOptimization>();
         add<StreamingWithMultipleIdFields>();
         add<NoOptimizationIfMissingDoubleSort>();
@@ -1209,7 +1289,8 @@ public:
         add<StreamingWithRootSubfield>();
         add<StreamingWithConstantAndFieldPath>();
         add<StreamingWithFieldRepeated>();
-#endif
+        add<StreamingDivertsNullishAndArrayKeys>();
+        add<StreamingCanPauseWithinAGroup>();
     }
 };
 
@@ -0,0 +1,502 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/document_source_internal_parallel.h"
+
+#include <algorithm>
+
+#include "mongo/db/client.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/stdx/memory.h"
+#include "mongo/stdx/thread.h"
+
+namespace mongo {
+
+using boost::intrusive_ptr;
+
+REGISTER_DOCUMENT_SOURCE(_internalParallel,
+                         LiteParsedDocumentSourceDefault::parse,
+                         DocumentSourceInternalParallel::createFromBson);
+
+constexpr StringData DocumentSourceInternalParallel::kStageName;
+constexpr size_t DocumentSourceInternalParallel::kBatchSize;
+constexpr size_t DocumentSourceInternalParallel::kMaxQueuedBatchesPerWorker;
+constexpr size_t DocumentSourceInternalParallel::kMaxQueuedOutputBytes;
+
+namespace {
+
+// The largest number of workers which a $_internalParallel stage may be parsed with.
+constexpr long long kMaxNumWorkers = 64;
+
+/**
+ * Returns true if a stage named 'name' may run on the workers. These stages do not read from any
+ * collections.
+ */
+bool isWorkerStage(StringData name) {
+    return name == "$match"_sd || name == "$project"_sd || name == "$addFields"_sd ||
+        name == "$group"_sd;
+}
+
+/**
+ * The first stage of each worker's pipeline. Returns the documents of the batch most recently
+ * handed to the worker, then pauses until the next batch, or returns EOF once the input of the
+ * parallel stage is exhausted.
+ */
+class ParallelWorkerInput final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalParallelWorkerInput"_sd;
+
+    explicit ParallelWorkerInput(const intrusive_ptr<ExpressionContext>& expCtx)
+        : DocumentSource(expCtx) {}
+
+    GetNextResult getNext() final {
+        pExpCtx->checkForInterrupt();
+
+        if (_position < _batch.size()) {
+            return std::move(_batch[_position++]);
+        }
+        return _exhausted ? GetNextResult::makeEOF() : GetNextResult::makePauseExecution();
+    }
+
+    const char* getSourceName() const final {
+        return kStageName.rawData();
+    }
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        StageConstraints constraints(StreamType::kStreaming,
+                                     PositionRequirement::kFirst,
+                                     HostTypeRequirement::kNone,
+                                     DiskUseRequirement::kNoDiskUse,
+                                     FacetRequirement::kNotAllowed,
+                                     TransactionRequirement::kAllowed);
+
+        constraints.requiresInputDocSource = false;
+        return constraints;
+    }
+
+    boost::optional<MergingLogic> mergingLogic() final {
+        return boost::none;
+    }
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final {
+        return Value();
+    }
+
+    /**
+     * Replaces the batch of input, which must have been fully consumed.
+     */
+    void push(std::vector<Document> batch) {
+        invariant(_position == _batch.size());
+        _batch = std::move(batch);
+        _position = 0;
+    }
+
+    void setExhausted() {
+        _exhausted = true;
+    }
+
+protected:
+    void doDispose() final {
+        _batch.clear();
+        _position = 0;
+    }
+
+private:
+    std::vector<Document> _batch;
+    size_t _position = 0;
+    bool _exhausted = false;
+};
+
+constexpr StringData ParallelWorkerInput::kStageName;
+
+}  // namespace
+
+struct DocumentSourceInternalParallel::Worker {
+    boost::intrusive_ptr<ExpressionContext> expCtx;
+
+    // Owned by the worker thread while it runs, which disposes of it before finishing.
+    std::unique_ptr<Pipeline, PipelineDeleter> pipeline;
+    boost::intrusive_ptr<ParallelWorkerInput> input;
+
+    stdx::thread thread;
+
+    // Guarded by '_mutex'.
+    std::deque<std::vector<Document>> batches;
+    bool done = false;
+    bool usedDisk = false;
+    Status status = Status::OK();
+};
+
+intrusive_ptr<DocumentSourceInternalParallel> DocumentSourceInternalParallel::create(
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    const Pipeline::SourceContainer& stages,
+    size_t numWorkers) {
+    std::vector<Value> serializedStages;
+    for (auto&& stage : stages) {
+        stage->serializeToArray(serializedStages);
+    }
+    std::vector<BSONObj> stagesSpec;
+    for (auto&& serializedStage : serializedStages) {
+        invariant(serializedStage.getType() == BSONType::Object);
+        stagesSpec.push_back(serializedStage.getDocument().toBson());
+    }
+    return new DocumentSourceInternalParallel(expCtx, std::move(stagesSpec), numWorkers);
+}
+
+intrusive_ptr<DocumentSource> DocumentSourceInternalParallel::createFromBson(
+    BSONElement elem, const intrusive_ptr<ExpressionContext>& expCtx) {
+    uassert(ErrorCodes::TypeMismatch,
+            str::stream() << kStageName << " must take a nested object but found: " << elem,
+            elem.type() == BSONType::Object);
+
+    long long numWorkers = 0;
+    std::vector<BSONObj> stagesSpec;
+    for (auto&& elt : elem.embeddedObject()) {
+        if (elt.fieldNameStringData() == "numWorkers"_sd) {
+            uassert(ErrorCodes::BadValue,
+                    str::stream() << "'numWorkers' must be an integer between 1 and "
+                                  << kMaxNumWorkers
+                                  << " but found: "
+                                  << elt,
+                    elt.isNumber() && elt.safeNumberLong() >= 1 &&
+                        elt.safeNumberLong() <= kMaxNumWorkers);
+            numWorkers = elt.safeNumberLong();
+        } else if (elt.fieldNameStringData() == "pipeline"_sd) {
+            uassert(ErrorCodes::TypeMismatch,
+                    str::stream() << "'pipeline' must be an array but found: " << elt.type(),
+                    elt.type() == BSONType::Array);
+            for (auto&& stageElt : elt.embeddedObject()) {
+                uassert(ErrorCodes::TypeMismatch,
+                        str::stream() << "each stage of 'pipeline' must be an object but found: "
+                                      << stageElt.type(),
+                        stageElt.type() == BSONType::Object);
+                const StringData stageName = stageElt.embeddedObject().firstElementFieldName();
+                uassert(ErrorCodes::BadValue,
+                        str::stream() << kStageName << " cannot run a " << stageName
+                                      << " stage on its workers",
+                        isWorkerStage(stageName));
+                stagesSpec.push_back(stageElt.embeddedObject().getOwned());
+            }
+        } else {
+            uasserted(ErrorCodes::FailedToParse,
+                      str::stream() << "unrecognized field while parsing " << kStageName << ": '"
+                                    << elt.fieldNameStringData()
+                                    << "'");
+        }
+    }
+    uassert(ErrorCodes::FailedToParse,
+            str::stream() << kStageName << " requires 'numWorkers'",
+            numWorkers > 0);
+    uassert(ErrorCodes::FailedToParse,
+            str::stream() << kStageName << " requires a non-empty 'pipeline'",
+            !stagesSpec.empty());
+
+    return new DocumentSourceInternalParallel(expCtx, std::move(stagesSpec), numWorkers);
+}
+
+DocumentSourceInternalParallel::DocumentSourceInternalParallel(
+    const intrusive_ptr<ExpressionContext>& expCtx,
+    std::vector<BSONObj> stagesSpec,
+    size_t numWorkers)
+    : DocumentSource(expCtx), _stagesSpec(std::move(stagesSpec)) {
+    invariant(numWorkers > 0);
+
+    for (size_t i = 0; i < numWorkers; ++i) {
+        auto worker = stdx::make_unique<Worker>();
+        worker->expCtx =
+            expCtx->copyWith(expCtx->ns,
+                             expCtx->uuid,
+                             expCtx->getCollator() ? expCtx->getCollator()->clone() : nullptr);
+        worker->expCtx->needsMerge = true;
+        worker->pipeline = uassertStatusOK(Pipeline::parse(_stagesSpec, worker->expCtx));
+
+        // Together, the workers' $groups may use as much memory as the $group they replace.
+        if (auto group =
+                dynamic_cast<DocumentSourceGroup*>(worker->pipeline->getSources().back().get())) {
+            group->setMaxMemoryUsageBytes(group->getMaxMemoryUsageBytes() / numWorkers);
+        }
+
+        worker->input = new ParallelWorkerInput(worker->expCtx);
+        worker->pipeline->addInitialSource(worker->input);
+        _workers.push_back(std::move(worker));
+    }
+}
+
+DocumentSourceInternalParallel::~DocumentSourceInternalParallel() {
+    stopWorkers();
+}
+
+DocumentSource::GetNextResult DocumentSourceInternalParallel::getNext() {
+    pExpCtx->checkForInterrupt();
+
+    if (_outputPosition == _outputBatch.size()) {
+        if (!_inputExhausted) {
+            auto distributeResult = distributeInput();
+            if (distributeResult.isPaused()) {
+                return distributeResult;
+            }
+        }
+        if (!takeOutputBatch()) {
+            stopWorkers();
+            return GetNextResult::makeEOF();
+        }
+    }
+    return std::move(_outputBatch[_outputPosition++]);
+}
+
+DocumentSource::GetNextResult DocumentSourceInternalParallel::distributeInput() {
+    if (!_workersStarted) {
+        auto serviceContext = pExpCtx->opCtx->getServiceContext();
+        for (auto&& worker : _workers) {
+            auto workerPtr = worker.get();
+            worker->thread = stdx::thread(
+                [this, workerPtr, serviceContext] { runWorker(workerPtr, serviceContext); });
+        }
+        _workersStarted = true;
+    }
+
+    while (!_sourceExhausted) {
+        if (_batch.size() >= kBatchSize) {
+            if (!dispatchBatch()) {
+                return GetNextResult::makeEOF();
+            }
+            continue;
+        }
+
+        auto input = pSource->getNext();
+        if (input.isPaused()) {
+            return input;
+        }
+        if (input.isEOF()) {
+            _sourceExhausted = true;
+            break;
+        }
+        _batch.push_back(input.releaseDocument());
+    }
+
+    if (!_batch.empty() && !dispatchBatch()) {
+        return GetNextResult::makeEOF();
+    }
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    _inputExhausted = true;
+    _workAvailable.notify_all();
+    return GetNextResult::makeEOF();
+}
+
+bool DocumentSourceInternalParallel::dispatchBatch() {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    Worker* target = nullptr;
+    pExpCtx->opCtx->waitForConditionOrInterrupt(_workerProgress, lk, [&] {
+        uassertWorkersOK_inlock();
+        for (auto&& worker : _workers) {
+            if (worker->batches.size() < kMaxQueuedBatchesPerWorker &&
+                (!target || worker->batches.size() < target->batches.size())) {
+                target = worker.get();
+            }
+        }
+
+        // The workers may be waiting for their output to be consumed before they take more input.
+        return target || _queuedOutputBytes >= kMaxQueuedOutputBytes;
+    });
+    if (!target) {
+        return false;
+    }
+
+    target->batches.push_back(std::move(_batch));
+    _batch.clear();
+    _workAvailable.notify_all();
+    return true;
+}
+
+bool DocumentSourceInternalParallel::takeOutputBatch() {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    pExpCtx->opCtx->waitForConditionOrInterrupt(_workerProgress, lk, [&] {
+        uassertWorkersOK_inlock();
+        return !_queuedOutput.empty() ||
+            (_inputExhausted &&
+             std::all_of(_workers.begin(), _workers.end(), [](const auto& worker) {
+                 return worker->done;
+             }));
+    });
+    if (_queuedOutput.empty()) {
+        return false;
+    }
+
+    _outputBatch = std::move(_queuedOutput.front().documents);
+    _outputPosition = 0;
+    _queuedOutputBytes -= _queuedOutput.front().approximateSize;
+    _queuedOutput.pop_front();
+    _outputConsumed.notify_all();
+    return true;
+}
+
+bool DocumentSourceInternalParallel::queueOutput(OutputBatch batch) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    _queuedOutputBytes += batch.approximateSize;
+    _queuedOutput.push_back(std::move(batch));
+    _workerProgress.notify_all();
+
+    _outputConsumed.wait(
+        lk, [&] { return _stopping || _queuedOutputBytes < kMaxQueuedOutputBytes; });
+    return !_stopping;
+}
+
+void DocumentSourceInternalParallel::runWorker(Worker* worker, ServiceContext* serviceContext) {
+    ThreadClient threadClient("ParallelAggregationWorker", serviceContext);
+    auto opCtx = threadClient->makeOperationContext();
+    worker->expCtx->opCtx = opCtx.get();
+
+    // Queues the output of the worker's pipeline until it pauses for more input or reaches EOF.
+    // Returns false if the worker should stop instead.
+    DocumentSource* lastStage = worker->pipeline->getSources().back().get();
+    bool reachedEOF = false;
+    auto drainPipeline = [&] {
+        OutputBatch output;
+        auto next = lastStage->getNext();
+        for (; next.isAdvanced(); next = lastStage->getNext()) {
+            output.approximateSize += next.getDocument().getApproximateSize();
+            output.documents.push_back(next.releaseDocument());
+            if (output.documents.size() >= kBatchSize) {
+                if (!queueOutput(std::move(output))) {
+                    return false;
+                }
+                output = OutputBatch();
+            }
+        }
+        reachedEOF = next.isEOF();
+        return output.documents.empty() || queueOutput(std::move(output));
+    };
+
+    Status status = Status::OK();
+    try {
+        bool stopped = false;
+        while (true) {
+            std::vector<Document> batch;
+            {
+                stdx::unique_lock<stdx::mutex> lk(_mutex);
+                _workAvailable.wait(lk, [&] {
+                    return _stopping || _inputExhausted || !worker->batches.empty();
+                });
+                if (_stopping || worker->batches.empty()) {
+                    stopped = _stopping;
+                    break;
+                }
+                batch = std::move(worker->batches.front());
+                worker->batches.pop_front();
+                _workerProgress.notify_all();
+            }
+            worker->input->push(std::move(batch));
+            if (!drainPipeline()) {
+                stopped = true;
+                break;
+            }
+        }
+
+        // Once the input is exhausted, the pipeline returns the rest of its output.
+        if (!stopped) {
+            worker->input->setExhausted();
+            if (drainPipeline()) {
+                invariant(reachedEOF);
+            }
+        }
+    } catch (const DBException& ex) {
+        status = ex.toStatus();
+    }
+
+    const bool usedDisk = worker->pipeline->usedDisk();
+    worker->pipeline->dispose(opCtx.get());
+    worker->pipeline.get_deleter().dismissDisposal();
+    worker->pipeline.reset();
+    worker->input.reset();
+
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    worker->status = std::move(status);
+    worker->usedDisk = usedDisk;
+    worker->done = true;
+    _workerProgress.notify_all();
+}
+
+void DocumentSourceInternalParallel::uassertWorkersOK_inlock() const {
+    for (auto&& worker : _workers) {
+        uassertStatusOK(worker->status);
+    }
+}
+
+void DocumentSourceInternalParallel::stopWorkers() {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        _stopping = true;
+        _workAvailable.notify_all();
+        _outputConsumed.notify_all();
+    }
+
+    for (auto&& worker : _workers) {
+        if (worker->thread.joinable()) {
+            worker->thread.join();
+        }
+
+        // A worker whose thread never started still owns its pipeline.
+        if (worker->pipeline) {
+            worker->pipeline->dispose(pExpCtx->opCtx);
+            worker->pipeline.get_deleter().dismissDisposal();
+            worker->pipeline.reset();
+        }
+    }
+}
+
+void DocumentSourceInternalParallel::doDispose() {
+    stopWorkers();
+    _batch.clear();
+    _outputBatch.clear();
+    _outputPosition = 0;
+    _queuedOutput.clear();
+    _queuedOutputBytes = 0;
+}
+
+bool DocumentSourceInternalParallel::usedDisk() {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return std::any_of(_workers.begin(), _workers.end(), [](const auto& worker) {
+        return worker->usedDisk;
+    });
+}
+
+Value DocumentSourceInternalParallel::serialize(
+    boost::optional<ExplainOptions::Verbosity> explain) const {
+    std::vector<Value> stages(_stagesSpec.begin(), _stagesSpec.end());
+    return Value(DOC(getSourceName() << DOC("numWorkers" << static_cast<long long>(_workers.size())
+                                                         << "pipeline"
+                                                         << Value(std::move(stages)))));
+}
+
+}  // namespace mongo
@@ -0,0 +1,207 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "mongo/db/pipeline/document_source.h"
+#include "mongo/db/pipeline/pipeline.h"
+#include "mongo/stdx/condition_variable.h"
+#include "mongo/stdx/mutex.h"
+
+namespace mongo {
+
+/**
+ * An internal stage which runs a copy of a sub-pipeline on each of several worker threads. The
+ * input of this stage is read on the calling thread and handed out to the workers in batches, and
+ * the output of all the workers is returned in no particular order as they produce it. A worker
+ * waits for its output to be consumed once too much of it is queued.
+ *
+ * As each worker only sees part of the input, the sub-pipeline must not depend on the order of its
+ * input or on seeing all of it. The workers produce their output in the format used for merging,
+ * like the shards part of a split pipeline, so a sub-pipeline ending in a $group must be followed
+ * by the corresponding merging $group. The $groups of the workers share the memory limit of a
+ * single $group, and spill to disk or fail when they exceed their share as a $group would.
+ *
+ * Each worker has its own Client, OperationContext and ExpressionContext, as none of these can be
+ * shared between threads. The workers do not take any locks, so the sub-pipeline must not read
+ * from any collections.
+ */
+class DocumentSourceInternalParallel final : public DocumentSource {
+public:
+    static constexpr StringData kStageName = "$_internalParallel"_sd;
+
+    // The number of documents handed to a worker at a time.
+    static constexpr size_t kBatchSize = 1024;
+
+    // The number of batches which may be waiting to be processed by each worker before the input
+    // is no longer read.
+    static constexpr size_t kMaxQueuedBatchesPerWorker = 2;
+
+    // The approximate size of the output which may be waiting to be returned before the workers
+    // stop producing more.
+    static constexpr size_t kMaxQueuedOutputBytes = 16 * 1024 * 1024;
+
+    /**
+     * Creates a stage which runs a copy of 'stages' on each of 'numWorkers' threads. 'stages' are
+     * serialized and parsed again for each worker, and are not otherwise used.
+     */
+    static boost::intrusive_ptr<DocumentSourceInternalParallel> create(
+        const boost::intrusive_ptr<ExpressionContext>& expCtx,
+        const Pipeline::SourceContainer& stages,
+        size_t numWorkers);
+
+    /**
+     * Parses a $_internalParallel stage, as serialized by serialize().
+     */
+    static boost::intrusive_ptr<DocumentSource> createFromBson(
+        BSONElement elem, const boost::intrusive_ptr<ExpressionContext>& expCtx);
+
+    ~DocumentSourceInternalParallel();
+
+    GetNextResult getNext() final;
+
+    const char* getSourceName() const final {
+        return kStageName.rawData();
+    }
+
+    StageConstraints constraints(Pipeline::SplitState pipeState) const final {
+        return {StreamType::kBlocking,
+                PositionRequirement::kNone,
+                HostTypeRequirement::kNone,
+                DiskUseRequirement::kWritesTmpData,
+                FacetRequirement::kNotAllowed,
+                TransactionRequirement::kAllowed};
+    }
+
+    boost::optional<MergingLogic> mergingLogic() final {
+        return boost::none;
+    }
+
+    Value serialize(boost::optional<ExplainOptions::Verbosity> explain = boost::none) const final;
+
+    bool usedDisk() final;
+
+protected:
+    void doDispose() final;
+
+private:
+    struct Worker;
+
+    struct OutputBatch {
+        std::vector<Document> documents;
+        size_t approximateSize = 0;
+    };
+
+    DocumentSourceInternalParallel(const boost::intrusive_ptr<ExpressionContext>& expCtx,
+                                   std::vector<BSONObj> stagesSpec,
+                                   size_t numWorkers);
+
+    /**
+     * Reads the input and hands it out to the workers, starting them first if necessary. Returns
+     * a pause if the input paused, and otherwise EOF once the input is exhausted or once the
+     * queued output must be consumed before more input can be handed out.
+     */
+    GetNextResult distributeInput();
+
+    /**
+     * Hands the current batch of input to the worker with the fewest batches waiting, waiting
+     * for one to have room if necessary. Returns false, without handing out the batch, if the
+     * queued output must be consumed first.
+     */
+    bool dispatchBatch();
+
+    /**
+     * Waits for a batch of output from the workers and makes it the one being returned. Returns
+     * false if the workers have finished and all of their output has been returned.
+     */
+    bool takeOutputBatch();
+
+    /**
+     * Queues a batch of a worker's output, then waits until the queued output is small enough
+     * for the worker to continue. Returns false if the worker should stop instead.
+     */
+    bool queueOutput(OutputBatch batch);
+
+    /**
+     * The body of each worker thread.
+     */
+    void runWorker(Worker* worker, ServiceContext* serviceContext);
+
+    /**
+     * Throws the error of the first worker which failed, if any. Must be called with '_mutex'
+     * held.
+     */
+    void uassertWorkersOK_inlock() const;
+
+    /**
+     * Tells the workers to stop, joins their threads and disposes of any pipelines which they did
+     * not dispose of themselves.
+     */
+    void stopWorkers();
+
+    const std::vector<BSONObj> _stagesSpec;
+
+    std::vector<std::unique_ptr<Worker>> _workers;
+    bool _workersStarted = false;
+
+    // The input read since the last batch was handed out.
+    std::vector<Document> _batch;
+    bool _sourceExhausted = false;
+
+    // The batch of output currently being returned.
+    std::vector<Document> _outputBatch;
+    size_t _outputPosition = 0;
+
+    // Protects the state of the workers which is shared with their threads.
+    mutable stdx::mutex _mutex;
+
+    // Signalled when a worker has input waiting, or should finish.
+    stdx::condition_variable _workAvailable;
+
+    // Signalled when a worker has taken a batch of input, queued a batch of output, or finished.
+    stdx::condition_variable _workerProgress;
+
+    // Signalled when a batch of output has been taken, or the workers should finish.
+    stdx::condition_variable _outputConsumed;
+
+    // The output of the workers waiting to be returned.
+    std::deque<OutputBatch> _queuedOutput;
+    size_t _queuedOutputBytes = 0;
+
+    // Set once all of the input has been handed out. Only written by the thread reading the input.
+    bool _inputExhausted = false;
+    bool _stopping = false;
+};
+
+}  // namespace mongo
@@ -0,0 +1,300 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/json.h"
+#include "mongo/db/pipeline/aggregation_context_fixture.h"
+#include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_internal_parallel.h"
+#include "mongo/db/pipeline/document_source_match.h"
+#include "mongo/db/pipeline/document_source_mock.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/query/query_knobs_gen.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace {
+
+using boost::intrusive_ptr;
+
+class DocumentSourceInternalParallelTest : public AggregationContextFixture {
+protected:
+    /**
+     * Returns a mock source of 'numDocs' documents of the form {a: i % numGroups, b: i}.
+     */
+    intrusive_ptr<DocumentSourceMock> makeSource(int numDocs, int numGroups) {
+        auto source = DocumentSourceMock::create();
+        for (int i = 0; i < numDocs; ++i) {
+            source->queue.emplace_back(Document{{"a", i % numGroups}, {"b", i}});
+        }
+        return source;
+    }
+
+    /**
+     * Runs 'prefix', which must end with a $group, on 'numWorkers' threads over the output of
+     * 'source', followed by the merging $group. Returns the groups keyed by their _id.
+     */
+    std::map<int, Document> runParallelGroup(const intrusive_ptr<DocumentSource>& source,
+                                             Pipeline::SourceContainer prefix,
+                                             size_t numWorkers) {
+        auto group = dynamic_cast<DocumentSourceGroup*>(prefix.back().get());
+        ASSERT(group);
+        auto merger = group->mergingLogic()->mergingStage;
+
+        auto parallel = DocumentSourceInternalParallel::create(getExpCtx(), prefix, numWorkers);
+        parallel->setSource(source.get());
+        merger->setSource(parallel.get());
+
+        std::map<int, Document> groups;
+        for (auto next = merger->getNext(); !next.isEOF(); next = merger->getNext()) {
+            if (next.isPaused()) {
+                continue;
+            }
+            auto doc = next.releaseDocument();
+            ASSERT(groups.emplace(doc["_id"].getInt(), doc).second);
+        }
+        merger->dispose();
+        return groups;
+    }
+
+    intrusive_ptr<DocumentSource> makeGroup(const char* spec) {
+        return DocumentSourceGroup::createFromBson(fromjson(spec).firstElement(), getExpCtx());
+    }
+};
+
+TEST_F(DocumentSourceInternalParallelTest, ShouldMergePartialGroupsOfEachWorker) {
+    const int kNumDocs = 10 * DocumentSourceInternalParallel::kBatchSize + 7;
+    const int kNumGroups = 13;
+    auto groups = runParallelGroup(
+        makeSource(kNumDocs, kNumGroups),
+        {makeGroup("{$group: {_id: '$a', count: {$sum: 1}, total: {$sum: '$b'}, avg: {$avg: '$b'}, "
+                   "min: {$min: '$b'}, max: {$max: '$b'}}}")},
+        4);
+
+    ASSERT_EQ(groups.size(), static_cast<size_t>(kNumGroups));
+    for (int a = 0; a < kNumGroups; ++a) {
+        long long count = 0;
+        long long total = 0;
+        for (int b = a; b < kNumDocs; b += kNumGroups) {
+            ++count;
+            total += b;
+        }
+        const auto& group = groups[a];
+        ASSERT_VALUE_EQ(group["count"], Value(count));
+        ASSERT_VALUE_EQ(group["total"], Value(total));
+        ASSERT_VALUE_EQ(group["avg"], Value(static_cast<double>(total) / count));
+        ASSERT_VALUE_EQ(group["min"], Value(a));
+        ASSERT_VALUE_EQ(group["max"], Value(a + (count - 1) * kNumGroups));
+    }
+}
+
+TEST_F(DocumentSourceInternalParallelTest, ShouldRunStagesBeforeTheGroupOnEachWorker) {
+    const int kNumDocs = 3 * DocumentSourceInternalParallel::kBatchSize;
+    auto match = DocumentSourceMatch::create(fromjson("{b: {$gte: 100}}"), getExpCtx());
+    auto groups = runParallelGroup(
+        makeSource(kNumDocs, 2),
+        {match, makeGroup("{$group: {_id: '$a', values: {$addToSet: {$mod: ['$b', 10]}}}}")},
+        3);
+
+    ASSERT_EQ(groups.size(), 2UL);
+    ASSERT_EQ(groups[0]["values"].getArrayLength(), 5UL);
+    ASSERT_EQ(groups[1]["values"].getArrayLength(), 5UL);
+}
+
+TEST_F(DocumentSourceInternalParallelTest, ShouldPassOnPausesInItsInput) {
+    auto source = DocumentSourceMock::create();
+    source->queue.emplace_back(Document{{"a", 1}, {"b", 1}});
+    source->queue.emplace_back(DocumentSource::GetNextResult::makePauseExecution());
+    source->queue.emplace_back(Document{{"a", 1}, {"b", 2}});
+
+    auto group = makeGroup("{$group: {_id: '$a', total: {$sum: '$b'}}}");
+    auto parallel = DocumentSourceInternalParallel::create(getExpCtx(), {group}, 2);
+    parallel->setSource(source.get());
+
+    ASSERT_TRUE(parallel->getNext().isPaused());
+    auto next = parallel->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_VALUE_EQ(next.getDocument()["total"], Value(3));
+    ASSERT_TRUE(parallel->getNext().isEOF());
+    parallel->dispose();
+}
+
+TEST_F(DocumentSourceInternalParallelTest, ShouldReportErrorsFromTheWorkers) {
+    auto source = makeSource(DocumentSourceInternalParallel::kBatchSize, 2);
+    source->queue.emplace_back(Document{{"a", 1}, {"b", "not a number"_sd}});
+
+    auto group = makeGroup("{$group: {_id: '$a', total: {$sum: {$add: ['$b', 1]}}}}");
+    auto parallel = DocumentSourceInternalParallel::create(getExpCtx(), {group}, 2);
+    parallel->setSource(source.get());
+
+    ASSERT_THROWS_CODE(parallel->getNext(), AssertionException, 16554);
+    parallel->dispose();
+}
+
+TEST_F(DocumentSourceInternalParallelTest, ShouldStopWorkersWhenDisposedBeforeEOF) {
+    auto source = makeSource(DocumentSourceInternalParallel::kBatchSize, 2);
+    source->queue.emplace_back(DocumentSource::GetNextResult::makePauseExecution());
+    source->queue.emplace_back(Document{{"a", 1}, {"b", 1}});
+
+    auto group = makeGroup("{$group: {_id: '$a', total: {$sum: '$b'}}}");
+    auto parallel = DocumentSourceInternalParallel::create(getExpCtx(), {group}, 2);
+    parallel->setSource(source.get());
+
+    ASSERT_TRUE(parallel->getNext().isPaused());
+    parallel->dispose();
+}
+
+TEST_F(DocumentSourceInternalParallelTest, ShouldReturnMoreOutputThanItQueuesAtOnce) {
+    // Each group holds a 1KB string, so the output is larger than the workers may queue at once.
+    const int kNumDocs = 20 * DocumentSourceInternalParallel::kBatchSize;
+    const std::string largeStr(1024, 'x');
+    auto source = DocumentSourceMock::create();
+    for (int i = 0; i < kNumDocs; ++i) {
+        source->queue.emplace_back(Document{{"a", i}, {"largeStr", largeStr}});
+    }
+
+    auto groups =
+        runParallelGroup(source, {makeGroup("{$group: {_id: '$a', str: {$max: '$largeStr'}}}")}, 4);
+
+    ASSERT_EQ(groups.size(), static_cast<size_t>(kNumDocs));
+    for (auto&& group : groups) {
+        ASSERT_EQ(group.second["str"].getStringData(), largeStr);
+    }
+}
+
+TEST_F(DocumentSourceInternalParallelTest, ShouldFailWhenTheWorkersExceedTheGroupMemoryLimit) {
+    const long long originalMaxMemoryBytes = internalDocumentSourceGroupMaxMemoryBytes.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupMaxMemoryBytes.store(originalMaxMemoryBytes); });
+    internalDocumentSourceGroupMaxMemoryBytes.store(64 * 1024);
+
+    auto group = makeGroup("{$group: {_id: '$b', count: {$sum: 1}}}");
+    auto parallel = DocumentSourceInternalParallel::create(getExpCtx(), {group}, 2);
+    auto source = makeSource(4 * DocumentSourceInternalParallel::kBatchSize, 1);
+    parallel->setSource(source.get());
+
+    ASSERT_THROWS_CODE(parallel->getNext(), AssertionException, 16945);
+    parallel->dispose();
+}
+
+TEST_F(DocumentSourceInternalParallelTest, ShouldSpillWhenTheWorkersExceedTheGroupMemoryLimit) {
+    const long long originalMaxMemoryBytes = internalDocumentSourceGroupMaxMemoryBytes.load();
+    ON_BLOCK_EXIT([&] { internalDocumentSourceGroupMaxMemoryBytes.store(originalMaxMemoryBytes); });
+    internalDocumentSourceGroupMaxMemoryBytes.store(64 * 1024);
+
+    unittest::TempDir tempDir("DocumentSourceInternalParallelTest");
+    getExpCtx()->tempDir = tempDir.path();
+    getExpCtx()->allowDiskUse = true;
+
+    const int kNumDocs = 4 * DocumentSourceInternalParallel::kBatchSize;
+    auto group = makeGroup("{$group: {_id: '$b', count: {$sum: 1}}}");
+    auto parallel = DocumentSourceInternalParallel::create(getExpCtx(), {group}, 2);
+    auto source = makeSource(kNumDocs, 1);
+    parallel->setSource(source.get());
+
+    // Each _id is seen by only one worker, so each partial group has a count of 1.
+    int numGroups = 0;
+    for (auto next = parallel->getNext(); next.isAdvanced(); next = parallel->getNext()) {
+        ASSERT_VALUE_EQ(next.getDocument()["count"], Value(1));
+        ++numGroups;
+    }
+    ASSERT_EQ(numGroups, kNumDocs);
+    ASSERT_TRUE(parallel->usedDisk());
+    parallel->dispose();
+}
+
+TEST_F(DocumentSourceInternalParallelTest, ShouldParseItsSerialization) {
+    auto group = makeGroup("{$group: {_id: '$a', total: {$sum: '$b'}}}");
+    auto parallel = DocumentSourceInternalParallel::create(getExpCtx(), {group}, 3);
+
+    std::vector<Value> serialized;
+    parallel->serializeToArray(serialized);
+    ASSERT_EQ(serialized.size(), 1UL);
+    auto parsed = DocumentSourceInternalParallel::createFromBson(
+        serialized[0].getDocument().toBson().firstElement(), getExpCtx());
+
+    std::vector<Value> reserialized;
+    parsed->serializeToArray(reserialized);
+    ASSERT_EQ(reserialized.size(), 1UL);
+    ASSERT_VALUE_EQ(reserialized[0], serialized[0]);
+
+    auto source = makeSource(2 * DocumentSourceInternalParallel::kBatchSize, 1);
+    parsed->setSource(source.get());
+    auto next = parsed->getNext();
+    ASSERT_TRUE(next.isAdvanced());
+    ASSERT_TRUE(parsed->getNext().isEOF());
+    parsed->dispose();
+}
+
+TEST_F(DocumentSourceInternalParallelTest, ShouldRejectInvalidSpecifications) {
+    auto parse = [&](const char* spec) {
+        return DocumentSourceInternalParallel::createFromBson(fromjson(spec).firstElement(),
+                                                              getExpCtx());
+    };
+
+    ASSERT_THROWS_CODE(
+        parse("{$_internalParallel: 1}"), AssertionException, ErrorCodes::TypeMismatch);
+    ASSERT_THROWS_CODE(parse("{$_internalParallel: {numWorkers: 0, pipeline: [{$match: {}}]}}"),
+                       AssertionException,
+                       ErrorCodes::BadValue);
+    ASSERT_THROWS_CODE(parse("{$_internalParallel: {numWorkers: 2, pipeline: []}}"),
+                       AssertionException,
+                       ErrorCodes::FailedToParse);
+    ASSERT_THROWS_CODE(parse("{$_internalParallel: {numWorkers: 2, pipeline: [{$lookup: {from: "
+                             "'other', localField: 'a', foreignField: 'a', as: 'b'}}]}}"),
+                       AssertionException,
+                       ErrorCodes::BadValue);
+    ASSERT_THROWS_CODE(parse("{$_internalParallel: {numWorkers: 2, pipeline: [{$match: {}}], "
+                             "unknown: 1}}"),
+                       AssertionException,
+                       ErrorCodes::FailedToParse);
+}
+
+TEST_F(DocumentSourceInternalParallelTest, ShouldSerializeTheStagesRunByEachWorker) {
+    auto group = makeGroup("{$group: {_id: '$a', total: {$sum: '$b'}}}");
+    auto parallel = DocumentSourceInternalParallel::create(getExpCtx(), {group}, 3);
+
+    std::vector<Value> serialized;
+    parallel->serializeToArray(serialized);
+    ASSERT_EQ(serialized.size(), 1UL);
+    ASSERT_VALUE_EQ(serialized[0],
+                    Value(fromjson("{$_internalParallel: {numWorkers: 3, pipeline: [{$group: {_id: "
+                                   "'$a', total: {$sum: '$b'}}}]}}")));
+}
+
+}  // namespace
+}  // namespace mongo
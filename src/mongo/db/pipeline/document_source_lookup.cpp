@@ -27,6 +27,8 @@
  *    it in the license file.
  */
 
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kQuery
+
 #include "mongo/platform/basic.h"
 
 #include "mongo/db/pipeline/document_source_lookup.h"
@@ -41,6 +43,7 @@
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/log.h"
 
 namespace mongo {
 
@@ -223,6 +226,22 @@ BSONObj buildEqualityOrQuery(const std::string& fieldName, const BSONArray& valu
     return orBuilder.obj();
 }
 
+/**
+ * Returns the values of 'localFieldPath' in 'input' to join on. If 'localFieldPath' references a
+ * field with an array in its path, we may need to join on multiple values, so each element is
+ * returned. A missing value is treated as null.
+ */
+std::vector<Value> extractLocalValues(const Document& input, const FieldPath& localFieldPath) {
+    std::vector<Value> values;
+    document_path_support::visitAllValuesAtPath(
+        input, localFieldPath, [&](const Value& nextValue) { values.push_back(nextValue); });
+
+    if (values.empty()) {
+        values.push_back(Value(BSONNULL));
+    }
+    return values;
+}
+
 }  // namespace
 
 DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
@@ -243,20 +262,11 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
     // '_unwindSrc' would be non-null, and we would not have made it here.
     invariant(!_matchSrc);
 
-    if (!wasConstructedWithPipelineSyntax()) {
-        auto matchStage =
-            makeMatchStageFromInput(inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
-        // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
-        _resolvedPipeline.back() = matchStage;
-    }
-
-    auto pipeline = buildPipeline(inputDoc);
-
     std::vector<Value> results;
     int objsize = 0;
     const auto maxBytes = internalLookupStageIntermediateDocumentMaxSizeBytes.load();
-    while (auto result = pipeline->getNext()) {
-        objsize += result->getApproximateSize();
+    auto addResult = [&](Document&& result) {
+        objsize += result.getApproximateSize();
         uassert(4568,
                 str::stream() << "Total size of documents in " << _fromNs.coll()
                               << " matching pipeline's $lookup stage exceeds "
@@ -264,11 +274,29 @@ DocumentSource::GetNextResult DocumentSourceLookUp::getNext() {
                               << " bytes",
 
                 objsize <= maxBytes);
-        results.emplace_back(std::move(*result));
-    }
-    for (auto&& source : pipeline->getSources()) {
-        if (source->usedDisk())
-            _usedDisk = true;
+        results.emplace_back(std::move(result));
+    };
+
+    if (auto hashJoinMatches = probeHashTable(inputDoc)) {
+        for (auto&& match : *hashJoinMatches) {
+            addResult(std::move(match));
+        }
+    } else {
+        if (!wasConstructedWithPipelineSyntax()) {
+            auto matchStage = makeMatchStageFromInput(
+                inputDoc, *_localField, _foreignField->fullPath(), BSONObj());
+            // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
+            _resolvedPipeline.back() = matchStage;
+        }
+
+        auto pipeline = buildPipeline(inputDoc);
+        while (auto result = pipeline->getNext()) {
+            addResult(std::move(*result));
+        }
+        for (auto&& source : pipeline->getSources()) {
+            if (source->usedDisk())
+                _usedDisk = true;
+        }
     }
 
     MutableDocument output(std::move(inputDoc));
@@ -322,6 +350,63 @@ std::unique_ptr<Pipeline, PipelineDeleter> DocumentSourceLookUp::buildPipeline(
     return pipeline;
 }
 
+boost::optional<std::vector<Document>> DocumentSourceLookUp::probeHashTable(
+    const Document& inputDoc) {
+    if (wasConstructedWithPipelineSyntax()) {
+        return boost::none;
+    }
+
+    if (!_hashTable) {
+        const auto maxSizeBytes = internalDocumentSourceLookupHashJoinMaxMemoryBytes.load();
+        if (maxSizeBytes <= 0) {
+            return boost::none;
+        }
+        buildHashTable(static_cast<size_t>(maxSizeBytes));
+    }
+
+    if (!_hashTable->isServing()) {
+        return boost::none;
+    }
+
+    return _hashTable->probe(extractLocalValues(inputDoc, *_localField));
+}
+
+void DocumentSourceLookUp::buildHashTable(size_t maxSizeBytes) {
+    invariant(!_hashTable);
+    _hashTable.emplace(*_foreignField, _fromExpCtx->getCollator(), maxSizeBytes);
+
+    // Scan the whole foreign collection, restricted only by a $match absorbed from after an
+    // absorbed $unwind. We've already allocated space for the trailing $match stage in
+    // '_resolvedPipeline'.
+    _resolvedPipeline.back() = BSON("$match" << _additionalFilter.value_or(BSONObj()));
+    copyVariablesToExpCtx(_variables, _variablesParseState, _fromExpCtx.get());
+    auto pipeline = pExpCtx->mongoProcessInterface->makePipeline(_resolvedPipeline, _fromExpCtx);
+
+    while (auto result = pipeline->getNext()) {
+        _hashTable->add(*result);
+        if (_hashTable->isAbandoned()) {
+            LOG(1) << "Abandoning hash join for $lookup from " << _fromNs.ns()
+                   << " after exceeding " << maxSizeBytes << " bytes";
+            break;
+        }
+    }
+    _usedDisk = _usedDisk || pipeline->usedDisk();
+
+    if (_hashTable->isBuilding()) {
+        _hashTable->freeze();
+    }
+}
+
+boost::optional<Document> DocumentSourceLookUp::getNextForeignDocument() {
+    if (_hashTable && _hashTable->isServing()) {
+        if (_nextHashJoinMatch == _hashJoinMatches.size()) {
+            return boost::none;
+        }
+        return std::move(_hashJoinMatches[_nextHashJoinMatch++]);
+    }
+    return _pipeline->getNext();
+}
+
 DocumentSource::GetModPathsReturn DocumentSourceLookUp::getModifiedPaths() const {
     std::set<std::string> modifiedPaths{_as.fullPath()};
     if (_unwindSrc) {
@@ -459,27 +544,22 @@ void DocumentSourceLookUp::doDispose() {
         _pipeline->dispose(pExpCtx->opCtx);
         _pipeline.reset();
     }
+    _hashTable.reset();
+    _hashJoinMatches.clear();
 }
 
 BSONObj DocumentSourceLookUp::makeMatchStageFromInput(const Document& input,
                                                       const FieldPath& localFieldPath,
                                                       const std::string& foreignFieldName,
                                                       const BSONObj& additionalFilter) {
-    // Add the 'localFieldPath' of 'input' into 'localFieldList'. If 'localFieldPath' references a
-    // field with an array in its path, we may need to join on multiple values, so we add each
-    // element to 'localFieldList'.
+    // Add the 'localFieldPath' of 'input' into 'localFieldList'.
     BSONArrayBuilder arrBuilder;
     bool containsRegex = false;
-    document_path_support::visitAllValuesAtPath(input, localFieldPath, [&](const Value& nextValue) {
+    for (auto&& nextValue : extractLocalValues(input, localFieldPath)) {
         arrBuilder << nextValue;
         if (!containsRegex && nextValue.getType() == BSONType::RegEx) {
             containsRegex = true;
         }
-    });
-
-    if (arrBuilder.arrSize() == 0) {
-        // Missing values are treated as null.
-        arrBuilder << BSONNULL;
     }
 
     const auto localFieldListSize = arrBuilder.arrSize();
@@ -551,7 +631,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
     // Loop until we get a document that has at least one match.
     // Note we may return early from this loop if our source stage is exhausted or if the unwind
     // source was asked to return empty arrays and we get a document without a match.
-    while (!_pipeline || !_nextValue) {
+    while (!_nextValue) {
         auto nextInput = pSource->getNext();
         if (!nextInput.isAdvanced()) {
             return nextInput;
@@ -559,28 +639,34 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
         _input = nextInput.releaseDocument();
 
-        if (!wasConstructedWithPipelineSyntax()) {
-            BSONObj filter = _additionalFilter.value_or(BSONObj());
-            auto matchStage =
-                makeMatchStageFromInput(*_input, *_localField, _foreignField->fullPath(), filter);
-            // We've already allocated space for the trailing $match stage in '_resolvedPipeline'.
-            _resolvedPipeline.back() = matchStage;
-        }
+        if (auto hashJoinMatches = probeHashTable(*_input)) {
+            _hashJoinMatches = std::move(*hashJoinMatches);
+            _nextHashJoinMatch = 0;
+        } else {
+            if (!wasConstructedWithPipelineSyntax()) {
+                BSONObj filter = _additionalFilter.value_or(BSONObj());
+                auto matchStage = makeMatchStageFromInput(
+                    *_input, *_localField, _foreignField->fullPath(), filter);
+                // We've already allocated space for the trailing $match stage in
+                // '_resolvedPipeline'.
+                _resolvedPipeline.back() = matchStage;
+            }
 
-        if (_pipeline) {
-            _usedDisk = _usedDisk || _pipeline->usedDisk();
-            _pipeline->dispose(pExpCtx->opCtx);
-        }
+            if (_pipeline) {
+                _usedDisk = _usedDisk || _pipeline->usedDisk();
+                _pipeline->dispose(pExpCtx->opCtx);
+            }
 
-        _pipeline = buildPipeline(*_input);
+            _pipeline = buildPipeline(*_input);
 
-        // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
-        // potentially be used by multiple OperationContexts, and the $lookup stage is part of an
-        // outer Pipeline that will propagate dispose() calls before being destroyed.
-        _pipeline.get_deleter().dismissDisposal();
+            // The $lookup stage takes responsibility for disposing of its Pipeline, since it will
+            // potentially be used by multiple OperationContexts, and the $lookup stage is part of
+            // an outer Pipeline that will propagate dispose() calls before being destroyed.
+            _pipeline.get_deleter().dismissDisposal();
+        }
 
         _cursorIndex = 0;
-        _nextValue = _pipeline->getNext();
+        _nextValue = getNextForeignDocument();
 
         if (_unwindSrc->preserveNullAndEmptyArrays() && !_nextValue) {
             // There were no results for this cursor, but the $unwind was asked to preserve empty
@@ -598,7 +684,7 @@ DocumentSource::GetNextResult DocumentSourceLookUp::unwindResult() {
 
     invariant(bool(_input) && bool(_nextValue));
     auto currentValue = *_nextValue;
-    _nextValue = _pipeline->getNext();
+    _nextValue = getNextForeignDocument();
 
     // Move input document into output if this is the last or only result, otherwise perform a copy.
     MutableDocument output(_nextValue ? *_input : std::move(*_input));
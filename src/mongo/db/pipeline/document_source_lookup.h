@@ -37,6 +37,7 @@
 #include "mongo/db/pipeline/document_source_unwind.h"
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/lite_parsed_pipeline.h"
+#include "mongo/db/pipeline/lookup_hash_table.h"
 #include "mongo/db/pipeline/lookup_set_cache.h"
 #include "mongo/db/pipeline/value_comparator.h"
 
@@ -263,6 +264,26 @@ private:
      */
     std::unique_ptr<Pipeline, PipelineDeleter> buildPipeline(const Document& inputDoc);
 
+    /**
+     * Returns the foreign documents joining with 'inputDoc' from the hash table, building the table
+     * on first use. Returns boost::none if the hash join is disabled or not applicable, or if the
+     * foreign documents do not fit in the table, in which case the caller must run the $lookup
+     * pipeline for 'inputDoc' instead.
+     */
+    boost::optional<std::vector<Document>> probeHashTable(const Document& inputDoc);
+
+    /**
+     * Scans the foreign collection once, adding every document which passes '_additionalFilter' to
+     * '_hashTable'.
+     */
+    void buildHashTable(size_t maxSizeBytes);
+
+    /**
+     * Returns the next foreign document joining with '_input' when '_unwindSrc' is not null, either
+     * from '_hashJoinMatches' or from '_pipeline'.
+     */
+    boost::optional<Document> getNextForeignDocument();
+
     /**
      * Reinitialize the cache with a new max size. May only be called if this DSLookup was created
      * with pipeline syntax, the cache has not been frozen or abandoned, and no data has been added
@@ -296,6 +317,12 @@ private:
     // from a cursor source.
     boost::optional<SequentialDocumentCache> _cache;
 
+    // For use when $lookup is specified with localField/foreignField syntax and hash joins are
+    // enabled. Holds the foreign documents, indexed by their values of '_foreignField', so that each
+    // input document can be joined without querying the foreign collection. Not initialized until
+    // the first input document arrives.
+    boost::optional<LookupHashTable> _hashTable;
+
     // The ExpressionContext used when performing aggregation pipelines against the '_resolvedNs'
     // namespace.
     boost::intrusive_ptr<ExpressionContext> _fromExpCtx;
@@ -319,6 +346,8 @@ private:
     // not null.
     long long _cursorIndex = 0;
     std::unique_ptr<Pipeline, PipelineDeleter> _pipeline;
+    std::vector<Document> _hashJoinMatches;
+    size_t _nextHashJoinMatch = 0;
     boost::optional<Document> _input;
     boost::optional<Document> _nextValue;
 };
@@ -40,6 +40,7 @@
 #include "mongo/db/pipeline/lite_parsed_document_source.h"
 #include "mongo/db/pipeline/value.h"
 #include "mongo/db/query/collation/collation_index_key.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/s/query/document_source_merge_cursors.h"
 
 namespace mongo {
@@ -328,6 +329,7 @@ SortOptions DocumentSourceSort::makeSortOptions() const {
     if (pExpCtx->allowDiskUse && !pExpCtx->inMongos) {
         opts.extSortAllowed = true;
         opts.tempDir = pExpCtx->tempDir;
+        opts.maxThreads = static_cast<size_t>(internalQueryMaxSortThreads.load());
     }
 
     return opts;
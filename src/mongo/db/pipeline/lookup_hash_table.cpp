@@ -0,0 +1,174 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/lookup_hash_table.h"
+
+#include <algorithm>
+#include <memory>
+#include <set>
+
+#include "mongo/db/bson/dotted_path_support.h"
+#include "mongo/db/matcher/expression_leaf.h"
+#include "mongo/db/query/collation/collator_interface.h"
+#include "mongo/stdx/memory.h"
+
+namespace mongo {
+
+namespace dps = ::mongo::dotted_path_support;
+
+LookupHashTable::LookupHashTable(FieldPath foreignField,
+                                 const CollatorInterface* collator,
+                                 size_t maxSizeBytes)
+    : _foreignField(std::move(foreignField)),
+      _collator(collator),
+      _valueComparator(collator),
+      _maxSizeBytes(maxSizeBytes),
+      _index(_valueComparator.makeUnorderedValueMap<std::vector<size_t>>()) {}
+
+void LookupHashTable::add(const Document& foreignDoc) {
+    invariant(_status == TableStatus::kBuilding);
+
+    const size_t docIndex = _documents.size();
+    _documents.push_back(foreignDoc.toBsonWithMetaData());
+    const BSONObj& doc = _documents.back();
+    _sizeBytes += doc.objsize();
+
+    // An equality predicate on an array matches both the array itself and each of its elements,
+    // so index both.
+    const auto path = _foreignField.fullPath();
+    BSONElementSet elements;
+    std::set<size_t> arrayComponents;
+    dps::extractAllElementsAlongPath(doc, path, elements, true, &arrayComponents);
+    dps::extractAllElementsAlongPath(doc, path, elements, false);
+
+    // A null predicate also matches documents where the path is missing, including when an array
+    // on the way to the last component holds an element without it.
+    bool mayMatchNull = elements.empty() ||
+        (!arrayComponents.empty() && *arrayComponents.begin() + 1 < _foreignField.getPathLength());
+    for (auto&& elem : elements) {
+        if (elem.isNull() || elem.type() == BSONType::Undefined) {
+            mayMatchNull = true;
+        } else {
+            addKey(elem, docIndex);
+        }
+    }
+    if (mayMatchNull) {
+        _mayMatchNull.push_back(docIndex);
+        _sizeBytes += sizeof(size_t);
+    }
+
+    if (_sizeBytes > _maxSizeBytes) {
+        abandon();
+    }
+}
+
+void LookupHashTable::addKey(const BSONElement& key, size_t docIndex) {
+    auto inserted = _index.emplace(Value(key), std::vector<size_t>());
+    if (inserted.second) {
+        _sizeBytes += inserted.first->first.getApproximateSize();
+    }
+
+    // The same value may be reached through several paths within one document.
+    auto& docIndexes = inserted.first->second;
+    if (docIndexes.empty() || docIndexes.back() != docIndex) {
+        docIndexes.push_back(docIndex);
+        _sizeBytes += sizeof(size_t);
+    }
+}
+
+void LookupHashTable::freeze() {
+    invariant(_status == TableStatus::kBuilding);
+
+    _status = TableStatus::kServing;
+    _documents.shrink_to_fit();
+}
+
+void LookupHashTable::abandon() {
+    _status = TableStatus::kAbandoned;
+
+    _documents.clear();
+    _documents.shrink_to_fit();
+    _index.clear();
+    _mayMatchNull.clear();
+    _mayMatchNull.shrink_to_fit();
+    _sizeBytes = 0;
+}
+
+std::vector<Document> LookupHashTable::probe(const std::vector<Value>& localValues) const {
+    invariant(_status == TableStatus::kServing);
+
+    // The hash table only narrows down the candidates. Whether a candidate matches is decided by
+    // the same equality predicates the $lookup query would use, which also reject undefined.
+    const auto path = _foreignField.fullPath();
+    std::vector<BSONObj> operands;
+    operands.reserve(localValues.size());
+    std::vector<std::unique_ptr<EqualityMatchExpression>> predicates;
+    std::vector<size_t> candidates;
+    for (auto&& value : localValues) {
+        BSONObjBuilder operandBuilder;
+        value.addToBsonObj(&operandBuilder, "");
+        operands.push_back(operandBuilder.obj());
+
+        auto predicate =
+            stdx::make_unique<EqualityMatchExpression>(path, operands.back().firstElement());
+        predicate->setCollator(_collator);
+        predicates.push_back(std::move(predicate));
+
+        if (value.nullish()) {
+            candidates.insert(candidates.end(), _mayMatchNull.begin(), _mayMatchNull.end());
+        } else {
+            auto it = _index.find(value);
+            if (it != _index.end()) {
+                candidates.insert(candidates.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+
+    // Return the matches in the order the foreign documents were added.
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<Document> matches;
+    for (auto docIndex : candidates) {
+        const BSONObj& doc = _documents[docIndex];
+        const bool isMatch =
+            std::any_of(predicates.begin(), predicates.end(), [&doc](const auto& predicate) {
+                return predicate->matchesBSON(doc);
+            });
+        if (isMatch) {
+            matches.push_back(Document::fromBsonWithMetaData(doc));
+        }
+    }
+    return matches;
+}
+
+}  // namespace mongo
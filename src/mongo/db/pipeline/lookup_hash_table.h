@@ -0,0 +1,148 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/pipeline/document.h"
+#include "mongo/db/pipeline/field_path.h"
+#include "mongo/db/pipeline/value.h"
+#include "mongo/db/pipeline/value_comparator.h"
+
+namespace mongo {
+
+class CollatorInterface;
+
+/**
+ * Implements the build side of a hash join for a $lookup on 'localField' and 'foreignField'. The
+ * foreign documents are added once, indexed by every value that an equality predicate on
+ * 'foreignField' could match, and then probed with the values of each local document.
+ *
+ * Like SequentialDocumentCache, the table is either building, serving, or abandoned. It abandons
+ * itself, releasing its memory, once the documents added to it exceed the maximum size.
+ */
+class LookupHashTable {
+    MONGO_DISALLOW_COPYING(LookupHashTable);
+
+public:
+    enum class TableStatus {
+        // Foreign documents are being added. A newly instantiated table is in this state.
+        kBuilding,
+
+        // The caller has invoked freeze(). The table is read-only and may be probed.
+        kServing,
+
+        // The maximum permitted size has been exceeded. The table is empty and cannot be used.
+        kAbandoned,
+    };
+
+    /**
+     * 'collator' must outlive the table. A null collator compares strings by their binary
+     * representation.
+     */
+    LookupHashTable(FieldPath foreignField,
+                    const CollatorInterface* collator,
+                    size_t maxSizeBytes);
+
+    /**
+     * Adds a foreign document to the table. May only be called while building.
+     */
+    void add(const Document& foreignDoc);
+
+    /**
+     * Moves the table into 'kServing' mode. May only be called while building.
+     */
+    void freeze();
+
+    /**
+     * Abandons the table and frees the memory allocated while building.
+     */
+    void abandon();
+
+    /**
+     * Returns the foreign documents, in the order they were added, matching the query
+     * {<foreignField>: {$in: 'localValues'}} where regular expressions only match equal regular
+     * expressions. This is the query the $lookup would otherwise run for a local document. May only
+     * be called while serving.
+     */
+    std::vector<Document> probe(const std::vector<Value>& localValues) const;
+
+    TableStatus status() const {
+        return _status;
+    }
+
+    bool isBuilding() const {
+        return _status == TableStatus::kBuilding;
+    }
+
+    bool isServing() const {
+        return _status == TableStatus::kServing;
+    }
+
+    bool isAbandoned() const {
+        return _status == TableStatus::kAbandoned;
+    }
+
+    size_t sizeBytes() const {
+        return _sizeBytes;
+    }
+
+    size_t count() const {
+        return _documents.size();
+    }
+
+private:
+    /**
+     * Records that the document at 'docIndex' may match the value 'key'.
+     */
+    void addKey(const BSONElement& key, size_t docIndex);
+
+    const FieldPath _foreignField;
+    const CollatorInterface* const _collator;
+    const ValueComparator _valueComparator;
+    const size_t _maxSizeBytes;
+
+    TableStatus _status = TableStatus::kBuilding;
+    size_t _sizeBytes = 0;
+
+    // The foreign documents, serialized with their metadata so that they can be matched.
+    std::vector<BSONObj> _documents;
+
+    // Maps each value of 'foreignField' to the indexes in '_documents' of the documents holding
+    // it, in ascending order. Null and undefined values are tracked by '_mayMatchNull' instead.
+    ValueUnorderedMap<std::vector<size_t>> _index;
+
+    // The indexes of the documents which may match a null value, because 'foreignField' is null,
+    // undefined or missing in them, or because it traverses an array.
+    std::vector<size_t> _mayMatchNull;
+};
+
+}  // namespace mongo
@@ -0,0 +1,198 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/pipeline/lookup_hash_table.h"
+
+#include "mongo/bson/bsonobjbuilder.h"
+#include "mongo/db/pipeline/document_value_test_util.h"
+#include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/unittest/death_test.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const size_t kTableSizeBytes = 1024 * 1024;
+
+std::vector<Value> values(std::initializer_list<Value> vals) {
+    return std::vector<Value>(vals);
+}
+
+void assertMatches(const std::vector<Document>& expected, const std::vector<Document>& actual) {
+    ASSERT_EQ(expected.size(), actual.size());
+    for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_DOCUMENT_EQ(expected[i], actual[i]);
+    }
+}
+
+TEST(LookupHashTableTest, TableIsInBuildingModeUponInstantiation) {
+    LookupHashTable table(FieldPath("a"), nullptr, kTableSizeBytes);
+    ASSERT(table.isBuilding());
+    ASSERT_EQ(table.count(), 0ul);
+}
+
+DEATH_TEST(LookupHashTableTest, CannotProbeTableWhileBuilding, "invariant") {
+    LookupHashTable table(FieldPath("a"), nullptr, kTableSizeBytes);
+    table.probe(values({Value(1)}));
+}
+
+DEATH_TEST(LookupHashTableTest, CannotAddToTableAfterFreezing, "invariant") {
+    LookupHashTable table(FieldPath("a"), nullptr, kTableSizeBytes);
+    table.freeze();
+    table.add(DOC("a" << 1));
+}
+
+TEST(LookupHashTableTest, ProbeReturnsEqualDocumentsInInsertionOrder) {
+    LookupHashTable table(FieldPath("a"), nullptr, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a" << 1));
+    table.add(DOC("_id" << 1 << "a" << 2));
+    table.add(DOC("_id" << 2 << "a" << 1));
+    table.freeze();
+    ASSERT(table.isServing());
+    ASSERT_EQ(table.count(), 3ul);
+
+    assertMatches({DOC("_id" << 0 << "a" << 1), DOC("_id" << 2 << "a" << 1)},
+                  table.probe(values({Value(1)})));
+    assertMatches({DOC("_id" << 1 << "a" << 2)}, table.probe(values({Value(2)})));
+    assertMatches({}, table.probe(values({Value(3)})));
+
+    // Each document is returned once, however many of the values it matches.
+    assertMatches({DOC("_id" << 0 << "a" << 1),
+                   DOC("_id" << 1 << "a" << 2),
+                   DOC("_id" << 2 << "a" << 1)},
+                  table.probe(values({Value(2), Value(1), Value(1)})));
+}
+
+TEST(LookupHashTableTest, ProbeComparesNumbersByValue) {
+    LookupHashTable table(FieldPath("a"), nullptr, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a" << 1));
+    table.add(DOC("_id" << 1 << "a" << 1.0));
+    table.add(DOC("_id" << 2 << "a" << 1LL));
+    table.add(DOC("_id" << 3 << "a" << "1"_sd));
+    table.freeze();
+
+    ASSERT_EQ(table.probe(values({Value(Decimal128("1"))})).size(), 3ul);
+}
+
+TEST(LookupHashTableTest, ProbeMatchesArrayElementsAndWholeArrays) {
+    LookupHashTable table(FieldPath("a"), nullptr, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a" << BSON_ARRAY(1 << 2)));
+    table.add(DOC("_id" << 1 << "a" << BSON_ARRAY(BSON_ARRAY(1 << 2))));
+    table.freeze();
+
+    assertMatches({DOC("_id" << 0 << "a" << BSON_ARRAY(1 << 2))}, table.probe(values({Value(2)})));
+    assertMatches({DOC("_id" << 0 << "a" << BSON_ARRAY(1 << 2)),
+                   DOC("_id" << 1 << "a" << BSON_ARRAY(BSON_ARRAY(1 << 2)))},
+                  table.probe(values({Value(BSON_ARRAY(1 << 2))})));
+}
+
+TEST(LookupHashTableTest, ProbeTraversesArraysAlongDottedPaths) {
+    LookupHashTable table(FieldPath("a.b"), nullptr, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a" << BSON_ARRAY(BSON("b" << 1) << BSON("b" << 2))));
+    table.add(DOC("_id" << 1 << "a" << BSON("b" << 2)));
+    table.add(DOC("_id" << 2 << "a" << BSON_ARRAY(BSON("c" << 1))));
+    table.freeze();
+
+    assertMatches({DOC("_id" << 0 << "a" << BSON_ARRAY(BSON("b" << 1) << BSON("b" << 2))),
+                   DOC("_id" << 1 << "a" << BSON("b" << 2))},
+                  table.probe(values({Value(2)})));
+    assertMatches({DOC("_id" << 2 << "a" << BSON_ARRAY(BSON("c" << 1)))},
+                  table.probe(values({Value(BSONNULL)})));
+}
+
+TEST(LookupHashTableTest, NullMatchesNullAndMissingValues) {
+    LookupHashTable table(FieldPath("a"), nullptr, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a" << BSONNULL));
+    table.add(DOC("_id" << 1));
+    table.add(DOC("_id" << 2 << "a" << 0));
+    table.add(DOC("_id" << 3 << "a" << BSON_ARRAY(1 << BSONNULL)));
+    table.freeze();
+
+    assertMatches({DOC("_id" << 0 << "a" << BSONNULL),
+                   DOC("_id" << 1),
+                   DOC("_id" << 3 << "a" << BSON_ARRAY(1 << BSONNULL))},
+                  table.probe(values({Value(BSONNULL)})));
+}
+
+TEST(LookupHashTableTest, RegexOnlyMatchesEqualRegex) {
+    LookupHashTable table(FieldPath("a"), nullptr, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a" << "abc"_sd));
+    table.add(Document(BSON("_id" << 1 << "a" << BSONRegEx("^a"))));
+    table.freeze();
+
+    assertMatches({Document(BSON("_id" << 1 << "a" << BSONRegEx("^a")))},
+                  table.probe(values({Value(BSONRegEx("^a"))})));
+}
+
+TEST(LookupHashTableTest, ProbeRespectsCollation) {
+    CollatorInterfaceMock collator(CollatorInterfaceMock::MockType::kAlwaysEqual);
+    LookupHashTable table(FieldPath("a"), &collator, kTableSizeBytes);
+    table.add(DOC("_id" << 0 << "a" << "foo"_sd));
+    table.add(DOC("_id" << 1 << "a" << "bar"_sd));
+    table.add(DOC("_id" << 2 << "a" << 1));
+    table.freeze();
+
+    ASSERT_EQ(table.probe(values({Value("baz"_sd)})).size(), 2ul);
+}
+
+TEST(LookupHashTableTest, ProbePreservesMetadata) {
+    LookupHashTable table(FieldPath("a"), nullptr, kTableSizeBytes);
+    MutableDocument doc(DOC("_id" << 0 << "a" << 1));
+    doc.setTextScore(2.5);
+    table.add(doc.freeze());
+    table.freeze();
+
+    auto matches = table.probe(values({Value(1)}));
+    ASSERT_EQ(matches.size(), 1ul);
+    ASSERT_EQ(matches[0].getTextScore(), 2.5);
+}
+
+TEST(LookupHashTableTest, TableAbandonsItselfWhenMaxSizeIsExceeded) {
+    LookupHashTable table(FieldPath("a"), nullptr, 100);
+    table.add(DOC("_id" << 0 << "a" << 1));
+    ASSERT(table.isBuilding());
+    ASSERT_GT(table.sizeBytes(), 0ul);
+
+    table.add(DOC("_id" << 1 << "a" << std::string(100, 'x')));
+    ASSERT(table.isAbandoned());
+    ASSERT_EQ(table.count(), 0ul);
+    ASSERT_EQ(table.sizeBytes(), 0ul);
+}
+
+DEATH_TEST(LookupHashTableTest, CannotProbeAbandonedTable, "invariant") {
+    LookupHashTable table(FieldPath("a"), nullptr, kTableSizeBytes);
+    table.abandon();
+    table.probe(values({Value(1)}));
+}
+
+}  // namespace
+}  // namespace mongo
@@ -59,6 +59,7 @@
 #include "mongo/db/pipeline/document_source_geo_near.h"
 #include "mongo/db/pipeline/document_source_geo_near_cursor.h"
 #include "mongo/db/pipeline/document_source_group.h"
+#include "mongo/db/pipeline/document_source_internal_parallel.h"
 #include "mongo/db/pipeline/document_source_match.h"
 #include "mongo/db/pipeline/document_source_sample.h"
 #include "mongo/db/pipeline/document_source_sample_from_random_cursor.h"
@@ -68,6 +69,7 @@
 #include "mongo/db/query/collation/collator_interface.h"
 #include "mongo/db/query/get_executor.h"
 #include "mongo/db/query/plan_summary_stats.h"
+#include "mongo/db/query/query_knobs_gen.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/s/collection_sharding_state.h"
 #include "mongo/db/s/sharding_state.h"
@@ -801,6 +803,72 @@ void PipelineD::addCursorSource(Pipeline* pipeline,
     }
 }
 
+namespace {
+
+/**
+ * Returns true if 'stage' transforms or filters each document on its own, and so can be run on
+ * any subset of its input.
+ */
+bool isParallelizableStage(const DocumentSource* stage) {
+    const StringData name = stage->getSourceName();
+    return name == "$match"_sd || name == "$project"_sd || name == "$addFields"_sd;
+}
+
+/**
+ * Returns true if the result of each accumulator of 'group' does not depend on the order in which
+ * it sees its input, so that partial groups may be merged in any order.
+ */
+bool hasOrderInsensitiveAccumulators(const DocumentSourceGroup* group,
+                                     const intrusive_ptr<ExpressionContext>& expCtx) {
+    const auto& accumulatedFields = group->getAccumulatedFields();
+    return std::all_of(
+        accumulatedFields.begin(), accumulatedFields.end(), [&](const auto& accumulatedField) {
+            const StringData opName = accumulatedField.makeAccumulator(expCtx)->getOpName();
+            return opName == "$sum"_sd || opName == "$avg"_sd || opName == "$min"_sd ||
+                opName == "$max"_sd || opName == "$addToSet"_sd || opName == "$stdDevPop"_sd ||
+                opName == "$stdDevSamp"_sd;
+        });
+}
+
+}  // namespace
+
+void PipelineD::parallelizePipelinePrefix(Pipeline* pipeline) {
+    const int parallelism = internalQueryAggregationParallelism.load();
+    const auto& expCtx = pipeline->getContext();
+    if (parallelism <= 1 || expCtx->explain || expCtx->tailableMode != TailableModeEnum::kNormal) {
+        return;
+    }
+
+    auto& sources = pipeline->_sources;
+    if (sources.empty() || !dynamic_cast<DocumentSourceCursor*>(sources.front().get())) {
+        return;
+    }
+
+    auto prefixBegin = std::next(sources.begin());
+    auto groupIt = std::find_if_not(prefixBegin, sources.end(), [](const auto& stage) {
+        return isParallelizableStage(stage.get());
+    });
+    if (groupIt == sources.end()) {
+        return;
+    }
+    auto group = dynamic_cast<DocumentSourceGroup*>(groupIt->get());
+    if (!group || group->doingMerge() || !hasOrderInsensitiveAccumulators(group, expCtx)) {
+        return;
+    }
+
+    auto mergingLogic = group->mergingLogic();
+    invariant(mergingLogic && mergingLogic->mergingStage);
+
+    const Pipeline::SourceContainer prefix(prefixBegin, std::next(groupIt));
+    auto parallel = DocumentSourceInternalParallel::create(expCtx, prefix, parallelism);
+    auto afterPrefix = sources.erase(prefixBegin, std::next(groupIt));
+    sources.insert(afterPrefix, {parallel, mergingLogic->mergingStage});
+    pipeline->stitch();
+
+    LOG(2) << "Running " << prefix.size() << " stages of aggregation on " << expCtx->ns << " on "
+           << parallelism << " threads";
+}
+
 Timestamp PipelineD::getLatestOplogTimestamp(const Pipeline* pipeline) {
     if (auto docSourceCursor =
             dynamic_cast<DocumentSourceCursor*>(pipeline->_sources.front().get())) {
@@ -97,6 +97,15 @@ public:
                                            const AggregationRequest* aggRequest,
                                            Pipeline* pipeline);
 
+    /**
+     * If 'pipeline' reads from a collection with $match, $project and $addFields stages followed by
+     * a $group whose accumulators do not depend on the order of their input, replaces those stages
+     * with a stage which runs them on internalQueryAggregationParallelism threads, followed by a
+     * $group which merges the partial groups of the threads. Does nothing if the knob is 1, or if
+     * the pipeline is being explained or is tailable.
+     */
+    static void parallelizePipelinePrefix(Pipeline* pipeline);
+
     static std::string getPlanSummaryStr(const Pipeline* pipeline);
 
     static void getPlanSummaryStats(const Pipeline* pipeline, PlanSummaryStats* statsOut);
@@ -0,0 +1,467 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "mongo/bson/bsonelement_comparator_interface.h"
+#include "mongo/bson/util/bson_extract.h"
+#include "mongo/db/bson/dotted_path_support.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+namespace dps = ::mongo::dotted_path_support;
+
+constexpr StringData CollectionStatistics::kNumRecordsFieldName;
+constexpr StringData CollectionStatistics::kSampleSizeFieldName;
+constexpr StringData CollectionStatistics::kTimeOfCreationFieldName;
+constexpr StringData CollectionStatistics::kFieldsFieldName;
+constexpr StringData CollectionStatistics::kPathFieldName;
+
+namespace {
+
+const StringData kNumValuesFieldName = "numValues"_sd;
+const StringData kDistinctEstimateFieldName = "distinctEstimate"_sd;
+const StringData kBucketsFieldName = "buckets"_sd;
+const StringData kBoundFieldName = "bound"_sd;
+const StringData kRangeCountFieldName = "rangeCount"_sd;
+const StringData kRangeDistinctFieldName = "rangeDistinct"_sd;
+const StringData kBoundCountFieldName = "boundCount"_sd;
+
+// The value recorded for documents in which a path is missing, matching how indexes key them.
+const BSONObj kNullObj = BSON("" << BSONNULL);
+
+int compareValues(const BSONElement& lhs, const BSONElement& rhs) {
+    const bool considerFieldName = false;
+    return lhs.woCompare(rhs, considerFieldName);
+}
+
+/**
+ * Returns whether 'value' falls within 'interval', which must be ascending.
+ */
+bool intervalContains(const Interval& interval, const BSONElement& value) {
+    const int startCmp = compareValues(interval.start, value);
+    if (startCmp > 0 || (startCmp == 0 && !interval.startInclusive)) {
+        return false;
+    }
+    const int endCmp = compareValues(value, interval.end);
+    return endCmp < 0 || (endCmp == 0 && interval.endInclusive);
+}
+
+/**
+ * Returns the fraction of the open range (low, high) covered by the ascending 'interval', which is
+ * known to overlap it partially. Numeric ranges are interpolated linearly. For other types half of
+ * the range is assumed to be covered.
+ */
+double partialOverlapFraction(const BSONElement& low,
+                              const BSONElement& high,
+                              const Interval& interval) {
+    const double kDefaultFraction = 0.5;
+    if (!low.isNumber() || !high.isNumber()) {
+        return kDefaultFraction;
+    }
+
+    const double lowValue = low.numberDouble();
+    const double highValue = high.numberDouble();
+    const double width = highValue - lowValue;
+    if (!std::isfinite(width) || width <= 0) {
+        return kDefaultFraction;
+    }
+
+    const double overlapLow =
+        interval.start.isNumber() ? std::max(interval.start.numberDouble(), lowValue) : lowValue;
+    const double overlapHigh =
+        interval.end.isNumber() ? std::min(interval.end.numberDouble(), highValue) : highValue;
+    const double fraction = (overlapHigh - overlapLow) / width;
+    if (!std::isfinite(fraction)) {
+        return kDefaultFraction;
+    }
+    return std::min(1.0, std::max(0.0, fraction));
+}
+
+/**
+ * Extrapolates the number of distinct values in a population of 'populationSize' values from a
+ * sample of 'sampleSize' values containing 'numDistinct' distinct values, 'numSingletons' of which
+ * appear exactly once. Uses the guaranteed-error estimator, which scales up the values seen only
+ * once by the square root of the sampling ratio.
+ */
+double estimateDistinct(double sampleSize,
+                        double populationSize,
+                        double numDistinct,
+                        double numSingletons) {
+    if (sampleSize <= 0 || populationSize <= sampleSize) {
+        return numDistinct;
+    }
+    const double estimate =
+        std::sqrt(populationSize / sampleSize) * numSingletons + (numDistinct - numSingletons);
+    return std::min(populationSize, std::max(numDistinct, estimate));
+}
+
+Status extractNonNegativeNumber(const BSONObj& obj, StringData fieldName, double* out) {
+    BSONElement elem;
+    auto status = bsonExtractField(obj, fieldName, &elem);
+    if (!status.isOK()) {
+        return status;
+    }
+    if (!elem.isNumber() || !(elem.numberDouble() >= 0)) {
+        return {ErrorCodes::FailedToParse,
+                str::stream() << "'" << fieldName << "' must be a non-negative number, but found "
+                              << elem};
+    }
+    *out = elem.numberDouble();
+    return Status::OK();
+}
+
+}  // namespace
+
+FieldStatistics FieldStatistics::make(std::vector<BSONElement> values,
+                                      long long sampleSize,
+                                      long long numRecords,
+                                      size_t maxBuckets) {
+    invariant(maxBuckets > 0);
+
+    FieldStatistics stats;
+    stats._numValues = values.size();
+    if (values.empty()) {
+        return stats;
+    }
+
+    const auto isLess = [](const BSONElement& lhs, const BSONElement& rhs) {
+        return compareValues(lhs, rhs) < 0;
+    };
+    const auto isEqual = [](const BSONElement& lhs, const BSONElement& rhs) {
+        return compareValues(lhs, rhs) == 0;
+    };
+    std::sort(values.begin(), values.end(), isLess);
+
+    // Returns the number of distinct values in the sorted range [begin, end).
+    const auto countDistinct = [&](size_t begin, size_t end) {
+        size_t numDistinct = 0;
+        for (size_t i = begin; i < end; ++i) {
+            if (i == begin || !isEqual(values[i - 1], values[i])) {
+                ++numDistinct;
+            }
+        }
+        return numDistinct;
+    };
+
+    size_t numDistinct = 0;
+    size_t numSingletons = 0;
+    for (size_t i = 0; i < values.size();) {
+        size_t runEnd = i + 1;
+        while (runEnd < values.size() && isEqual(values[i], values[runEnd])) {
+            ++runEnd;
+        }
+        ++numDistinct;
+        if (runEnd - i == 1) {
+            ++numSingletons;
+        }
+        i = runEnd;
+    }
+
+    const double populationSize = sampleSize > 0
+        ? static_cast<double>(numRecords) * values.size() / sampleSize
+        : static_cast<double>(values.size());
+    stats._distinctEstimate =
+        estimateDistinct(values.size(), populationSize, numDistinct, numSingletons);
+
+    // The first bucket holds only the smallest value, so that every other bucket has a lower
+    // bound. The remaining values are split into buckets of roughly equal depth, where a bucket
+    // always extends to include every value equal to its bound.
+    const size_t numRangeBuckets = std::max<size_t>(maxBuckets - 1, 1);
+    const size_t depth = std::max<size_t>(values.size() / numRangeBuckets, 1);
+    for (size_t begin = 0; begin < values.size();) {
+        size_t last = stats._buckets.empty() ? begin : std::min(begin + depth, values.size()) - 1;
+        while (last + 1 < values.size() && isEqual(values[last], values[last + 1])) {
+            ++last;
+        }
+        size_t boundBegin = last;
+        while (boundBegin > begin && isEqual(values[boundBegin - 1], values[last])) {
+            --boundBegin;
+        }
+
+        Bucket bucket;
+        bucket.bound = values[last].wrap("");
+        bucket.rangeCount = boundBegin - begin;
+        bucket.rangeDistinct = countDistinct(begin, boundBegin);
+        bucket.boundCount = last - boundBegin + 1;
+        stats._buckets.push_back(std::move(bucket));
+
+        begin = last + 1;
+    }
+
+    return stats;
+}
+
+StatusWith<FieldStatistics> FieldStatistics::parse(const BSONObj& obj) {
+    FieldStatistics stats;
+    auto status = extractNonNegativeNumber(obj, kNumValuesFieldName, &stats._numValues);
+    if (!status.isOK()) {
+        return status;
+    }
+    status = extractNonNegativeNumber(obj, kDistinctEstimateFieldName, &stats._distinctEstimate);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    BSONElement bucketsElem;
+    status = bsonExtractTypedField(obj, kBucketsFieldName, BSONType::Array, &bucketsElem);
+    if (!status.isOK()) {
+        return status;
+    }
+    for (auto&& bucketElem : bucketsElem.Obj()) {
+        if (bucketElem.type() != BSONType::Object) {
+            return {ErrorCodes::TypeMismatch,
+                    str::stream() << "histogram buckets must be objects, but found "
+                                  << bucketElem};
+        }
+        const BSONObj bucketObj = bucketElem.Obj();
+
+        Bucket bucket;
+        BSONElement boundElem;
+        status = bsonExtractField(bucketObj, kBoundFieldName, &boundElem);
+        if (!status.isOK()) {
+            return status;
+        }
+        if (!stats._buckets.empty() &&
+            compareValues(stats._buckets.back().bound.firstElement(), boundElem) >= 0) {
+            return {ErrorCodes::FailedToParse,
+                    str::stream() << "histogram bucket bounds must be increasing, but found "
+                                  << boundElem << " after "
+                                  << stats._buckets.back().bound.firstElement()};
+        }
+        bucket.bound = boundElem.wrap("");
+
+        for (auto&& field : {std::make_pair(kRangeCountFieldName, &bucket.rangeCount),
+                             std::make_pair(kRangeDistinctFieldName, &bucket.rangeDistinct),
+                             std::make_pair(kBoundCountFieldName, &bucket.boundCount)}) {
+            status = extractNonNegativeNumber(bucketObj, field.first, field.second);
+            if (!status.isOK()) {
+                return status;
+            }
+        }
+        stats._buckets.push_back(std::move(bucket));
+    }
+
+    return {std::move(stats)};
+}
+
+void FieldStatistics::serialize(BSONObjBuilder* builder) const {
+    builder->append(kNumValuesFieldName, _numValues);
+    builder->append(kDistinctEstimateFieldName, _distinctEstimate);
+
+    BSONArrayBuilder bucketsBuilder(builder->subarrayStart(kBucketsFieldName));
+    for (auto&& bucket : _buckets) {
+        BSONObjBuilder bucketBuilder(bucketsBuilder.subobjStart());
+        bucketBuilder.appendAs(bucket.bound.firstElement(), kBoundFieldName);
+        bucketBuilder.append(kRangeCountFieldName, bucket.rangeCount);
+        bucketBuilder.append(kRangeDistinctFieldName, bucket.rangeDistinct);
+        bucketBuilder.append(kBoundCountFieldName, bucket.boundCount);
+        bucketBuilder.doneFast();
+    }
+    bucketsBuilder.doneFast();
+}
+
+double FieldStatistics::estimatePointCount(const BSONElement& value) const {
+    const auto bucket = std::lower_bound(
+        _buckets.begin(), _buckets.end(), value, [](const Bucket& bucket, const BSONElement& elem) {
+            return compareValues(bucket.bound.firstElement(), elem) < 0;
+        });
+    if (bucket == _buckets.end()) {
+        return 0;
+    }
+    if (compareValues(bucket->bound.firstElement(), value) == 0) {
+        return bucket->boundCount;
+    }
+    if (bucket->rangeDistinct == 0) {
+        return 0;
+    }
+
+    // Assume the value is as frequent as the average value in the range of its bucket, but no
+    // more frequent than the average value overall.
+    double estimate = bucket->rangeCount / bucket->rangeDistinct;
+    if (_distinctEstimate > 0) {
+        estimate = std::min(estimate, _numValues / _distinctEstimate);
+    }
+    return estimate;
+}
+
+double FieldStatistics::estimateCount(const Interval& interval) const {
+    if (interval.isPoint()) {
+        return estimatePointCount(interval.start);
+    }
+
+    const Interval ascending =
+        interval.getDirection() == Interval::Direction::kDirectionDescending
+        ? interval.reverseClone()
+        : interval;
+
+    double count = 0;
+    for (size_t i = 0; i < _buckets.size(); ++i) {
+        const Bucket& bucket = _buckets[i];
+        const BSONElement bound = bucket.bound.firstElement();
+        if (intervalContains(ascending, bound)) {
+            count += bucket.boundCount;
+        }
+
+        if (i == 0 || bucket.rangeCount == 0) {
+            continue;
+        }
+
+        // Account for the values strictly between the previous bound and this one.
+        const BSONElement previousBound = _buckets[i - 1].bound.firstElement();
+        if (compareValues(ascending.end, previousBound) <= 0 ||
+            compareValues(ascending.start, bound) >= 0) {
+            continue;
+        }
+        if (compareValues(ascending.start, previousBound) <= 0 &&
+            compareValues(ascending.end, bound) >= 0) {
+            count += bucket.rangeCount;
+        } else {
+            count += bucket.rangeCount * partialOverlapFraction(previousBound, bound, ascending);
+        }
+    }
+    return count;
+}
+
+CollectionStatistics CollectionStatistics::make(const std::vector<BSONObj>& sample,
+                                                long long numRecords,
+                                                const std::vector<std::string>& paths,
+                                                size_t maxBuckets,
+                                                Date_t now) {
+    CollectionStatistics stats;
+    stats._numRecords = numRecords;
+    stats._sampleSize = sample.size();
+    stats._timeOfCreation = now;
+
+    for (auto&& path : paths) {
+        std::vector<BSONElement> values;
+        for (auto&& doc : sample) {
+            BSONElementSet elements;
+            dps::extractAllElementsAlongPath(doc, path, elements);
+            if (elements.empty()) {
+                values.push_back(kNullObj.firstElement());
+            }
+            values.insert(values.end(), elements.begin(), elements.end());
+        }
+        stats._fields[path] =
+            FieldStatistics::make(std::move(values), stats._sampleSize, numRecords, maxBuckets);
+    }
+    return stats;
+}
+
+StatusWith<CollectionStatistics> CollectionStatistics::parse(const BSONObj& obj) {
+    CollectionStatistics stats;
+    auto status = bsonExtractIntegerField(obj, kNumRecordsFieldName, &stats._numRecords);
+    if (!status.isOK()) {
+        return status;
+    }
+    status = bsonExtractIntegerField(obj, kSampleSizeFieldName, &stats._sampleSize);
+    if (!status.isOK()) {
+        return status;
+    }
+    BSONElement timeElem;
+    status = bsonExtractTypedField(obj, kTimeOfCreationFieldName, BSONType::Date, &timeElem);
+    if (!status.isOK()) {
+        return status;
+    }
+    stats._timeOfCreation = timeElem.date();
+
+    BSONElement fieldsElem;
+    status = bsonExtractTypedField(obj, kFieldsFieldName, BSONType::Array, &fieldsElem);
+    if (!status.isOK()) {
+        return status;
+    }
+    for (auto&& fieldElem : fieldsElem.Obj()) {
+        if (fieldElem.type() != BSONType::Object) {
+            return {ErrorCodes::TypeMismatch,
+                    str::stream() << "field statistics must be objects, but found " << fieldElem};
+        }
+        std::string path;
+        status = bsonExtractStringField(fieldElem.Obj(), kPathFieldName, &path);
+        if (!status.isOK()) {
+            return status;
+        }
+        auto fieldStats = FieldStatistics::parse(fieldElem.Obj());
+        if (!fieldStats.isOK()) {
+            return fieldStats.getStatus();
+        }
+        stats._fields[path] = std::move(fieldStats.getValue());
+    }
+
+    return {std::move(stats)};
+}
+
+void CollectionStatistics::serialize(BSONObjBuilder* builder) const {
+    builder->append(kNumRecordsFieldName, _numRecords);
+    builder->append(kSampleSizeFieldName, _sampleSize);
+    builder->append(kTimeOfCreationFieldName, _timeOfCreation);
+
+    // Serialize the paths in order so that the output is deterministic.
+    std::vector<std::string> paths;
+    for (auto&& field : _fields) {
+        paths.push_back(field.first);
+    }
+    std::sort(paths.begin(), paths.end());
+
+    BSONArrayBuilder fieldsBuilder(builder->subarrayStart(kFieldsFieldName));
+    for (auto&& path : paths) {
+        BSONObjBuilder fieldBuilder(fieldsBuilder.subobjStart());
+        fieldBuilder.append(kPathFieldName, path);
+        _fields.find(path)->second.serialize(&fieldBuilder);
+        fieldBuilder.doneFast();
+    }
+    fieldsBuilder.doneFast();
+}
+
+const FieldStatistics* CollectionStatistics::getFieldStatistics(StringData path) const {
+    auto it = _fields.find(path);
+    return it == _fields.end() ? nullptr : &it->second;
+}
+
+boost::optional<double> CollectionStatistics::estimateSelectivity(
+    StringData path, const OrderedIntervalList& oil) const {
+    const FieldStatistics* fieldStats = getFieldStatistics(path);
+    if (!fieldStats || _sampleSize <= 0) {
+        return boost::none;
+    }
+
+    double count = 0;
+    for (auto&& interval : oil.intervals) {
+        count += fieldStats->estimateCount(interval);
+    }
+    return count / _sampleSize;
+}
+
+}  // namespace mongo
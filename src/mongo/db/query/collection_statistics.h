@@ -0,0 +1,169 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "mongo/base/status_with.h"
+#include "mongo/bson/bsonobj.h"
+#include "mongo/db/query/index_bounds.h"
+#include "mongo/util/string_map.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+/**
+ * Cardinality statistics for a single (possibly dotted) field path, built from a sample of the
+ * documents in a collection.
+ *
+ * The values of the path are summarized by an equi-depth histogram. Like index keys, arrays are
+ * expanded one level, each document contributes each of its distinct values once, and a missing
+ * field counts as null. Every bucket describes the values in the range between the previous
+ * bucket's bound (exclusive) and its own bound (exclusive), plus the bound itself. All counts
+ * are numbers of sampled values.
+ */
+class FieldStatistics {
+public:
+    struct Bucket {
+        // A single-element object holding the upper bound of the bucket.
+        BSONObj bound;
+
+        // The number of sampled values strictly between the previous bound and 'bound'.
+        double rangeCount = 0;
+
+        // The number of distinct sampled values strictly between the previous bound and 'bound'.
+        double rangeDistinct = 0;
+
+        // The number of sampled values equal to 'bound'.
+        double boundCount = 0;
+    };
+
+    /**
+     * Builds the statistics from 'values', the values of the path in each of 'sampleSize' sampled
+     * documents. 'values' need not be sorted. 'numRecords' is the number of documents in the
+     * collection, which is used to extrapolate the number of distinct values.
+     */
+    static FieldStatistics make(std::vector<BSONElement> values,
+                                long long sampleSize,
+                                long long numRecords,
+                                size_t maxBuckets);
+
+    static StatusWith<FieldStatistics> parse(const BSONObj& obj);
+
+    void serialize(BSONObjBuilder* builder) const;
+
+    /**
+     * Returns the estimated number of sampled values which fall within 'interval'.
+     */
+    double estimateCount(const Interval& interval) const;
+
+    const std::vector<Bucket>& getBuckets() const {
+        return _buckets;
+    }
+
+    /**
+     * Returns the estimated number of distinct values of the path in the whole collection.
+     */
+    double getDistinctEstimate() const {
+        return _distinctEstimate;
+    }
+
+private:
+    double estimatePointCount(const BSONElement& value) const;
+
+    std::vector<Bucket> _buckets;
+
+    // The total number of sampled values.
+    double _numValues = 0;
+
+    double _distinctEstimate = 0;
+};
+
+/**
+ * The cardinality statistics of a collection, as built by the 'analyze' command and stored in its
+ * database's 'system.statistics' collection with the collection UUID as '_id'.
+ */
+class CollectionStatistics {
+public:
+    static constexpr StringData kNumRecordsFieldName = "numRecords"_sd;
+    static constexpr StringData kSampleSizeFieldName = "sampleSize"_sd;
+    static constexpr StringData kTimeOfCreationFieldName = "timeOfCreation"_sd;
+    static constexpr StringData kFieldsFieldName = "fields"_sd;
+    static constexpr StringData kPathFieldName = "path"_sd;
+
+    /**
+     * Builds statistics for each of 'paths' from the documents in 'sample'.
+     */
+    static CollectionStatistics make(const std::vector<BSONObj>& sample,
+                                     long long numRecords,
+                                     const std::vector<std::string>& paths,
+                                     size_t maxBuckets,
+                                     Date_t now);
+
+    /**
+     * Parses statistics previously produced by serialize(). Unknown top-level fields, such as
+     * '_id', are ignored.
+     */
+    static StatusWith<CollectionStatistics> parse(const BSONObj& obj);
+
+    void serialize(BSONObjBuilder* builder) const;
+
+    /**
+     * Returns the estimated fraction of the collection's documents whose values for 'path' fall
+     * within 'oil', or boost::none if there are no statistics for 'path'. The fraction may exceed
+     * one for paths holding arrays, as each array element is counted.
+     */
+    boost::optional<double> estimateSelectivity(StringData path,
+                                                const OrderedIntervalList& oil) const;
+
+    const FieldStatistics* getFieldStatistics(StringData path) const;
+
+    long long getNumRecords() const {
+        return _numRecords;
+    }
+
+    long long getSampleSize() const {
+        return _sampleSize;
+    }
+
+    Date_t getTimeOfCreation() const {
+        return _timeOfCreation;
+    }
+
+private:
+    long long _numRecords = 0;
+    long long _sampleSize = 0;
+    Date_t _timeOfCreation;
+
+    StringMap<FieldStatistics> _fields;
+};
+
+}  // namespace mongo
@@ -0,0 +1,255 @@
+/**
+ *    Copyright (C) 2018-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/query/collection_statistics.h"
+
+#include "mongo/db/json.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace {
+
+const Date_t kTimeOfCreation = Date_t::fromMillisSinceEpoch(1000);
+
+Interval makeInterval(BSONObj bounds, bool startInclusive, bool endInclusive) {
+    return Interval(std::move(bounds), startInclusive, endInclusive);
+}
+
+Interval makePoint(int value) {
+    return makeInterval(BSON("" << value << "" << value), true, true);
+}
+
+/**
+ * Returns 'numDocs' documents where 'a' counts up from zero.
+ */
+std::vector<BSONObj> makeSequentialSample(int numDocs) {
+    std::vector<BSONObj> sample;
+    for (int i = 0; i < numDocs; ++i) {
+        sample.push_back(BSON("a" << i));
+    }
+    return sample;
+}
+
+TEST(CollectionStatisticsTest, FirstBucketHoldsOnlyTheMinimum) {
+    auto stats = CollectionStatistics::make(
+        makeSequentialSample(100), 100, {"a"}, 10, kTimeOfCreation);
+    const FieldStatistics* fieldStats = stats.getFieldStatistics("a");
+    ASSERT(fieldStats);
+
+    const auto& buckets = fieldStats->getBuckets();
+    ASSERT_EQ(buckets.size(), 10U);
+    ASSERT_BSONOBJ_EQ(buckets.front().bound, BSON("" << 0));
+    ASSERT_EQ(buckets.front().rangeCount, 0);
+    ASSERT_EQ(buckets.front().boundCount, 1);
+    ASSERT_BSONOBJ_EQ(buckets.back().bound, BSON("" << 99));
+
+    double total = 0;
+    for (auto&& bucket : buckets) {
+        total += bucket.rangeCount + bucket.boundCount;
+    }
+    ASSERT_EQ(total, 100);
+}
+
+TEST(CollectionStatisticsTest, EstimatePointCounts) {
+    auto stats = CollectionStatistics::make(
+        makeSequentialSample(100), 100, {"a"}, 10, kTimeOfCreation);
+    const FieldStatistics* fieldStats = stats.getFieldStatistics("a");
+    ASSERT(fieldStats);
+
+    // A bucket bound, a value inside a bucket, and values outside of the histogram.
+    ASSERT_EQ(fieldStats->estimateCount(makePoint(0)), 1);
+    ASSERT_EQ(fieldStats->estimateCount(makePoint(5)), 1);
+    ASSERT_EQ(fieldStats->estimateCount(makePoint(-1)), 0);
+    ASSERT_EQ(fieldStats->estimateCount(makePoint(1000)), 0);
+}
+
+TEST(CollectionStatisticsTest, EstimateRangeCounts) {
+    auto stats = CollectionStatistics::make(
+        makeSequentialSample(100), 100, {"a"}, 10, kTimeOfCreation);
+    const FieldStatistics* fieldStats = stats.getFieldStatistics("a");
+    ASSERT(fieldStats);
+
+    ASSERT_EQ(fieldStats->estimateCount(makeInterval(BSON("" << 0 << "" << 99), true, true)), 100);
+    ASSERT_EQ(
+        fieldStats->estimateCount(makeInterval(BSON("" << MINKEY << "" << MAXKEY), true, true)),
+        100);
+    ASSERT_EQ(fieldStats->estimateCount(makeInterval(BSON("" << 100 << "" << 200), true, true)),
+              0);
+
+    // Ranges partially covering a bucket are interpolated.
+    ASSERT_APPROX_EQUAL(
+        fieldStats->estimateCount(makeInterval(BSON("" << 10 << "" << 20), true, true)), 11, 1.5);
+    ASSERT_APPROX_EQUAL(
+        fieldStats->estimateCount(makeInterval(BSON("" << 50 << "" << 1000), true, false)),
+        50,
+        1.5);
+}
+
+TEST(CollectionStatisticsTest, DescendingIntervalsAreEstimatedLikeAscendingOnes) {
+    auto stats = CollectionStatistics::make(
+        makeSequentialSample(100), 100, {"a"}, 10, kTimeOfCreation);
+    const FieldStatistics* fieldStats = stats.getFieldStatistics("a");
+    ASSERT(fieldStats);
+
+    ASSERT_EQ(fieldStats->estimateCount(makeInterval(BSON("" << 20 << "" << 10), true, true)),
+              fieldStats->estimateCount(makeInterval(BSON("" << 10 << "" << 20), true, true)));
+}
+
+TEST(CollectionStatisticsTest, FrequentValuesGetTheirOwnBucket) {
+    std::vector<BSONObj> sample;
+    for (int i = 0; i < 50; ++i) {
+        sample.push_back(BSON("a" << 7));
+        sample.push_back(BSON("a" << 100 + i));
+    }
+    auto stats = CollectionStatistics::make(sample, 100, {"a"}, 4, kTimeOfCreation);
+    const FieldStatistics* fieldStats = stats.getFieldStatistics("a");
+    ASSERT(fieldStats);
+
+    ASSERT_EQ(fieldStats->estimateCount(makePoint(7)), 50);
+    ASSERT_APPROX_EQUAL(fieldStats->estimateCount(makePoint(120)), 1, 0.5);
+}
+
+TEST(CollectionStatisticsTest, MissingPathsCountAsNull) {
+    std::vector<BSONObj> sample{BSON("a" << 1), BSON("b" << 1), BSON("a" << BSONNULL)};
+    auto stats = CollectionStatistics::make(sample, 3, {"a"}, 10, kTimeOfCreation);
+
+    OrderedIntervalList oil("a");
+    oil.intervals.push_back(makeInterval(BSON("" << BSONNULL << "" << BSONNULL), true, true));
+    auto selectivity = stats.estimateSelectivity("a", oil);
+    ASSERT(selectivity);
+    ASSERT_APPROX_EQUAL(*selectivity, 2.0 / 3, 1e-9);
+}
+
+TEST(CollectionStatisticsTest, ArraysAreExpandedAndDeduplicated) {
+    std::vector<BSONObj> sample{fromjson("{a: [1, 2, 2]}"), fromjson("{a: {b: 3}}")};
+    auto stats = CollectionStatistics::make(sample, 2, {"a", "a.b"}, 10, kTimeOfCreation);
+
+    OrderedIntervalList oil("a");
+    oil.intervals.push_back(makeInterval(BSON("" << 1 << "" << 2), true, true));
+    auto selectivity = stats.estimateSelectivity("a", oil);
+    ASSERT(selectivity);
+    ASSERT_EQ(*selectivity, 1.0);
+
+    OrderedIntervalList dottedOil("a.b");
+    dottedOil.intervals.push_back(makePoint(3));
+    selectivity = stats.estimateSelectivity("a.b", dottedOil);
+    ASSERT(selectivity);
+    ASSERT_EQ(*selectivity, 0.5);
+}
+
+TEST(CollectionStatisticsTest, EstimateSelectivityReturnsNoneForUnknownPaths) {
+    auto stats =
+        CollectionStatistics::make(makeSequentialSample(10), 10, {"a"}, 10, kTimeOfCreation);
+    OrderedIntervalList oil("b");
+    oil.intervals.push_back(makePoint(1));
+    ASSERT_FALSE(stats.estimateSelectivity("b", oil));
+}
+
+TEST(CollectionStatisticsTest, DistinctEstimateIsExtrapolatedFromSingletons) {
+    // Every sampled value is unique, so the number of distinct values is scaled up.
+    auto stats = CollectionStatistics::make(
+        makeSequentialSample(100), 1000, {"a"}, 10, kTimeOfCreation);
+    ASSERT_APPROX_EQUAL(
+        stats.getFieldStatistics("a")->getDistinctEstimate(), 100 * std::sqrt(10.0), 1e-6);
+
+    // Every sampled value repeats, so the number of distinct values is taken as is.
+    std::vector<BSONObj> sample;
+    for (int i = 0; i < 100; ++i) {
+        sample.push_back(BSON("a" << i % 10));
+    }
+    stats = CollectionStatistics::make(sample, 1000, {"a"}, 10, kTimeOfCreation);
+    ASSERT_EQ(stats.getFieldStatistics("a")->getDistinctEstimate(), 10);
+
+    // The whole collection was sampled.
+    stats = CollectionStatistics::make(makeSequentialSample(100), 100, {"a"}, 10, kTimeOfCreation);
+    ASSERT_EQ(stats.getFieldStatistics("a")->getDistinctEstimate(), 100);
+}
+
+TEST(CollectionStatisticsTest, SerializeAndParseRoundTrip) {
+    auto stats = CollectionStatistics::make(
+        makeSequentialSample(100), 1000, {"b", "a"}, 10, kTimeOfCreation);
+    BSONObjBuilder builder;
+    builder.append("_id", "coll");
+    stats.serialize(&builder);
+    const BSONObj serialized = builder.obj();
+
+    // Paths are serialized in sorted order.
+    ASSERT_EQ(serialized[CollectionStatistics::kFieldsFieldName].Obj().firstElement().Obj()
+                  [CollectionStatistics::kPathFieldName]
+                      .str(),
+              "a");
+
+    auto parsed = CollectionStatistics::parse(serialized);
+    ASSERT_OK(parsed.getStatus());
+    ASSERT_EQ(parsed.getValue().getNumRecords(), 1000);
+    ASSERT_EQ(parsed.getValue().getSampleSize(), 100);
+    ASSERT_EQ(parsed.getValue().getTimeOfCreation(), kTimeOfCreation);
+
+    BSONObjBuilder reserializedBuilder;
+    reserializedBuilder.append("_id", "coll");
+    parsed.getValue().serialize(&reserializedBuilder);
+    ASSERT_BSONOBJ_EQ(reserializedBuilder.obj(), serialized);
+}
+
+TEST(CollectionStatisticsTest, ParseFailsOnMissingFields) {
+    ASSERT_NOT_OK(CollectionStatistics::parse(
+                      fromjson("{sampleSize: 1, timeOfCreation: new Date(0), fields: []}"))
+                      .getStatus());
+    ASSERT_NOT_OK(
+        CollectionStatistics::parse(fromjson("{numRecords: 1, sampleSize: 1, fields: []}"))
+            .getStatus());
+    ASSERT_NOT_OK(CollectionStatistics::parse(
+                      fromjson("{numRecords: 1, sampleSize: 1, timeOfCreation: new Date(0), "
+                               "fields: [{numValues: 1, distinctEstimate: 1, buckets: []}]}"))
+                      .getStatus());
+}
+
+TEST(CollectionStatisticsTest, ParseFailsOnInvalidBuckets) {
+    ASSERT_NOT_OK(FieldStatistics::parse(
+                      fromjson("{numValues: 2, distinctEstimate: 2, buckets: ["
+                               "{bound: 2, rangeCount: 0, rangeDistinct: 0, boundCount: 1}, "
+                               "{bound: 1, rangeCount: 0, rangeDistinct: 0, boundCount: 1}]}"))
+                      .getStatus());
+    ASSERT_NOT_OK(FieldStatistics::parse(
+                      fromjson("{numValues: 1, distinctEstimate: 1, buckets: ["
+                               "{bound: 1, rangeCount: -1, rangeDistinct: 0, boundCount: 1}]}"))
+                      .getStatus());
+    ASSERT_NOT_OK(
+        FieldStatistics::parse(fromjson("{numValues: 1, distinctEstimate: 1, buckets: [1]}"))
+            .getStatus());
+    ASSERT_OK(FieldStatistics::parse(
+                  fromjson("{numValues: 1, distinctEstimate: 1, buckets: ["
+                           "{bound: 1, rangeCount: 0, rangeDistinct: 0, boundCount: 1}]}"))
+                  .getStatus());
+}
+
+}  // namespace
+}  // namespace mongo
@@ -31,6 +31,8 @@
 
 #include "mongo/db/query/explain.h"
 
+#include <algorithm>
+
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/exec/cached_plan.h"
@@ -539,6 +541,9 @@ void Explain::statsToBSON(const PlanStageStats& stats,
         if (verbosity >= ExplainOptions::Verbosity::kExecStats) {
             bob->appendNumber("memUsage", spec->memUsage);
             bob->appendNumber("memLimit", spec->memLimit);
+            if (spec->allowDiskUse) {
+                bob->appendBool("usedDisk", spec->usedDisk);
+            }
         }
 
         if (spec->limit > 0) {
@@ -938,6 +943,12 @@ void Explain::getSummaryStats(const PlanExecutor& exec, PlanSummaryStats* statsO
         return;
     }
 
+    getSummaryStats(root, statsOut);
+}
+
+void Explain::getSummaryStats(const PlanStage* root, PlanSummaryStats* statsOut) {
+    invariant(NULL != statsOut);
+
     // We can get some of the fields we need from the common stats stored in the
     // root stage of the plan tree.
     const CommonStats* common = root->getCommonStats();
@@ -1019,6 +1030,23 @@ void Explain::planCacheEntryToBSON(const PlanCacheEntry& entry, BSONObjBuilder*
     // Append whether or not the entry is active.
     out->append("isActive", entry.isActive);
     out->append("works", static_cast<long long>(entry.works));
+    out->append("planningWorks", static_cast<long long>(entry.planningWorks()));
+
+    const auto& runtimeStats = entry.runtimeStats;
+    BSONObjBuilder runtimeStatsBob(out->subobjStart("runtimeStats"));
+    runtimeStatsBob.append("numExecutions", runtimeStats.numExecutions);
+    runtimeStatsBob.append("averageLatencyMicros", runtimeStats.averageLatencyMicros);
+    runtimeStatsBob.append("totalDocsExamined", runtimeStats.totalDocsExamined);
+    runtimeStatsBob.append("totalKeysExamined", runtimeStats.totalKeysExamined);
+    runtimeStatsBob.append("totalReturned", runtimeStats.totalReturned);
+
+    // The ratios are taken against at least one returned document so that shapes which match
+    // nothing still report how much work they do.
+    const double returned = std::max(runtimeStats.totalReturned, 1LL);
+    runtimeStatsBob.append("docsExaminedPerReturned", runtimeStats.totalDocsExamined / returned);
+    runtimeStatsBob.append("keysExaminedPerReturned", runtimeStats.totalKeysExamined / returned);
+    runtimeStatsBob.append("numReplans", runtimeStats.numReplans);
+    runtimeStatsBob.doneFast();
 
     BSONObjBuilder cachedPlanBob(out->subobjStart("cachedPlan"));
     Explain::statsToBSON(
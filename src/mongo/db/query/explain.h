@@ -157,6 +157,12 @@ public:
      */
     static void getSummaryStats(const PlanExecutor& exec, PlanSummaryStats* statsOut);
 
+    /**
+     * Same as above, but aggregates the stats of the plan tree rooted at 'root'. Pipeline proxy
+     * stages are not supported.
+     */
+    static void getSummaryStats(const PlanStage* root, PlanSummaryStats* statsOut);
+
     /**
      * If exec's root stage is a MultiPlanStage, returns the stats for the trial period of of the
      * winning plan. Otherwise, returns nullptr.
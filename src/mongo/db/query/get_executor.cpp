@@ -229,6 +229,9 @@ void fillOutPlannerParams(OperationContext* opCtx,
         }
     }
 
+    // Let the planner use the collection's cardinality statistics, if it has been analyzed.
+    plannerParams->statistics = collection->infoCache()->getStatistics(opCtx);
+
     // We will not output collection scans unless there are no indexed solutions. NO_TABLE_SCAN
     // overrides this behavior by not outputting a collscan even if there are no indexed
     // solutions.
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <functional>
 #include <list>
 #include <memory>
 
@@ -51,6 +52,12 @@ namespace mongo {
  * Implemented as a doubly-linked list with a hash map for quickly locating the kv-store entries.
  * The add(), get(), and remove() operations are all O(1).
  *
+ * Optionally, the kv-store may be given a cost function and an eviction window. When an entry
+ * must be evicted, the 'evictionWindow' least recently used entries are considered and the one
+ * with the lowest cost is evicted, preferring the least recently used among equal costs. This
+ * makes add() O(evictionWindow) when it evicts. With the default window of 1 the policy is plain
+ * LRU.
+ *
  * The keys of generic type K map to values of type V*. The V*
  * pointers are owned by the kv-store.
  *
@@ -60,8 +67,16 @@ namespace mongo {
 template <class K, class V, class KeyHasher = std::hash<K>>
 class LRUKeyValue {
 public:
+    using CostFunction = std::function<size_t(const V&)>;
+
     LRUKeyValue(size_t maxSize) : _maxSize(maxSize), _currentSize(0){};
 
+    LRUKeyValue(size_t maxSize, size_t evictionWindow, CostFunction costFn)
+        : _maxSize(maxSize),
+          _currentSize(0),
+          _evictionWindow(evictionWindow),
+          _costFn(std::move(costFn)){};
+
     ~LRUKeyValue() {
         clear();
     }
@@ -84,8 +99,9 @@ public:
      * If 'key' already exists in the kv-store, 'entry' will
      * simply replace what is already there.
      *
-     * The least recently used entry is evicted if the
-     * kv-store is full prior to the add() operation.
+     * The least recently used entry (or the cheapest entry within
+     * the eviction window, if a cost function was provided) is
+     * evicted if the kv-store is full prior to the add() operation.
      *
      * If an entry is evicted, it will be returned in
      * an unique_ptr for the caller to use before disposing.
@@ -108,11 +124,12 @@ public:
         // If the store has grown beyond its allowed size,
         // evict the least recently used entry.
         if (_currentSize > _maxSize) {
-            V* evictedEntry = _kvList.back().second;
+            KVListIt victim = selectVictim();
+            V* evictedEntry = victim->second;
             invariant(evictedEntry);
 
-            _kvMap.erase(_kvList.back().first);
-            _kvList.pop_back();
+            _kvMap.erase(victim->first);
+            _kvList.erase(victim);
             _currentSize--;
             invariant(_currentSize == _maxSize);
 
@@ -210,12 +227,46 @@ public:
     }
 
 private:
+    /**
+     * Chooses the entry to evict. Without a cost function this is the least recently used entry.
+     * Otherwise, it is the lowest cost entry among the '_evictionWindow' least recently used
+     * entries. The most recently used entry, which is the one just added, is only chosen if it is
+     * the sole entry in the kv-store.
+     */
+    KVListIt selectVictim() {
+        KVListIt victim = std::prev(_kvList.end());
+        if (!_costFn || _evictionWindow <= 1 || victim == _kvList.begin()) {
+            return victim;
+        }
+
+        size_t victimCost = _costFn(*victim->second);
+        KVListIt candidate = victim;
+        for (size_t considered = 1; considered < _evictionWindow; ++considered) {
+            if (--candidate == _kvList.begin()) {
+                break;
+            }
+            const size_t candidateCost = _costFn(*candidate->second);
+            if (candidateCost < victimCost) {
+                victim = candidate;
+                victimCost = candidateCost;
+            }
+        }
+        return victim;
+    }
+
     // The maximum allowable number of entries in the kv-store.
     const size_t _maxSize;
 
     // The number of entries currently in the kv-store.
     size_t _currentSize;
 
+    // The number of least recently used entries considered for eviction when '_costFn' is set.
+    const size_t _evictionWindow = 1;
+
+    // Optional function returning the cost of recreating an entry. Cheaper entries are evicted
+    // first within the eviction window.
+    const CostFunction _costFn;
+
     // (K, V*) pairs are stored in this std::list. They are sorted in order
     // of use, where the front is the most recently used and the back is the
     // least recently used.
@@ -195,4 +195,56 @@ TEST(LRUKeyValueTest, IterationTest) {
     ASSERT(i == cache.end());
 }
 
+/**
+ * Test that with a cost function, the cheapest entry within the eviction window is evicted
+ * instead of the least recently used one.
+ */
+TEST(LRUKeyValueTest, CostAwareEvictionWithinWindow) {
+    // The cost of an entry is its value.
+    LRUKeyValue<int, int> cache(3, 2, [](const int& value) { return size_t(value); });
+    cache.add(1, new int(100));
+    cache.add(2, new int(1));
+    cache.add(3, new int(50));
+
+    // Keys 1 and 2 are the two least recently used. Key 2 is cheaper, so it is evicted even
+    // though key 1 is older.
+    std::unique_ptr<int> evicted = cache.add(4, new int(10));
+    ASSERT(evicted);
+    ASSERT_EQUALS(*evicted, 1);
+    assertNotInKVStore(cache, 2);
+
+    // Now keys 1 and 3 form the window, so key 3 is evicted and the expensive key 1 survives.
+    evicted = cache.add(5, new int(1000));
+    ASSERT(evicted);
+    ASSERT_EQUALS(*evicted, 50);
+    assertNotInKVStore(cache, 3);
+    assertInKVStore(cache, 1, 100);
+    assertInKVStore(cache, 4, 10);
+    assertInKVStore(cache, 5, 1000);
+}
+
+/**
+ * Test that entries of equal cost are evicted in LRU order, and that the entry just added is
+ * never considered while other entries exist.
+ */
+TEST(LRUKeyValueTest, CostAwareEvictionTiesAreLRU) {
+    LRUKeyValue<int, int> cache(2, 10, [](const int&) { return size_t(1); });
+    cache.add(1, new int(1));
+    cache.add(2, new int(2));
+    std::unique_ptr<int> evicted = cache.add(3, new int(3));
+    ASSERT(evicted);
+    ASSERT_EQUALS(*evicted, 1);
+    assertInKVStore(cache, 2, 2);
+    assertInKVStore(cache, 3, 3);
+}
+
+/**
+ * A cost-aware kv-store of size 0 must still evict the entry which was just added.
+ */
+TEST(LRUKeyValueTest, CostAwareSizeZeroCache) {
+    LRUKeyValue<int, int> cache(0, 4, [](const int& value) { return size_t(value); });
+    cache.add(1, new int(2));
+    assertNotInKVStore(cache, 1);
+}
+
 }  // namespace
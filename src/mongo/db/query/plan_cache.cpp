@@ -236,6 +236,7 @@ PlanCacheEntry* PlanCacheEntry::clone() const {
 
     // Copy performance stats.
     entry->feedback = feedback;
+    entry->runtimeStats = runtimeStats;
 
     return entry;
 }
@@ -248,6 +249,33 @@ std::string PlanCacheEntry::toString() const {
                          << ";timeOfCreation: " << timeOfCreation.toString() << ")";
 }
 
+size_t PlanCacheEntry::planningWorks() const {
+    size_t total = 0;
+    for (auto&& stats : decision->stats) {
+        total += stats->common.works;
+    }
+    return total;
+}
+
+void PlanCacheEntryRuntimeStats::recordExecution(Microseconds latency,
+                                                 const PlanSummaryStats& summaryStats) {
+    // The weight given to the newest sample in the moving average of the latency.
+    const double kLatencySampleWeight = 0.2;
+
+    const double latencyMicros = durationCount<Microseconds>(latency);
+    averageLatencyMicros = numExecutions == 0
+        ? latencyMicros
+        : kLatencySampleWeight * latencyMicros + (1 - kLatencySampleWeight) * averageLatencyMicros;
+
+    ++numExecutions;
+    totalDocsExamined += summaryStats.totalDocsExamined;
+    totalKeysExamined += summaryStats.totalKeysExamined;
+    totalReturned += summaryStats.nReturned;
+    if (summaryStats.replanned) {
+        ++numReplans;
+    }
+}
+
 std::string CachedSolution::toString() const {
     return str::stream() << "key: " << key << '\n';
 }
@@ -353,9 +381,14 @@ std::string SolutionCacheData::toString() const {
 
 PlanCache::PlanCache() : PlanCache(internalQueryCacheSize.load()) {}
 
-PlanCache::PlanCache(size_t size) : _cache(size) {}
+PlanCache::PlanCache(size_t size)
+    : _cache(size,
+             internalQueryCacheEvictionWindow.load(),
+             [](const PlanCacheEntry& entry) { return entry.planningWorks(); }) {}
 
-PlanCache::PlanCache(const std::string& ns) : _cache(internalQueryCacheSize.load()), _ns(ns) {}
+PlanCache::PlanCache(const std::string& ns) : PlanCache(internalQueryCacheSize.load()) {
+    _ns = ns;
+}
 
 PlanCache::~PlanCache() {}
 
@@ -480,15 +513,15 @@ Status PlanCache::set(const CanonicalQuery& query,
     bool isNewEntryActive = false;
     uint32_t queryHash;
     uint32_t planCacheKey;
+    PlanCacheEntry* oldEntry = nullptr;
+    Status cacheStatus = _cache.get(key, &oldEntry);
+    invariant(cacheStatus.isOK() || cacheStatus == ErrorCodes::NoSuchKey);
     if (internalQueryCacheDisableInactiveEntries.load()) {
         // All entries are always active.
         isNewEntryActive = true;
         planCacheKey = canonical_query_encoder::computeHash(key.stringData());
         queryHash = canonical_query_encoder::computeHash(key.getStableKeyStringData());
     } else {
-        PlanCacheEntry* oldEntry = nullptr;
-        Status cacheStatus = _cache.get(key, &oldEntry);
-        invariant(cacheStatus.isOK() || cacheStatus == ErrorCodes::NoSuchKey);
         if (oldEntry) {
             queryHash = oldEntry->queryHash;
             planCacheKey = oldEntry->planCacheKey;
@@ -522,6 +555,11 @@ Status PlanCache::set(const CanonicalQuery& query,
     }
     newEntry->timeOfCreation = now;
 
+    // The execution statistics describe the shape, so they survive the replacement of its entry.
+    if (oldEntry) {
+        newEntry->runtimeStats = oldEntry->runtimeStats;
+    }
+
     // Strip projections on $-prefixed fields, as these are added by internal callers of the query
     // system and are not considered part of the user projection.
     BSONObjBuilder projBuilder;
@@ -600,6 +638,23 @@ Status PlanCache::feedback(const CanonicalQuery& cq, double score) {
     return Status::OK();
 }
 
+Status PlanCache::recordExecution(const CanonicalQuery& cq,
+                                  Microseconds latency,
+                                  const PlanSummaryStats& summaryStats) {
+    PlanCacheKey ck = computeKey(cq);
+
+    stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
+    PlanCacheEntry* entry;
+    Status cacheStatus = _cache.get(ck, &entry);
+    if (!cacheStatus.isOK()) {
+        return cacheStatus;
+    }
+    invariant(entry);
+
+    entry->runtimeStats.recordExecution(latency, summaryStats);
+    return Status::OK();
+}
+
 Status PlanCache::remove(const CanonicalQuery& canonicalQuery) {
     stdx::lock_guard<stdx::mutex> cacheLock(_cacheMutex);
     return _cache.remove(computeKey(canonicalQuery));
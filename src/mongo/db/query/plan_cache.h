@@ -37,6 +37,7 @@
 #include "mongo/db/query/index_tag.h"
 #include "mongo/db/query/lru_key_value.h"
 #include "mongo/db/query/plan_cache_indexability.h"
+#include "mongo/db/query/plan_summary_stats.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
@@ -269,6 +270,34 @@ public:
     size_t decisionWorks;
 };
 
+/**
+ * Statistics about the queries which executed with a given query shape while it had an entry in
+ * the plan cache. These describe the shape rather than a particular plan, so they are carried
+ * over when a replan replaces the entry.
+ */
+struct PlanCacheEntryRuntimeStats {
+    /**
+     * Folds the statistics of a single query execution into the totals.
+     */
+    void recordExecution(Microseconds latency, const PlanSummaryStats& summaryStats);
+
+    // The number of executions recorded.
+    long long numExecutions = 0;
+
+    // Exponentially weighted moving average of the latency of recorded executions, so that recent
+    // executions dominate.
+    double averageLatencyMicros = 0;
+
+    // Totals across all recorded executions.
+    long long totalDocsExamined = 0;
+    long long totalKeysExamined = 0;
+    long long totalReturned = 0;
+
+    // The number of recorded executions which had to replan because the cached plan performed
+    // poorly.
+    long long numReplans = 0;
+};
+
 /**
  * Used by the cache to track entries and their performance over time.
  * Also used by the plan cache commands to display plan cache state.
@@ -298,6 +327,13 @@ public:
     // For debugging.
     std::string toString() const;
 
+    /**
+     * Returns the total number of works performed by all candidate plans while the plan for this
+     * entry was being selected. This approximates the cost of planning the shape again should the
+     * entry be evicted.
+     */
+    size_t planningWorks() const;
+
     //
     // Planner data
     //
@@ -345,6 +381,9 @@ public:
     // trigger a replan. Running a query of the same shape while this cache entry is inactive may
     // cause this value to be increased.
     size_t works = 0;
+
+    // Execution statistics for queries of this shape.
+    PlanCacheEntryRuntimeStats runtimeStats;
 };
 
 /**
@@ -468,6 +507,18 @@ public:
      */
     Status feedback(const CanonicalQuery& cq, double score);
 
+    /**
+     * Records the statistics of an execution of a cached plan for a query of the shape of 'cq'.
+     * This is called once per execution, however many batches it returned its results in. If the
+     * plan was replanned during execution, this is counted against the shape as well.
+     *
+     * If the entry corresponding to 'cq' isn't in the cache, the statistics are ignored and an
+     * error Status is returned.
+     */
+    Status recordExecution(const CanonicalQuery& cq,
+                           Microseconds latency,
+                           const PlanSummaryStats& summaryStats);
+
     /**
      * Remove the entry corresponding to 'ck' from the cache.  Returns Status::OK() if the plan
      * was present and removed and an error status otherwise.
@@ -543,6 +594,9 @@ private:
                                    size_t newWorks,
                                    double growthCoefficient);
 
+    // When the cache is full, the entry with the fewest planning works among the
+    // 'internalQueryCacheEvictionWindow' least recently used entries is evicted, so that shapes
+    // which are expensive to plan stay resident over cheap ones.
     LRUKeyValue<PlanCacheKey, PlanCacheEntry, PlanCacheKeyHasher> _cache;
 
     // Protects _cache.
@@ -565,6 +565,99 @@ TEST(PlanCacheTest, PlanCacheLRUPolicyRemovesInactiveEntries) {
     ASSERT_EQ(planCache.get(*cqC).state, PlanCache::CacheEntryState::kPresentInactive);
 }
 
+TEST(PlanCacheTest, PlanCacheEvictionPrefersEntriesWhichAreCheapToPlan) {
+    // Use a tiny cache size.
+    const size_t kCacheSize = 2;
+    PlanCache planCache(kCacheSize);
+    QueryTestServiceContext serviceContext;
+
+    // The {a: 1} shape is expensive to plan, while the {b: 1} shape is cheap.
+    unique_ptr<CanonicalQuery> cqA(canonicalize("{a: 1}"));
+    auto qsA = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solnsA = {qsA.get(), qsA.get()};
+    ASSERT_OK(planCache.set(*cqA, solnsA, createDecision(2U, 500U), Date_t{}));
+
+    unique_ptr<CanonicalQuery> cqB(canonicalize("{b: 1}"));
+    auto qsB = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solnsB = {qsB.get(), qsB.get()};
+    ASSERT_OK(planCache.set(*cqB, solnsB, createDecision(2U, 5U), Date_t{}));
+
+    // Insert another entry. Although {a: 1} is the least recently used, {b: 1} is ejected because
+    // it is cheaper to plan again.
+    unique_ptr<CanonicalQuery> cqC(canonicalize("{c: 1}"));
+    addCacheEntryForShape(*cqC.get(), &planCache);
+    ASSERT_EQ(planCache.get(*cqB).state, PlanCache::CacheEntryState::kNotPresent);
+    ASSERT_EQ(planCache.get(*cqA).state, PlanCache::CacheEntryState::kPresentInactive);
+    ASSERT_EQ(planCache.get(*cqC).state, PlanCache::CacheEntryState::kPresentInactive);
+}
+
+TEST(PlanCacheTest, PlanCacheEntryPlanningWorksSumsAllCandidates) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    auto qs = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solns = {qs.get(), qs.get(), qs.get()};
+    QueryTestServiceContext serviceContext;
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(3U, 10U), Date_t{}));
+
+    auto entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_EQ(entry->works, 10U);
+    ASSERT_EQ(entry->planningWorks(), 30U);
+}
+
+TEST(PlanCacheTest, RecordExecutionAccumulatesRuntimeStats) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    auto qs = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solns = {qs.get()};
+    QueryTestServiceContext serviceContext;
+
+    // Executions of a shape which is not cached are ignored.
+    PlanSummaryStats summaryStats;
+    summaryStats.nReturned = 2;
+    summaryStats.totalDocsExamined = 10;
+    summaryStats.totalKeysExamined = 4;
+    ASSERT_NOT_OK(planCache.recordExecution(*cq, Microseconds(100), summaryStats));
+
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U), Date_t{}));
+    ASSERT_OK(planCache.recordExecution(*cq, Microseconds(100), summaryStats));
+    summaryStats.replanned = true;
+    ASSERT_OK(planCache.recordExecution(*cq, Microseconds(200), summaryStats));
+
+    auto entry = assertGet(planCache.getEntry(*cq));
+    const auto& runtimeStats = entry->runtimeStats;
+    ASSERT_EQ(runtimeStats.numExecutions, 2);
+    ASSERT_EQ(runtimeStats.totalReturned, 4);
+    ASSERT_EQ(runtimeStats.totalDocsExamined, 20);
+    ASSERT_EQ(runtimeStats.totalKeysExamined, 8);
+    ASSERT_EQ(runtimeStats.numReplans, 1);
+
+    // The average latency moves towards the most recent sample.
+    ASSERT_GT(runtimeStats.averageLatencyMicros, 100.0);
+    ASSERT_LT(runtimeStats.averageLatencyMicros, 200.0);
+}
+
+TEST(PlanCacheTest, RuntimeStatsSurviveReplacementOfEntry) {
+    PlanCache planCache;
+    unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
+    auto qs = getQuerySolutionForCaching();
+    std::vector<QuerySolution*> solns = {qs.get()};
+    QueryTestServiceContext serviceContext;
+
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U, 10U), Date_t{}));
+    PlanSummaryStats summaryStats;
+    summaryStats.nReturned = 1;
+    ASSERT_OK(planCache.recordExecution(*cq, Microseconds(50), summaryStats));
+
+    // Replace the inactive entry with an active one which took fewer works.
+    ASSERT_OK(planCache.set(*cq, solns, createDecision(1U, 5U), Date_t{}));
+    ASSERT_EQ(planCache.get(*cq).state, PlanCache::CacheEntryState::kPresentActive);
+
+    auto entry = assertGet(planCache.getEntry(*cq));
+    ASSERT_EQ(entry->works, 5U);
+    ASSERT_EQ(entry->runtimeStats.numExecutions, 1);
+    ASSERT_EQ(entry->runtimeStats.totalReturned, 1);
+}
+
 TEST(PlanCacheTest, PlanCacheRemoveDeletesInactiveEntries) {
     PlanCache planCache;
     unique_ptr<CanonicalQuery> cq(canonicalize("{a: 1}"));
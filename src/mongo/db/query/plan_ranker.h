@@ -71,7 +71,7 @@ public:
  */
 struct CandidatePlan {
     CandidatePlan(std::unique_ptr<QuerySolution> solution, PlanStage* r, WorkingSet* w)
-        : solution(std::move(solution)), root(r), ws(w), failed(false) {}
+        : solution(std::move(solution)), root(r), ws(w), failed(false), abandoned(false) {}
 
     std::unique_ptr<QuerySolution> solution;
     PlanStage* root;  // Not owned here.
@@ -81,6 +81,10 @@ struct CandidatePlan {
     std::queue<WorkingSetID> results;
 
     bool failed;
+
+    // Set if the plan fell so far behind the leading plan that it was no longer worked during the
+    // trial period. It is still ranked based on the work it did.
+    bool abandoned;
 };
 
 /**
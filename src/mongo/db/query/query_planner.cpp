@@ -33,6 +33,7 @@
 
 #include "mongo/db/query/query_planner.h"
 
+#include <algorithm>
 #include <boost/optional.hpp>
 #include <vector>
 
@@ -527,6 +528,143 @@ StatusWith<std::unique_ptr<QuerySolution>> QueryPlanner::planFromCache(
     return {std::move(soln)};
 }
 
+/**
+ * Returns true if 'oil' places no constraint on its field, in either direction.
+ */
+static bool isFullRange(const OrderedIntervalList& oil) {
+    if (oil.intervals.size() != 1) {
+        return false;
+    }
+    const auto& interval = oil.intervals[0];
+    return interval.isMinToMax() ||
+        (interval.start.type() == BSONType::MaxKey && interval.end.type() == BSONType::MinKey);
+}
+
+/**
+ * Estimates the fraction of the collection's documents whose keys fall within the bounds of the
+ * index scan 'ixn'. The keys scanned are those matching every field of the equality prefix of the
+ * bounds and the range on the field after it, so the selectivities of these fields are multiplied
+ * as if they were independent. Returns boost::none if one of them has no statistics.
+ */
+static boost::optional<double> estimateIndexScanFraction(const IndexScanNode* ixn,
+                                                         const CollectionStatistics& statistics) {
+    double fraction = 1.0;
+    BSONObjIterator keyPatternIt(ixn->index.keyPattern);
+    for (auto&& oil : ixn->bounds.fields) {
+        const BSONElement keyPatternElem = keyPatternIt.next();
+        if (isFullRange(oil)) {
+            break;
+        }
+        auto selectivity =
+            statistics.estimateSelectivity(keyPatternElem.fieldNameStringData(), oil);
+        if (!selectivity) {
+            return boost::none;
+        }
+        fraction *= *selectivity;
+
+        const bool isEquality = std::all_of(oil.intervals.begin(),
+                                            oil.intervals.end(),
+                                            [](const Interval& interval) {
+                                                return interval.isPoint();
+                                            });
+        if (!isEquality) {
+            break;
+        }
+    }
+    return fraction;
+}
+
+/**
+ * Estimates the number of index keys and documents scanned by the data access portion of the
+ * plan rooted at 'node', as a fraction of the number of documents in the collection. Returns
+ * boost::none if the statistics cannot describe some part of the plan.
+ */
+static boost::optional<double> estimateScannedFraction(const QuerySolutionNode* node,
+                                                       const CollectionStatistics& statistics) {
+    switch (node->getType()) {
+        case STAGE_COLLSCAN:
+            return 1.0;
+        case STAGE_IXSCAN: {
+            const auto* ixn = static_cast<const IndexScanNode*>(node);
+            // Collation-aware bounds hold comparison keys rather than the sampled values.
+            if (ixn->index.type != INDEX_BTREE || ixn->index.collator ||
+                ixn->bounds.isSimpleRange || ixn->bounds.fields.empty()) {
+                return boost::none;
+            }
+            return estimateIndexScanFraction(ixn, statistics);
+        }
+        case STAGE_AND_HASH:
+        case STAGE_AND_SORTED:
+        case STAGE_OR:
+        case STAGE_SORT_MERGE: {
+            // Every child of an intersection or union is scanned in full.
+            double total = 0;
+            for (auto&& child : node->children) {
+                auto childEstimate = estimateScannedFraction(child, statistics);
+                if (!childEstimate) {
+                    return boost::none;
+                }
+                total += *childEstimate;
+            }
+            return total;
+        }
+        default:
+            if (node->children.size() != 1) {
+                return boost::none;
+            }
+            return estimateScannedFraction(node->children[0], statistics);
+    }
+}
+
+/**
+ * Discards the solutions in 'out' whose estimated scan size exceeds that of the cheapest solution
+ * by more than 'internalQueryPlannerStatisticsPruningRatio'. Solutions which cannot be estimated
+ * are always kept.
+ */
+static void pruneSolutionsUsingStatistics(const CanonicalQuery& query,
+                                          const CollectionStatistics& statistics,
+                                          std::vector<std::unique_ptr<QuerySolution>>* out) {
+    const double pruningRatio = internalQueryPlannerStatisticsPruningRatio.load();
+    if (pruningRatio <= 0 || statistics.getSampleSize() <= 0) {
+        return;
+    }
+
+    // A plan which scans many keys can still be the fastest when it provides the sort order or
+    // when a limit lets it stop early, so only plain filters are considered.
+    const auto& qr = query.getQueryRequest();
+    if (!qr.getSort().isEmpty() || qr.getLimit() || qr.getNToReturn() || qr.getSkip()) {
+        return;
+    }
+
+    std::vector<boost::optional<double>> estimates;
+    boost::optional<double> cheapest;
+    for (auto&& soln : *out) {
+        estimates.push_back(estimateScannedFraction(soln->root.get(), statistics));
+        if (estimates.back() && (!cheapest || *estimates.back() < *cheapest)) {
+            cheapest = estimates.back();
+        }
+    }
+    if (!cheapest) {
+        return;
+    }
+
+    // Each sampled document stands for many documents, so estimates which differ by only a few
+    // sampled documents are indistinguishable.
+    const double threshold = pruningRatio * *cheapest + 2.0 / statistics.getSampleSize();
+
+    std::vector<std::unique_ptr<QuerySolution>> kept;
+    for (size_t i = 0; i < out->size(); ++i) {
+        if (estimates[i] && *estimates[i] > threshold) {
+            LOG(5) << "Planner: pruning solution with estimated scan fraction " << *estimates[i]
+                   << ", cheapest is " << *cheapest << ":" << endl
+                   << redact((*out)[i]->toString());
+            continue;
+        }
+        kept.push_back(std::move((*out)[i]));
+    }
+    *out = std::move(kept);
+}
+
 // static
 StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
     const CanonicalQuery& query, const QueryPlannerParams& params) {
@@ -1017,6 +1155,10 @@ StatusWith<std::vector<std::unique_ptr<QuerySolution>>> QueryPlanner::plan(
         }
     }
 
+    if (params.statistics && out.size() > 1) {
+        pruneSolutionsUsingStatistics(query, *params.statistics, &out);
+    }
+
     return {std::move(out)};
 }
 
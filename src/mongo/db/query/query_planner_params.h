@@ -29,9 +29,11 @@
 
 #pragma once
 
+#include <memory>
 #include <vector>
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/query/collection_statistics.h"
 #include "mongo/db/query/index_entry.h"
 #include "mongo/db/query/query_knobs_gen.h"
 
@@ -117,6 +119,11 @@ struct QueryPlannerParams {
     // plans via the MultiPlanStage, and the set of possible plans is very large for certain
     // index+query combinations.
     size_t maxIndexedSolutions;
+
+    // Cardinality statistics for the collection, if it has been analyzed. Used to discard
+    // candidate plans which are clearly more expensive than others before the MultiPlanStage
+    // trial period.
+    std::shared_ptr<const CollectionStatistics> statistics;
 };
 
 }  // namespace mongo
@@ -37,8 +37,10 @@
 #include "mongo/db/json.h"
 #include "mongo/db/matcher/expression_always_boolean.h"
 #include "mongo/db/query/collation/collator_interface_mock.h"
+#include "mongo/db/query/collection_statistics.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/query/query_planner_test_fixture.h"
+#include "mongo/util/scopeguard.h"
 
 namespace {
 
@@ -5784,4 +5786,105 @@ TEST_F(QueryPlannerTest, EmptyQueryWithProjectionUsesCollscanIfIndexCollationDif
         "{proj: {spec: {_id: 0, a: 1}, node: "
         "{cscan: {dir: 1}}}}");
 }
+/**
+ * Returns statistics for a collection of 1000 documents in which 'a' is unique and 'b' takes only
+ * the values 0 and 1.
+ */
+std::shared_ptr<const CollectionStatistics> makeSelectiveAStatistics() {
+    std::vector<BSONObj> sample;
+    for (int i = 0; i < 1000; ++i) {
+        sample.push_back(BSON("a" << i << "b" << i % 2));
+    }
+    return std::make_shared<const CollectionStatistics>(
+        CollectionStatistics::make(sample, 1000, {"a", "b"}, 64, Date_t()));
+}
+
+TEST_F(QueryPlannerTest, StatisticsPruneUnselectiveIndexes) {
+    params.statistics = makeSelectiveAStatistics();
+    addIndex(BSON("a" << 1));
+    addIndex(BSON("b" << 1));
+
+    // Both the index on 'b' and the collection scan examine about half of the collection or more.
+    runQuery(fromjson("{a: 5, b: 1}"));
+    assertNumSolutions(1U);
+    assertSolutionExists("{fetch: {filter: {b: 1}, node: {ixscan: {pattern: {a: 1}}}}}");
+}
+
+TEST_F(QueryPlannerTest, StatisticsKeepComparableIndexes) {
+    params.statistics = makeSelectiveAStatistics();
+    addIndex(BSON("a" << 1));
+    addIndex(BSON("b" << 1));
+
+    // Both predicates match about half of the collection.
+    runQuery(fromjson("{a: {$gte: 500}, b: 1}"));
+    assertNumSolutions(3U);
+    assertSolutionExists("{fetch: {filter: {b: 1}, node: {ixscan: {pattern: {a: 1}}}}}");
+    assertSolutionExists("{fetch: {filter: {a: {$gte: 500}}, node: {ixscan: {pattern: {b: 1}}}}}");
+    assertSolutionExists("{cscan: {dir: 1}}");
+}
+
+TEST_F(QueryPlannerTest, StatisticsDoNotPruneWhenSortIsRequested) {
+    params.statistics = makeSelectiveAStatistics();
+    addIndex(BSON("a" << 1));
+    addIndex(BSON("b" << 1));
+
+    // The index on 'b' provides the sort, so it may be the better plan despite scanning more.
+    runQuerySortProj(fromjson("{a: 5, b: 1}"), BSON("b" << 1), BSONObj());
+    assertNumSolutions(3U);
+}
+
+TEST_F(QueryPlannerTest, StatisticsDoNotPruneIndexesWithoutStatistics) {
+    params.statistics = makeSelectiveAStatistics();
+    addIndex(BSON("a" << 1));
+    addIndex(BSON("c" << 1));
+
+    // Only the collection scan is pruned.
+    runQuery(fromjson("{a: 5, c: 1}"));
+    assertNumSolutions(2U);
+    assertSolutionExists("{fetch: {filter: {c: 1}, node: {ixscan: {pattern: {a: 1}}}}}");
+    assertSolutionExists("{fetch: {filter: {a: 5}, node: {ixscan: {pattern: {c: 1}}}}}");
+}
+
+TEST_F(QueryPlannerTest, StatisticsEstimateCompoundIndexesFromEveryBoundedField) {
+    // 'a' takes only the values 0 and 1, while 'b' is unique.
+    std::vector<BSONObj> sample;
+    for (int i = 0; i < 1000; ++i) {
+        sample.push_back(BSON("a" << i % 2 << "b" << i));
+    }
+    params.statistics = std::make_shared<const CollectionStatistics>(
+        CollectionStatistics::make(sample, 1000, {"a", "b"}, 64, Date_t()));
+    addIndex(BSON("a" << 1 << "b" << 1));
+    addIndex(BSON("b" << 1));
+
+    // The compound index is as selective as the index on 'b', so only the collection scan is
+    // pruned.
+    runQuery(fromjson("{a: 1, b: 5}"));
+    assertNumSolutions(2U);
+    assertSolutionExists("{fetch: {node: {ixscan: {pattern: {a: 1, b: 1}}}}}");
+    assertSolutionExists("{fetch: {filter: {a: 1}, node: {ixscan: {pattern: {b: 1}}}}}");
+}
+
+TEST_F(QueryPlannerTest, StatisticsDoNotPruneCompoundIndexesWithoutStatisticsForBoundedFields) {
+    params.statistics = makeSelectiveAStatistics();
+    addIndex(BSON("b" << 1 << "c" << 1));
+    addIndex(BSON("a" << 1));
+
+    // The compound index cannot be estimated because 'c' has no statistics.
+    runQuery(fromjson("{a: 5, b: 1, c: 1}"));
+    assertNumSolutions(2U);
+    assertSolutionExists("{fetch: {filter: {a: 5}, node: {ixscan: {pattern: {b: 1, c: 1}}}}}");
+    assertSolutionExists("{fetch: {filter: {b: 1, c: 1}, node: {ixscan: {pattern: {a: 1}}}}}");
+}
+
+TEST_F(QueryPlannerTest, StatisticsPruningCanBeDisabled) {
+    internalQueryPlannerStatisticsPruningRatio.store(0);
+    ON_BLOCK_EXIT([] { internalQueryPlannerStatisticsPruningRatio.store(10.0); });
+
+    params.statistics = makeSelectiveAStatistics();
+    addIndex(BSON("a" << 1));
+    addIndex(BSON("b" << 1));
+
+    runQuery(fromjson("{a: 5, b: 1}"));
+    assertNumSolutions(3U);
+}
 }  // namespace
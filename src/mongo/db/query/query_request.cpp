@@ -103,6 +103,7 @@ const char kOptionsField[] = "options";
 const char kReadOnceField[] = "readOnce";
 const char kAllowSpeculativeMajorityReadField[] = "allowSpeculativeMajorityRead";
 const char kInternalReadAtClusterTimeField[] = "$_internalReadAtClusterTime";
+const char kAllowDiskUseField[] = "allowDiskUse";
 
 // Field names for sorting options.
 const char kNaturalSortField[] = "$natural";
@@ -387,6 +388,13 @@ StatusWith<unique_ptr<QueryRequest>> QueryRequest::parseFromFindCommand(unique_p
                 return status;
             }
             qr->_internalReadAtClusterTime = el.timestamp();
+        } else if (fieldName == kAllowDiskUseField) {
+            Status status = checkFieldType(el, Bool);
+            if (!status.isOK()) {
+                return status;
+            }
+
+            qr->_allowDiskUse = el.boolean();
         } else if (!isGenericArgument(fieldName)) {
             return Status(ErrorCodes::FailedToParse,
                           str::stream() << "Failed to parse: " << cmdObj.toString() << ". "
@@ -556,6 +564,10 @@ void QueryRequest::asFindCommandInternal(BSONObjBuilder* cmdBuilder) const {
         cmdBuilder->append(kAllowSpeculativeMajorityReadField, true);
     }
 
+    if (_allowDiskUse) {
+        cmdBuilder->append(kAllowDiskUseField, true);
+    }
+
     if (_internalReadAtClusterTime) {
         cmdBuilder->append(kInternalReadAtClusterTimeField, *_internalReadAtClusterTime);
     }
@@ -1116,6 +1128,9 @@ StatusWith<BSONObj> QueryRequest::asAggregationCommand() const {
     if (!_unwrappedReadPref.isEmpty()) {
         aggregationBuilder.append(QueryRequest::kUnwrappedReadPrefField, _unwrappedReadPref);
     }
+    if (_allowDiskUse) {
+        aggregationBuilder.append(kAllowDiskUseField, true);
+    }
     return StatusWith<BSONObj>(aggregationBuilder.obj());
 }
 }  // namespace mongo
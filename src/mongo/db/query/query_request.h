@@ -381,6 +381,14 @@ public:
         return _readOnce;
     }
 
+    bool allowDiskUse() const {
+        return _allowDiskUse;
+    }
+
+    void setAllowDiskUse(bool allowDiskUse) {
+        _allowDiskUse = allowDiskUse;
+    }
+
     void setReadOnce(bool readOnce) {
         _readOnce = readOnce;
     }
@@ -523,6 +531,7 @@ private:
     bool _allowPartialResults = false;
     bool _readOnce = false;
     bool _allowSpeculativeMajorityRead = false;
+    bool _allowDiskUse = false;
 
     boost::optional<long long> _replicationTerm;
 
@@ -403,7 +403,8 @@ TEST(QueryRequestTest, ParseFromCommandAllFlagsTrue) {
         "awaitData: true,"
         "allowPartialResults: true,"
         "readOnce: true,"
-        "allowSpeculativeMajorityRead: true}");
+        "allowSpeculativeMajorityRead: true,"
+        "allowDiskUse: true}");
     const NamespaceString nss("test.testns");
     bool isExplain = false;
     unique_ptr<QueryRequest> qr(
@@ -418,6 +419,7 @@ TEST(QueryRequestTest, ParseFromCommandAllFlagsTrue) {
     ASSERT(qr->isAllowPartialResults());
     ASSERT(qr->isReadOnce());
     ASSERT(qr->allowSpeculativeMajorityRead());
+    ASSERT(qr->allowDiskUse());
 }
 
 TEST(QueryRequestTest, ParseFromCommandReadOnceDefaultsToFalse) {
@@ -429,6 +431,15 @@ TEST(QueryRequestTest, ParseFromCommandReadOnceDefaultsToFalse) {
     ASSERT(!qr->isReadOnce());
 }
 
+TEST(QueryRequestTest, ParseFromCommandAllowDiskUseDefaultsToFalse) {
+    BSONObj cmdObj = fromjson("{find: 'testns'}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    unique_ptr<QueryRequest> qr(
+        assertGet(QueryRequest::makeFromFindCommand(nss, cmdObj, isExplain)));
+    ASSERT(!qr->allowDiskUse());
+}
+
 TEST(QueryRequestTest, ParseFromCommandCommentWithValidMinMax) {
     BSONObj cmdObj = fromjson(
         "{find: 'testns',"
@@ -778,6 +789,16 @@ TEST(QueryRequestTest, ParseFromCommandCollationWrongType) {
     ASSERT_NOT_OK(result.getStatus());
 }
 
+TEST(QueryRequestTest, ParseFromCommandAllowDiskUseWrongType) {
+    BSONObj cmdObj = fromjson(
+        "{find: 'testns',"
+        "allowDiskUse: 1}");
+    const NamespaceString nss("test.testns");
+    bool isExplain = false;
+    auto result = QueryRequest::makeFromFindCommand(nss, cmdObj, isExplain);
+    ASSERT_EQ(ErrorCodes::FailedToParse, result.getStatus());
+}
+
 TEST(QueryRequestTest, ParseFromCommandReadOnceWrongType) {
     BSONObj cmdObj = fromjson(
         "{find: 'testns',"
@@ -1315,6 +1336,17 @@ TEST(QueryRequestTest, ConvertToAggregationWithCollationSucceeds) {
     ASSERT_BSONOBJ_EQ(ar.getValue().getCollation(), BSON("f" << 1));
 }
 
+TEST(QueryRequestTest, ConvertToAggregationWithAllowDiskUseSucceeds) {
+    QueryRequest qr(testns);
+    qr.setAllowDiskUse(true);
+    const auto aggCmd = qr.asAggregationCommand();
+    ASSERT_OK(aggCmd);
+
+    auto ar = AggregationRequest::parseFromBSON(testns, aggCmd.getValue());
+    ASSERT_OK(ar.getStatus());
+    ASSERT(ar.getValue().shouldAllowDiskUse());
+}
+
 TEST(QueryRequestTest, ConvertToAggregationWithReadOnceFails) {
     QueryRequest qr(testns);
     qr.setReadOnce(true);
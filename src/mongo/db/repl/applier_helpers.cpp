@@ -35,6 +35,8 @@
 
 #include <algorithm>
 #include <iterator>
+#include <utility>
+#include <vector>
 
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/ops/write_ops.h"
@@ -61,10 +63,35 @@ void ApplierHelpers::stableSortByNamespace(MultiApplier::OperationPtrs* oplogEnt
     if (oplogEntryPointers->size() < 1U) {
         return;
     }
-    auto nssComparator = [](const OplogEntry* l, const OplogEntry* r) {
-        return l->getNss() < r->getNss();
-    };
-    std::stable_sort(oplogEntryPointers->begin(), oplogEntryPointers->end(), nssComparator);
+    const bool hasCommands =
+        std::any_of(oplogEntryPointers->begin(),
+                    oplogEntryPointers->end(),
+                    [](const OplogEntry* entry) { return entry->isCommand(); });
+    if (!hasCommands) {
+        auto nssComparator = [](const OplogEntry* l, const OplogEntry* r) {
+            return l->getNss() < r->getNss();
+        };
+        std::stable_sort(oplogEntryPointers->begin(), oplogEntryPointers->end(), nssComparator);
+        return;
+    }
+
+    // A collection-scoped command is sorted with the operations on its collection rather than
+    // under '<db>.$cmd', so that it is still applied in oplog order with them.
+    std::vector<std::pair<NamespaceString, const OplogEntry*>> entriesByNss;
+    entriesByNss.reserve(oplogEntryPointers->size());
+    for (auto entry : *oplogEntryPointers) {
+        boost::optional<NamespaceString> commandNss;
+        if (entry->isCommand()) {
+            commandNss = entry->getCollectionScopedCommandNss();
+        }
+        entriesByNss.emplace_back(commandNss ? *commandNss : entry->getNss(), entry);
+    }
+    std::stable_sort(entriesByNss.begin(),
+                     entriesByNss.end(),
+                     [](const auto& l, const auto& r) { return l.first < r.first; });
+    for (std::size_t i = 0; i < entriesByNss.size(); ++i) {
+        (*oplogEntryPointers)[i] = entriesByNss[i].second;
+    }
 }
 
 using InsertGroup = ApplierHelpers::InsertGroup;
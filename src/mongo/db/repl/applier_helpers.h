@@ -47,7 +47,8 @@ public:
 
     /**
      * Sorts the oplog entries by namespace, so that entries from the same namespace will be next to
-     * each other in the list.
+     * each other in the list. Collection-scoped commands are sorted by the namespace of the
+     * collection they apply to.
      */
     static void stableSortByNamespace(OperationPtrs* oplogEntryPointers);
 
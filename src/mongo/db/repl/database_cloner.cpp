@@ -82,6 +82,21 @@ MONGO_EXPORT_STARTUP_SERVER_PARAMETER(collectionClonerBatchSize, int, 0)
 // The number of attempts for the listCollections commands.
 MONGO_EXPORT_SERVER_PARAMETER(numInitialSyncListCollectionsAttempts, int, 3);
 
+// The maximum number of collections of a database which are cloned at the same time. Each
+// collection cloner reads its collection over its own connection and loads it on the db worker
+// thread pool.
+MONGO_EXPORT_SERVER_PARAMETER(initialSyncMaxConcurrentCollectionClones, int, 1)
+    ->withValidator([](const int& maxClones) {
+        return (maxClones >= 1)
+            ? Status::OK()
+            : Status(ErrorCodes::Error(51102),
+                     str::stream()
+                         << "initialSyncMaxConcurrentCollectionClones must be greater than or "
+                            "equal to 1. '"
+                         << maxClones
+                         << "' is an invalid setting.");
+    });
+
 // Failpoint which causes initial sync to hang right after listCollections, but before cloning
 // any colelctions in the 'database' database.
 MONGO_FAIL_POINT_DEFINE(initialSyncHangAfterListCollections);
@@ -144,7 +159,9 @@ DatabaseCloner::DatabaseCloner(executor::TaskExecutor* executor,
                                   numInitialSyncListCollectionsAttempts.load(),
                                   executor::RemoteCommandRequest::kNoTimeout,
                                   RemoteCommandRetryScheduler::kAllRetriableErrors)),
-      _startCollectionCloner([](CollectionCloner& cloner) { return cloner.startup(); }) {
+      _startCollectionCloner([](CollectionCloner& cloner) { return cloner.startup(); }),
+      _maxConcurrentCollectionClones(
+          static_cast<size_t>(initialSyncMaxConcurrentCollectionClones.load())) {
     // Fetcher throws an exception on null executor.
     invariant(executor);
     uassert(ErrorCodes::BadValue, "db worker thread pool cannot be null", dbWorkThreadPool);
@@ -269,6 +286,11 @@ void DatabaseCloner::setStartCollectionClonerFn(
     _startCollectionCloner = startCollectionCloner;
 }
 
+void DatabaseCloner::setMaxConcurrentCollectionClones_forTest(size_t maxClones) {
+    invariant(maxClones >= 1);
+    _maxConcurrentCollectionClones = maxClones;
+}
+
 DatabaseCloner::State DatabaseCloner::getState_forTest() const {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
     return _state;
@@ -422,18 +444,44 @@ void DatabaseCloner::_listCollectionsCallback(const StatusWith<Fetcher::QueryRes
         }
     }
 
-    // Start first collection cloner.
-    _currentCollectionClonerIter = _collectionCloners.begin();
+    // Start as many collection cloners as we are allowed to run at the same time.
+    _nextCollectionClonerIter = _collectionCloners.begin();
+    _startCollectionCloners_inlock();
+    if (_activeCollectionCloners == 0) {
+        _finishCallback_inlock(lk, _collectionClonersStatus);
+    }
+}
 
-    LOG(1) << "    cloning collection " << _currentCollectionClonerIter->getSourceNamespace();
+void DatabaseCloner::_startCollectionCloners_inlock() {
+    while (_collectionClonersStatus.isOK() &&
+           _nextCollectionClonerIter != _collectionCloners.end() &&
+           _activeCollectionCloners < _maxConcurrentCollectionClones) {
+        auto& collectionCloner = *_nextCollectionClonerIter;
+        LOG(1) << "    cloning collection " << collectionCloner.getSourceNamespace();
 
-    Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-    if (!startStatus.isOK()) {
-        LOG(1) << "    failed to start collection cloning on "
-               << _currentCollectionClonerIter->getSourceNamespace() << ": " << redact(startStatus);
-        _finishCallback_inlock(lk, startStatus);
+        Status startStatus = _startCollectionCloner(collectionCloner);
+        if (!startStatus.isOK()) {
+            LOG(1) << "    failed to start collection cloning on "
+                   << collectionCloner.getSourceNamespace() << ": " << redact(startStatus);
+            _failCollectionCloners_inlock(startStatus);
+            return;
+        }
+        ++_activeCollectionCloners;
+        ++_nextCollectionClonerIter;
+    }
+}
+
+void DatabaseCloner::_failCollectionCloners_inlock(const Status& status) {
+    if (!_collectionClonersStatus.isOK()) {
         return;
     }
+    _collectionClonersStatus = status;
+
+    // Stop the collection cloners which are still running. The database cloner completes once all
+    // of them have reported back.
+    for (auto it = _collectionCloners.begin(); it != _nextCollectionClonerIter; ++it) {
+        it->shutdown();
+    }
 }
 
 void DatabaseCloner::_collectionClonerCallback(const Status& status, const NamespaceString& nss) {
@@ -451,30 +499,23 @@ void DatabaseCloner::_collectionClonerCallback(const Status& status, const Names
     _collectionWork(collStatus, nss);
     lk.lock();
 
+    invariant(_activeCollectionCloners > 0);
+    --_activeCollectionCloners;
+
     // Failure to clone a collection will stop the database cloner from
     // cloning the rest of the collections in the listCollections result.
     if (!collStatus.isOK()) {
-        Status failStatus = {ErrorCodes::InitialSyncFailure, collStatus.toString()};
-        _finishCallback_inlock(lk, failStatus);
-        return;
+        _failCollectionCloners_inlock({ErrorCodes::InitialSyncFailure, collStatus.toString()});
+    } else {
+        ++_stats.clonedCollections;
+        _startCollectionCloners_inlock();
     }
 
-    ++_stats.clonedCollections;
-    _currentCollectionClonerIter++;
-
-    if (_currentCollectionClonerIter != _collectionCloners.end()) {
-        Status startStatus = _startCollectionCloner(*_currentCollectionClonerIter);
-        if (!startStatus.isOK()) {
-            LOG(1) << "    failed to start collection cloning on "
-                   << _currentCollectionClonerIter->getSourceNamespace() << ": "
-                   << redact(startStatus);
-            _finishCallback_inlock(lk, startStatus);
-            return;
-        }
+    if (_activeCollectionCloners > 0) {
         return;
     }
 
-    _finishCallback_inlock(lk, Status::OK());
+    _finishCallback_inlock(lk, _collectionClonersStatus);
 }
 
 void DatabaseCloner::_finishCallback(const Status& status) {
@@ -157,6 +157,14 @@ public:
      */
     void setStartCollectionClonerFn(const StartCollectionClonerFn& startCollectionCloner);
 
+    /**
+     * Overrides the maximum number of collections cloned at the same time, which otherwise comes
+     * from the 'initialSyncMaxConcurrentCollectionClones' server parameter.
+     *
+     * For testing only.
+     */
+    void setMaxConcurrentCollectionClones_forTest(size_t maxClones);
+
     // State transitions:
     // PreStart --> Running --> ShuttingDown --> Complete
     // It is possible to skip intermediate states. For example,
@@ -192,6 +200,18 @@ private:
      */
     void _collectionClonerCallback(const Status& status, const NamespaceString& nss);
 
+    /**
+     * Starts collection cloners, in listCollections order, until the maximum number of concurrent
+     * collection clones is reached or there are no collections left to clone.
+     */
+    void _startCollectionCloners_inlock();
+
+    /**
+     * Records 'status' as the result of cloning the database, unless a failure has already been
+     * recorded, and shuts down the collection cloners which have been started.
+     */
+    void _failCollectionCloners_inlock(const Status& status);
+
     /**
      * Reports completion status.
      * Sets cloner to inactive.
@@ -234,11 +254,14 @@ private:
     // Holds all collection infos from listCollections.
     std::vector<BSONObj> _collectionInfos;                               // (M)
     std::vector<NamespaceString> _collectionNamespaces;                  // (M)
-    std::list<CollectionCloner> _collectionCloners;                      // (M)
-    std::list<CollectionCloner>::iterator _currentCollectionClonerIter;  // (M)
+    std::list<CollectionCloner> _collectionCloners;                   // (M)
+    std::list<CollectionCloner>::iterator _nextCollectionClonerIter;  // (M)
+    size_t _activeCollectionCloners = 0;  // (M) Started cloners which have not reported back yet.
+    Status _collectionClonersStatus = Status::OK();  // (M) First collection cloning failure.
     ScheduleDbWorkFn
         _scheduleDbWorkFn;  // (RT) Function for scheduling database work using the executor.
     StartCollectionClonerFn _startCollectionCloner;  // (RT)
+    size_t _maxConcurrentCollectionClones;           // (RT)
     Stats _stats;                                    // (M) Stats about what this instance did.
 
     // Current database cloner state. See comments for State enum class for details.
@@ -31,6 +31,7 @@
 
 #include <list>
 #include <memory>
+#include <set>
 #include <utility>
 
 #include "mongo/db/catalog/collection_options.h"
@@ -789,6 +790,62 @@ TEST_F(DatabaseClonerTest, ShutdownCancelsCollectionCloning) {
     ASSERT_EQUALS(ErrorCodes::InitialSyncFailure, getStatus());
 }
 
+TEST_F(DatabaseClonerTest, ClonesCollectionsConcurrentlyUpToLimit) {
+    _databaseCloner->setMaxConcurrentCollectionClones_forTest(2);
+    ASSERT_OK(_databaseCloner->startup());
+
+    auto net = getNet();
+    {
+        executor::NetworkInterfaceMock::InNetworkGuard guard(net);
+
+        assertRemoteCommandNameEquals(
+            "listCollections",
+            net->scheduleSuccessfulResponse(createListCollectionsResponse(
+                0,
+                BSON_ARRAY(BSON("name"
+                                << "a"
+                                << "options"
+                                << _options1.toBSON())
+                           << BSON("name"
+                                   << "b"
+                                   << "options"
+                                   << _options2.toBSON())
+                           << BSON("name"
+                                   << "c"
+                                   << "options"
+                                   << _options3.toBSON())))));
+        net->runReadyNetworkOperations();
+
+        // The first two collection cloners are started without waiting for each other, so both
+        // of their count requests are outstanding. Blackhole them to leave the cloners active.
+        std::set<UUID> countedCollections;
+        for (int i = 0; i < 2; ++i) {
+            ASSERT_TRUE(net->hasReadyRequests());
+            auto noi = net->getNextReadyRequest();
+            assertRemoteCommandNameEquals("count", noi->getRequest());
+            countedCollections.insert(
+                unittest::assertGet(UUID::parse(noi->getRequest().cmdObj.firstElement())));
+            net->blackHole(noi);
+        }
+        ASSERT_EQUALS(1U, countedCollections.count(*_options1.uuid));
+        ASSERT_EQUALS(1U, countedCollections.count(*_options2.uuid));
+
+        // The third collection cloner waits for one of the others to finish.
+        ASSERT_FALSE(net->hasReadyRequests());
+    }
+
+    _databaseCloner->shutdown();
+    executor::NetworkInterfaceMock::InNetworkGuard(net)->runReadyNetworkOperations();
+
+    _databaseCloner->join();
+    ASSERT_FALSE(_databaseCloner->isActive());
+    ASSERT_EQUALS(ErrorCodes::InitialSyncFailure, getStatus());
+
+    // Only the collections whose cloners were started are reported.
+    ASSERT_EQUALS(2U, _collections.size());
+    ASSERT_EQUALS(0U, _collections.count(NamespaceString(dbname, "c")));
+}
+
 TEST_F(DatabaseClonerTest, FirstCollectionListIndexesFailed) {
     ASSERT_EQUALS(DatabaseCloner::State::kPreStart, _databaseCloner->getState_forTest());
 
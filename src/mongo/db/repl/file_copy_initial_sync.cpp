@@ -0,0 +1,345 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kReplicationInitialSync
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/repl/file_copy_initial_sync.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <map>
+
+#include "mongo/client/dbclient_connection.h"
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/db/repl/oplogreader.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/db/storage/storage_file_util.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+#include "mongo/util/net/hostandport.h"
+#include "mongo/util/scopeguard.h"
+
+namespace mongo {
+namespace repl {
+
+namespace {
+
+// The host and port of the node whose data files are copied into an empty data directory on
+// startup. Logical initial sync is used when this is empty.
+MONGO_EXPORT_STARTUP_SERVER_PARAMETER(initialSyncFileCopySource, std::string, "");
+
+// The directory within the data directory the files are copied into before being moved into place.
+const char kStagingDirectoryName[] = "_fileCopyInitialSync";
+
+// The WiredTiger metadata file, which is moved into place last, so that an interrupted copy leaves
+// a data directory which still counts as empty.
+const char kWiredTigerFileName[] = "WiredTiger";
+
+/**
+ * Writes the chunks of files returned by a $backupCursor below a destination directory.
+ */
+class BackupFileWriter {
+public:
+    explicit BackupFileWriter(boost::filesystem::path destination)
+        : _destination(std::move(destination)) {}
+
+    void writeDocument(const BSONObj& doc) {
+        if (_metadata.isEmpty()) {
+            uassert(ErrorCodes::FailedToParse,
+                    str::stream() << "Expected backup cursor metadata, but found: " << doc,
+                    doc["metadata"].type() == BSONType::Object);
+            _metadata = doc["metadata"].Obj().getOwned();
+            _sourceDbpath = _metadata["dbpath"].str();
+            uassert(ErrorCodes::FailedToParse,
+                    str::stream() << "Backup cursor metadata is missing 'dbpath': " << _metadata,
+                    !_sourceDbpath.empty());
+            return;
+        }
+        _writeChunk(doc);
+    }
+
+    /**
+     * Returns the backup's metadata after verifying that the last file was completely copied, and
+     * flushing the directories holding the copied files.
+     */
+    BSONObj finish() {
+        uassert(ErrorCodes::OperationFailed,
+                "Backup cursor returned no metadata",
+                !_metadata.isEmpty());
+        uassert(ErrorCodes::OperationFailed,
+                str::stream() << "Backup cursor ended before the end of " << _filename,
+                !_file.is_open());
+        for (auto&& directoryEntry : _directoryEntries) {
+            uassertStatusOK(fsyncParentDirectory(directoryEntry.second));
+        }
+        log() << "Copied " << _filesCopied << " data files (" << _bytesCopied << " bytes) from "
+              << _sourceDbpath;
+        return _metadata;
+    }
+
+private:
+    void _writeChunk(const BSONObj& chunk) {
+        const auto filename = chunk["filename"].str();
+        const auto byteOffset = chunk["byteOffset"].safeNumberLong();
+        const auto dataElem = chunk["data"];
+        uassert(ErrorCodes::FailedToParse,
+                str::stream() << "Invalid backup file chunk: " << chunk.removeField("data"),
+                !filename.empty() && dataElem.type() == BSONType::BinData &&
+                    chunk["endOfFile"].isBoolean());
+
+        if (byteOffset == 0 && !_file.is_open()) {
+            _openFile(filename);
+        }
+        uassert(ErrorCodes::OperationFailed,
+                str::stream() << "Unexpected chunk of " << filename << " at offset " << byteOffset
+                              << " while copying "
+                              << _filename
+                              << " at offset "
+                              << _bytesWrittenToFile,
+                _file.is_open() && filename == _filename && byteOffset == _bytesWrittenToFile);
+
+        int length = 0;
+        const char* data = dataElem.binData(length);
+        _file.write(data, length);
+        uassert(ErrorCodes::OperationFailed,
+                str::stream() << "Failed to write " << _filePath.string(),
+                _file.good());
+        _bytesWrittenToFile += length;
+        _bytesCopied += length;
+
+        if (chunk["endOfFile"].boolean()) {
+            _file.close();
+            uassert(ErrorCodes::OperationFailed,
+                    str::stream() << "Failed to write " << _filePath.string(),
+                    !_file.fail());
+            uassertStatusOK(fsyncFile(_filePath));
+            ++_filesCopied;
+        }
+    }
+
+    void _openFile(const std::string& filename) {
+        // Place the file at the same path relative to the destination as it has relative to the
+        // source's data directory.
+        const auto prefix = _sourceDbpath.back() == '/' ? _sourceDbpath : _sourceDbpath + '/';
+        uassert(ErrorCodes::OperationFailed,
+                str::stream() << "Backup file " << filename << " is not within " << _sourceDbpath,
+                StringData(filename).startsWith(prefix) && filename.size() > prefix.size());
+        const boost::filesystem::path relativePath(filename.substr(prefix.size()));
+        for (auto&& component : relativePath) {
+            uassert(ErrorCodes::OperationFailed,
+                    str::stream() << "Invalid backup file path " << filename,
+                    component != ".." && component != ".");
+        }
+
+        _filename = filename;
+        _filePath = _destination / relativePath;
+        boost::filesystem::create_directories(_filePath.parent_path());
+        for (auto path = _filePath; path != _destination && path.has_parent_path();
+             path = path.parent_path()) {
+            _directoryEntries.emplace(path.parent_path(), path);
+        }
+        _file.open(_filePath.string(), std::ios::out | std::ios::binary | std::ios::trunc);
+        uassert(ErrorCodes::OperationFailed,
+                str::stream() << "Failed to open " << _filePath.string(),
+                _file.is_open());
+        _bytesWrittenToFile = 0;
+    }
+
+    const boost::filesystem::path _destination;
+
+    BSONObj _metadata;
+    std::string _sourceDbpath;
+
+    // The file currently being written.
+    std::string _filename;
+    boost::filesystem::path _filePath;
+    std::ofstream _file;
+    long long _bytesWrittenToFile = 0;
+
+    // An entry of each directory which holds copied files or directories, by directory, so that
+    // each of them can be flushed once.
+    std::map<boost::filesystem::path, boost::filesystem::path> _directoryEntries;
+
+    size_t _filesCopied = 0;
+    long long _bytesCopied = 0;
+};
+
+/**
+ * Moves the contents of 'staging' into 'dbpath', replacing what is there, and moves the WiredTiger
+ * metadata file last. 'dbpath' is flushed before and after the WiredTiger metadata file is moved,
+ * so that it is never durably present next to files which are not.
+ */
+void moveIntoPlace(const boost::filesystem::path& staging, const boost::filesystem::path& dbpath) {
+    auto moveEntry = [&](const boost::filesystem::path& from) {
+        const auto to = dbpath / from.filename();
+        boost::filesystem::remove_all(to);
+        boost::filesystem::rename(from, to);
+        return to;
+    };
+
+    std::vector<boost::filesystem::path> entries;
+    for (boost::filesystem::directory_iterator it(staging), end; it != end; ++it) {
+        if (it->path().filename() != kWiredTigerFileName) {
+            entries.push_back(it->path());
+        }
+    }
+    for (auto&& entry : entries) {
+        moveEntry(entry);
+    }
+    // Flush 'dbpath', which is the parent of the staging directory.
+    uassertStatusOK(fsyncParentDirectory(staging));
+    uassertStatusOK(fsyncParentDirectory(moveEntry(staging / kWiredTigerFileName)));
+    boost::filesystem::remove_all(staging);
+}
+
+}  // namespace
+
+StatusWith<BSONObj> copyBackupFiles(DBClientBase* conn, const std::string& destination) {
+    try {
+        BackupFileWriter writer{boost::filesystem::path(destination)};
+
+        BSONObj reply;
+        conn->runCommand(
+            "admin",
+            BSON("aggregate" << 1 << "pipeline" << BSON_ARRAY(BSON("$backupCursor" << BSONObj()))
+                             << "cursor"
+                             << BSONObj()),
+            reply);
+        auto response = uassertStatusOK(CursorResponse::parseFromBSON(reply));
+        const auto nss = response.getNSS();
+
+        // Close the backup cursor on the source if we fail before exhausting it.
+        auto cursorId = response.getCursorId();
+        auto killCursorGuard = makeGuard([&] {
+            if (cursorId != 0) {
+                BSONObj killReply;
+                conn->runCommand(nss.db().toString(),
+                                 BSON("killCursors" << nss.coll() << "cursors"
+                                                    << BSON_ARRAY(cursorId)),
+                                 killReply);
+            }
+        });
+
+        for (auto&& doc : response.getBatch()) {
+            writer.writeDocument(doc);
+        }
+        while (cursorId != 0) {
+            conn->runCommand(nss.db().toString(),
+                             BSON("getMore" << cursorId << "collection" << nss.coll()),
+                             reply);
+            response = uassertStatusOK(CursorResponse::parseFromBSON(reply));
+            cursorId = response.getCursorId();
+            for (auto&& doc : response.getBatch()) {
+                writer.writeDocument(doc);
+            }
+        }
+
+        return writer.finish();
+    } catch (const DBException& ex) {
+        return ex.toStatus().withContext("Failed to copy backup files");
+    } catch (const boost::filesystem::filesystem_error& ex) {
+        return {ErrorCodes::OperationFailed,
+                str::stream() << "Failed to copy backup files: " << ex.what()};
+    }
+}
+
+Status copyDataFilesFromSyncSourceIfNeeded(const std::string& dbpath) {
+    if (initialSyncFileCopySource.empty()) {
+        return Status::OK();
+    }
+
+    const boost::filesystem::path dbpathDir(dbpath);
+    if (boost::filesystem::exists(dbpathDir / kWiredTigerFileName)) {
+        log() << "Not copying data files from " << initialSyncFileCopySource << " because "
+              << dbpath << " already holds data";
+        return Status::OK();
+    }
+    if (storageGlobalParams.engine != "wiredTiger") {
+        return {ErrorCodes::InvalidOptions,
+                str::stream() << "initialSyncFileCopySource requires the wiredTiger storage "
+                                 "engine, but the storage engine is "
+                              << storageGlobalParams.engine};
+    }
+
+    auto swSource = HostAndPort::parse(initialSyncFileCopySource);
+    if (!swSource.isOK()) {
+        return swSource.getStatus().withContext("Invalid initialSyncFileCopySource");
+    }
+
+    log() << "Copying data files from " << swSource.getValue() << " into " << dbpath;
+    DBClientConnection conn;
+    auto status = conn.connect(swSource.getValue(), "FileCopyInitialSync");
+    if (!status.isOK()) {
+        return status.withContext(str::stream() << "Failed to connect to "
+                                                << swSource.getValue());
+    }
+    if (!replAuthenticate(&conn)) {
+        return {ErrorCodes::AuthenticationFailed,
+                str::stream() << "Failed to authenticate to " << swSource.getValue()};
+    }
+
+    // Copy into a staging directory, so that files left over by an interrupted copy are discarded
+    // the next time around.
+    const auto staging = dbpathDir / kStagingDirectoryName;
+    try {
+        boost::filesystem::remove_all(staging);
+        boost::filesystem::create_directories(staging);
+    } catch (const boost::filesystem::filesystem_error& ex) {
+        return {ErrorCodes::OperationFailed,
+                str::stream() << "Failed to create " << staging.string() << ": " << ex.what()};
+    }
+
+    auto swMetadata = copyBackupFiles(&conn, staging.string());
+    if (!swMetadata.isOK()) {
+        return swMetadata.getStatus();
+    }
+
+    try {
+        moveIntoPlace(staging, dbpathDir);
+    } catch (const DBException& ex) {
+        return ex.toStatus().withContext(str::stream()
+                                         << "Failed to move the copied data files into "
+                                         << dbpath);
+    } catch (const boost::filesystem::filesystem_error& ex) {
+        return {ErrorCodes::OperationFailed,
+                str::stream() << "Failed to move the copied data files into " << dbpath << ": "
+                              << ex.what()};
+    }
+
+    log() << "Copied data files from " << swSource.getValue()
+          << ", backup metadata: " << swMetadata.getValue();
+    return Status::OK();
+}
+
+}  // namespace repl
+}  // namespace mongo
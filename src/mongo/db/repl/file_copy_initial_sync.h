@@ -0,0 +1,68 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <string>
+
+#include "mongo/base/status.h"
+#include "mongo/base/status_with.h"
+#include "mongo/bson/bsonobj.h"
+
+namespace mongo {
+
+class DBClientBase;
+
+namespace repl {
+
+/**
+ * Copies the files of a checkpoint of the node 'conn' is connected to into 'destination', using a
+ * $backupCursor on that node. The files are placed at the same paths relative to 'destination' as
+ * they have relative to the source's data directory.
+ *
+ * Returns the metadata of the backup, which holds the source's data directory and, when available,
+ * the timestamp of the copied checkpoint.
+ */
+StatusWith<BSONObj> copyBackupFiles(DBClientBase* conn, const std::string& destination);
+
+/**
+ * If the 'initialSyncFileCopySource' startup parameter names a node and 'dbpath' holds no data yet,
+ * fills 'dbpath' with a copy of that node's data files. This must run before the storage engine is
+ * started.
+ *
+ * The node then starts up from the copied checkpoint as it would after a clean restart of the
+ * source, replaying the copied oplog, and catches up with the rest of the replica set through
+ * regular oplog replication once it is a member of the set. This replaces the logical initial
+ * sync, which clones every document and rebuilds every index.
+ */
+Status copyDataFilesFromSyncSourceIfNeeded(const std::string& dbpath);
+
+}  // namespace repl
+}  // namespace mongo
@@ -0,0 +1,165 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iterator>
+
+#include "mongo/db/query/cursor_response.h"
+#include "mongo/db/repl/file_copy_initial_sync.h"
+#include "mongo/dbtests/mock/mock_dbclient_connection.h"
+#include "mongo/dbtests/mock/mock_remote_db_server.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace repl {
+namespace {
+
+const NamespaceString kBackupCursorNss("admin.$cmd.aggregate");
+const CursorId kCursorId = 123;
+
+BSONObj makeMetadata() {
+    return BSON("metadata" << BSON("backupId" << 1 << "dbpath"
+                                              << "/data/db"));
+}
+
+BSONObj makeChunk(StringData filename, long long byteOffset, StringData data, bool endOfFile) {
+    BSONObjBuilder builder;
+    builder.append("filename", filename);
+    builder.append("byteOffset", byteOffset);
+    builder.appendBinData("data", data.size(), BinDataGeneral, data.rawData());
+    builder.append("endOfFile", endOfFile);
+    return builder.obj();
+}
+
+BSONObj makeInitialResponse(CursorId cursorId, std::vector<BSONObj> batch) {
+    return CursorResponse(kBackupCursorNss, cursorId, std::move(batch))
+        .toBSON(CursorResponse::ResponseType::InitialResponse);
+}
+
+BSONObj makeSubsequentResponse(CursorId cursorId, std::vector<BSONObj> batch) {
+    return CursorResponse(kBackupCursorNss, cursorId, std::move(batch))
+        .toBSON(CursorResponse::ResponseType::SubsequentResponse);
+}
+
+std::string readFile(const boost::filesystem::path& path) {
+    std::ifstream file(path.string(), std::ios::in | std::ios::binary);
+    return {std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>()};
+}
+
+class FileCopyInitialSyncTest : public unittest::Test {
+protected:
+    FileCopyInitialSyncTest()
+        : _server("source:27017"), _conn(&_server), _destination("file_copy_initial_sync_test") {}
+
+    MockRemoteDBServer _server;
+    MockDBClientConnection _conn;
+    unittest::TempDir _destination;
+};
+
+TEST_F(FileCopyInitialSyncTest, CopiesFilesAcrossBatches) {
+    _server.setCommandReply(
+        "aggregate",
+        makeInitialResponse(kCursorId,
+                            {makeMetadata(),
+                             makeChunk("/data/db/WiredTiger", 0, "wt", true),
+                             makeChunk("/data/db/journal/log.1", 0, "ab", false)}));
+    _server.setCommandReply(
+        "getMore",
+        std::vector<BSONObj>{
+            makeSubsequentResponse(kCursorId, {makeChunk("/data/db/journal/log.1", 2, "cd", true)}),
+            makeSubsequentResponse(0, {makeChunk("/data/db/empty.wt", 0, "", true)})});
+
+    auto metadata = unittest::assertGet(copyBackupFiles(&_conn, _destination.path()));
+    ASSERT_BSONOBJ_EQ(makeMetadata()["metadata"].Obj(), metadata);
+
+    const boost::filesystem::path destination(_destination.path());
+    ASSERT_EQ("wt", readFile(destination / "WiredTiger"));
+    ASSERT_EQ("abcd", readFile(destination / "journal" / "log.1"));
+    ASSERT_TRUE(boost::filesystem::exists(destination / "empty.wt"));
+    ASSERT_EQ(0U, boost::filesystem::file_size(destination / "empty.wt"));
+}
+
+TEST_F(FileCopyInitialSyncTest, RejectsFilesOutsideTheSourceDbpath) {
+    _server.setCommandReply(
+        "aggregate",
+        makeInitialResponse(0, {makeMetadata(), makeChunk("/etc/passwd", 0, "x", true)}));
+    ASSERT_EQ(ErrorCodes::OperationFailed,
+              copyBackupFiles(&_conn, _destination.path()).getStatus());
+
+    _server.setCommandReply(
+        "aggregate",
+        makeInitialResponse(0, {makeMetadata(), makeChunk("/data/db/../x", 0, "x", true)}));
+    ASSERT_EQ(ErrorCodes::OperationFailed,
+              copyBackupFiles(&_conn, _destination.path()).getStatus());
+}
+
+TEST_F(FileCopyInitialSyncTest, RejectsMissingChunks) {
+    _server.setCommandReply("aggregate",
+                            makeInitialResponse(0,
+                                                {makeMetadata(),
+                                                 makeChunk("/data/db/a.wt", 0, "ab", false),
+                                                 makeChunk("/data/db/a.wt", 3, "d", true)}));
+    ASSERT_EQ(ErrorCodes::OperationFailed,
+              copyBackupFiles(&_conn, _destination.path()).getStatus());
+}
+
+TEST_F(FileCopyInitialSyncTest, RejectsTruncatedStream) {
+    _server.setCommandReply(
+        "aggregate",
+        makeInitialResponse(0, {makeMetadata(), makeChunk("/data/db/a.wt", 0, "ab", false)}));
+    ASSERT_EQ(ErrorCodes::OperationFailed,
+              copyBackupFiles(&_conn, _destination.path()).getStatus());
+}
+
+TEST_F(FileCopyInitialSyncTest, RequiresMetadataFirst) {
+    _server.setCommandReply(
+        "aggregate", makeInitialResponse(0, {makeChunk("/data/db/a.wt", 0, "ab", true)}));
+    ASSERT_EQ(ErrorCodes::FailedToParse,
+              copyBackupFiles(&_conn, _destination.path()).getStatus());
+}
+
+TEST_F(FileCopyInitialSyncTest, KillsCursorOnFailure) {
+    _server.setCommandReply(
+        "aggregate",
+        makeInitialResponse(kCursorId, {makeMetadata(), makeChunk("/etc/passwd", 0, "x", true)}));
+    _server.setCommandReply("killCursors", BSON("ok" << 1));
+    ASSERT_EQ(ErrorCodes::OperationFailed,
+              copyBackupFiles(&_conn, _destination.path()).getStatus());
+    // The aggregate and the killCursors commands.
+    ASSERT_EQ(2U, _server.getCmdCount());
+}
+
+}  // namespace
+}  // namespace repl
+}  // namespace mongo
@@ -175,11 +175,15 @@ StatusWith<OplogApplier::Operations> OplogApplier::getNextApplierBatch(
             return {ErrorCodes::BadValue, message};
         }
 
-        // Commands must be processed one at a time. The only exception to this is applyOps because
-        // applyOps oplog entries are effectively containers for CRUD operations. Therefore, it is
-        // safe to batch applyOps commands with CRUD operations when reading from the oplog buffer.
-        if (entry.isCommand() && (entry.getCommandType() != OplogEntry::CommandType::kApplyOps ||
-                                  entry.shouldPrepare())) {
+        // Commands must be processed one at a time. The exceptions to this are applyOps, because
+        // applyOps oplog entries are effectively containers for CRUD operations, and commands
+        // which only affect a single collection, because the writer vectors order them with the
+        // other operations on that collection. Therefore, it is safe to batch these commands with
+        // CRUD operations when reading from the oplog buffer.
+        if (entry.isCommand() &&
+            (entry.getCommandType() != OplogEntry::CommandType::kApplyOps ||
+             entry.shouldPrepare()) &&
+            !entry.getCollectionScopedCommandNss()) {
             if (ops.empty()) {
                 // Apply commands one-at-a-time.
                 ops.push_back(std::move(entry));
@@ -301,6 +301,39 @@ OplogEntry::CommandType OplogEntry::getCommandType() const {
     return _commandType;
 }
 
+boost::optional<NamespaceString> OplogEntry::getCollectionScopedCommandNss() const {
+    invariant(isCommand());
+
+    // Commands on the config database may change the transactions table, which is written in
+    // order with the rest of the batch.
+    const auto& nss = getNss();
+    if (nss.isConfigDB()) {
+        return boost::none;
+    }
+
+    switch (_commandType) {
+        case CommandType::kCreate:
+        case CommandType::kCollMod: {
+            // Creating or modifying a view writes to 'system.views', which must be applied alone.
+            const auto& obj = getObject();
+            if (obj.hasField("viewOn") || obj.hasField("pipeline")) {
+                return boost::none;
+            }
+            const auto collElem = obj.firstElement();
+            if (collElem.type() != BSONType::String) {
+                return boost::none;
+            }
+            NamespaceString target(nss.db(), collElem.valueStringData());
+            if (!target.isValid() || target.isSystem()) {
+                return boost::none;
+            }
+            return target;
+        }
+        default:
+            return boost::none;
+    }
+}
+
 int OplogEntry::getRawObjSizeBytes() const {
     return raw.objsize();
 }
@@ -143,6 +143,13 @@ public:
      */
     CommandType getCommandType() const;
 
+    /**
+     * Returns the namespace of the collection changed by a command which only affects that one
+     * collection, such as 'create' or 'collMod', and so only conflicts with other operations on
+     * it. Returns boost::none for every other command. Must be called on a command op.
+     */
+    boost::optional<NamespaceString> getCollectionScopedCommandNss() const;
+
     /**
      * Returns the size of the original document used to create this OplogEntry.
      */
@@ -34,14 +34,20 @@
 
 #include "mongo/db/repl/rollback_impl.h"
 
+#include <algorithm>
+
+#include "mongo/bson/simple_bsonobj_comparator.h"
 #include "mongo/bson/util/bson_extract.h"
 #include "mongo/db/background.h"
+#include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/catalog/uuid_catalog.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/concurrency/replication_state_transition_lock_guard.h"
 #include "mongo/db/db_raii.h"
+#include "mongo/db/dbhelpers.h"
 #include "mongo/db/kill_sessions_local.h"
 #include "mongo/db/logical_time_validator.h"
 #include "mongo/db/operation_context.h"
@@ -135,6 +141,21 @@ boost::optional<long long> _parseDroppedCollectionCount(const OplogEntry& oplogE
     return count;
 }
 
+/**
+ * Returns the document of 'collection' with the _id in 'id', or boost::none if there is no such
+ * document. Looks the document up through the _id index, which 'collection' must have.
+ */
+boost::optional<BSONObj> findDocumentByIdIndex(OperationContext* opCtx,
+                                                Collection* collection,
+                                                const BSONObj& id) {
+    const auto recordId = Helpers::findById(opCtx, collection, id);
+    Snapshotted<BSONObj> document;
+    if (recordId.isNull() || !collection->findDoc(opCtx, recordId, &document)) {
+        return boost::none;
+    }
+    return document.value().getOwned();
+}
+
 }  // namespace
 
 constexpr const char* RollbackImpl::kRollbackRemoveSaverType;
@@ -926,24 +947,6 @@ Timestamp RollbackImpl::_findTruncateTimestamp(
     return truncatePointTime.getValue().getTimestamp();
 }
 
-boost::optional<BSONObj> RollbackImpl::_findDocumentById(OperationContext* opCtx,
-                                                         UUID uuid,
-                                                         NamespaceString nss,
-                                                         BSONElement id) {
-    auto document = _storageInterface->findById(opCtx, {nss.db().toString(), uuid}, id);
-    if (document.isOK()) {
-        return document.getValue();
-    } else if (document.getStatus().code() == ErrorCodes::NoSuchKey) {
-        return boost::none;
-    } else {
-        severe() << "Rollback failed to read document with " << redact(id) << " in namespace "
-                 << nss.ns() << " with uuid " << uuid.toString() << causedBy(document.getStatus());
-        fassert(50751, document.getStatus());
-    }
-
-    MONGO_UNREACHABLE;
-}
-
 Status RollbackImpl::_writeRollbackFiles(OperationContext* opCtx) {
     const auto& uuidCatalog = UUIDCatalog::get(opCtx);
     auto storageEngine = opCtx->getServiceContext()->getStorageEngine();
@@ -1013,13 +1016,37 @@ void RollbackImpl::_writeRollbackFileForNamespace(OperationContext* opCtx,
         _rollbackStats.rollbackDataFileDirectory = std::string(newDirectoryPath.begin(), prefixEnd);
     }
 
-    for (auto&& id : idSet) {
-        // StorageInterface::findById() does not respect the collation, but because we are using
-        // exact _id fields recorded in the oplog, we can get away with binary string
-        // comparisons.
-        auto document = _findDocumentById(opCtx, uuid, nss, id.firstElement());
-        if (document) {
-            fassert(50750, removeSaver.goingToDelete(*document));
+    // Look the documents up under a single collection lock rather than locking the collection and
+    // planning a query for each of them. Rolling back a busy primary's writes can touch millions
+    // of documents.
+    {
+        AutoGetCollection autoColl(opCtx, {nss.db().toString(), uuid}, MODE_IS);
+        auto collection = autoColl.getCollection();
+        invariant(collection,
+                  str::stream() << "The collection with UUID " << uuid
+                                << " is unexpectedly missing while writing its rollback file");
+
+        if (collection->getIndexCatalog()->findIdIndex(opCtx)) {
+            // Probe the _id index in _id order. This does not respect the collation, but because
+            // we are using exact _id fields recorded in the oplog, we can get away with binary
+            // string comparisons.
+            std::vector<BSONObj> ids(idSet.begin(), idSet.end());
+            std::sort(ids.begin(), ids.end(), SimpleBSONObjComparator::kInstance.makeLessThan());
+            for (auto&& id : ids) {
+                if (auto document = findDocumentByIdIndex(opCtx, collection, id)) {
+                    fassert(50750, removeSaver.goingToDelete(*document));
+                }
+            }
+        } else {
+            // Without an _id index, find all of the documents in one scan of the collection.
+            auto cursor = collection->getCursor(opCtx);
+            while (auto record = cursor->next()) {
+                auto document = record->data.releaseToBson();
+                auto idElem = document["_id"];
+                if (idElem && idSet.count(idElem.wrap())) {
+                    fassert(51115, removeSaver.goingToDelete(document));
+                }
+            }
         }
     }
     _listener->onRollbackFileWrittenForNamespace(std::move(uuid), std::move(nss));
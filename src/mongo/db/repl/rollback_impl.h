@@ -276,19 +276,6 @@ public:
     void docsDeletedForNamespace_forTest(UUID)&& = delete;
 
 protected:
-    /**
-     * Returns the document with _id 'id' in the namespace 'nss', or boost::none if that document
-     * no longer exists in 'nss'. This function is used to write documents to rollback data files,
-     * and this function will terminate the server if an unexpected error is returned by the storage
-     * interface.
-     *
-     * This function is protected so that subclasses can access this method for test purposes.
-     */
-    boost::optional<BSONObj> _findDocumentById(OperationContext* opCtx,
-                                               UUID uuid,
-                                               NamespaceString nss,
-                                               BSONElement id);
-
     /**
      * Writes a rollback file for the namespace 'nss' containing all of the documents whose _ids are
      * listed in 'idSet'.
@@ -30,7 +30,10 @@
 
 #include "mongo/platform/basic.h"
 
+#include <boost/filesystem/operations.hpp>
 #include <boost/optional.hpp>
+#include <fstream>
+#include <iterator>
 
 #include "mongo/db/catalog/collection_mock.h"
 #include "mongo/db/catalog/drop_collection.h"
@@ -46,6 +49,7 @@
 #include "mongo/db/s/type_shard_identity.h"
 #include "mongo/db/server_transactions_metrics.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/storage_options.h"
 #include "mongo/s/catalog/type_config_version.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/util/assert_util.h"
@@ -115,6 +119,17 @@ public:
         return iter->second;
     }
 
+    /**
+     * Runs RollbackImpl's own _writeRollbackFileForNamespace(), which writes the documents out to
+     * a rollback file, rather than the simulation below.
+     */
+    void writeRollbackFileForNamespace_forTest(OperationContext* opCtx,
+                                               UUID uuid,
+                                               NamespaceString nss,
+                                               const SimpleBSONObjUnorderedSet& idSet) {
+        RollbackImpl::_writeRollbackFileForNamespace(opCtx, uuid, nss, idSet);
+    }
+
 protected:
     /**
      * Saves documents that would be deleted in '_uuidToObjsMap', rather than writing them out to a
@@ -128,9 +143,10 @@ protected:
               << uuid;
         for (auto&& id : idSet) {
             log() << "Looking up " << id.jsonString();
-            auto document = _findDocumentById(opCtx, uuid, nss, id.firstElement());
-            if (document) {
-                _uuidToObjsMap[uuid].push_back(*document);
+            auto document = StorageInterface::get(opCtx)->findById(
+                opCtx, {nss.db().toString(), uuid}, id.firstElement());
+            if (document.getStatus() != ErrorCodes::NoSuchKey) {
+                _uuidToObjsMap[uuid].push_back(uassertStatusOK(std::move(document)));
             }
         }
         _listener->onRollbackFileWrittenForNamespace(std::move(uuid), std::move(nss));
@@ -142,6 +158,29 @@ private:
 
 const std::vector<BSONObj> RollbackImplForTest::kEmptyVector;
 
+/**
+ * Returns the documents saved in the rollback files for the namespace 'nss', in the order in which
+ * they were written.
+ */
+std::vector<BSONObj> readRollbackFiles(const NamespaceString& nss) {
+    boost::filesystem::path directory(storageGlobalParams.dbpath);
+    directory /= RollbackImpl::kRollbackRemoveSaverType;
+    directory /= nss.ns();
+
+    std::vector<BSONObj> documents;
+    for (boost::filesystem::directory_iterator it(directory), end; it != end; ++it) {
+        std::ifstream file(it->path().string(), std::ios::binary);
+        const std::string contents{std::istreambuf_iterator<char>(file),
+                                   std::istreambuf_iterator<char>()};
+        for (std::size_t offset = 0; offset < contents.size();) {
+            BSONObj document(contents.data() + offset);
+            documents.push_back(document.getOwned());
+            offset += document.objsize();
+        }
+    }
+    return documents;
+}
+
 /**
  * Unit test for rollback implementation introduced in 3.6.
  */
@@ -1398,6 +1437,51 @@ TEST_F(RollbackImplTest, RollbackCallsClearOpTimes) {
     ASSERT_FALSE(txnMetrics->getOldestNonMajorityCommittedOpTime());
 }
 
+TEST_F(RollbackImplTest, RollbackFileHoldsDocumentsFoundThroughTheIdIndexInIdOrder) {
+    const NamespaceString withIdIndex("test.rollback_with_id_index");
+    CollectionOptions options;
+    options.uuid = UUID::gen();
+    ASSERT_OK(_storageInterface->createCollection(_opCtx.get(), withIdIndex, options));
+    for (int i = 4; i >= 0; --i) {
+        ASSERT_OK(_storageInterface->insertDocument(
+            _opCtx.get(), withIdIndex, {BSON("_id" << i << "x" << i), Timestamp()}, 1));
+    }
+
+    // The _id 7 was never inserted, so there is nothing to save for it.
+    SimpleBSONObjUnorderedSet ids{BSON("_id" << 3), BSON("_id" << 7), BSON("_id" << 1)};
+    _rollback->writeRollbackFileForNamespace_forTest(_opCtx.get(), *options.uuid, withIdIndex, ids);
+
+    auto documents = readRollbackFiles(withIdIndex);
+    ASSERT_EQ(documents.size(), 2U);
+    ASSERT_BSONOBJ_EQ(documents[0], BSON("_id" << 1 << "x" << 1));
+    ASSERT_BSONOBJ_EQ(documents[1], BSON("_id" << 3 << "x" << 3));
+}
+
+TEST_F(RollbackImplTest, RollbackFileHoldsDocumentsOfCollectionWithoutIdIndex) {
+    // Only unreplicated collections may be created without an _id index.
+    const NamespaceString withoutIdIndex("local.rollback_without_id_index");
+    CollectionOptions options;
+    options.uuid = UUID::gen();
+    options.autoIndexId = CollectionOptions::NO;
+    ASSERT_OK(_storageInterface->createCollection(_opCtx.get(), withoutIdIndex, options));
+    for (int i = 4; i >= 0; --i) {
+        ASSERT_OK(_storageInterface->insertDocument(
+            _opCtx.get(), withoutIdIndex, {BSON("_id" << i << "x" << i), Timestamp()}, 1));
+    }
+    ASSERT_OK(_storageInterface->insertDocument(
+        _opCtx.get(), withoutIdIndex, {BSON("x" << 5), Timestamp()}, 1));
+
+    SimpleBSONObjUnorderedSet ids{BSON("_id" << 3), BSON("_id" << 7), BSON("_id" << 1)};
+    _rollback->writeRollbackFileForNamespace_forTest(
+        _opCtx.get(), *options.uuid, withoutIdIndex, ids);
+
+    // The documents are found by scanning the collection, so they are saved in natural order.
+    auto documents = readRollbackFiles(withoutIdIndex);
+    ASSERT_EQ(documents.size(), 2U);
+    ASSERT_BSONOBJ_EQ(documents[0], BSON("_id" << 3 << "x" << 3));
+    ASSERT_BSONOBJ_EQ(documents[1], BSON("_id" << 1 << "x" << 1));
+}
+
 /**
  * Fixture to help test that rollback records the correct information in its RollbackObserverInfo
  * struct.
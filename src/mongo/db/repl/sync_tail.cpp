@@ -269,17 +269,20 @@ LockMode fixLockModeForSystemDotViewsChanges(const NamespaceString& nss, LockMod
     return nss.isSystemDotViews() ? MODE_X : mode;
 }
 
-}  // namespace
-
-// static
-Status SyncTail::syncApply(OperationContext* opCtx,
-                           const BSONObj& op,
-                           OplogApplication::Mode oplogApplicationMode,
-                           boost::optional<Timestamp> stableTimestampForRecovery) {
+/**
+ * Applies 'op'. If the caller has already parsed 'op', 'parsedEntry' is its parsed form and is
+ * used instead of reading the namespace, operation type and command from 'op' again.
+ */
+Status syncApplyImpl(OperationContext* opCtx,
+                     const BSONObj& op,
+                     const OplogEntry* parsedEntry,
+                     OplogApplication::Mode oplogApplicationMode,
+                     boost::optional<Timestamp> stableTimestampForRecovery) {
     // Count each log op application as a separate operation, for reporting purposes
     CurOp individualOp(opCtx);
 
-    const NamespaceString nss(op.getStringField("ns"));
+    const NamespaceString nss(parsedEntry ? parsedEntry->getNss()
+                                          : NamespaceString(op.getStringField("ns")));
 
     auto incrementOpsAppliedStats = [] { opsAppliedStats.increment(1); };
 
@@ -315,7 +318,9 @@ Status SyncTail::syncApply(OperationContext* opCtx,
         MONGO_FAIL_POINT_PAUSE_WHILE_SET(hangAfterRecordingOpApplicationStartTime);
     }
 
-    auto opType = OpType_parse(IDLParserErrorContext("syncApply"), op["op"].valuestrsafe());
+    auto opType = parsedEntry
+        ? parsedEntry->getOpType()
+        : OpType_parse(IDLParserErrorContext("syncApply"), op["op"].valuestrsafe());
 
     auto finishApply = [&](Status status) {
         return finishAndLogApply(clockSource, status, applyStartTime, opType, op);
@@ -366,9 +371,12 @@ Status SyncTail::syncApply(OperationContext* opCtx,
             // Transactions have to acquire the same locks on secondaries as on primary.
             boost::optional<Lock::GlobalWrite> globalWriteLock;
 
-            // TODO SERVER-37180 Remove this double-parsing.
-            // The command entry has been parsed before, so it must be valid.
-            auto entry = uassertStatusOK(OplogEntry::parse(op));
+            // Only parse the command entry if the caller did not provide its parsed form.
+            boost::optional<OplogEntry> ownedEntry;
+            if (!parsedEntry) {
+                ownedEntry.emplace(uassertStatusOK(OplogEntry::parse(op)));
+            }
+            const OplogEntry& entry = parsedEntry ? *parsedEntry : *ownedEntry;
             const StringData commandName(op["o"].embeddedObject().firstElementFieldName());
             // SERVER-37313: createIndex does not need to take the Global X lock.
             if (!op.getBoolField("prepare") && commandName != "abortTransaction" &&
@@ -387,6 +395,25 @@ Status SyncTail::syncApply(OperationContext* opCtx,
     MONGO_UNREACHABLE;
 }
 
+}  // namespace
+
+// static
+Status SyncTail::syncApply(OperationContext* opCtx,
+                           const BSONObj& op,
+                           OplogApplication::Mode oplogApplicationMode,
+                           boost::optional<Timestamp> stableTimestampForRecovery) {
+    return syncApplyImpl(opCtx, op, nullptr, oplogApplicationMode, stableTimestampForRecovery);
+}
+
+// static
+Status SyncTail::syncApply(OperationContext* opCtx,
+                           const OplogEntry& entry,
+                           OplogApplication::Mode oplogApplicationMode,
+                           boost::optional<Timestamp> stableTimestampForRecovery) {
+    return syncApplyImpl(
+        opCtx, entry.raw, &entry, oplogApplicationMode, stableTimestampForRecovery);
+}
+
 SyncTail::SyncTail(OplogApplier::Observer* observer,
                    ReplicationConsistencyMarkers* consistencyMarkers,
                    StorageInterface* storageInterface,
@@ -600,115 +627,150 @@ void tryToGoLiveAsASecondary(OperationContext* opCtx,
     }
 }
 
+/**
+ * Returns true if 'entry' must be applied in a batch of its own.
+ *
+ * Commands must be processed one at a time. The exceptions to this are applyOps, because
+ * applyOps oplog entries are effectively containers for CRUD operations, and commands which
+ * only affect a single collection, because _fillWriterVectors() orders them with the other
+ * operations on that collection. Therefore, it is safe to batch these commands with CRUD
+ * operations when reading from the oplog buffer.
+ *
+ * Oplog entries on 'system.views' should also be processed one at a time. View catalog
+ * immediately reflects changes for each oplog entry so we can see inconsistent view catalog if
+ * multiple oplog entries on 'system.views' are being applied out of the original order.
+ *
+ * Process updates to 'admin.system.version' individually as well so the secondary's FCV when
+ * processing each operation matches the primary's when committing that operation.
+ */
+bool mustBeAppliedAlone(const OplogEntry& entry) {
+    return (entry.isCommand() &&
+            (entry.getCommandType() != OplogEntry::CommandType::kApplyOps ||
+             entry.shouldPrepare()) &&
+            !entry.getCollectionScopedCommandNss()) ||
+        entry.getNss().isSystemDotViews() || entry.getNss().isServerConfigurationCollection();
+}
+
 }  // namespace
 
-class SyncTail::OpQueueBatcher {
-    MONGO_DISALLOW_COPYING(OpQueueBatcher);
+SyncTail::OpQueueBatcher::OpQueueBatcher(SyncTail* syncTail,
+                                         StorageInterface* storageInterface,
+                                         OplogBuffer* oplogBuffer)
+    : _syncTail(syncTail),
+      _storageInterface(storageInterface),
+      _oplogBuffer(oplogBuffer),
+      _ops(0),
+      _thread([this] { run(); }) {}
 
-public:
-    OpQueueBatcher(SyncTail* syncTail, StorageInterface* storageInterface, OplogBuffer* oplogBuffer)
-        : _syncTail(syncTail),
-          _storageInterface(storageInterface),
-          _oplogBuffer(oplogBuffer),
-          _ops(0),
-          _thread([this] { run(); }) {}
-    ~OpQueueBatcher() {
-        invariant(_isDead);
-        _thread.join();
+SyncTail::OpQueueBatcher::~OpQueueBatcher() {
+    invariant(_isDead);
+    _thread.join();
+}
+
+SyncTail::OpQueue SyncTail::OpQueueBatcher::getNextBatch(Seconds maxWaitTime) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (_ops.empty() && !_ops.mustShutdown()) {
+        // We intentionally don't care about whether this returns due to signaling or timeout
+        // since we do the same thing either way: return whatever is in _ops.
+        (void)_cv.wait_for(lk, maxWaitTime.toSystemDuration());
     }
 
-    OpQueue getNextBatch(Seconds maxWaitTime) {
-        stdx::unique_lock<stdx::mutex> lk(_mutex);
-        if (_ops.empty() && !_ops.mustShutdown()) {
-            // We intentionally don't care about whether this returns due to signaling or timeout
-            // since we do the same thing either way: return whatever is in _ops.
-            (void)_cv.wait_for(lk, maxWaitTime.toSystemDuration());
-        }
+    OpQueue ops = std::move(_ops);
+    _ops = OpQueue(0);
+    _cv.notify_all();
 
-        OpQueue ops = std::move(_ops);
-        _ops = OpQueue(0);
-        _cv.notify_all();
+    return ops;
+}
 
-        return ops;
+boost::optional<Date_t> SyncTail::OpQueueBatcher::_calculateSlaveDelayLatestTimestamp() {
+    auto service = cc().getServiceContext();
+    auto replCoord = ReplicationCoordinator::get(service);
+    auto slaveDelay = replCoord->getSlaveDelaySecs();
+    if (slaveDelay <= Seconds(0)) {
+        return {};
     }
+    auto fastClockSource = service->getFastClockSource();
+    return fastClockSource->now() - slaveDelay;
+}
 
-private:
-    /**
-     * If slaveDelay is enabled, this function calculates the most recent timestamp of any oplog
-     * entries that can be be returned in a batch.
-     */
-    boost::optional<Date_t> _calculateSlaveDelayLatestTimestamp() {
-        auto service = cc().getServiceContext();
-        auto replCoord = ReplicationCoordinator::get(service);
-        auto slaveDelay = replCoord->getSlaveDelaySecs();
-        if (slaveDelay <= Seconds(0)) {
-            return {};
-        }
-        auto fastClockSource = service->getFastClockSource();
-        return fastClockSource->now() - slaveDelay;
+SyncTail::BatchLimits SyncTail::OpQueueBatcher::_getLimitsForNextOps(const BatchLimits& limits) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    if (_ops.empty() || mustBeAppliedAlone(_ops.back()) || _ops.getCount() >= limits.ops ||
+        _ops.getBytes() >= limits.bytes) {
+        return limits;
     }
 
-    void run() {
-        Client::initThread("ReplBatcher");
+    // Only this thread adds to the pending batch, so it can only have been taken by the applier,
+    // not grown, by the time the operations are handed over.
+    BatchLimits remaining = limits;
+    remaining.ops -= _ops.getCount();
+    remaining.bytes -= _ops.getBytes();
+    return remaining;
+}
 
-        BatchLimits batchLimits;
-        batchLimits.bytes = OplogApplier::calculateBatchLimitBytes(
-            cc().makeOperationContext().get(), _storageInterface);
+void SyncTail::OpQueueBatcher::_handOver(OpQueue&& ops, const BatchLimits& limits) {
+    stdx::unique_lock<stdx::mutex> lk(_mutex);
+    if (!_ops.empty() && !ops.mustShutdown() && !mustBeAppliedAlone(_ops.back()) &&
+        !mustBeAppliedAlone(ops.front()) && _ops.getCount() + ops.getCount() <= limits.ops &&
+        _ops.getBytes() + ops.getBytes() <= limits.bytes) {
+        _ops.append(std::move(ops));
+        _cv.notify_all();
+        return;
+    }
 
-        while (true) {
-            batchLimits.slaveDelayLatestTimestamp = _calculateSlaveDelayLatestTimestamp();
+    // Block until the pending batch has been taken.
+    _cv.wait(lk, [&] { return _ops.empty(); });
+    _ops = std::move(ops);
+    _cv.notify_all();
+    if (_ops.mustShutdown()) {
+        _isDead = true;
+    }
+}
 
-            // Check this once per batch since users can change it at runtime.
-            batchLimits.ops = OplogApplier::getBatchLimitOperations();
+void SyncTail::OpQueueBatcher::run() {
+    Client::initThread("ReplBatcher");
 
-            OpQueue ops(batchLimits.ops);
-            // tryPopAndWaitForMore adds to ops and returns true when we need to end a batch early.
-            {
-                auto opCtx = cc().makeOperationContext();
+    BatchLimits batchLimits;
+    batchLimits.bytes = OplogApplier::calculateBatchLimitBytes(cc().makeOperationContext().get(),
+                                                               _storageInterface);
 
-                // This use of UninterruptibleLockGuard is intentional. It is undesirable to use an
-                // UninterruptibleLockGuard in client operations because stepdown requires the
-                // ability to interrupt client operations. However, it is acceptable to use an
-                // UninterruptibleLockGuard in batch application because the only cause of
-                // interruption would be shutdown, and the ReplBatcher thread has its own shutdown
-                // handling.
-                UninterruptibleLockGuard noInterrupt(opCtx->lockState());
+    while (true) {
+        batchLimits.slaveDelayLatestTimestamp = _calculateSlaveDelayLatestTimestamp();
 
-                while (!_syncTail->tryPopAndWaitForMore(
-                    opCtx.get(), _oplogBuffer, &ops, batchLimits)) {
-                }
-            }
+        // Check this once per batch since users can change it at runtime.
+        batchLimits.ops = OplogApplier::getBatchLimitOperations();
 
-            if (ops.empty() && !ops.mustShutdown()) {
-                continue;  // Don't emit empty batches.
-            }
+        // If the applier is still busy with the pending batch, these operations will be added to
+        // it, so only read as many as there is room left for.
+        const BatchLimits limits = _getLimitsForNextOps(batchLimits);
 
-            stdx::unique_lock<stdx::mutex> lk(_mutex);
-            // Block until the previous batch has been taken.
-            _cv.wait(lk, [&] { return _ops.empty(); });
-            _ops = std::move(ops);
-            _cv.notify_all();
-            if (_ops.mustShutdown()) {
-                _isDead = true;
-                return;
-            }
-        }
-    }
+        OpQueue ops(limits.ops);
+        // tryPopAndWaitForMore adds to ops and returns true when we need to end a batch early.
+        {
+            auto opCtx = cc().makeOperationContext();
 
-    SyncTail* const _syncTail;
-    StorageInterface* const _storageInterface;
-    OplogBuffer* const _oplogBuffer;
+            // This use of UninterruptibleLockGuard is intentional. It is undesirable to use an
+            // UninterruptibleLockGuard in client operations because stepdown requires the
+            // ability to interrupt client operations. However, it is acceptable to use an
+            // UninterruptibleLockGuard in batch application because the only cause of
+            // interruption would be shutdown, and the ReplBatcher thread has its own shutdown
+            // handling.
+            UninterruptibleLockGuard noInterrupt(opCtx->lockState());
 
-    stdx::mutex _mutex;  // Guards _ops.
-    stdx::condition_variable _cv;
-    OpQueue _ops;
+            while (!_syncTail->tryPopAndWaitForMore(opCtx.get(), _oplogBuffer, &ops, limits)) {
+            }
+        }
 
-    // This only exists so the destructor invariants rather than deadlocking.
-    // TODO remove once we trust noexcept enough to mark oplogApplication() as noexcept.
-    bool _isDead = false;
+        if (ops.empty() && !ops.mustShutdown()) {
+            continue;  // Don't emit empty batches.
+        }
 
-    stdx::thread _thread;  // Must be last so all other members are initialized before starting.
-};
+        _handOver(std::move(ops), batchLimits);
+        if (_isDead) {
+            return;
+        }
+    }
+}
 
 void SyncTail::oplogApplication(OplogBuffer* oplogBuffer, ReplicationCoordinator* replCoord) {
     // We don't start data replication for arbiters at all and it's not allowed to reconfig
@@ -906,19 +968,7 @@ bool SyncTail::tryPopAndWaitForMore(OperationContext* opCtx,
         return true;
     }
 
-    // Commands must be processed one at a time. The only exception to this is applyOps because
-    // applyOps oplog entries are effectively containers for CRUD operations. Therefore, it is safe
-    // to batch applyOps commands with CRUD operations when reading from the oplog buffer.
-    //
-    // Oplog entries on 'system.views' should also be processed one at a time. View catalog
-    // immediately reflects changes for each oplog entry so we can see inconsistent view catalog if
-    // multiple oplog entries on 'system.views' are being applied out of the original order.
-    //
-    // Process updates to 'admin.system.version' individually as well so the secondary's FCV when
-    // processing each operation matches the primary's when committing that operation.
-    if ((entry.isCommand() &&
-         (entry.getCommandType() != OplogEntry::CommandType::kApplyOps || entry.shouldPrepare())) ||
-        entry.getNss().isSystemDotViews() || entry.getNss().isServerConfigurationCollection()) {
+    if (mustBeAppliedAlone(entry)) {
         if (ops->getCount() == 1) {
             // apply commands one-at-a-time
             _consume(opCtx, oplogBuffer);
@@ -1157,7 +1207,7 @@ Status multiSyncApply(OperationContext* opCtx,
             try {
                 auto stableTimestampForRecovery = st->getOptions().stableTimestampForRecovery;
                 const Status status = SyncTail::syncApply(
-                    opCtx, entry.raw, oplogApplicationMode, stableTimestampForRecovery);
+                    opCtx, entry, oplogApplicationMode, stableTimestampForRecovery);
 
                 if (!status.isOK()) {
                     // In initial sync, update operations can cause documents to be missed during
@@ -1207,12 +1257,16 @@ Status multiSyncApply(OperationContext* opCtx,
  * writerVectors - Set of operations for each worker thread to apply.
  * derivedOps - If provided, this function inserts a decomposition of applyOps operations
  *      and instructions for updating the transactions table.
+ * commandNamespaces - The namespaces changed by collection-scoped commands in the batch, mapped
+ *      to whether a command creates a capped collection there. All operations on these
+ *      namespaces are assigned to a single writer, so they are applied in order with the command.
  * sessionUpdateTracker - if provided, keeps track of session info from ops.
  */
 void SyncTail::_fillWriterVectors(OperationContext* opCtx,
                                   MultiApplier::Operations* ops,
                                   std::vector<MultiApplier::OperationPtrs>* writerVectors,
                                   std::vector<MultiApplier::Operations>* derivedOps,
+                                  const StringMap<bool>& commandNamespaces,
                                   SessionUpdateTracker* sessionUpdateTracker) {
     const auto serviceContext = opCtx->getServiceContext();
     const auto storageEngine = serviceContext->getStorageEngine();
@@ -1229,7 +1283,14 @@ void SyncTail::_fillWriterVectors(OperationContext* opCtx,
             continue;
         }
 
-        auto hashedNs = StringMapHasher().hashed_key(op.getNss().ns());
+        // A command which only affects a single collection is hashed by that collection's
+        // namespace, so it is assigned to the same writer as the other operations on it.
+        boost::optional<NamespaceString> commandNss;
+        if (op.isCommand()) {
+            commandNss = op.getCollectionScopedCommandNss();
+        }
+        const auto& nsToHash = commandNss ? commandNss->ns() : op.getNss().ns();
+        auto hashedNs = StringMapHasher().hashed_key(nsToHash);
         // Reduce the hash from 64bit down to 32bit, just to allow combinations with murmur3 later
         // on. Bit depth not important, we end up just doing integer modulo with this in the end.
         // The hash function should provide entropy in the lower bits as it's used in hash tables.
@@ -1240,19 +1301,27 @@ void SyncTail::_fillWriterVectors(OperationContext* opCtx,
         if (sessionUpdateTracker) {
             if (auto newOplogWrites = sessionUpdateTracker->updateOrFlush(op)) {
                 derivedOps->emplace_back(std::move(*newOplogWrites));
-                _fillWriterVectors(opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+                _fillWriterVectors(opCtx,
+                                   &derivedOps->back(),
+                                   writerVectors,
+                                   derivedOps,
+                                   commandNamespaces,
+                                   nullptr);
             }
         }
 
         if (op.isCrudOpType()) {
             auto collProperties = collPropertiesCache.getCollectionProperties(opCtx, hashedNs);
+            auto commandNsIt = commandNamespaces.find(op.getNss().ns());
+            const bool hasCommand = commandNsIt != commandNamespaces.end();
 
             // For doc locking engines, include the _id of the document in the hash so we get
             // parallelism even if all writes are to a single collection.
             //
             // For capped collections, this is illegal, since capped collections must preserve
-            // insertion order.
-            if (supportsDocLocking && !collProperties.isCapped) {
+            // insertion order. Neither may operations on a collection changed by a command in this
+            // batch be spread out, since they must be applied in order with the command.
+            if (supportsDocLocking && !collProperties.isCapped && !hasCommand) {
                 BSONElement id = op.getIdElement();
                 BSONElementComparator elementHasher(BSONElementComparator::FieldNamesMode::kIgnore,
                                                     collProperties.collator);
@@ -1260,7 +1329,8 @@ void SyncTail::_fillWriterVectors(OperationContext* opCtx,
                 MurmurHash3_x86_32(&idHash, sizeof(idHash), hash, &hash);
             }
 
-            if (op.getOpType() == OpTypeEnum::kInsert && collProperties.isCapped) {
+            if (op.getOpType() == OpTypeEnum::kInsert &&
+                (collProperties.isCapped || (hasCommand && commandNsIt->second))) {
                 // Mark capped collection ops before storing them to ensure we do not attempt to
                 // bulk insert them.
                 op.isForCappedCollection = true;
@@ -1274,7 +1344,12 @@ void SyncTail::_fillWriterVectors(OperationContext* opCtx,
                 derivedOps->emplace_back(ApplyOps::extractOperations(op));
 
                 // Nested entries cannot have different session updates.
-                _fillWriterVectors(opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+                _fillWriterVectors(opCtx,
+                                   &derivedOps->back(),
+                                   writerVectors,
+                                   derivedOps,
+                                   commandNamespaces,
+                                   nullptr);
             } catch (...) {
                 fassertFailedWithStatusNoTrace(
                     50711,
@@ -1297,13 +1372,28 @@ void SyncTail::_fillWriterVectors(OperationContext* opCtx,
                                   MultiApplier::Operations* ops,
                                   std::vector<MultiApplier::OperationPtrs>* writerVectors,
                                   std::vector<MultiApplier::Operations>* derivedOps) {
+    StringMap<bool> commandNamespaces;
+    for (auto&& op : *ops) {
+        if (!op.isCommand()) {
+            continue;
+        }
+        if (auto nss = op.getCollectionScopedCommandNss()) {
+            auto& createsCapped = commandNamespaces[nss->ns()];
+            createsCapped = createsCapped ||
+                (op.getCommandType() == OplogEntry::CommandType::kCreate &&
+                 op.getObject()["capped"].trueValue());
+        }
+    }
+
     SessionUpdateTracker sessionUpdateTracker;
-    _fillWriterVectors(opCtx, ops, writerVectors, derivedOps, &sessionUpdateTracker);
+    _fillWriterVectors(
+        opCtx, ops, writerVectors, derivedOps, commandNamespaces, &sessionUpdateTracker);
 
     auto newOplogWrites = sessionUpdateTracker.flushAll();
     if (!newOplogWrites.empty()) {
         derivedOps->emplace_back(std::move(newOplogWrites));
-        _fillWriterVectors(opCtx, &derivedOps->back(), writerVectors, derivedOps, nullptr);
+        _fillWriterVectors(
+            opCtx, &derivedOps->back(), writerVectors, derivedOps, commandNamespaces, nullptr);
     }
 }
 
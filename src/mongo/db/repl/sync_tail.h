@@ -30,8 +30,10 @@
 #pragma once
 
 #include <deque>
+#include <iterator>
 #include <memory>
 
+#include "mongo/base/disallow_copying.h"
 #include "mongo/base/status.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/db/repl/multiapplier.h"
@@ -42,9 +44,12 @@
 #include "mongo/db/repl/replication_consistency_markers.h"
 #include "mongo/db/repl/session_update_tracker.h"
 #include "mongo/db/repl/storage_interface.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/string_map.h"
 
 namespace mongo {
 
@@ -82,6 +87,14 @@ public:
                             OplogApplication::Mode oplogApplicationMode,
                             boost::optional<Timestamp> stableTimestampForRecovery);
 
+    /**
+     * Applies the already parsed operation 'entry', without parsing its raw BSON again.
+     */
+    static Status syncApply(OperationContext* opCtx,
+                            const OplogEntry& entry,
+                            OplogApplication::Mode oplogApplicationMode,
+                            boost::optional<Timestamp> stableTimestampForRecovery);
+
     /**
      *
      * Constructs a SyncTail.
@@ -164,6 +177,19 @@ public:
             _batch.pop_back();
         }
 
+        /**
+         * Moves the operations of 'other' to the end of this batch.
+         */
+        void append(OpQueue&& other) {
+            invariant(!_mustShutdown && !other._mustShutdown);
+            _bytes += other._bytes;
+            _batch.insert(_batch.end(),
+                          std::make_move_iterator(other._batch.begin()),
+                          std::make_move_iterator(other._batch.end()));
+            other._batch.clear();
+            other._bytes = 0;
+        }
+
         /**
          * A batch with this set indicates that the upstream stages of the pipeline are shutdown and
          * no more batches will be coming.
@@ -195,6 +221,8 @@ public:
 
     using BatchLimits = OplogApplier::BatchLimits;
 
+    class OpQueueBatcher;
+
     /**
      * Attempts to pop an OplogEntry off the BGSync queue and add it to ops.
      *
@@ -247,8 +275,6 @@ private:
      */
     void _consume(OperationContext* opCtx, OplogBuffer* oplogBuffer);
 
-    class OpQueueBatcher;
-
     void _oplogApplication(OplogBuffer* oplogBuffer,
                            ReplicationCoordinator* replCoord,
                            OpQueueBatcher* batcher) noexcept;
@@ -257,6 +283,7 @@ private:
                             MultiApplier::Operations* ops,
                             std::vector<MultiApplier::OperationPtrs>* writerVectors,
                             std::vector<MultiApplier::Operations>* derivedOps,
+                            const StringMap<bool>& commandNamespaces,
                             SessionUpdateTracker* sessionUpdateTracker);
 
     void _fillWriterVectors(OperationContext* opCtx,
@@ -285,6 +312,70 @@ private:
     bool _inShutdown = false;
 };
 
+/**
+ * Runs a thread that reads operations from an OplogBuffer and groups them into batches for the
+ * applier, within the usual batch limits.
+ *
+ * A batch is handed over as soon as the oplog buffer runs dry, but it remains pending until the
+ * applier takes it. While the applier is busy with the previous batch, operations which arrive in
+ * the buffer are added to the pending batch, so batch sizes adapt to how long application takes.
+ * The thread blocks on the oplog buffer while waiting for operations, and on the applier taking
+ * the pending batch when that batch cannot grow any further.
+ */
+class SyncTail::OpQueueBatcher {
+    MONGO_DISALLOW_COPYING(OpQueueBatcher);
+
+public:
+    OpQueueBatcher(SyncTail* syncTail,
+                   StorageInterface* storageInterface,
+                   OplogBuffer* oplogBuffer);
+    ~OpQueueBatcher();
+
+    /**
+     * Returns the pending batch, waiting up to 'maxWaitTime' for one if there is none. Returns an
+     * empty batch if none became available in time. A batch with the mustShutdown flag set is the
+     * last one.
+     */
+    OpQueue getNextBatch(Seconds maxWaitTime);
+
+private:
+    /**
+     * If slaveDelay is enabled, this function calculates the most recent timestamp of any oplog
+     * entries that can be be returned in a batch.
+     */
+    boost::optional<Date_t> _calculateSlaveDelayLatestTimestamp();
+
+    /**
+     * Returns the limits for the operations to read next. If they can be added to the pending
+     * batch, these are what remains of 'limits' after the pending batch. Otherwise, the
+     * operations will form a batch of their own and these are 'limits'.
+     */
+    BatchLimits _getLimitsForNextOps(const BatchLimits& limits);
+
+    /**
+     * Hands 'ops' over to the applier. They are added to the pending batch if it is still waiting
+     * for the applier and there is room left in it. Otherwise, waits for the applier to take the
+     * pending batch first, and 'ops' become the new pending batch.
+     */
+    void _handOver(OpQueue&& ops, const BatchLimits& limits);
+
+    void run();
+
+    SyncTail* const _syncTail;
+    StorageInterface* const _storageInterface;
+    OplogBuffer* const _oplogBuffer;
+
+    stdx::mutex _mutex;  // Guards _ops.
+    stdx::condition_variable _cv;
+    OpQueue _ops;
+
+    // This only exists so the destructor invariants rather than deadlocking.
+    // TODO remove once we trust noexcept enough to mark oplogApplication() as noexcept.
+    bool _isDead = false;
+
+    stdx::thread _thread;  // Must be last so all other members are initialized before starting.
+};
+
 // This free function is used by the thread pool workers to write ops to the db.
 // This consumes the passed in OperationPtrs and callers should not make any assumptions about the
 // state of the container after calling. However, this function cannot modify the pointed-to
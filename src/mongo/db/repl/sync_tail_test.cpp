@@ -65,6 +65,7 @@
 #include "mongo/db/service_context_d_test_fixture.h"
 #include "mongo/db/session_catalog_mongod.h"
 #include "mongo/db/session_txn_record_gen.h"
+#include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
 #include "mongo/unittest/death_test.h"
 #include "mongo/unittest/unittest.h"
@@ -381,6 +382,25 @@ TEST_F(SyncTailTest, SyncApplyCommand) {
     ASSERT_TRUE(applyCmdCalled);
 }
 
+TEST_F(SyncTailTest, SyncApplyParsedCommandEntry) {
+    NamespaceString nss("test.t");
+    auto op = makeCreateCollectionOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss);
+    bool applyCmdCalled = false;
+    _opObserver->onCreateCollectionFn = [&](OperationContext* opCtx,
+                                            Collection*,
+                                            const NamespaceString& collNss,
+                                            const CollectionOptions&,
+                                            const BSONObj&) {
+        applyCmdCalled = true;
+        ASSERT_TRUE(opCtx->lockState()->isW());
+        ASSERT_EQUALS(nss, collNss);
+        return Status::OK();
+    };
+    ASSERT_OK(
+        SyncTail::syncApply(_opCtx.get(), op, OplogApplication::Mode::kSecondary, boost::none));
+    ASSERT_TRUE(applyCmdCalled);
+}
+
 TEST_F(SyncTailTest, SyncApplyCommandThrowsException) {
     const BSONObj op = BSON("op"
                             << "c"
@@ -458,6 +478,127 @@ TEST_F(SyncTailTest,
                                                      createOplogCollectionOptions()));
 }
 
+TEST_F(SyncTailTest, MultiApplyOrdersCollectionScopedCommandsWithOperationsOnTheirCollection) {
+    NamespaceString nss1("test." + _agent.getSuiteName() + "_" + _agent.getTestName() + "_1");
+    NamespaceString nss2("test." + _agent.getSuiteName() + "_" + _agent.getTestName() + "_2");
+    createCollection(_opCtx.get(), nss2, CollectionOptions());
+
+    int seconds = 1;
+    auto nextOpTime = [&seconds] { return OpTime(Timestamp(Seconds(seconds++), 0), 1LL); };
+    MultiApplier::Operations ops;
+    ops.push_back(makeCreateCollectionOplogEntry(
+        nextOpTime(), nss1, BSON("capped" << true << "size" << 1024 * 1024)));
+    for (int i = 0; i < 20; ++i) {
+        ops.push_back(makeInsertDocumentOplogEntry(nextOpTime(), nss1, BSON("_id" << i)));
+        ops.push_back(makeInsertDocumentOplogEntry(nextOpTime(), nss2, BSON("_id" << i)));
+    }
+    ops.push_back(makeCommandOplogEntry(
+        nextOpTime(), nss1, BSON("collMod" << nss1.coll() << "validationLevel"
+                                           << "off")));
+    ops.push_back(makeInsertDocumentOplogEntry(nextOpTime(), nss1, BSON("_id" << 20)));
+
+    ASSERT_EQUALS(nss1, *ops.front().getCollectionScopedCommandNss());
+    auto isForNss1 = [&](const OplogEntry& op) { return op.isCommand() || op.getNss() == nss1; };
+    MultiApplier::Operations expectedNss1Ops;
+    std::copy_if(ops.begin(), ops.end(), std::back_inserter(expectedNss1Ops), isForNss1);
+
+    // Apply each writer's operations for real, and record them in the order multiSyncApply()
+    // sorted them into.
+    stdx::mutex mutex;
+    std::vector<MultiApplier::Operations> writerVectorsApplied;
+    auto applyOperationFn = [&](OperationContext* opCtx,
+                                MultiApplier::OperationPtrs* operationsToApply,
+                                SyncTail* st,
+                                WorkerMultikeyPathInfo* workerMultikeyPathInfo) -> Status {
+        auto status = multiSyncApply(opCtx, operationsToApply, st, workerMultikeyPathInfo);
+        MultiApplier::Operations applied;
+        for (auto&& opPtr : *operationsToApply) {
+            applied.push_back(*opPtr);
+        }
+        stdx::lock_guard<stdx::mutex> lock(mutex);
+        writerVectorsApplied.push_back(std::move(applied));
+        return status;
+    };
+
+    auto writerPool = OplogApplier::makeWriterPool();
+    SyncTail syncTail(nullptr,
+                      getConsistencyMarkers(),
+                      getStorageInterface(),
+                      applyOperationFn,
+                      writerPool.get());
+    ASSERT_EQUALS(ops.back().getOpTime(),
+                  unittest::assertGet(syncTail.multiApply(_opCtx.get(), ops)));
+
+    // The commands and every operation on 'nss1' are applied by one writer, in oplog order. The
+    // inserts into the new capped collection are not grouped.
+    std::size_t numWritersForNss2 = 0;
+    for (auto&& applied : writerVectorsApplied) {
+        if (applied.empty()) {
+            continue;
+        }
+        MultiApplier::Operations nss1Ops;
+        std::copy_if(applied.begin(), applied.end(), std::back_inserter(nss1Ops), isForNss1);
+        if (nss1Ops.empty()) {
+            ++numWritersForNss2;
+            continue;
+        }
+
+        ASSERT_EQUALS(expectedNss1Ops.size(), nss1Ops.size());
+        for (std::size_t i = 0; i < nss1Ops.size(); ++i) {
+            ASSERT_EQUALS(expectedNss1Ops[i], nss1Ops[i]);
+            if (nss1Ops[i].getOpType() == OpTypeEnum::kInsert) {
+                ASSERT_TRUE(nss1Ops[i].isForCappedCollection);
+            }
+        }
+    }
+
+    // Inserts into 'nss2' are still spread across writers by _id.
+    ASSERT_GREATER_THAN(numWritersForNss2, 1U);
+
+    ASSERT_EQUALS(21U, unittest::assertGet(getStorageInterface()->getCollectionCount(
+                           _opCtx.get(), nss1)));
+    ASSERT_EQUALS(20U, unittest::assertGet(getStorageInterface()->getCollectionCount(
+                           _opCtx.get(), nss2)));
+}
+
+TEST_F(SyncTailTest, MultiSyncApplyKeepsCollectionScopedCommandsInOrderWithTheirCollection) {
+    // Commands are logged under 'test.$cmd', which sorts before both collections.
+    NamespaceString nss("test.t");
+    NamespaceString otherNss("test.a");
+    createCollectionWithUuid(_opCtx.get(), nss);
+    createCollectionWithUuid(_opCtx.get(), otherNss);
+
+    const Seconds s(1);
+    unsigned int i = 1;
+    auto op1 = makeInsertDocumentOplogEntry({Timestamp(s, i++), 1LL}, nss, BSON("_id" << 1));
+    auto op2 = makeInsertDocumentOplogEntry({Timestamp(s, i++), 1LL}, otherNss, BSON("_id" << 1));
+    auto op3 = makeCommandOplogEntry({Timestamp(s, i++), 1LL},
+                                     nss,
+                                     BSON("collMod" << nss.coll() << "validationLevel"
+                                                    << "off"));
+    auto op4 = makeInsertDocumentOplogEntry({Timestamp(s, i++), 1LL}, nss, BSON("_id" << 2));
+
+    std::vector<std::string> events;
+    _opObserver->onInsertsFn =
+        [&](OperationContext*, const NamespaceString& nss, const std::vector<BSONObj>& docs) {
+            for (const auto& doc : docs) {
+                events.push_back(str::stream() << "insert " << nss.ns() << " " << doc["_id"]);
+            }
+        };
+    _opObserver->onCollModFn = [&](OperationContext*, const NamespaceString& nss) {
+        events.push_back(str::stream() << "collMod " << nss.ns());
+    };
+
+    ASSERT_OK(runOpsSteadyState({op1, op2, op3, op4}));
+
+    const std::vector<std::string> expectedEvents = {
+        "insert test.a _id: 1", "insert test.t _id: 1", "collMod test.t", "insert test.t _id: 2"};
+    ASSERT_EQUALS(expectedEvents.size(), events.size());
+    for (std::size_t j = 0; j < events.size(); ++j) {
+        ASSERT_EQUALS(expectedEvents[j], events[j]);
+    }
+}
+
 TEST_F(SyncTailTest, MultiSyncApplyUsesSyncApplyToApplyOperation) {
     NamespaceString nss("local." + _agent.getSuiteName() + "_" + _agent.getTestName());
     auto op = makeCreateCollectionOplogEntry({Timestamp(Seconds(1), 0), 1LL}, nss);
@@ -1078,6 +1219,127 @@ DEATH_TEST_F(SyncTailTest,
     syncTail.oplogApplication(oplogBuffer.get(), &replCoord);
 }
 
+namespace {
+
+/**
+ * Oplog buffer which lets a test wait for the ReplBatcher to have handed over every operation it
+ * has read. The ReplBatcher only waits for data once it has handed over the operations read so far.
+ */
+class OplogBufferWithIdleNotification final : public OplogBuffer {
+public:
+    void startup(OperationContext* opCtx) override {
+        _buffer.startup(opCtx);
+    }
+    void shutdown(OperationContext* opCtx) override {
+        _buffer.shutdown(opCtx);
+    }
+    void pushEvenIfFull(OperationContext* opCtx, const Value& value) override {
+        _buffer.pushEvenIfFull(opCtx, value);
+    }
+    void push(OperationContext* opCtx, const Value& value) override {
+        _buffer.push(opCtx, value);
+    }
+    void pushAllNonBlocking(OperationContext* opCtx,
+                            Batch::const_iterator begin,
+                            Batch::const_iterator end) override {
+        _buffer.pushAllNonBlocking(opCtx, begin, end);
+    }
+    void waitForSpace(OperationContext* opCtx, std::size_t size) override {
+        _buffer.waitForSpace(opCtx, size);
+    }
+    bool isEmpty() const override {
+        return _buffer.isEmpty();
+    }
+    std::size_t getMaxSize() const override {
+        return _buffer.getMaxSize();
+    }
+    std::size_t getSize() const override {
+        return _buffer.getSize();
+    }
+    std::size_t getCount() const override {
+        return _buffer.getCount();
+    }
+    void clear(OperationContext* opCtx) override {
+        _buffer.clear(opCtx);
+    }
+    bool tryPop(OperationContext* opCtx, Value* value) override {
+        if (!_buffer.tryPop(opCtx, value)) {
+            return false;
+        }
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        ++_numPopped;
+        return true;
+    }
+    bool waitForData(Seconds waitDuration) override {
+        {
+            stdx::lock_guard<stdx::mutex> lk(_mutex);
+            _numPoppedWhenIdle = _numPopped;
+            _idleCV.notify_all();
+        }
+        return _buffer.waitForData(waitDuration);
+    }
+    bool peek(OperationContext* opCtx, Value* value) override {
+        return _buffer.peek(opCtx, value);
+    }
+    boost::optional<Value> lastObjectPushed(OperationContext* opCtx) const override {
+        return _buffer.lastObjectPushed(opCtx);
+    }
+
+    /**
+     * Waits until 'numPopped' operations have been popped and the reader is waiting for more.
+     */
+    void waitUntilIdleAfterPopping(std::size_t numPopped) {
+        stdx::unique_lock<stdx::mutex> lk(_mutex);
+        _idleCV.wait(lk, [&] { return _numPoppedWhenIdle >= numPopped; });
+    }
+
+private:
+    OplogBufferBlockingQueue _buffer;
+
+    stdx::mutex _mutex;
+    stdx::condition_variable _idleCV;
+    std::size_t _numPopped = 0;
+    std::size_t _numPoppedWhenIdle = 0;
+};
+
+}  // namespace
+
+TEST_F(SyncTailTest, OpQueueBatcherAddsToThePendingBatchWhileTheApplierIsBusy) {
+    NamespaceString nss("test.t");
+    auto makeOp = [&nss](int i) {
+        return makeInsertDocumentOplogEntry({Timestamp(Seconds(i), 0), 1LL}, nss, BSON("_id" << i))
+            .toBSON();
+    };
+
+    OplogBufferWithIdleNotification oplogBuffer;
+    SyncTail syncTail(
+        nullptr, _consistencyMarkers.get(), _storageInterface.get(), noopApplyOperationFn, nullptr);
+    SyncTail::OpQueueBatcher batcher(&syncTail, _storageInterface.get(), &oplogBuffer);
+    ON_BLOCK_EXIT([&] {
+        syncTail.shutdown();
+        while (!batcher.getNextBatch(Seconds(1)).mustShutdown()) {
+        }
+    });
+
+    // The applier takes the first batch and is then busy applying it.
+    oplogBuffer.push(_opCtx.get(), makeOp(1));
+    auto batch = batcher.getNextBatch(Seconds(30));
+    ASSERT_EQUALS(1U, batch.getCount());
+
+    // Operations which arrive one at a time while the applier is busy are all added to the batch
+    // handed over after the first one arrived.
+    for (int i = 2; i <= 4; ++i) {
+        oplogBuffer.push(_opCtx.get(), makeOp(i));
+        oplogBuffer.waitUntilIdleAfterPopping(i);
+    }
+
+    batch = batcher.getNextBatch(Seconds(30));
+    ASSERT_EQUALS(3U, batch.getCount());
+    for (int i = 0; i < 3; ++i) {
+        ASSERT_EQUALS(Timestamp(Seconds(i + 2), 0), batch.getBatch()[i].getTimestamp());
+    }
+}
+
 TEST_F(IdempotencyTest, Geo2dsphereIndexFailedOnUpdate) {
     ASSERT_OK(
         ReplicationCoordinator::get(_opCtx.get())->setFollowerMode(MemberState::RS_RECOVERING));
@@ -87,6 +87,18 @@ void SyncTailOpObserver::onCreateCollection(OperationContext* opCtx,
     onCreateCollectionFn(opCtx, coll, collectionName, options, idIndex);
 }
 
+void SyncTailOpObserver::onCollMod(OperationContext* opCtx,
+                                   const NamespaceString& nss,
+                                   OptionalCollectionUUID uuid,
+                                   const BSONObj& collModCmd,
+                                   const CollectionOptions& oldCollOptions,
+                                   boost::optional<TTLCollModInfo> ttlInfo) {
+    if (!onCollModFn) {
+        return;
+    }
+    onCollModFn(opCtx, nss);
+}
+
 // static
 OplogApplier::Options SyncTailTest::makeInitialSyncOptions() {
     OplogApplier::Options options;
@@ -78,6 +78,16 @@ public:
                             const BSONObj& idIndex,
                             const OplogSlot& createOpTime) override;
 
+    /**
+     * Called when SyncTail modifies a collection's options.
+     */
+    void onCollMod(OperationContext* opCtx,
+                   const NamespaceString& nss,
+                   OptionalCollectionUUID uuid,
+                   const BSONObj& collModCmd,
+                   const CollectionOptions& oldCollOptions,
+                   boost::optional<TTLCollModInfo> ttlInfo) override;
+
     // Hooks for OpObserver functions. Defaults to a no-op function but may be overridden to check
     // actual documents mutated.
     std::function<void(OperationContext*, const NamespaceString&, const std::vector<BSONObj>&)>
@@ -97,6 +107,8 @@ public:
                        const CollectionOptions&,
                        const BSONObj&)>
         onCreateCollectionFn;
+
+    std::function<void(OperationContext*, const NamespaceString&)> onCollModFn;
 };
 
 class SyncTailTest : public ServiceContextMongoDTest {
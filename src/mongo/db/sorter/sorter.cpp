@@ -49,9 +49,13 @@
 #include "mongo/db/sorter/sorter.h"
 
 #include <boost/filesystem/operations.hpp>
+#include <exception>
 #include <snappy.h>
+#include <system_error>
 #include <vector>
+#include <zstd.h>
 
+#include "mongo/base/data_view.h"
 #include "mongo/base/string_data.h"
 #include "mongo/config.h"
 #include "mongo/db/jsobj.h"
@@ -60,8 +64,10 @@
 #include "mongo/db/storage/storage_options.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/s/is_mongos.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/bufreader.h"
+#include "mongo/util/checksum.h"
 #include "mongo/util/destructor_guard.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/unowned_ptr.h"
@@ -81,6 +87,13 @@ inline std::string myErrnoWithDescription() {
     return sb.str();
 }
 
+/**
+ * Each block of a spill file starts with a header holding the size of the block's data as stored,
+ * the SorterCompressor it was compressed with, and the two words of a Checksum of the stored data.
+ * The data is the serialized keys and values, compressed and then encrypted if encryption is on.
+ */
+const size_t kBlockHeaderSize = sizeof(int32_t) + sizeof(uint8_t) + 2 * sizeof(uint64_t);
+
 template <typename Data, typename Comparator>
 void dassertCompIsSane(const Comparator& comp, const Data& lhs, const Data& rhs) {
 #if defined(MONGO_CONFIG_DEBUG_BUILD) && !defined(_MSC_VER)
@@ -104,6 +117,90 @@ void dassertCompIsSane(const Comparator& comp, const Data& lhs, const Data& rhs)
 #endif
 }
 
+/**
+ * Runs 'task(i)' for each 'i' in [0, numTasks), each on a thread of its own except for the first,
+ * which runs on the calling thread along with any task a thread could not be started for. Once all
+ * tasks have finished, rethrows the exception thrown by the lowest-numbered failing task, if any.
+ */
+template <typename Task>
+void runInParallel(size_t numTasks, const Task& task) {
+    std::vector<std::exception_ptr> errors(numTasks);
+    auto runTask = [&](size_t i) {
+        try {
+            task(i);
+        } catch (...) {
+            errors[i] = std::current_exception();
+        }
+    };
+
+    std::vector<stdx::thread> threads;
+    size_t numStarted = 1;
+    for (; numStarted < numTasks; ++numStarted) {
+        try {
+            threads.emplace_back([&runTask, i = numStarted] { runTask(i); });
+        } catch (const std::system_error&) {
+            break;
+        }
+    }
+
+    if (numTasks > 0) {
+        runTask(0);
+    }
+    for (size_t i = numStarted; i < numTasks; ++i) {
+        runTask(i);
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+
+    for (auto&& error : errors) {
+        if (error) {
+            std::rethrow_exception(error);
+        }
+    }
+}
+
+/**
+ * Stably sorts 'data' on up to 'maxThreads' threads. Each thread sorts a contiguous slice of the
+ * data, then adjacent sorted slices are merged pairwise in rounds, with the merges of a round also
+ * running in parallel. Small inputs are sorted on the calling thread.
+ */
+template <typename Container, typename Less>
+void parallelStableSort(Container* data, size_t maxThreads, const Less& less) {
+    // Below this many elements per slice, starting a thread costs more than it saves.
+    const size_t kMinSliceSize = 16 * 1024;
+
+    const size_t numSlices = std::min(maxThreads, data->size() / kMinSliceSize);
+    if (numSlices <= 1) {
+        std::stable_sort(data->begin(), data->end(), less);
+        return;
+    }
+
+    std::vector<size_t> bounds;
+    for (size_t i = 0; i <= numSlices; ++i) {
+        bounds.push_back(data->size() * i / numSlices);
+    }
+    const auto begin = data->begin();
+
+    runInParallel(numSlices, [&](size_t i) {
+        std::stable_sort(begin + bounds[i], begin + bounds[i + 1], less);
+    });
+
+    for (size_t width = 1; width < numSlices; width *= 2) {
+        std::vector<size_t> firstSlices;
+        for (size_t i = 0; i + width < numSlices; i += 2 * width) {
+            firstSlices.push_back(i);
+        }
+        runInParallel(firstSlices.size(), [&](size_t m) {
+            const size_t i = firstSlices[m];
+            std::inplace_merge(begin + bounds[i],
+                               begin + bounds[i + width],
+                               begin + bounds[std::min(i + 2 * width, numSlices)],
+                               less);
+        });
+    }
+}
+
 /**
  * Returns results from sorted in-memory storage.
  */
@@ -228,19 +325,35 @@ private:
      * read, then _done is set to true and the function returns immediately.
      */
     void fillBufferFromDisk() {
-        int32_t rawSize;
-        read(&rawSize, sizeof(rawSize));
+        char header[kBlockHeaderSize];
+        read(header, sizeof(header));
         if (_done)
             return;
 
-        // negative size means compressed
-        const bool compressed = rawSize < 0;
-        int32_t blockSize = std::abs(rawSize);
+        ConstDataView headerView(header);
+        int32_t blockSize = headerView.read<LittleEndian<int32_t>>();
+        const auto compressor =
+            static_cast<SorterCompressor>(headerView.read<uint8_t>(sizeof(int32_t)));
+        Checksum expectedChecksum;
+        expectedChecksum.words[0] =
+            headerView.read<LittleEndian<uint64_t>>(sizeof(int32_t) + sizeof(uint8_t));
+        expectedChecksum.words[1] = headerView.read<LittleEndian<uint64_t>>(
+            sizeof(int32_t) + sizeof(uint8_t) + sizeof(uint64_t));
+        uassert(51096,
+                str::stream() << "invalid block size " << blockSize << " in file \"" << _fileName
+                              << "\"",
+                blockSize > 0);
 
         _buffer.reset(new char[blockSize]);
         read(_buffer.get(), blockSize);
         uassert(16816, "file too short?", !_done);
 
+        Checksum checksum;
+        checksum.gen(_buffer.get(), blockSize);
+        uassert(51097,
+                str::stream() << "checksum mismatch in a block of file \"" << _fileName << "\"",
+                checksum == expectedChecksum);
+
         auto encryptionHooks = EncryptionHooks::get(getGlobalServiceContext());
         if (encryptionHooks->enabled()) {
             std::unique_ptr<char[]> out(new char[blockSize]);
@@ -258,22 +371,51 @@ private:
             _buffer.swap(out);
         }
 
-        if (!compressed) {
-            _bufferReader.reset(new BufReader(_buffer.get(), blockSize));
-            return;
-        }
-
-        dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
-
         size_t uncompressedSize;
-        uassert(17061,
-                "couldn't get uncompressed length",
-                snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
-
-        std::unique_ptr<char[]> decompressionBuffer(new char[uncompressedSize]);
-        uassert(17062,
-                "decompression failed",
-                snappy::RawUncompress(_buffer.get(), blockSize, decompressionBuffer.get()));
+        std::unique_ptr<char[]> decompressionBuffer;
+        switch (compressor) {
+            case SorterCompressor::kNone:
+                _bufferReader.reset(new BufReader(_buffer.get(), blockSize));
+                return;
+            case SorterCompressor::kSnappy: {
+                dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
+
+                uassert(17061,
+                        "couldn't get uncompressed length",
+                        snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
+
+                decompressionBuffer.reset(new char[uncompressedSize]);
+                uassert(17062,
+                        "decompression failed",
+                        snappy::RawUncompress(_buffer.get(), blockSize, decompressionBuffer.get()));
+                break;
+            }
+            case SorterCompressor::kZstd: {
+                const auto contentSize = ZSTD_getFrameContentSize(_buffer.get(), blockSize);
+                uassert(51098,
+                        "couldn't get uncompressed length",
+                        contentSize != ZSTD_CONTENTSIZE_UNKNOWN &&
+                            contentSize != ZSTD_CONTENTSIZE_ERROR);
+                uncompressedSize = contentSize;
+
+                decompressionBuffer.reset(new char[uncompressedSize]);
+                const size_t ret = ZSTD_decompress(
+                    decompressionBuffer.get(), uncompressedSize, _buffer.get(), blockSize);
+                uassert(51099,
+                        str::stream() << "decompression failed: "
+                                      << (ZSTD_isError(ret) ? ZSTD_getErrorName(ret)
+                                                            : "unexpected size"),
+                        !ZSTD_isError(ret) && ret == uncompressedSize);
+                break;
+            }
+            default:
+                uasserted(51100,
+                          str::stream() << "unknown compressor "
+                                        << static_cast<int>(compressor)
+                                        << " in a block of file \""
+                                        << _fileName
+                                        << "\"");
+        }
 
         // hold on to decompressed data and throw out compressed data at block exit
         _buffer.swap(decompressionBuffer);
@@ -322,6 +464,11 @@ private:
  * Merge-sorts results from 0 or more FileIterators, all of which should be iterating over sorted
  * ranges within the same file. This class is given the data source file name upon construction and
  * is responsible for deleting the data source file upon destruction.
+ *
+ * The inputs are merged with a tournament tree of losers. Each internal node of the tree holds the
+ * input which lost the comparison made there, and the overall winner is kept separately, so that
+ * replacing the winner's value takes one comparison per level of the tree. Ties go to the input
+ * which was passed first, which keeps the merge stable.
  */
 template <typename Key, typename Value, typename Comparator>
 class MergeIterator : public SortIteratorInterface<Key, Value> {
@@ -341,28 +488,26 @@ public:
         for (size_t i = 0; i < iters.size(); i++) {
             iters[i]->openSource();
             if (iters[i]->more()) {
-                _heap.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
+                _streams.push_back(std::make_shared<Stream>(i, iters[i]->next(), iters[i]));
             } else {
                 iters[i]->closeSource();
             }
         }
 
-        if (_heap.empty()) {
+        if (_streams.empty()) {
             _remaining = 0;
             return;
         }
 
-        std::make_heap(_heap.begin(), _heap.end(), _greater);
-        std::pop_heap(_heap.begin(), _heap.end(), _greater);
-        _current = _heap.back();
-        _heap.pop_back();
+        _numActive = _streams.size();
+        _tree.resize(_streams.size());
+        _tree[0] = _playSubtree(1);
     }
 
     ~MergeIterator() {
         // Clear the remaining Stream objects first, to close the file handles before deleting the
         // file. Some systems will error closing the file if any file handles are still open.
-        _current.reset();
-        _heap.clear();
+        _streams.clear();
         DESTRUCTOR_GUARD(boost::filesystem::remove(_itersSourceFileName));
     }
 
@@ -370,7 +515,8 @@ public:
     void closeSource() {}
 
     bool more() {
-        if (_remaining > 0 && (_first || !_heap.empty() || _current->more()))
+        if (_remaining > 0 &&
+            (_first || _numActive > 1 || (_numActive == 1 && _streams[_tree[0]]->more())))
             return true;
 
         _remaining = 0;
@@ -384,21 +530,26 @@ public:
 
         if (_first) {
             _first = false;
-            return _current->current();
+            return _streams[_tree[0]]->current();
         }
 
-        if (!_current->advance()) {
-            verify(!_heap.empty());
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            _current = _heap.back();
-            _heap.pop_back();
-        } else if (!_heap.empty() && _greater(_current, _heap.front())) {
-            std::pop_heap(_heap.begin(), _heap.end(), _greater);
-            std::swap(_current, _heap.back());
-            std::push_heap(_heap.begin(), _heap.end(), _greater);
+        size_t winner = _tree[0];
+        if (!_streams[winner]->advance()) {
+            // Closes the exhausted input.
+            _streams[winner].reset();
+            _numActive--;
+            verify(_numActive > 0);
         }
 
-        return _current->current();
+        // Replay the matches on the path from the winner's leaf to the root.
+        for (size_t node = (winner + _streams.size()) / 2; node > 0; node /= 2) {
+            if (_beats(_tree[node], winner)) {
+                std::swap(_tree[node], winner);
+            }
+        }
+        _tree[0] = winner;
+
+        return _streams[winner]->current();
     }
 
 
@@ -440,7 +591,7 @@ private:
         std::shared_ptr<Input> _rest;
     };
 
-    class STLComparator {  // uses greater rather than less-than to maintain a MinHeap
+    class STLComparator {  // uses greater rather than less-than
     public:
         explicit STLComparator(const Comparator& comp) : _comp(comp) {}
         bool operator()(unowned_ptr<const Stream> lhs, unowned_ptr<const Stream> rhs) const {
@@ -458,12 +609,43 @@ private:
         const Comparator _comp;
     };
 
+    /**
+     * Returns true if the stream at index 'lhs' should be returned before the one at 'rhs'. An
+     * exhausted stream loses to every other.
+     */
+    bool _beats(size_t lhs, size_t rhs) const {
+        if (!_streams[lhs])
+            return false;
+        if (!_streams[rhs])
+            return true;
+        return _greater(_streams[rhs], _streams[lhs]);
+    }
+
+    /**
+     * Plays the matches of the subtree rooted at 'node', recording the loser of each, and returns
+     * the index of the subtree's winner. The leaves are the nodes from _streams.size() onwards.
+     */
+    size_t _playSubtree(size_t node) {
+        if (node >= _streams.size())
+            return node - _streams.size();
+
+        const size_t left = _playSubtree(2 * node);
+        const size_t right = _playSubtree(2 * node + 1);
+        if (_beats(left, right)) {
+            _tree[node] = right;
+            return left;
+        }
+        _tree[node] = left;
+        return right;
+    }
+
     SortOptions _opts;
     unsigned long long _remaining;
     bool _first;
-    std::shared_ptr<Stream> _current;
-    std::vector<std::shared_ptr<Stream>> _heap;  // MinHeap
-    STLComparator _greater;                      // named so calls make sense
+    std::vector<std::shared_ptr<Stream>> _streams;  // Null once a stream is exhausted.
+    std::vector<size_t> _tree;  // _tree[0] is the winner, the others the losers of each node.
+    size_t _numActive = 0;      // The number of streams which are not exhausted.
+    STLComparator _greater;     // named so calls make sense
     std::string _itersSourceFileName;
 };
 
@@ -487,6 +669,8 @@ public:
     }
 
     ~NoLimitSorter() {
+        // A background spill may still be writing to the file.
+        DESTRUCTOR_GUARD(_waitForSpill());
         if (!_done) {
             // If done() was never called to return a MergeIterator, then this Sorter still owns
             // file deletion.
@@ -502,19 +686,21 @@ public:
         _memUsed += key.memUsageForSorter();
         _memUsed += val.memUsageForSorter();
 
-        if (_memUsed > _opts.maxMemoryUsageBytes)
+        if (_memUsed > _spillThresholdBytes())
             spill();
     }
 
     Iterator* done() {
         invariant(!_done);
 
-        if (_iters.empty()) {
-            sort();
+        // A running spill thread may still be appending to '_iters', so only look at it otherwise.
+        if (!_spillThread.joinable() && _iters.empty()) {
+            sort(&_data);
             return new InMemIterator<Key, Value>(_data);
         }
 
         spill();
+        _waitForSpill();
         Iterator* mergeIt = Iterator::merge(_iters, _fileName, _opts, _comp);
         _done = true;
         return mergeIt;
@@ -533,15 +719,56 @@ private:
         const Comparator& _comp;
     };
 
-    void sort() {
+    void sort(std::deque<Data>* data) {
         STLComparator less(_comp);
-        std::stable_sort(_data.begin(), _data.end(), less);
+        parallelStableSort(data, _opts.maxThreads, less);
 
         // Does 2x more compares than stable_sort
         // TODO test on windows
         // std::sort(_data.begin(), _data.end(), comp);
     }
 
+    /**
+     * With more than one thread, a spill is written in the background while the next one fills,
+     * so each may only use half of the memory.
+     */
+    size_t _spillThresholdBytes() const {
+        if (_opts.maxThreads > 1 && _opts.extSortAllowed)
+            return _opts.maxMemoryUsageBytes / 2;
+        return _opts.maxMemoryUsageBytes;
+    }
+
+    /**
+     * Sorts 'data' and appends it to the file as a new sorted range.
+     */
+    void _writeSpill(std::deque<Data>* data) {
+        sort(data);
+
+        SortedFileWriter<Key, Value> writer(
+            _opts, _fileName, _nextSortedFileWriterOffset, _settings);
+        for (; !data->empty(); data->pop_front()) {
+            writer.addAlreadySorted(data->front().first, data->front().second);
+        }
+        Iterator* iteratorPtr = writer.done();
+        _nextSortedFileWriterOffset = writer.getFileEndOffset();
+
+        _iters.push_back(std::shared_ptr<Iterator>(iteratorPtr));
+    }
+
+    /**
+     * Waits for the spill being written in the background, if any, and rethrows its error.
+     */
+    void _waitForSpill() {
+        if (!_spillThread.joinable())
+            return;
+
+        _spillThread.join();
+        _spillData.clear();
+        if (auto error = std::exchange(_spillError, nullptr)) {
+            std::rethrow_exception(error);
+        }
+    }
+
     void spill() {
         invariant(!_done);
 
@@ -562,19 +789,24 @@ private:
                           << " Pass allowDiskUse:true to opt in.");
         }
 
-        sort();
+        // Only one spill is written at a time, as each appends to the end of the same file.
+        _waitForSpill();
 
-        SortedFileWriter<Key, Value> writer(
-            _opts, _fileName, _nextSortedFileWriterOffset, _settings);
-        for (; !_data.empty(); _data.pop_front()) {
-            writer.addAlreadySorted(_data.front().first, _data.front().second);
+        if (_opts.maxThreads <= 1) {
+            _writeSpill(&_data);
+            _memUsed = 0;
+            return;
         }
-        Iterator* iteratorPtr = writer.done();
-        _nextSortedFileWriterOffset = writer.getFileEndOffset();
-
-        _iters.push_back(std::shared_ptr<Iterator>(iteratorPtr));
 
+        _spillData.swap(_data);
         _memUsed = 0;
+        _spillThread = stdx::thread([this] {
+            try {
+                _writeSpill(&_spillData);
+            } catch (...) {
+                _spillError = std::current_exception();
+            }
+        });
     }
 
     const Comparator _comp;
@@ -585,7 +817,14 @@ private:
     bool _done = false;
     size_t _memUsed;
     std::deque<Data> _data;                         // the "current" data
-    std::vector<std::shared_ptr<Iterator>> _iters;  // data that has already been spilled
+    // Data that has already been spilled. Appended to by '_spillThread' while it runs.
+    std::vector<std::shared_ptr<Iterator>> _iters;
+
+    // The data being written by '_spillThread', and any error it failed with. Only accessed by the
+    // spill thread while it is running.
+    std::deque<Data> _spillData;
+    std::exception_ptr _spillError;
+    stdx::thread _spillThread;
 };
 
 template <typename Key, typename Value, typename Comparator>
@@ -901,7 +1140,7 @@ SortedFileWriter<Key, Value>::SortedFileWriter(const SortOptions& opts,
                                                const std::string& fileName,
                                                const std::streampos fileStartOffset,
                                                const Settings& settings)
-    : _settings(settings) {
+    : _settings(settings), _compressor(getSorterSpillCompressor()) {
     namespace str = mongoutils::str;
 
     // This should be checked by consumers, but if we get here don't allow writes.
@@ -953,10 +1192,28 @@ void SortedFileWriter<Key, Value>::spill() {
         return;
 
     std::string compressed;
-    snappy::Compress(outBuffer, size, &compressed);
+    switch (_compressor) {
+        case SorterCompressor::kNone:
+            break;
+        case SorterCompressor::kSnappy:
+            snappy::Compress(outBuffer, size, &compressed);
+            break;
+        case SorterCompressor::kZstd: {
+            compressed.resize(ZSTD_compressBound(size));
+            const size_t ret = ZSTD_compress(
+                &compressed[0], compressed.size(), outBuffer, size, ZSTD_CLEVEL_DEFAULT);
+            uassert(51101,
+                    str::stream() << "Failed to compress data: " << ZSTD_getErrorName(ret),
+                    !ZSTD_isError(ret));
+            compressed.resize(ret);
+            break;
+        }
+    }
     verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
 
-    const bool shouldCompress = compressed.size() < size_t(_buffer.len() / 10 * 9);
+    // Blocks which hardly compress are stored as they are, so reading them back is cheaper.
+    const bool shouldCompress =
+        _compressor != SorterCompressor::kNone && compressed.size() < size_t(size / 10 * 9);
     if (shouldCompress) {
         size = compressed.size();
         outBuffer = const_cast<char*>(compressed.data());
@@ -980,11 +1237,21 @@ void SortedFileWriter<Key, Value>::spill() {
         size = resultLen;
     }
 
-    // negative size means compressed
-    size = shouldCompress ? -size : size;
+    Checksum checksum;
+    checksum.gen(outBuffer, size);
+
+    char header[sorter::kBlockHeaderSize];
+    DataView headerView(header);
+    headerView.write<LittleEndian<int32_t>>(size);
+    headerView.write<uint8_t>(
+        static_cast<uint8_t>(shouldCompress ? _compressor : SorterCompressor::kNone),
+        sizeof(int32_t));
+    headerView.write<LittleEndian<uint64_t>>(checksum.words[0], sizeof(int32_t) + sizeof(uint8_t));
+    headerView.write<LittleEndian<uint64_t>>(checksum.words[1],
+                                             sizeof(int32_t) + sizeof(uint8_t) + sizeof(uint64_t));
     try {
-        _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-        _file.write(outBuffer, std::abs(size));
+        _file.write(header, sizeof(header));
+        _file.write(outBuffer, size);
     } catch (const std::exception&) {
         msgasserted(16821,
                     str::stream() << "error writing to file \"" << _fileName << "\": "
@@ -38,6 +38,7 @@
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/bson/util/builder.h"
+#include "mongo/db/sorter/sorter_options.h"
 
 /**
  * This is the public API for the Sorter (both in-memory and external)
@@ -104,7 +105,13 @@ struct SortOptions {
     // extSortAllowed is true.
     std::string tempDir;
 
-    SortOptions() : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false) {}
+    // The number of threads which may sort the data held in memory. When greater than one, an
+    // unlimited sort also writes each spill on a background thread while further data is added,
+    // so it spills once half of maxMemoryUsageBytes is in use.
+    size_t maxThreads;
+
+    SortOptions()
+        : limit(0), maxMemoryUsageBytes(64 * 1024 * 1024), extSortAllowed(false), maxThreads(1) {}
 
     // Fluent API to support expressions like SortOptions().Limit(1000).ExtSortAllowed(true)
 
@@ -127,6 +134,11 @@ struct SortOptions {
         tempDir = newTempDir;
         return *this;
     }
+
+    SortOptions& MaxThreads(size_t newMaxThreads) {
+        maxThreads = newMaxThreads;
+        return *this;
+    }
 };
 
 /**
@@ -254,6 +266,7 @@ private:
     void spill();
 
     const Settings _settings;
+    const SorterCompressor _compressor;
     std::string _fileName;
     std::ofstream _file;
     BufBuilder _buffer;
@@ -38,11 +38,13 @@
 #include "mongo/base/static_assert.h"
 #include "mongo/config.h"
 #include "mongo/db/service_context_test_fixture.h"
+#include "mongo/db/sorter/sorter_options_gen.h"
 #include "mongo/platform/random.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/scopeguard.h"
 
 #include <memory>
 
@@ -309,6 +311,54 @@ public:
     }
 };
 
+class SpillCompressorTests : public ScopedGlobalServiceContextForTest {
+public:
+    void run() {
+        unittest::TempDir tempDir("spillCompressorTests");
+        const SortOptions opts = SortOptions().TempDir(tempDir.path());
+        const std::string originalCompressor = gSorterSpillCompressor;
+        ON_BLOCK_EXIT([&] { gSorterSpillCompressor = originalCompressor; });
+
+        for (auto&& compressor : {"none", "snappy", "zstd"}) {
+            gSorterSpillCompressor = compressor;
+            std::string fileName = opts.tempDir + "/" + nextFileName();
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(opts, fileName, 0);
+            for (int i = 0; i < 1000 * 1000; i++)
+                sorter.addAlreadySorted(i, -i);
+
+            ASSERT_ITERATORS_EQUIVALENT(std::shared_ptr<IWIterator>(sorter.done()),
+                                        make_shared<IntIterator>(0, 1000 * 1000));
+
+            ASSERT_TRUE(boost::filesystem::remove(fileName));
+        }
+
+        {  // a corrupted block is detected
+            std::string fileName = opts.tempDir + "/" + nextFileName();
+            SortedFileWriter<IntWrapper, IntWrapper> sorter(opts, fileName, 0);
+            for (int i = 0; i < 1000; i++)
+                sorter.addAlreadySorted(i, -i);
+            std::shared_ptr<IWIterator> iter(sorter.done());
+
+            {
+                // Flip a bit in the data of the first block.
+                const std::streamoff offset = kBlockHeaderSize + 10;
+                std::fstream file(fileName, std::ios::in | std::ios::out | std::ios::binary);
+                file.seekg(offset);
+                const char byte = file.get();
+                file.seekp(offset);
+                file.put(byte ^ 1);
+            }
+
+            iter->openSource();
+            ASSERT_THROWS_CODE(iter->more(), AssertionException, 51097);
+            iter->closeSource();
+
+            ASSERT_TRUE(boost::filesystem::remove(fileName));
+        }
+
+        ASSERT(boost::filesystem::is_empty(tempDir.path()));
+    }
+};
 
 class MergeIteratorTests {
 public:
@@ -363,6 +413,24 @@ public:
                 mergeIterators(iterators, ASC, SortOptions().Limit(10)),
                 make_shared<LimitIterator>(10, make_shared<IntIterator>(0, 20, 1)));
         }
+        {  // test many sources, not a power of two, which run out at different times
+            const int kNumSources = 37;
+            std::vector<std::shared_ptr<IWIterator>> vec;
+            for (int i = 0; i < kNumSources; i++)
+                vec.push_back(make_shared<IntIterator>(i, kNumSources * (i + 1), kNumSources));
+            std::shared_ptr<IWIterator> mergeIter(
+                IWIterator::merge(vec, "", SortOptions(), IWComparator()));
+
+            // Source 'i' produces i, i + kNumSources, ... for i + 1 values in total.
+            std::vector<IWPair> expected;
+            for (int i = 0; i < kNumSources * kNumSources; i++) {
+                if (i / kNumSources <= i % kNumSources)
+                    expected.push_back(IWPair(i, -i));
+            }
+            std::shared_ptr<IWIterator> expectedIter =
+                make_shared<sorter::InMemIterator<IntWrapper, IntWrapper>>(expected);
+            ASSERT_ITERATORS_EQUIVALENT(mergeIter, expectedIter);
+        }
     }
 };
 
@@ -546,6 +614,50 @@ public:
 };
 
 
+template <bool Random = true>
+class ParallelLotsOfDataLittleMemory : public LotsOfDataLittleMemory<Random> {
+    SortOptions adjustSortOptions(SortOptions opts) {
+        return LotsOfDataLittleMemory<Random>::adjustSortOptions(opts).MaxThreads(4);
+    }
+};
+
+// Sorts enough data with duplicate keys to split it between threads, and checks that values with
+// the same key are returned in the order they were added.
+template <bool Spill>
+class ParallelStability : public Basic {
+    SortOptions adjustSortOptions(SortOptions opts) {
+        opts.MaxThreads(4);
+        if (Spill)
+            opts.MaxMemoryUsageBytes(MEM_LIMIT).ExtSortAllowed();
+        return opts;
+    }
+    void addData(unowned_ptr<IWSorter> sorter) {
+        for (int i = 0; i < NUM_ITEMS; i++)
+            sorter->add(i % NUM_KEYS, i);
+    }
+    virtual std::shared_ptr<IWIterator> correct() {
+        std::vector<IWPair> vec;
+        for (int key = 0; key < NUM_KEYS; key++) {
+            for (int i = key; i < NUM_ITEMS; i += NUM_KEYS)
+                vec.push_back(IWPair(key, i));
+        }
+        return make_shared<sorter::InMemIterator<IntWrapper, IntWrapper>>(vec);
+    }
+    virtual std::shared_ptr<IWIterator> correctReverse() {
+        std::vector<IWPair> vec;
+        for (int key = NUM_KEYS - 1; key >= 0; key--) {
+            for (int i = key; i < NUM_ITEMS; i += NUM_KEYS)
+                vec.push_back(IWPair(key, i));
+        }
+        return make_shared<sorter::InMemIterator<IntWrapper, IntWrapper>>(vec);
+    }
+    enum Constants {
+        NUM_ITEMS = 200 * 1000,
+        NUM_KEYS = 10,
+        MEM_LIMIT = 256 * 1024,
+    };
+};
+
 template <long long Limit, bool Random = true>
 class LotsOfDataWithLimit : public LotsOfDataLittleMemory<Random> {
     typedef LotsOfDataLittleMemory<Random> Parent;
@@ -578,12 +690,17 @@ public:
     void setupTests() {
         add<InMemIterTests>();
         add<SortedFileWriterAndFileIteratorTests>();
+        add<SpillCompressorTests>();
         add<MergeIteratorTests>();
         add<SorterTests::Basic>();
         add<SorterTests::Limit>();
         add<SorterTests::Dupes>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/false>>();
         add<SorterTests::LotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::ParallelLotsOfDataLittleMemory</*random=*/false>>();
+        add<SorterTests::ParallelLotsOfDataLittleMemory</*random=*/true>>();
+        add<SorterTests::ParallelStability</*spill=*/false>>();
+        add<SorterTests::ParallelStability</*spill=*/true>>();
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/false>>();     // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<1, /*random=*/true>>();      // limit=1 is special case
         add<SorterTests::LotsOfDataWithLimit<100, /*random=*/false>>();   // fits in mem
@@ -0,0 +1,141 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/backup_cursor_service.h"
+
+#include "mongo/base/init.h"
+#include "mongo/db/operation_context.h"
+#include "mongo/db/storage/recovery_unit.h"
+#include "mongo/db/storage/storage_engine.h"
+#include "mongo/db/storage/storage_options.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+MONGO_INITIALIZER(RegisterBackupCursorService)(InitializerContext* context) {
+    BackupCursorHooks::registerInitializer([](StorageEngine* storageEngine) {
+        return stdx::make_unique<BackupCursorService>(storageEngine);
+    });
+    return Status::OK();
+}
+
+BackupCursorService::BackupCursorService(StorageEngine* storageEngine)
+    : _storageEngine(storageEngine) {}
+
+void BackupCursorService::fsyncLock(OperationContext* opCtx) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    uassert(51103, "The node is already fsyncLocked.", _state != State::kFsyncLocked);
+    uassert(51104,
+            "The existing backup cursor must be closed before fsyncLock can succeed.",
+            _state != State::kBackupCursorOpened);
+    uassertStatusOK(_storageEngine->beginBackup(opCtx));
+    _state = State::kFsyncLocked;
+}
+
+void BackupCursorService::fsyncUnlock(OperationContext* opCtx) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    uassert(51105, "The node is not fsyncLocked.", _state == State::kFsyncLocked);
+    _storageEngine->endBackup(opCtx);
+    _state = State::kInactive;
+}
+
+BackupCursorState BackupCursorService::openBackupCursor(OperationContext* opCtx) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    uassert(51106, "The node is currently fsyncLocked.", _state != State::kFsyncLocked);
+    uassert(51107,
+            "The existing backup cursor must be closed before $backupCursor can succeed.",
+            _state != State::kBackupCursorOpened);
+
+    auto filenames = uassertStatusOK(_storageEngine->beginNonBlockingBackup(opCtx));
+    const auto checkpointTimestamp = _storageEngine->getLastStableRecoveryTimestamp();
+
+    _state = State::kBackupCursorOpened;
+    _activeBackupId = UUID::gen();
+    log() << "Opened backup cursor " << *_activeBackupId << " on " << filenames.size()
+          << " files";
+
+    MutableDocument metadata;
+    metadata["backupId"] = Value(*_activeBackupId);
+    metadata["dbpath"] = Value(storageGlobalParams.dbpath);
+    if (checkpointTimestamp) {
+        metadata["checkpointTimestamp"] = Value(*checkpointTimestamp);
+    }
+    return {*_activeBackupId,
+            Document{{"metadata", metadata.freezeToValue()}},
+            std::move(filenames)};
+}
+
+void BackupCursorService::closeBackupCursor(OperationContext* opCtx, const UUID& backupId) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    uassert(51108, "There is no backup cursor to close.", _state == State::kBackupCursorOpened);
+    uassert(51109,
+            str::stream() << "Can only close the running backup cursor. To close: " << backupId
+                          << " Running: "
+                          << *_activeBackupId,
+            backupId == *_activeBackupId);
+
+    _storageEngine->endNonBlockingBackup(opCtx);
+    log() << "Closed backup cursor " << backupId;
+    _state = State::kInactive;
+    _activeBackupId = boost::none;
+}
+
+BackupCursorExtendState BackupCursorService::extendBackupCursor(OperationContext* opCtx,
+                                                                const UUID& backupId,
+                                                                const Timestamp& extendTo) {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    uassert(51110, "There is no backup cursor to extend.", _state == State::kBackupCursorOpened);
+    uassert(51111,
+            str::stream() << "Can only extend the running backup cursor. To extend: " << backupId
+                          << " Running: "
+                          << *_activeBackupId,
+            backupId == *_activeBackupId);
+    uassert(51112,
+            str::stream() << "Cannot extend the backup cursor to " << extendTo.toString()
+                          << ", which is later than the latest committed write",
+            extendTo <= _storageEngine->getAllCommittedTimestamp());
+
+    // Flush the journal so that the journal files returned hold every write up to 'extendTo'.
+    opCtx->recoveryUnit()->waitUntilDurable();
+    auto filenames = uassertStatusOK(_storageEngine->extendBackupCursor(opCtx));
+    return {std::move(filenames)};
+}
+
+bool BackupCursorService::isBackupCursorOpen() const {
+    stdx::lock_guard<stdx::mutex> lk(_mutex);
+    return _state == State::kBackupCursorOpened;
+}
+
+}  // namespace mongo
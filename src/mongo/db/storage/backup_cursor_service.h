@@ -0,0 +1,92 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/optional.hpp>
+
+#include "mongo/db/storage/backup_cursor_hooks.h"
+#include "mongo/stdx/mutex.h"
+#include "mongo/util/uuid.h"
+
+namespace mongo {
+
+/**
+ * Implements backup cursors on top of the storage engine's non-blocking backup support.
+ *
+ * At most one backup cursor can be open at a time, and a backup cursor cannot be opened while the
+ * node is fsyncLocked, nor the other way around. While a backup cursor is open, the storage engine
+ * keeps the checkpoint it describes, and the oplog needed to recover from it, on disk.
+ */
+class BackupCursorService final : public BackupCursorHooks {
+public:
+    explicit BackupCursorService(StorageEngine* storageEngine);
+
+    bool enabled() const override {
+        return true;
+    }
+
+    void fsyncLock(OperationContext* opCtx) override;
+
+    void fsyncUnlock(OperationContext* opCtx) override;
+
+    /**
+     * Opens a backup cursor on the most recent checkpoint. The preamble holds the backup's id, the
+     * data directory the returned file names are relative to, and the checkpoint's timestamp when
+     * the storage engine takes stable checkpoints.
+     */
+    BackupCursorState openBackupCursor(OperationContext* opCtx) override;
+
+    void closeBackupCursor(OperationContext* opCtx, const UUID& backupId) override;
+
+    /**
+     * Returns the journal files which must be copied in addition to the ones returned when the
+     * backup cursor was opened so that the backup includes all writes up to 'extendTo', which must
+     * already be committed.
+     */
+    BackupCursorExtendState extendBackupCursor(OperationContext* opCtx,
+                                               const UUID& backupId,
+                                               const Timestamp& extendTo) override;
+
+    bool isBackupCursorOpen() const override;
+
+private:
+    enum class State { kInactive, kFsyncLocked, kBackupCursorOpened };
+
+    StorageEngine* const _storageEngine;
+
+    mutable stdx::mutex _mutex;
+    State _state = State::kInactive;  // (M)
+
+    // The id of the open backup cursor, if there is one.
+    boost::optional<UUID> _activeBackupId;  // (M)
+};
+
+}  // namespace mongo
@@ -0,0 +1,284 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#define MONGO_LOG_DEFAULT_COMPONENT ::mongo::logger::LogComponent::kStorage
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/biggie/biggie_checkpoint.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "mongo/base/data_range_cursor.h"
+#include "mongo/base/data_type_endian.h"
+#include "mongo/base/data_view.h"
+#include "mongo/db/storage/storage_file_util.h"
+#include "mongo/util/log.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+namespace biggie {
+namespace {
+
+const uint32_t kCheckpointMagic = 0x42494743;  // "BIGC"
+const uint32_t kCheckpointVersion = 1;
+
+const uint64_t kFnvOffsetBasis = 14695981039346656037ULL;
+const uint64_t kFnvPrime = 1099511628211ULL;
+
+uint64_t fnv1a(uint64_t hash, const char* data, size_t len) {
+    for (size_t i = 0; i < len; ++i) {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= kFnvPrime;
+    }
+    return hash;
+}
+
+/**
+ * Writes little-endian integers and length-prefixed strings to a file while keeping a running
+ * checksum of everything written.
+ */
+class CheckpointWriter {
+public:
+    explicit CheckpointWriter(std::ofstream* stream) : _stream(stream) {}
+
+    void writeUInt8(uint8_t value) {
+        _write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    void writeUInt32(uint32_t value) {
+        char buf[sizeof(value)];
+        DataView(buf).write(tagLittleEndian(value));
+        _write(buf, sizeof(buf));
+    }
+
+    void writeUInt64(uint64_t value) {
+        char buf[sizeof(value)];
+        DataView(buf).write(tagLittleEndian(value));
+        _write(buf, sizeof(buf));
+    }
+
+    void writeString(const std::string& value) {
+        writeUInt32(value.size());
+        _write(value.data(), value.size());
+    }
+
+    uint64_t checksum() const {
+        return _checksum;
+    }
+
+private:
+    void _write(const char* data, size_t len) {
+        _checksum = fnv1a(_checksum, data, len);
+        _stream->write(data, len);
+    }
+
+    std::ofstream* _stream;
+    uint64_t _checksum = kFnvOffsetBasis;
+};
+
+Status truncatedStatus(const boost::filesystem::path& path) {
+    return {ErrorCodes::FileStreamFailed,
+            str::stream() << "biggie checkpoint " << path.generic_string() << " is truncated"};
+}
+
+StatusWith<std::string> readString(ConstDataRangeCursor* cursor) {
+    auto swLen = cursor->readAndAdvance<LittleEndian<uint32_t>>();
+    if (!swLen.isOK()) {
+        return swLen.getStatus();
+    }
+    const uint32_t len = swLen.getValue();
+    if (len > cursor->length()) {
+        return {ErrorCodes::Overflow, "string extends past the end of the checkpoint"};
+    }
+    std::string value(cursor->data(), len);
+    cursor->advance(len).transitional_ignore();
+    return {std::move(value)};
+}
+
+}  // namespace
+
+Status saveCheckpoint(const boost::filesystem::path& path,
+                      const std::map<std::string, bool>& idents,
+                      const StringStore& store) {
+    boost::filesystem::path tempPath(path);
+    tempPath += ".tmp";
+
+    std::ofstream stream;
+    stream.open(tempPath.c_str(),
+                std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+    if (!stream.is_open()) {
+        return {ErrorCodes::FileNotOpen,
+                "Failed to open biggie checkpoint file " + tempPath.generic_string()};
+    }
+
+    CheckpointWriter writer(&stream);
+    writer.writeUInt32(kCheckpointMagic);
+    writer.writeUInt32(kCheckpointVersion);
+
+    writer.writeUInt64(idents.size());
+    for (auto&& ident : idents) {
+        writer.writeString(ident.first);
+        writer.writeUInt8(ident.second ? 1 : 0);
+    }
+
+    writer.writeUInt64(store.size());
+    for (auto&& entry : store) {
+        writer.writeString(entry.first);
+        writer.writeString(entry.second);
+    }
+
+    // The checksum covers everything before it, so it is written without being added to itself.
+    const uint64_t checksum = writer.checksum();
+    writer.writeUInt64(checksum);
+
+    stream.close();
+    if (stream.fail()) {
+        return {ErrorCodes::FileStreamFailed,
+                "Failed to write biggie checkpoint file " + tempPath.generic_string()};
+    }
+
+    // The new checkpoint must be durable before it replaces the previous one, and the rename must
+    // be durable before the checkpoint is reported as written.
+    auto status = fsyncFile(tempPath);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    boost::system::error_code ec;
+    boost::filesystem::rename(tempPath, path, ec);
+    if (ec) {
+        return {ErrorCodes::FileRenameFailed, ec.message()};
+    }
+
+    status = fsyncParentDirectory(path);
+    if (!status.isOK()) {
+        return status;
+    }
+
+    LOG(1) << "Wrote biggie checkpoint of " << store.size() << " entries and " << idents.size()
+           << " idents to " << path.generic_string();
+    return Status::OK();
+}
+
+Status loadCheckpoint(const boost::filesystem::path& path,
+                      std::map<std::string, bool>* idents,
+                      StringStore* store) {
+    invariant(idents->empty());
+    invariant(store->empty());
+
+    boost::system::error_code ec;
+    const auto fileSize = boost::filesystem::file_size(path, ec);
+    if (ec) {
+        return {ErrorCodes::FileStreamFailed, ec.message()};
+    }
+
+    std::string buf(fileSize, '\0');
+    std::ifstream stream(path.c_str(), std::ios_base::in | std::ios_base::binary);
+    if (!stream.is_open()) {
+        return {ErrorCodes::FileNotOpen,
+                "Failed to open biggie checkpoint file " + path.generic_string()};
+    }
+    stream.read(&buf[0], buf.size());
+    if (stream.fail()) {
+        return {ErrorCodes::FileStreamFailed,
+                "Failed to read biggie checkpoint file " + path.generic_string()};
+    }
+
+    const size_t kChecksumSize = sizeof(uint64_t);
+    if (buf.size() < kChecksumSize) {
+        return truncatedStatus(path);
+    }
+    const size_t bodySize = buf.size() - kChecksumSize;
+    const uint64_t expectedChecksum =
+        ConstDataView(buf.data() + bodySize).read<LittleEndian<uint64_t>>();
+    if (fnv1a(kFnvOffsetBasis, buf.data(), bodySize) != expectedChecksum) {
+        return {ErrorCodes::FileStreamFailed,
+                str::stream() << "biggie checkpoint " << path.generic_string()
+                              << " failed its checksum"};
+    }
+
+    ConstDataRangeCursor cursor(buf.data(), buf.data() + bodySize);
+    auto swMagic = cursor.readAndAdvance<LittleEndian<uint32_t>>();
+    auto swVersion = cursor.readAndAdvance<LittleEndian<uint32_t>>();
+    if (!swMagic.isOK() || !swVersion.isOK()) {
+        return truncatedStatus(path);
+    }
+    if (swMagic.getValue() != kCheckpointMagic || swVersion.getValue() != kCheckpointVersion) {
+        return {ErrorCodes::UnsupportedFormat,
+                str::stream() << "biggie checkpoint " << path.generic_string()
+                              << " has an unsupported format version"};
+    }
+
+    std::map<std::string, bool> loadedIdents;
+    auto swNumIdents = cursor.readAndAdvance<LittleEndian<uint64_t>>();
+    if (!swNumIdents.isOK()) {
+        return truncatedStatus(path);
+    }
+    for (uint64_t i = 0; i < swNumIdents.getValue(); ++i) {
+        auto swIdent = readString(&cursor);
+        auto swIsRecordStore = cursor.readAndAdvance<LittleEndian<uint8_t>>();
+        if (!swIdent.isOK() || !swIsRecordStore.isOK()) {
+            return truncatedStatus(path);
+        }
+        loadedIdents[swIdent.getValue()] = swIsRecordStore.getValue() != 0;
+    }
+
+    StringStore loadedStore;
+    auto swNumEntries = cursor.readAndAdvance<LittleEndian<uint64_t>>();
+    if (!swNumEntries.isOK()) {
+        return truncatedStatus(path);
+    }
+    for (uint64_t i = 0; i < swNumEntries.getValue(); ++i) {
+        auto swKey = readString(&cursor);
+        auto swValue = readString(&cursor);
+        if (!swKey.isOK() || !swValue.isOK()) {
+            return truncatedStatus(path);
+        }
+        loadedStore.insert(
+            StringStore::value_type(std::move(swKey.getValue()), std::move(swValue.getValue())));
+    }
+    if (!cursor.empty()) {
+        return {ErrorCodes::FileStreamFailed,
+                str::stream() << "biggie checkpoint " << path.generic_string()
+                              << " has trailing data"};
+    }
+
+    *idents = std::move(loadedIdents);
+    *store = std::move(loadedStore);
+
+    log() << "Restored biggie checkpoint of " << store->size() << " entries and "
+          << idents->size() << " idents from " << path.generic_string();
+    return Status::OK();
+}
+
+}  // namespace biggie
+}  // namespace mongo
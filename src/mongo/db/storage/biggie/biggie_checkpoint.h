@@ -0,0 +1,66 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#pragma once
+
+#include <boost/filesystem/path.hpp>
+#include <map>
+#include <string>
+
+#include "mongo/base/status.h"
+#include "mongo/db/storage/biggie/store.h"
+
+namespace mongo {
+namespace biggie {
+
+/**
+ * The name of the file, relative to the dbpath, which holds the biggie checkpoint.
+ */
+constexpr auto kCheckpointFileName = "biggie.checkpoint"_sd;
+
+/**
+ * Writes the contents of 'store' and the ident catalog 'idents' to 'path'. The checkpoint is first
+ * written to a temporary file next to 'path' which is then renamed over it, so a crash while
+ * writing leaves any previous checkpoint intact.
+ */
+Status saveCheckpoint(const boost::filesystem::path& path,
+                      const std::map<std::string, bool>& idents,
+                      const StringStore& store);
+
+/**
+ * Reads a checkpoint written by saveCheckpoint() into 'idents' and 'store', which must be empty.
+ * Returns an error without modifying either if the file is truncated or fails its checksum.
+ */
+Status loadCheckpoint(const boost::filesystem::path& path,
+                      std::map<std::string, bool>* idents,
+                      StringStore* store);
+
+}  // namespace biggie
+}  // namespace mongo
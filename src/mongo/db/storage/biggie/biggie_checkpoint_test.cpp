@@ -0,0 +1,210 @@
+/**
+ *    Copyright (C) 2019-present MongoDB, Inc.
+ *
+ *    This program is free software: you can redistribute it and/or modify
+ *    it under the terms of the Server Side Public License, version 1,
+ *    as published by MongoDB, Inc.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    Server Side Public License for more details.
+ *
+ *    You should have received a copy of the Server Side Public License
+ *    along with this program. If not, see
+ *    <http://www.mongodb.com/licensing/server-side-public-license>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the Server Side Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/storage/biggie/biggie_checkpoint.h"
+
+#include <boost/filesystem.hpp>
+#include <fstream>
+
+#include "mongo/db/catalog/collection_options.h"
+#include "mongo/db/service_context_test_fixture.h"
+#include "mongo/db/storage/biggie/biggie_kv_engine.h"
+#include "mongo/db/storage/write_unit_of_work.h"
+#include "mongo/stdx/thread.h"
+#include "mongo/unittest/temp_dir.h"
+#include "mongo/unittest/unittest.h"
+
+namespace mongo {
+namespace biggie {
+namespace {
+
+using value_type = StringStore::value_type;
+
+class BiggieCheckpointTest : public ServiceContextTest {
+public:
+    BiggieCheckpointTest() : _dir("biggie_checkpoint_test") {}
+
+    boost::filesystem::path checkpointPath() {
+        return boost::filesystem::path(_dir.path()) / kCheckpointFileName.toString();
+    }
+
+    std::string readFile(const boost::filesystem::path& path) {
+        std::ifstream stream(path.c_str(), std::ios_base::in | std::ios_base::binary);
+        return std::string(std::istreambuf_iterator<char>(stream), {});
+    }
+
+    void writeFile(const boost::filesystem::path& path, const std::string& contents) {
+        std::ofstream stream(path.c_str(),
+                             std::ios_base::out | std::ios_base::binary | std::ios_base::trunc);
+        stream.write(contents.data(), contents.size());
+    }
+
+    ServiceContext::UniqueOperationContext makeOperationContext(KVEngine* engine) {
+        auto opCtx = ServiceContextTest::makeOperationContext();
+        opCtx->setRecoveryUnit(std::unique_ptr<mongo::RecoveryUnit>(engine->newRecoveryUnit()),
+                               WriteUnitOfWork::RecoveryUnitState::kNotInUnitOfWork);
+        return opCtx;
+    }
+
+private:
+    unittest::TempDir _dir;
+};
+
+TEST_F(BiggieCheckpointTest, RoundTrip) {
+    StringStore store;
+    store.insert(value_type("a", "1"));
+    store.insert(value_type("ab", ""));
+    store.insert(value_type("abc", std::string("\0\1\2", 3)));
+    store.insert(value_type("b", std::string(100000, 'x')));
+    std::map<std::string, bool> idents{{"collection-1", true}, {"index-2", false}};
+
+    ASSERT_OK(saveCheckpoint(checkpointPath(), idents, store));
+
+    StringStore loadedStore;
+    std::map<std::string, bool> loadedIdents;
+    ASSERT_OK(loadCheckpoint(checkpointPath(), &loadedIdents, &loadedStore));
+    ASSERT(loadedIdents == idents);
+    ASSERT_EQ(loadedStore.size(), store.size());
+    ASSERT_EQ(loadedStore.dataSize(), store.dataSize());
+    for (auto&& entry : store) {
+        auto it = loadedStore.find(entry.first);
+        ASSERT(it != loadedStore.end());
+        ASSERT_EQ(it->second, entry.second);
+    }
+}
+
+TEST_F(BiggieCheckpointTest, OverwritesPreviousCheckpoint) {
+    StringStore store;
+    store.insert(value_type("a", "1"));
+    ASSERT_OK(saveCheckpoint(checkpointPath(), {}, store));
+    store.erase("a");
+    store.insert(value_type("b", "2"));
+    ASSERT_OK(saveCheckpoint(checkpointPath(), {}, store));
+
+    StringStore loadedStore;
+    std::map<std::string, bool> loadedIdents;
+    ASSERT_OK(loadCheckpoint(checkpointPath(), &loadedIdents, &loadedStore));
+    ASSERT_EQ(1U, loadedStore.size());
+    ASSERT(loadedStore.find("b") != loadedStore.end());
+}
+
+TEST_F(BiggieCheckpointTest, RejectsCorruptCheckpoints) {
+    StringStore store;
+    store.insert(value_type("key", "value"));
+    ASSERT_OK(saveCheckpoint(checkpointPath(), {{"collection-1", true}}, store));
+    const std::string contents = readFile(checkpointPath());
+
+    std::string flipped = contents;
+    flipped[flipped.size() / 2] ^= 0x1;
+    writeFile(checkpointPath(), flipped);
+    StringStore loadedStore;
+    std::map<std::string, bool> loadedIdents;
+    ASSERT_NOT_OK(loadCheckpoint(checkpointPath(), &loadedIdents, &loadedStore));
+
+    writeFile(checkpointPath(), contents.substr(0, contents.size() - 1));
+    ASSERT_NOT_OK(loadCheckpoint(checkpointPath(), &loadedIdents, &loadedStore));
+
+    writeFile(checkpointPath(), "");
+    ASSERT_NOT_OK(loadCheckpoint(checkpointPath(), &loadedIdents, &loadedStore));
+
+    ASSERT(loadedIdents.empty());
+    ASSERT(loadedStore.empty());
+}
+
+TEST_F(BiggieCheckpointTest, EngineRestoresRecordStoresOnRestart) {
+    const CollectionOptions options;
+    RecordId lastId;
+    {
+        KVEngine engine(checkpointPath());
+        auto opCtx = makeOperationContext(&engine);
+        ASSERT_OK(engine.createRecordStore(opCtx.get(), "a.b", "collection-1", options));
+        auto rs = engine.getRecordStore(opCtx.get(), "a.b", "collection-1", options);
+        WriteUnitOfWork wuow(opCtx.get());
+        for (int i = 0; i < 10; ++i) {
+            auto swId = rs->insertRecord(opCtx.get(), "abcd", 4, Timestamp());
+            ASSERT_OK(swId.getStatus());
+            lastId = swId.getValue();
+        }
+        wuow.commit();
+        engine.cleanShutdown();
+    }
+
+    KVEngine engine(checkpointPath());
+    auto opCtx = makeOperationContext(&engine);
+    ASSERT_EQ(1U, engine.getAllIdents(opCtx.get()).size());
+    auto rs = engine.getRecordStore(opCtx.get(), "a.b", "collection-1", options);
+    ASSERT_EQ(10, rs->numRecords(opCtx.get()));
+    ASSERT_EQ(40, rs->dataSize(opCtx.get()));
+
+    // New records are not assigned the ids of restored ones.
+    WriteUnitOfWork wuow(opCtx.get());
+    auto swId = rs->insertRecord(opCtx.get(), "efgh", 4, Timestamp());
+    ASSERT_OK(swId.getStatus());
+    ASSERT_GT(swId.getValue(), lastId);
+    wuow.commit();
+    ASSERT_EQ(11, rs->numRecords(opCtx.get()));
+}
+
+TEST_F(BiggieCheckpointTest, ConcurrentCheckpointsWhileCreatingIdents) {
+    KVEngine engine(checkpointPath());
+    const CollectionOptions options;
+
+    // Threads checkpointing while others create idents must each leave a complete checkpoint.
+    const int kNumThreads = 4;
+    const int kNumIterations = 20;
+    std::vector<stdx::thread> threads;
+    for (int t = 0; t < kNumThreads; ++t) {
+        threads.emplace_back([&, t] {
+            auto client = getServiceContext()->makeClient(str::stream() << "checkpoint-" << t);
+            auto opCtx = client->makeOperationContext();
+            for (int i = 0; i < kNumIterations; ++i) {
+                const std::string ident = str::stream() << "collection-" << t << "-" << i;
+                ASSERT_OK(engine.createRecordStore(opCtx.get(), "a.b", ident, options));
+                engine.flushAllFiles(opCtx.get(), true);
+            }
+        });
+    }
+    for (auto&& thread : threads) {
+        thread.join();
+    }
+    engine.cleanShutdown();
+
+    StringStore loadedStore;
+    std::map<std::string, bool> loadedIdents;
+    ASSERT_OK(loadCheckpoint(checkpointPath(), &loadedIdents, &loadedStore));
+    ASSERT_EQ(static_cast<size_t>(kNumThreads * kNumIterations), loadedIdents.size());
+    ASSERT_FALSE(boost::filesystem::exists(checkpointPath().string() + ".tmp"));
+}
+
+}  // namespace
+}  // namespace biggie
+}  // namespace mongo
@@ -31,7 +31,9 @@
 
 #include "mongo/base/init.h"
 #include "mongo/db/service_context.h"
+#include "mongo/db/storage/biggie/biggie_checkpoint.h"
 #include "mongo/db/storage/biggie/biggie_kv_engine.h"
+#include "mongo/db/storage/biggie/biggie_parameters_gen.h"
 #include "mongo/db/storage/kv/kv_storage_engine.h"
 #include "mongo/db/storage/storage_engine_init.h"
 #include "mongo/db/storage/storage_options.h"
@@ -47,7 +49,12 @@ public:
         KVStorageEngineOptions options;
         options.directoryPerDB = params.directoryperdb;
         options.forRepair = params.repair;
-        return new KVStorageEngine(new KVEngine(), options);
+        if (!gBiggieCheckpoint) {
+            return new KVStorageEngine(new KVEngine(), options);
+        }
+        auto checkpointPath =
+            boost::filesystem::path(params.dbpath) / kCheckpointFileName.toString();
+        return new KVStorageEngine(new KVEngine(std::move(checkpointPath)), options);
     }
 
     virtual StringData getCanonicalName() const {
@@ -31,19 +31,63 @@
 
 #include "mongo/platform/basic.h"
 
+#include <boost/filesystem/operations.hpp>
+
 #include "mongo/base/disallow_copying.h"
 #include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/snapshot_window_options.h"
+#include "mongo/db/storage/biggie/biggie_checkpoint.h"
 #include "mongo/db/storage/biggie/biggie_kv_engine.h"
 #include "mongo/db/storage/biggie/biggie_recovery_unit.h"
 #include "mongo/db/storage/key_string.h"
 #include "mongo/db/storage/record_store.h"
 #include "mongo/db/storage/sorted_data_interface.h"
 #include "mongo/stdx/memory.h"
+#include "mongo/util/log.h"
 
 namespace mongo {
 namespace biggie {
 
+KVEngine::KVEngine(boost::filesystem::path checkpointPath)
+    : mongo::KVEngine(), _checkpointPath(std::move(checkpointPath)) {
+    if (_checkpointPath.empty() || !boost::filesystem::exists(_checkpointPath)) {
+        return;
+    }
+    uassertStatusOK(loadCheckpoint(_checkpointPath, &_idents, &_master));
+    for (auto&& ident : _idents) {
+        if (ident.second) {
+            _restoredRecordStores.insert(ident.first);
+        }
+    }
+}
+
+void KVEngine::cleanShutdown() {
+    Status status = _saveCheckpoint();
+    if (!status.isOK()) {
+        error() << "Failed to write biggie checkpoint on shutdown: " << status;
+    }
+}
+
+int KVEngine::flushAllFiles(OperationContext* opCtx, bool sync) {
+    uassertStatusOK(_saveCheckpoint());
+    return 0;
+}
+
+Status KVEngine::_saveCheckpoint() {
+    if (_checkpointPath.empty()) {
+        return Status::OK();
+    }
+    stdx::lock_guard<stdx::mutex> checkpointLock(_checkpointMutex);
+    std::map<std::string, bool> idents;
+    {
+        stdx::lock_guard<stdx::mutex> lock(_identsLock);
+        idents = _idents;
+    }
+    // Copying the master is cheap as the copy shares its nodes with the original.
+    auto master = getMasterInfo().second;
+    return saveCheckpoint(_checkpointPath, idents, master);
+}
+
 mongo::RecoveryUnit* KVEngine::newRecoveryUnit() {
     return new RecoveryUnit(this, nullptr);
 }
@@ -56,6 +100,7 @@ Status KVEngine::createRecordStore(OperationContext* opCtx,
                                    StringData ns,
                                    StringData ident,
                                    const CollectionOptions& options) {
+    stdx::lock_guard<stdx::mutex> lock(_identsLock);
     _idents[ident.toString()] = true;
     return Status::OK();
 }
@@ -64,6 +109,7 @@ std::unique_ptr<mongo::RecordStore> KVEngine::makeTemporaryRecordStore(Operation
                                                                        StringData ident) {
     std::unique_ptr<mongo::RecordStore> recordStore =
         std::make_unique<RecordStore>("", ident, false);
+    stdx::lock_guard<stdx::mutex> lock(_identsLock);
     _idents[ident.toString()] = true;
     return recordStore;
 };
@@ -88,7 +134,16 @@ std::unique_ptr<mongo::RecordStore> KVEngine::getRecordStore(OperationContext* o
     } else {
         recordStore = std::make_unique<RecordStore>(ns, ident, options.capped);
     }
-    _idents[ident.toString()] = true;
+    bool restored;
+    {
+        stdx::lock_guard<stdx::mutex> lock(_identsLock);
+        restored = _restoredRecordStores.erase(ident.toString());
+        _idents[ident.toString()] = true;
+    }
+    if (restored) {
+        checked_cast<RecordStore*>(recordStore.get())
+            ->initializeStatsFromStore(getMasterInfo().second);
+    }
     return recordStore;
 }
 
@@ -106,6 +161,7 @@ bool KVEngine::trySwapMaster(StringStore& newMaster, uint64_t version) {
 Status KVEngine::createSortedDataInterface(OperationContext* opCtx,
                                            StringData ident,
                                            const IndexDescriptor* desc) {
+    stdx::lock_guard<stdx::mutex> lock(_identsLock);
     _idents[ident.toString()] = false;
     return Status::OK();  // I don't think we actually need to do anything here
 }
@@ -113,16 +169,27 @@ Status KVEngine::createSortedDataInterface(OperationContext* opCtx,
 mongo::SortedDataInterface* KVEngine::getSortedDataInterface(OperationContext* opCtx,
                                                              StringData ident,
                                                              const IndexDescriptor* desc) {
-    _idents[ident.toString()] = false;
+    {
+        stdx::lock_guard<stdx::mutex> lock(_identsLock);
+        _idents[ident.toString()] = false;
+    }
     return new SortedDataInterface(opCtx, ident, desc);
 }
 
 Status KVEngine::dropIdent(OperationContext* opCtx, StringData ident) {
     Status dropStatus = Status::OK();
-    if (_idents.count(ident.toString()) > 0) {
+    boost::optional<bool> isRecordStore;
+    {
+        stdx::lock_guard<stdx::mutex> lock(_identsLock);
+        auto it = _idents.find(ident.toString());
+        if (it != _idents.end()) {
+            isRecordStore = it->second;
+        }
+    }
+    if (isRecordStore) {
         // Check if the ident is a RecordStore or a SortedDataInterface then call the corresponding
         // truncate. A true value in the map means it is a RecordStore, false a SortedDataInterface.
-        if (_idents[ident.toString()] == true) {  // ident is RecordStore.
+        if (*isRecordStore) {  // ident is RecordStore.
             CollectionOptions s;
             auto rs = getRecordStore(opCtx, ""_sd, ident, s);
             dropStatus = checked_cast<RecordStore*>(rs.get())
@@ -133,6 +200,7 @@ Status KVEngine::dropIdent(OperationContext* opCtx, StringData ident) {
                 std::make_unique<SortedDataInterface>(Ordering::make(BSONObj()), true, ident);
             dropStatus = sdi->truncate(opCtx);
         }
+        stdx::lock_guard<stdx::mutex> lock(_identsLock);
         _idents.erase(ident.toString());
     }
     return dropStatus;
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <boost/filesystem/path.hpp>
 #include <memory>
 #include <mutex>
 #include <set>
@@ -49,6 +50,12 @@ class KVEngine : public mongo::KVEngine {
 public:
     KVEngine() : mongo::KVEngine() {}
 
+    /**
+     * Constructs an engine which restores its data from the checkpoint at 'checkpointPath' if one
+     * exists, and writes a new checkpoint there on clean shutdown and whenever files are flushed.
+     */
+    explicit KVEngine(boost::filesystem::path checkpointPath);
+
     virtual ~KVEngine() {}
 
     virtual mongo::RecoveryUnit* newRecoveryUnit();
@@ -125,6 +132,7 @@ public:
     }
 
     std::vector<std::string> getAllIdents(OperationContext* opCtx) const {
+        stdx::lock_guard<stdx::mutex> lock(_identsLock);
         std::vector<std::string> idents;
         for (const auto& i : _idents) {
             idents.push_back(i.first);
@@ -132,7 +140,9 @@ public:
         return idents;
     }
 
-    virtual void cleanShutdown(){};
+    virtual void cleanShutdown();
+
+    virtual int flushAllFiles(OperationContext* opCtx, bool sync) override;
 
     void setJournalListener(mongo::JournalListener* jl) final {}
 
@@ -162,11 +172,29 @@ public:
     bool trySwapMaster(StringStore& newMaster, uint64_t version);
 
 private:
+    /**
+     * Writes the current master and ident catalog to the checkpoint path. Does nothing if the
+     * engine was not constructed with one. Concurrent callers write one checkpoint at a time.
+     */
+    Status _saveCheckpoint();
+
     std::shared_ptr<void> _catalogInfo;
     int _cachePressureForTest = 0;
+
+    // Protects '_idents' and '_restoredRecordStores'.
+    mutable stdx::mutex _identsLock;
     std::map<std::string, bool> _idents;  // TODO : replace with a query to _master.
     std::unique_ptr<VisibilityManager> _visibilityManager;
 
+    // Empty when checkpointing is disabled.
+    boost::filesystem::path _checkpointPath;
+
+    // Held while writing a checkpoint, as every checkpoint goes through the same temporary file.
+    stdx::mutex _checkpointMutex;
+
+    // Record stores restored from the checkpoint whose statistics have not yet been recomputed.
+    std::set<std::string> _restoredRecordStores;
+
     mutable stdx::mutex _masterLock;
     StringStore _master;
     uint64_t _masterVersion = 0;
@@ -414,6 +414,25 @@ void RecordStore::updateStatsAfterRepair(OperationContext* opCtx,
     _dataSize.store(dataSize);
 }
 
+void RecordStore::initializeStatsFromStore(const StringStore& store) {
+    long long numRecords = 0;
+    long long dataSize = 0;
+    boost::optional<RecordId> highestRecordId;
+
+    StringStore::const_iterator end = store.upper_bound(_postfix);
+    for (auto it = store.lower_bound(_prefix); it != end; ++it) {
+        ++numRecords;
+        dataSize += it->second.size();
+        highestRecordId = extractRecordId(it->first);
+    }
+
+    _numRecords.store(numRecords);
+    _dataSize.store(dataSize);
+    if (highestRecordId && highestRecordId->repr() >= _highestRecordId.load()) {
+        _highestRecordId.store(highestRecordId->repr() + 1);
+    }
+}
+
 void RecordStore::waitForAllEarlierOplogWritesToBeVisible(OperationContext* opCtx) const {
     _visibilityManager->waitForAllEarlierOplogWritesToBeVisible(opCtx);
 }
@@ -524,6 +543,42 @@ boost::optional<Record> RecordStore::Cursor::next() {
     return boost::none;
 }
 
+void RecordStore::Cursor::nextBatch(std::vector<Record>* records, size_t maxRecords) {
+    invariant(maxRecords > 0);
+    records->clear();
+
+    // Unlike next(), look up the working copy and the visible end of the oplog once per batch, and
+    // only remember the position of the last record. The records point into the tree held by 'it',
+    // which is kept alive even if the working copy is modified before the cursor moves on.
+    _savedPosition = boost::none;
+    StringStore* workingCopy(RecoveryUnit::get(opCtx)->getHead());
+    if (_needFirstSeek) {
+        _needFirstSeek = false;
+        it = workingCopy->lower_bound(_prefix);
+    } else if (it != workingCopy->end() && !_lastMoveWasRestore) {
+        ++it;
+    }
+    _lastMoveWasRestore = false;
+
+    const RecordId visibleEnd =
+        _isOplog ? _visibilityManager->getAllCommittedRecord() : RecordId::max();
+    while (it != workingCopy->end() && inPrefix(it->first)) {
+        RecordId id(extractRecordId(it->first));
+        if (id > visibleEnd) {
+            break;
+        }
+        records->push_back({id, RecordData(it->second.c_str(), it->second.length())});
+        if (records->size() == maxRecords) {
+            break;
+        }
+        ++it;
+    }
+
+    if (it != workingCopy->end() && inPrefix(it->first)) {
+        _savedPosition = it->first;
+    }
+}
+
 boost::optional<Record> RecordStore::Cursor::seekExact(const RecordId& id) {
     _savedPosition = boost::none;
     _lastMoveWasRestore = false;
@@ -605,6 +660,41 @@ boost::optional<Record> RecordStore::ReverseCursor::next() {
     return boost::none;
 }
 
+void RecordStore::ReverseCursor::nextBatch(std::vector<Record>* records, size_t maxRecords) {
+    invariant(maxRecords > 0);
+    records->clear();
+
+    // As for the forward cursor, the working copy and the visible end of the oplog are looked up
+    // once per batch.
+    _savedPosition = boost::none;
+    StringStore* workingCopy(RecoveryUnit::get(opCtx)->getHead());
+    if (_needFirstSeek) {
+        _needFirstSeek = false;
+        it = StringStore::const_reverse_iterator(workingCopy->upper_bound(_postfix));
+    } else if (it != workingCopy->rend() && !_lastMoveWasRestore) {
+        ++it;
+    }
+    _lastMoveWasRestore = false;
+
+    const RecordId visibleEnd =
+        _isOplog ? _visibilityManager->getAllCommittedRecord() : RecordId::max();
+    while (it != workingCopy->rend() && inPrefix(it->first)) {
+        RecordId id(extractRecordId(it->first));
+        if (id > visibleEnd) {
+            break;
+        }
+        records->push_back({id, RecordData(it->second.c_str(), it->second.length())});
+        if (records->size() == maxRecords) {
+            break;
+        }
+        ++it;
+    }
+
+    if (it != workingCopy->rend() && inPrefix(it->first)) {
+        _savedPosition = it->first;
+    }
+}
+
 boost::optional<Record> RecordStore::ReverseCursor::seekExact(const RecordId& id) {
     _needFirstSeek = false;
     _savedPosition = boost::none;
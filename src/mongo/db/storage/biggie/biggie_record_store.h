@@ -123,6 +123,13 @@ public:
                                         long long numRecords,
                                         long long dataSize);
 
+    /**
+     * Recomputes the record count, data size and next record id from the records in 'store'. Used
+     * when the record store's contents were restored from a checkpoint rather than inserted
+     * through this instance.
+     */
+    void initializeStatsFromStore(const StringStore& store);
+
 private:
     friend class VisibilityManagerChange;
 
@@ -200,6 +207,7 @@ private:
                const RecordStore& rs,
                VisibilityManager* visibilityManager);
         boost::optional<Record> next() final;
+        void nextBatch(std::vector<Record>* records, size_t maxRecords) final;
         boost::optional<Record> seekExact(const RecordId& id) final override;
         void save() final;
         void saveUnpositioned() final override;
@@ -229,6 +237,7 @@ private:
                       const RecordStore& rs,
                       VisibilityManager* visibilityManager);
         boost::optional<Record> next() final;
+        void nextBatch(std::vector<Record>* records, size_t maxRecords) final;
         boost::optional<Record> seekExact(const RecordId& id) final override;
         void save() final;
         void saveUnpositioned() final override;
@@ -121,13 +121,22 @@ bool keysAreIdentical(std::string ks1, std::string ks2, bool isUnique) {
  * The data which is serialized as a byte array, has the following structure:
  *     [RecordId][TypeBits of internal keystring]
  */
-IndexKeyEntry keyStringToIndexKeyEntry(const std::string keyString,
-                                       std::string data,
-                                       const Ordering order) {
+IndexKeyEntry keyStringToIndexKeyEntry(
+    const std::string keyString,
+    std::string data,
+    const Ordering order,
+    ::mongo::SortedDataInterface::Cursor::RequestedInfo parts =
+        ::mongo::SortedDataInterface::Cursor::kKeyAndLoc) {
     int64_t ridRepr;
     std::memcpy(&ridRepr, data.data(), sizeof(int64_t));
     RecordId rid(ridRepr);
 
+    // Decoding the key is by far the most expensive part, so skip it when only the RecordId or
+    // the existence of the entry is wanted.
+    if (!(parts & ::mongo::SortedDataInterface::Cursor::kWantKey)) {
+        return IndexKeyEntry(BSONObj(), rid);
+    }
+
     std::string typeBitsString(data.length() - sizeof(int64_t), '\0');
     std::memcpy(&typeBitsString[0], data.data() + sizeof(int64_t), data.length() - sizeof(int64_t));
 
@@ -676,13 +685,13 @@ boost::optional<IndexKeyEntry> SortedDataInterface::Cursor::next(RequestedInfo p
     }
 
     if (_forward) {
-        return keyStringToIndexKeyEntry(_forwardIt->first, _forwardIt->second, _order);
+        return keyStringToIndexKeyEntry(_forwardIt->first, _forwardIt->second, _order, parts);
     }
-    return keyStringToIndexKeyEntry(_reverseIt->first, _reverseIt->second, _order);
+    return keyStringToIndexKeyEntry(_reverseIt->first, _reverseIt->second, _order, parts);
 }
 
-boost::optional<IndexKeyEntry> SortedDataInterface::Cursor::seekAfterProcessing(BSONObj finalKey,
-                                                                                bool inclusive) {
+boost::optional<IndexKeyEntry> SortedDataInterface::Cursor::seekAfterProcessing(
+    BSONObj finalKey, bool inclusive, RequestedInfo parts) {
     std::string workingCopyBound;
 
     // Similar to above, if forward and inclusive or reverse and not inclusive, then use min() for
@@ -746,9 +755,9 @@ boost::optional<IndexKeyEntry> SortedDataInterface::Cursor::seekAfterProcessing(
 
     // Everything checks out, so we have successfullly seeked and now return.
     if (_forward) {
-        return keyStringToIndexKeyEntry(_forwardIt->first, _forwardIt->second, _order);
+        return keyStringToIndexKeyEntry(_forwardIt->first, _forwardIt->second, _order, parts);
     }
-    return keyStringToIndexKeyEntry(_reverseIt->first, _reverseIt->second, _order);
+    return keyStringToIndexKeyEntry(_reverseIt->first, _reverseIt->second, _order, parts);
 }
 
 boost::optional<IndexKeyEntry> SortedDataInterface::Cursor::seek(const BSONObj& key,
@@ -758,7 +767,7 @@ boost::optional<IndexKeyEntry> SortedDataInterface::Cursor::seek(const BSONObj&
     _lastMoveWasRestore = false;
     _atEOF = false;
 
-    return seekAfterProcessing(finalKey, inclusive);
+    return seekAfterProcessing(finalKey, inclusive, parts);
 }
 
 boost::optional<IndexKeyEntry> SortedDataInterface::Cursor::seek(const IndexSeekPoint& seekPoint,
@@ -769,7 +778,7 @@ boost::optional<IndexKeyEntry> SortedDataInterface::Cursor::seek(const IndexSeek
     BSONObj finalKey = key;
     _lastMoveWasRestore = false;
 
-    return seekAfterProcessing(finalKey, inclusive);
+    return seekAfterProcessing(finalKey, inclusive, parts);
 }
 
 void SortedDataInterface::Cursor::save() {
@@ -135,7 +135,9 @@ public:
         // This is a helper function to check if the cursor is valid or not.
         bool checkCursorValid();
         // This is a helper function for seek.
-        boost::optional<IndexKeyEntry> seekAfterProcessing(BSONObj finalKey, bool inclusive);
+        boost::optional<IndexKeyEntry> seekAfterProcessing(BSONObj finalKey,
+                                                           bool inclusive,
+                                                           RequestedInfo parts);
         OperationContext* _opCtx;
         // This is the "working copy" of the master "branch" in the git analogy.
         StringStore* _workingCopy;
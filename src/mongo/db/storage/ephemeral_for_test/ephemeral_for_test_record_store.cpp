@@ -140,6 +140,21 @@ public:
         return {{_it->first, _it->second.toRecordData()}};
     }
 
+    void nextBatch(std::vector<Record>* records, size_t maxRecords) final {
+        invariant(maxRecords > 0);
+        records->clear();
+
+        // The records live in a std::map, so their data stays in place as the cursor moves on and
+        // need not be copied.
+        while (records->size() < maxRecords) {
+            auto record = next();
+            if (!record) {
+                break;
+            }
+            records->push_back(std::move(*record));
+        }
+    }
+
     boost::optional<Record> seekExact(const RecordId& id) final {
         _lastMoveWasRestore = false;
         _needFirstSeek = false;
@@ -203,6 +218,21 @@ public:
         return {{_it->first, _it->second.toRecordData()}};
     }
 
+    void nextBatch(std::vector<Record>* records, size_t maxRecords) final {
+        invariant(maxRecords > 0);
+        records->clear();
+
+        // The records live in a std::map, so their data stays in place as the cursor moves on and
+        // need not be copied.
+        while (records->size() < maxRecords) {
+            auto record = next();
+            if (!record) {
+                break;
+            }
+            records->push_back(std::move(*record));
+        }
+    }
+
     boost::optional<Record> seekExact(const RecordId& id) final {
         _lastMoveWasRestore = false;
         _needFirstSeek = false;
@@ -518,27 +548,30 @@ StatusWith<RecordData> EphemeralForTestRecordStore::updateWithDamages(
     stdx::lock_guard<stdx::recursive_mutex> lock(_data->recordsMutex);
 
     EphemeralForTestRecord* oldRecord = recordFor(loc);
-    const int len = oldRecord->size;
-
-    EphemeralForTestRecord newRecord(len);
-    memcpy(newRecord.data.get(), oldRecord->data.get(), len);
+    const int oldLen = oldRecord->size;
 
-    opCtx->recoveryUnit()->registerChange(new RemoveChange(opCtx, _data, loc, *oldRecord));
-    *oldRecord = newRecord;
-
-    cappedDeleteAsNeeded_inlock(opCtx);
-
-    char* root = newRecord.data.get();
+    std::string data(oldRecord->data.get(), oldLen);
     mutablebson::DamageVector::const_iterator where = damages.begin();
     const mutablebson::DamageVector::const_iterator end = damages.end();
     for (; where != end; ++where) {
-        const char* sourcePtr = damageSource + where->sourceOffset;
-        char* targetPtr = root + where->targetOffset;
-        std::memcpy(targetPtr, sourcePtr, where->size);
+        data.replace(where->targetOffset,
+                     where->getTargetSize(),
+                     damageSource + where->sourceOffset,
+                     where->size);
     }
 
+    // Documents in capped collections cannot change size. We check that above the storage layer.
+    invariant(!_isCapped || static_cast<int>(data.size()) == oldLen);
+
+    EphemeralForTestRecord newRecord(data.size());
+    memcpy(newRecord.data.get(), data.data(), data.size());
+
+    opCtx->recoveryUnit()->registerChange(new RemoveChange(opCtx, _data, loc, *oldRecord));
+    _data->dataSize += newRecord.size - oldLen;
     *oldRecord = newRecord;
 
+    cappedDeleteAsNeeded_inlock(opCtx);
+
     return newRecord.toRecordData();
 }
 
@@ -30,6 +30,7 @@
 #pragma once
 
 #include <boost/optional.hpp>
+#include <vector>
 
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/mutable/damage_vector.h"
@@ -143,6 +144,31 @@ public:
      */
     virtual boost::optional<Record> next() = 0;
 
+    /**
+     * Moves forward over up to 'maxRecords' records and replaces the contents of 'records' with
+     * them, so that a scan pays the cost of a call once per batch rather than once per record.
+     * Fewer than 'maxRecords' records are returned only once the cursor reaches EOF. 'maxRecords'
+     * must be positive.
+     *
+     * The data of the records may be unowned, and is only valid until the cursor is next used or
+     * saved. If an exception is thrown, 'records' holds the records read before it, which will not
+     * be returned again.
+     *
+     * The default implementation calls next() for each record and copies its data.
+     */
+    virtual void nextBatch(std::vector<Record>* records, size_t maxRecords) {
+        invariant(maxRecords > 0);
+        records->clear();
+        while (records->size() < maxRecords) {
+            auto record = next();
+            if (!record) {
+                break;
+            }
+            record->data.makeOwned();
+            records->push_back(std::move(*record));
+        }
+    }
+
     //
     // Saving and restoring state
     //
@@ -412,6 +438,10 @@ public:
      * 'damages' vector describes contiguous ranges of 'damageSource' from which to copy and apply
      * byte-level changes to the data. Behavior is undefined for calling this on a non-existant loc.
      *
+     * Damage events may replace regions of the record with data of a different size, as described
+     * in damage_vector.h, in which case the record grows or shrinks. 'oldRec' must be the current
+     * version of the record.
+     *
      * @return the updated version of the record. If unowned data is returned, then it is valid
      * until the next modification of this Record or the lock on the collection has been released.
      */
@@ -32,6 +32,8 @@
 #include "mongo/db/storage/record_store_test_harness.h"
 
 #include <algorithm>
+#include <utility>
+#include <vector>
 
 #include "mongo/bson/util/builder.h"
 #include "mongo/db/record_id.h"
@@ -483,5 +485,87 @@ TEST(RecordStoreTestHarness, SeekExactForMissingRecordReturnsNone) {
     ASSERT_FALSE(recordStore->findRecord(opCtx.get(), recordIds[1], &outputData));
 }
 
+// Insert multiple records and read them in batches in both directions, interleaving single
+// records, and check that the data of each batch stays valid until the cursor is used again.
+TEST(RecordStoreTestHarness, NextBatch) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    const int nToInsert = 10;
+    RecordId locs[nToInsert];
+    std::string datas[nToInsert];
+    for (int i = 0; i < nToInsert; i++) {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            stringstream ss;
+            ss << "record " << i;
+            string data = ss.str();
+
+            WriteUnitOfWork uow(opCtx.get());
+            StatusWith<RecordId> res =
+                rs->insertRecord(opCtx.get(), data.c_str(), data.size() + 1, Timestamp());
+            ASSERT_OK(res.getStatus());
+            locs[i] = res.getValue();
+            datas[i] = data;
+            uow.commit();
+        }
+    }
+
+    // Sort the data along with the locations, since inserted records may not be in RecordId order.
+    std::vector<std::pair<RecordId, std::string>> expected;
+    for (int i = 0; i < nToInsert; i++) {
+        expected.emplace_back(locs[i], datas[i]);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        auto cursor = rs->getCursor(opCtx.get());
+        std::vector<Record> batch;
+
+        cursor->nextBatch(&batch, 4);
+        ASSERT_EQUALS(4U, batch.size());
+        for (int i = 0; i < 4; i++) {
+            ASSERT_EQUALS(expected[i].first, batch[i].id);
+            ASSERT_EQUALS(expected[i].second, batch[i].data.data());
+        }
+
+        const auto record = cursor->next();
+        ASSERT(record);
+        ASSERT_EQUALS(expected[4].first, record->id);
+
+        // A batch which reaches EOF is short, and any later batch is empty.
+        cursor->nextBatch(&batch, 100);
+        ASSERT_EQUALS(5U, batch.size());
+        for (int i = 0; i < 5; i++) {
+            ASSERT_EQUALS(expected[i + 5].first, batch[i].id);
+            ASSERT_EQUALS(expected[i + 5].second, batch[i].data.data());
+        }
+        cursor->nextBatch(&batch, 100);
+        ASSERT(batch.empty());
+    }
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        auto cursor = rs->getCursor(opCtx.get(), false);
+        std::vector<Record> batch;
+
+        cursor->nextBatch(&batch, 3);
+        ASSERT_EQUALS(3U, batch.size());
+        for (int i = 0; i < 3; i++) {
+            ASSERT_EQUALS(expected[nToInsert - 1 - i].first, batch[i].id);
+            ASSERT_EQUALS(expected[nToInsert - 1 - i].second, batch[i].data.data());
+        }
+
+        // The cursor continues after the last record of the batch across a save and restore.
+        cursor->save();
+        ASSERT(cursor->restore());
+        cursor->nextBatch(&batch, nToInsert);
+        ASSERT_EQUALS(7U, batch.size());
+        ASSERT_EQUALS(expected[nToInsert - 4].first, batch[0].id);
+        ASSERT_EQUALS(expected[0].first, batch[6].id);
+    }
+}
+
 }  // namespace
 }  // namespace mongo
@@ -290,5 +290,67 @@ TEST(RecordStoreTestHarness, UpdateWithNoDamages) {
     }
 }
 
+// Insert a record and perform an in-place update on it with a DamageVector whose DamageEvents
+// grow and shrink the record.
+TEST(RecordStoreTestHarness, UpdateWithSizeChangingDamages) {
+    const auto harnessHelper(newRecordStoreHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    if (!rs->updateWithDamagesSupported())
+        return;
+
+    string data = "00010111";
+    RecordId loc;
+    const RecordData rec(data.c_str(), data.size() + 1);
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            WriteUnitOfWork uow(opCtx.get());
+            StatusWith<RecordId> res =
+                rs->insertRecord(opCtx.get(), rec.data(), rec.size(), Timestamp());
+            ASSERT_OK(res.getStatus());
+            loc = res.getValue();
+            uow.commit();
+        }
+    }
+
+    // Replace "00" with "abcd", then delete "11" from the record as modified by the first event.
+    string modifiedData = "abcd0101";
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            const char* damageSource = "abcd";
+            mutablebson::DamageVector dv(2);
+            dv[0].sourceOffset = 0;
+            dv[0].targetOffset = 0;
+            dv[0].size = 4;
+            dv[0].targetSize = 2;
+            dv[1].sourceOffset = 0;
+            dv[1].targetOffset = 8;
+            dv[1].size = 0;
+            dv[1].targetSize = 2;
+
+            WriteUnitOfWork uow(opCtx.get());
+            auto newRecStatus = rs->updateWithDamages(opCtx.get(), loc, rec, damageSource, dv);
+            ASSERT_OK(newRecStatus.getStatus());
+            ASSERT_EQUALS(modifiedData, newRecStatus.getValue().data());
+            ASSERT_EQUALS(static_cast<int>(modifiedData.size() + 1),
+                          newRecStatus.getValue().size());
+            uow.commit();
+        }
+    }
+
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        {
+            RecordData record = rs->dataFor(opCtx.get(), loc);
+            ASSERT_EQUALS(modifiedData, record.data());
+            ASSERT_EQUALS(static_cast<int>(modifiedData.size() + 1), record.size());
+        }
+        ASSERT_EQUALS(static_cast<long long>(modifiedData.size() + 1),
+                      rs->dataSize(opCtx.get()));
+    }
+}
+
 }  // namespace
 }  // namespace mongo
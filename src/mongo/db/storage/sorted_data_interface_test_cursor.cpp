@@ -249,5 +249,68 @@ TEST(SortedDataInterfaceBoundaryTest, NonUniqueBackwardWithInclusiveBoundaries)
     testBoundaries(/*unique*/ false, /*forward*/ false, /*inclusive*/ true);
 }
 
+// Verify that a cursor asked for less than the full entry still stops at the end position, returns
+// the RecordIds when asked for them, and keeps its position across save and restore.
+void testPartialEntries(bool unique, bool forward) {
+    const auto harnessHelper(newSortedDataInterfaceHarnessHelper());
+    const std::unique_ptr<SortedDataInterface> sorted(
+        harnessHelper->newSortedDataInterface(unique, /*partial=*/false));
+
+    const ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+    ASSERT(sorted->isEmpty(opCtx.get()));
+
+    int nToInsert = 10;
+    for (int i = 0; i < nToInsert; i++) {
+        WriteUnitOfWork uow(opCtx.get());
+        BSONObj key = BSON("" << i);
+        RecordId loc(42 + i * 2);
+        ASSERT_OK(sorted->insert(opCtx.get(), key, loc, true));
+        uow.commit();
+    }
+
+    int startVal = 2;
+    int endVal = 6;
+    if (!forward)
+        std::swap(startVal, endVal);
+    const int step = forward ? 1 : -1;
+
+    for (auto parts : {SortedDataInterface::Cursor::kJustExistance,
+                       SortedDataInterface::Cursor::kWantLoc}) {
+        const std::unique_ptr<SortedDataInterface::Cursor> cursor(
+            sorted->newCursor(opCtx.get(), forward));
+        cursor->setEndPosition(BSON("" << endVal), true);
+
+        int numEntries = 0;
+        for (auto entry = cursor->seek(BSON("" << startVal), true, parts); entry;
+             entry = cursor->next(parts)) {
+            if (parts & SortedDataInterface::Cursor::kWantLoc) {
+                ASSERT_EQ(entry->loc, RecordId(42 + (startVal + numEntries * step) * 2));
+            }
+            ++numEntries;
+
+            cursor->save();
+            cursor->restore();
+        }
+        ASSERT_EQ(numEntries, 5);
+        ASSERT(!cursor->next(parts));
+    }
+}
+
+TEST(SortedDataInterface, UniqueForwardCursorWithoutKeys) {
+    testPartialEntries(/*unique*/ true, /*forward*/ true);
+}
+
+TEST(SortedDataInterface, NonUniqueForwardCursorWithoutKeys) {
+    testPartialEntries(/*unique*/ false, /*forward*/ true);
+}
+
+TEST(SortedDataInterface, UniqueBackwardCursorWithoutKeys) {
+    testPartialEntries(/*unique*/ true, /*forward*/ false);
+}
+
+TEST(SortedDataInterface, NonUniqueBackwardCursorWithoutKeys) {
+    testPartialEntries(/*unique*/ false, /*forward*/ false);
+}
+
 }  // namespace
 }  // namespace mongo
@@ -363,7 +363,8 @@ void WiredTigerIndex::fullValidate(OperationContext* opCtx,
     TRACE_INDEX << " fullValidate";
 
     const auto requestedInfo = TRACING_ENABLED ? Cursor::kKeyAndLoc : Cursor::kJustExistance;
-    for (auto kv = cursor->seek(BSONObj(), true, requestedInfo); kv; kv = cursor->next()) {
+    for (auto kv = cursor->seek(BSONObj(), true, requestedInfo); kv;
+         kv = cursor->next(requestedInfo)) {
         TRACE_INDEX << "\t" << kv->key << ' ' << kv->loc;
         count++;
     }
@@ -572,8 +573,13 @@ protected:
         // completing - since checkpoints can take a long time, and waiting can result in
         // an unexpected pause in building an index.
         WT_SESSION* session = _session->getSession();
-        int err = session->open_cursor(
-            session, idx->uri().c_str(), NULL, "bulk,checkpoint_wait=false", &cursor);
+        const char* bulkConfig = "bulk,checkpoint_wait=false";
+        int err = session->open_cursor(session, idx->uri().c_str(), NULL, bulkConfig, &cursor);
+        if (err == EBUSY) {
+            // Cursors cached by idle sessions also keep the bulk cursor from being opened.
+            WiredTigerRecoveryUnit::get(_opCtx)->getSessionCache()->closeAllCursors(idx->uri());
+            err = session->open_cursor(session, idx->uri().c_str(), NULL, bulkConfig, &cursor);
+        }
         if (!err)
             return cursor;
 
@@ -605,10 +611,12 @@ protected:
 class WiredTigerIndex::StandardBulkBuilder : public BulkBuilder {
 public:
     StandardBulkBuilder(WiredTigerIndex* idx, OperationContext* opCtx, KVPrefix prefix)
-        : BulkBuilder(idx, opCtx, prefix), _idx(idx) {}
+        : BulkBuilder(idx, opCtx, prefix), _idx(idx), _keyString(idx->keyStringVersion()) {}
 
     StatusWith<SpecialFormatInserted> addKey(const BSONObj& key, const RecordId& id) override {
-        KeyString data(_idx->keyStringVersion(), key, _idx->_ordering, id);
+        // Reuse the KeyString's buffer rather than allocating one for every key.
+        _keyString.resetToKey(key, _idx->_ordering, id);
+        const KeyString& data = _keyString;
 
         // Can't use WiredTigerCursor since we aren't using the cache.
         WiredTigerItem item(data.getBuffer(), data.getSize());
@@ -638,6 +646,7 @@ public:
 
 private:
     WiredTigerIndex* _idx;
+    KeyString _keyString;
 };
 
 /**
@@ -816,7 +825,7 @@ public:
 
         if (!_lastMoveSkippedKey)
             advanceWTCursor();
-        updatePosition(true);
+        updatePosition(parts, true);
         return curr(parts);
     }
 
@@ -848,7 +857,7 @@ public:
         // unique vs non-unique key formats since both start with the key.
         _query.resetToKey(finalKey, _idx.ordering(), discriminator);
         seekWTCursor(_query);
-        updatePosition();
+        updatePosition(parts);
         return curr(parts);
     }
 
@@ -863,7 +872,7 @@ public:
             _forward ? KeyString::kExclusiveBefore : KeyString::kExclusiveAfter;
         _query.resetToKey(key, _idx.ordering(), discriminator);
         seekWTCursor(_query);
-        updatePosition();
+        updatePosition(parts);
         return curr(parts);
     }
 
@@ -967,7 +976,7 @@ protected:
             return {};
 
         dassert(!atOrPastEndPointAfterSeeking());
-        dassert(!_id.isNull());
+        dassert(!_id.isNull() || parts == kJustExistance);
 
         BSONObj bson;
         if (TRACING_ENABLED || (parts & kWantKey)) {
@@ -1054,8 +1063,12 @@ protected:
      * This must be called after moving the cursor to update our cached position. It should not
      * be called after a restore that did not restore to original state since that does not
      * logically move the cursor until the following call to next().
+     *
+     * The RecordId and TypeBits are only decoded if 'parts' asks for the key or the RecordId, so
+     * that callers which only count entries, such as COUNT_SCAN, look at nothing but the
+     * KeyString.
      */
-    void updatePosition(bool inNext = false) {
+    void updatePosition(RequestedInfo parts, bool inNext = false) {
         _lastMoveSkippedKey = false;
         if (_cursorAtEof) {
             _eof = true;
@@ -1102,6 +1115,11 @@ protected:
             return;
         }
 
+        if (!TRACING_ENABLED && parts == kJustExistance) {
+            _id = RecordId();
+            return;
+        }
+
         updateIdAndTypeBits();
     }
 
@@ -274,6 +274,65 @@ private:
     AtomicWord<bool> _shuttingDown{false};
 };
 
+class WiredTigerKVEngine::WiredTigerSizeStorerFlusher : public BackgroundJob {
+public:
+    explicit WiredTigerSizeStorerFlusher(WiredTigerKVEngine* wiredTigerKVEngine)
+        : BackgroundJob(false /* deleteSelf */), _wiredTigerKVEngine(wiredTigerKVEngine) {}
+
+    virtual string name() const {
+        return "WTSizeStorerFlusher";
+    }
+
+    virtual void run() {
+        ThreadClient tc(name(), getGlobalServiceContext());
+        LOG(1) << "starting " << name() << " thread";
+
+        while (!_shuttingDown.load()) {
+            {
+                stdx::unique_lock<stdx::mutex> lock(_mutex);
+                MONGO_IDLE_THREAD_BLOCK;
+                _condvar.wait_for(
+                    lock,
+                    stdx::chrono::seconds(gWiredTigerSizeStorerFlushIntervalSecs.load()),
+                    [&] { return _shuttingDown.load(); });
+            }
+
+            if (_shuttingDown.load())
+                break;
+
+            // Flushing here rather than when sessions are released keeps the writes to the size
+            // storer table off the path of user operations. A failed flush must not end the
+            // thread: the entries it did not write are kept for the next one.
+            try {
+                _wiredTigerKVEngine->syncSizeInfo(false);
+            } catch (const DBException& ex) {
+                warning() << name() << " failed to flush the size storer: " << redact(ex);
+            } catch (const std::exception& ex) {
+                warning() << name() << " failed to flush the size storer: " << ex.what();
+            }
+        }
+        LOG(1) << "stopping " << name() << " thread";
+    }
+
+    void shutdown() {
+        {
+            stdx::unique_lock<stdx::mutex> lock(_mutex);
+            _shuttingDown.store(true);
+            _condvar.notify_one();
+        }
+        wait();
+    }
+
+private:
+    WiredTigerKVEngine* _wiredTigerKVEngine;
+    AtomicWord<bool> _shuttingDown{false};
+
+    stdx::mutex _mutex;  // protects _condvar
+    // The flusher thread idles on this condition variable between flushes. It is signalled on
+    // shutdown so that the final, synchronous flush does not have to wait for it.
+    stdx::condition_variable _condvar;
+};
+
 class WiredTigerKVEngine::WiredTigerCheckpointThread : public BackgroundJob {
 public:
     explicit WiredTigerCheckpointThread(WiredTigerKVEngine* wiredTigerKVEngine,
@@ -545,7 +604,6 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
       _oplogManager(stdx::make_unique<WiredTigerOplogManager>()),
       _canonicalName(canonicalName),
       _path(path),
-      _sizeStorerSyncTracker(cs, 100000, Seconds(60)),
       _durable(durable),
       _ephemeral(ephemeral),
       _inRepairMode(repair),
@@ -585,7 +643,8 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
         // If we're readOnly skip all WAL-related settings.
         ss << "log=(enabled=true,archive=true,path=journal,compressor=";
         ss << wiredTigerGlobalOptions.journalCompressor << "),";
-        ss << "file_manager=(close_idle_time=100000),";  //~28 hours, will put better fix in 3.1.x
+        ss << "file_manager=(close_idle_time=" << gWiredTigerFileHandleCloseIdleTimeSecs
+           << ",close_minimum=" << gWiredTigerFileHandleCloseMinimum << "),";
         ss << "statistics_log=(wait=" << wiredTigerGlobalOptions.statisticsLogDelaySecs << "),";
         ss << "verbose=(recovery_progress),";
 
@@ -681,6 +740,11 @@ WiredTigerKVEngine::WiredTigerKVEngine(const std::string& canonicalName,
 
     _sizeStorer = std::make_unique<WiredTigerSizeStorer>(_conn, _sizeStorerUri, _readOnly);
 
+    if (!_readOnly) {
+        _sizeStorerFlusher = std::make_unique<WiredTigerSizeStorerFlusher>(this);
+        _sizeStorerFlusher->go();
+    }
+
     Locker::setGlobalThrottling(&openReadTransaction, &openWriteTransaction);
 }
 
@@ -776,6 +840,12 @@ void WiredTigerKVEngine::_openWiredTiger(const std::string& path, const std::str
 
 void WiredTigerKVEngine::cleanShutdown() {
     log() << "WiredTigerKVEngine shutting down";
+    if (_sizeStorerFlusher) {
+        log() << "Shutting down size storer flusher thread";
+        _sizeStorerFlusher->shutdown();
+        _sizeStorerFlusher.reset();
+        log() << "Finished shutting down size storer flusher thread";
+    }
     if (!_readOnly)
         syncSizeInfo(true);
     if (!_conn) {
@@ -1379,11 +1449,6 @@ bool WiredTigerKVEngine::haveDropsQueued() const {
     Date_t now = _clockSource->now();
     Milliseconds delta = now - _previousCheckedDropsQueued;
 
-    if (!_readOnly && _sizeStorerSyncTracker.intervalHasElapsed()) {
-        _sizeStorerSyncTracker.resetLastTime();
-        syncSizeInfo(false);
-    }
-
     // We only want to check the queue max once per second or we'll thrash
     if (delta < Milliseconds(1000))
         return false;
@@ -1767,6 +1832,9 @@ StatusWith<Timestamp> WiredTigerKVEngine::recoverToStableTimestamp(OperationCont
     }
 
     LOG_FOR_ROLLBACK(2) << "WiredTiger::RecoverToStableTimestamp syncing size storer to disk.";
+    if (_sizeStorerFlusher) {
+        _sizeStorerFlusher->shutdown();
+    }
     syncSizeInfo(true);
 
     if (!_ephemeral) {
@@ -1800,6 +1868,10 @@ StatusWith<Timestamp> WiredTigerKVEngine::recoverToStableTimestamp(OperationCont
     }
 
     _sizeStorer = std::make_unique<WiredTigerSizeStorer>(_conn, _sizeStorerUri, _readOnly);
+    if (_sizeStorerFlusher) {
+        _sizeStorerFlusher = std::make_unique<WiredTigerSizeStorerFlusher>(this);
+        _sizeStorerFlusher->go();
+    }
 
     return {stableTimestamp};
 }
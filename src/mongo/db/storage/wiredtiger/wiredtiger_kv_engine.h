@@ -44,7 +44,6 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
 #include "mongo/stdx/functional.h"
 #include "mongo/stdx/mutex.h"
-#include "mongo/util/elapsed_tracker.h"
 
 namespace mongo {
 
@@ -354,6 +353,7 @@ private:
     class WiredTigerSessionSweeper;
     class WiredTigerJournalFlusher;
     class WiredTigerCheckpointThread;
+    class WiredTigerSizeStorerFlusher;
 
     /**
      * Opens a connection on the WiredTiger database 'path' with the configuration 'wtOpenConfig'.
@@ -422,7 +422,6 @@ private:
 
     std::unique_ptr<WiredTigerSizeStorer> _sizeStorer;
     std::string _sizeStorerUri;
-    mutable ElapsedTracker _sizeStorerSyncTracker;
 
     bool _durable;
     bool _ephemeral;  // whether we are using the in-memory mode of the WT engine
@@ -439,6 +438,7 @@ private:
     std::unique_ptr<WiredTigerSessionSweeper> _sessionSweeper;
     std::unique_ptr<WiredTigerJournalFlusher> _journalFlusher;  // Depends on _sizeStorer
     std::unique_ptr<WiredTigerCheckpointThread> _checkpointThread;
+    std::unique_ptr<WiredTigerSizeStorerFlusher> _sizeStorerFlusher;  // Depends on _sizeStorer
 
     std::string _rsOptions;
     std::string _indexOptions;
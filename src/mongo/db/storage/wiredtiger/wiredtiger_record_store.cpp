@@ -51,6 +51,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_customization_hooks.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_global_options.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_parameters_gen.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_prepare_conflict.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
@@ -186,14 +187,30 @@ void WiredTigerRecordStore::OplogStones::kill() {
     _oplogReclaimCv.notify_one();
 }
 
+bool WiredTigerRecordStore::OplogStones::_isPastMinRetention(const Stone& stone, Date_t now) {
+    const double minRetentionHours = gOplogMinRetentionHours.load();
+    if (minRetentionHours <= 0) {
+        return true;
+    }
+
+    const auto minRetention = Milliseconds(static_cast<long long>(minRetentionHours * 3600 * 1000));
+    const auto lastRecordTime =
+        Date_t::fromMillisSinceEpoch(Timestamp(stone.lastRecord.repr()).getSecs() * 1000LL);
+    return lastRecordTime + minRetention < now;
+}
+
 void WiredTigerRecordStore::OplogStones::awaitHasExcessStonesOrDead() {
+    // Stones only age past the minimum retention period with time, without any insert to wake the
+    // reclaim thread, so check on them periodically while there is one.
+    const auto kRetentionCheckInterval = stdx::chrono::seconds(60);
+
     // Wait until kill() is called or there are too many oplog stones.
     stdx::unique_lock<stdx::mutex> lock(_oplogReclaimMutex);
     while (!_isDead) {
         {
             MONGO_IDLE_THREAD_BLOCK;
             stdx::lock_guard<stdx::mutex> lk(_mutex);
-            if (hasExcessStones_inlock()) {
+            if (hasExcessStones_inlock() && _isPastMinRetention(_stones.front(), Date_t::now())) {
                 // There are now excess oplog stones. However, there it may be necessary to keep
                 // additional oplog.
                 //
@@ -209,24 +226,49 @@ void WiredTigerRecordStore::OplogStones::awaitHasExcessStonesOrDead() {
                 }
             }
         }
-        _oplogReclaimCv.wait(lock);
+        if (gOplogMinRetentionHours.load() > 0) {
+            _oplogReclaimCv.wait_for(lock, kRetentionCheckInterval);
+        } else {
+            _oplogReclaimCv.wait(lock);
+        }
     }
 }
 
 boost::optional<WiredTigerRecordStore::OplogStones::Stone>
-WiredTigerRecordStore::OplogStones::peekOldestStoneIfNeeded() const {
+WiredTigerRecordStore::OplogStones::peekReclaimableStones(Timestamp mayTruncateUpTo) const {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
 
-    if (!hasExcessStones_inlock()) {
-        return {};
+    int64_t totalBytes = 0;
+    for (const auto& stone : _stones) {
+        totalBytes += stone.bytes;
     }
 
-    return _stones.front();
+    const Date_t now = Date_t::now();
+    boost::optional<Stone> reclaimable;
+    for (const auto& stone : _stones) {
+        invariant(stone.lastRecord.isValid());
+        if (totalBytes <= _rs->cappedMaxSize() || !_isPastMinRetention(stone, now) ||
+            static_cast<std::uint64_t>(stone.lastRecord.repr()) >= mayTruncateUpTo.asULL()) {
+            // Do not truncate oplogs needed for replication recovery.
+            break;
+        }
+
+        if (!reclaimable) {
+            reclaimable = Stone{0, 0, RecordId()};
+        }
+        reclaimable->records += stone.records;
+        reclaimable->bytes += stone.bytes;
+        reclaimable->lastRecord = stone.lastRecord;
+        totalBytes -= stone.bytes;
+    }
+    return reclaimable;
 }
 
-void WiredTigerRecordStore::OplogStones::popOldestStone() {
+void WiredTigerRecordStore::OplogStones::popOldestStones(RecordId lastRecord) {
     stdx::lock_guard<stdx::mutex> lk(_mutex);
-    _stones.pop_front();
+    while (!_stones.empty() && _stones.front().lastRecord <= lastRecord) {
+        _stones.pop_front();
+    }
 }
 
 void WiredTigerRecordStore::OplogStones::createNewStoneIfNeeded(RecordId lastRecord) {
@@ -308,8 +350,27 @@ void WiredTigerRecordStore::OplogStones::setMinBytesPerStone(int64_t size) {
     _minBytesPerStone = size;
 }
 
+void WiredTigerRecordStore::OplogStones::recordTruncation(Microseconds elapsed) {
+    _totalTimeTruncatingMicros.fetchAndAdd(durationCount<Microseconds>(elapsed));
+    _truncateCount.fetchAndAdd(1);
+}
+
+void WiredTigerRecordStore::OplogStones::appendTruncationStats(BSONObjBuilder* builder) const {
+    {
+        stdx::lock_guard<stdx::mutex> lk(_mutex);
+        builder->append("totalTimeProcessingMicros",
+                        durationCount<Microseconds>(_totalTimeProcessing));
+        builder->append("processingMethod", _processingMethod);
+    }
+    builder->append("totalTimeTruncatingMicros", _totalTimeTruncatingMicros.load());
+    builder->append("truncateCount", _truncateCount.load());
+}
+
 void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* opCtx,
                                                           size_t numStonesToKeep) {
+    Timer timer;
+    ON_BLOCK_EXIT([&] { _totalTimeProcessing = Microseconds(timer.micros()); });
+
     long long numRecords = _rs->numRecords(opCtx);
     long long dataSize = _rs->dataSize(opCtx);
 
@@ -325,6 +386,7 @@ void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* opCt
     if (numRecords <= 0 || dataSize <= 0 ||
         uint64_t(numRecords) <
             kMinSampleRatioForRandCursor * kRandomSamplesPerStone * numStonesToKeep) {
+        _processingMethod = "scanning";
         _calculateStonesByScanning(opCtx);
         return;
     }
@@ -335,6 +397,7 @@ void WiredTigerRecordStore::OplogStones::_calculateStones(OperationContext* opCt
     double estRecordsPerStone = std::ceil(_minBytesPerStone / avgRecordSize);
     double estBytesPerStone = estRecordsPerStone * avgRecordSize;
 
+    _processingMethod = "sampling";
     _calculateStonesBySampling(opCtx, int64_t(estRecordsPerStone), int64_t(estBytesPerStone));
 }
 
@@ -714,11 +777,36 @@ WiredTigerRecordStore::~WiredTigerRecordStore() {
 }
 
 void WiredTigerRecordStore::postConstructorInit(OperationContext* opCtx) {
-    // Find the largest RecordId currently in use and estimate the number of records.
-    std::unique_ptr<SeekableRecordCursor> cursor = getCursor(opCtx, /*forward=*/false);
     _sizeInfo =
         _sizeStorer ? _sizeStorer->load(_uri) : std::make_shared<WiredTigerSizeStorer::SizeInfo>();
 
+    // Reading the table opens its file. With many collections this dominates startup, so unless
+    // the size and count must come from a scan, the oplog needs the table straight away, or lazy
+    // initialization is disabled, defer it until the first write.
+    if (!_sizeStorer || _isOplog || !gWiredTigerLazyRecordStoreInit) {
+        _initializeFromTableIfNeeded(opCtx);
+    }
+
+    if (WiredTigerKVEngine::initRsOplogBackgroundThread(ns())) {
+        _oplogStones = std::make_shared<OplogStones>(opCtx, this);
+    }
+
+    if (_isOplog) {
+        invariant(_kvEngine);
+        _kvEngine->startOplogManager(opCtx, _uri, this);
+    }
+}
+
+void WiredTigerRecordStore::_initializeFromTableIfNeeded(OperationContext* opCtx) {
+    if (_tableInitialized.load())
+        return;
+
+    stdx::lock_guard<stdx::mutex> lk(_tableInitMutex);
+    if (_tableInitialized.load())
+        return;
+
+    // Find the largest RecordId currently in use and estimate the number of records.
+    std::unique_ptr<SeekableRecordCursor> cursor = getCursor(opCtx, /*forward=*/false);
     if (auto record = cursor->next()) {
         int64_t max = record->id.repr();
         _nextIdNum.store(1 + max);
@@ -762,14 +850,7 @@ void WiredTigerRecordStore::postConstructorInit(OperationContext* opCtx) {
     if (_sizeStorer)
         _sizeStorer->store(_uri, _sizeInfo);
 
-    if (WiredTigerKVEngine::initRsOplogBackgroundThread(ns())) {
-        _oplogStones = std::make_shared<OplogStones>(opCtx, this);
-    }
-
-    if (_isOplog) {
-        invariant(_kvEngine);
-        _kvEngine->startOplogManager(opCtx, _uri, this);
-    }
+    _tableInitialized.store(true);
 }
 
 const char* WiredTigerRecordStore::name() const {
@@ -856,6 +937,7 @@ bool WiredTigerRecordStore::findRecord(OperationContext* opCtx,
 
 void WiredTigerRecordStore::deleteRecord(OperationContext* opCtx, const RecordId& id) {
     dassert(opCtx->lockState()->isWriteLocked());
+    _initializeFromTableIfNeeded(opCtx);
 
     // Deletes should never occur on a capped collection because truncation uses
     // WT_SESSION::truncate().
@@ -1175,14 +1257,9 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx) {
 
 void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp mayTruncateUpTo) {
     Timer timer;
-    while (auto stone = _oplogStones->peekOldestStoneIfNeeded()) {
-        invariant(stone->lastRecord.isValid());
-
-        if (static_cast<std::uint64_t>(stone->lastRecord.repr()) >= mayTruncateUpTo.asULL()) {
-            // Do not truncate oplogs needed for replication recovery.
-            return;
-        }
-
+    // All of the stones which may be reclaimed are removed by a single range truncate, which is
+    // far cheaper than truncating each in turn.
+    while (auto stone = _oplogStones->peekReclaimableStones(mayTruncateUpTo)) {
         LOG(1) << "Truncating the oplog between " << _oplogStones->firstRecord << " and "
                << stone->lastRecord << " to remove approximately " << stone->records
                << " records totaling to " << stone->bytes << " bytes";
@@ -1191,6 +1268,7 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp mayT
         WT_SESSION* session = ru->getSession()->getSession();
 
         try {
+            Timer truncateTimer;
             WriteUnitOfWork wuow(opCtx);
 
             WiredTigerCursor cwrap(_uri, _tableId, true, opCtx);
@@ -1211,9 +1289,10 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp mayT
             _increaseDataSize(opCtx, -stone->bytes);
 
             wuow.commit();
+            _oplogStones->recordTruncation(Microseconds(truncateTimer.micros()));
 
-            // Remove the stone after a successful truncation.
-            _oplogStones->popOldestStone();
+            // Remove the stones after a successful truncation.
+            _oplogStones->popOldestStones(stone->lastRecord);
 
             // Stash the truncate point for next time to cleanly skip over tombstones, etc.
             _oplogStones->firstRecord = stone->lastRecord;
@@ -1228,6 +1307,12 @@ void WiredTigerRecordStore::reclaimOplog(OperationContext* opCtx, Timestamp mayT
     log() << "WiredTiger record store oplog truncation finished in: " << timer.millis() << "ms";
 }
 
+void WiredTigerRecordStore::getOplogTruncateStats(BSONObjBuilder& builder) const {
+    if (_oplogStones) {
+        _oplogStones->appendTruncationStats(&builder);
+    }
+}
+
 Status WiredTigerRecordStore::insertRecords(OperationContext* opCtx,
                                             std::vector<Record>* records,
                                             const std::vector<Timestamp>& timestamps) {
@@ -1239,6 +1324,7 @@ Status WiredTigerRecordStore::_insertRecords(OperationContext* opCtx,
                                              const Timestamp* timestamps,
                                              size_t nRecords) {
     dassert(opCtx->lockState()->isWriteLocked());
+    _initializeFromTableIfNeeded(opCtx);
 
     // We are kind of cheating on capped collections since we write all of them at once ....
     // Simplest way out would be to just block vector writes for everything except oplog ?
@@ -1424,15 +1510,23 @@ StatusWith<RecordData> WiredTigerRecordStore::updateWithDamages(
     const char* damageSource,
     const mutablebson::DamageVector& damages) {
 
+    // WiredTiger applies the modifications in order, the same way damage events are applied, so
+    // size-changing damage events map directly onto them.
     const int nentries = damages.size();
     mutablebson::DamageVector::const_iterator where = damages.begin();
     const mutablebson::DamageVector::const_iterator end = damages.cend();
     std::vector<WT_MODIFY> entries(nentries);
+    int64_t sizeChange = 0;
     for (u_int i = 0; where != end; ++i, ++where) {
         entries[i].data.data = damageSource + where->sourceOffset;
         entries[i].data.size = where->size;
         entries[i].offset = where->targetOffset;
-        entries[i].size = where->size;
+        entries[i].size = where->getTargetSize();
+        sizeChange += static_cast<int64_t>(where->size) - where->getTargetSize();
+    }
+
+    if (_oplogStones && sizeChange != 0) {
+        return {ErrorCodes::IllegalOperation, "Cannot change the size of a document in the oplog"};
     }
 
     WiredTigerCursor curwrap(_uri, _tableId, true, opCtx);
@@ -1450,6 +1544,13 @@ StatusWith<RecordData> WiredTigerRecordStore::updateWithDamages(
     WT_ITEM value;
     invariantWTOK(c->get_value(c, &value));
 
+    if (sizeChange != 0) {
+        _increaseDataSize(opCtx, sizeChange);
+        if (!_oplogStones) {
+            _cappedDeleteAsNeeded(opCtx, id);
+        }
+    }
+
     return RecordData(static_cast<const char*>(value.data), value.size).getOwned();
 }
 
@@ -1460,6 +1561,7 @@ std::unique_ptr<RecordCursor> WiredTigerRecordStore::getRandomCursor(
 }
 
 Status WiredTigerRecordStore::truncate(OperationContext* opCtx) {
+    _initializeFromTableIfNeeded(opCtx);
     WiredTigerCursor startWrap(_uri, _tableId, true, opCtx);
     WT_CURSOR* start = startWrap.get();
     int ret = wiredTigerPrepareConflictRetry(opCtx, [&] { return start->next(start); });
@@ -1741,6 +1843,7 @@ void WiredTigerRecordStore::_increaseDataSize(OperationContext* opCtx, int64_t a
 void WiredTigerRecordStore::cappedTruncateAfter(OperationContext* opCtx,
                                                 RecordId end,
                                                 bool inclusive) {
+    _initializeFromTableIfNeeded(opCtx);
     std::unique_ptr<SeekableRecordCursor> cursor = getCursor(opCtx, true);
 
     auto record = cursor->seekExact(end);
@@ -1868,9 +1971,49 @@ WiredTigerRecordStoreCursorBase::WiredTigerRecordStoreCursorBase(OperationContex
 }
 
 boost::optional<Record> WiredTigerRecordStoreCursorBase::next() {
-    if (_eof)
+    RecordId id;
+    WT_ITEM value;
+    if (!advance(&id, &value))
         return {};
 
+    return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
+}
+
+void WiredTigerRecordStoreCursorBase::nextBatch(std::vector<Record>* records, size_t maxRecords) {
+    invariant(maxRecords > 0);
+    records->clear();
+    _batchData.clear();
+
+    // The records only point into '_batchData' once it has stopped growing, which is also the case
+    // if an exception cuts the batch short.
+    auto pointRecordsAtBatchData = [&] {
+        size_t offset = 0;
+        for (auto&& record : *records) {
+            const int size = record.data.size();
+            record.data = RecordData(_batchData.data() + offset, size);
+            offset += size;
+        }
+    };
+
+    try {
+        RecordId id;
+        WT_ITEM value;
+        while (records->size() < maxRecords && advance(&id, &value)) {
+            const char* data = static_cast<const char*>(value.data);
+            _batchData.insert(_batchData.end(), data, data + value.size);
+            records->push_back({id, RecordData(nullptr, static_cast<int>(value.size))});
+        }
+    } catch (...) {
+        pointRecordsAtBatchData();
+        throw;
+    }
+    pointRecordsAtBatchData();
+}
+
+bool WiredTigerRecordStoreCursorBase::advance(RecordId* idOut, WT_ITEM* value) {
+    if (_eof)
+        return false;
+
     WT_CURSOR* c = _cursor->get();
 
     RecordId id;
@@ -1882,12 +2025,12 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::next() {
             _opCtx, [&] { return _forward ? c->next(c) : c->prev(c); });
         if (advanceRet == WT_NOTFOUND) {
             _eof = true;
-            return {};
+            return false;
         }
         invariantWTOK(advanceRet);
         if (hasWrongPrefix(c, &id)) {
             _eof = true;
-            return {};
+            return false;
         }
     }
 
@@ -1898,7 +2041,7 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::next() {
 
     if (_oplogVisibleTs && id.repr() > *_oplogVisibleTs) {
         _eof = true;
-        return {};
+        return false;
     }
 
     if (_forward && _lastReturnedId >= id) {
@@ -1910,11 +2053,11 @@ boost::optional<Record> WiredTigerRecordStoreCursorBase::next() {
         throw WriteConflictException();
     }
 
-    WT_ITEM value;
-    invariantWTOK(c->get_value(c, &value));
+    invariantWTOK(c->get_value(c, value));
 
     _lastReturnedId = id;
-    return {{id, {static_cast<const char*>(value.data), static_cast<int>(value.size)}}};
+    *idOut = id;
+    return true;
 }
 
 boost::optional<Record> WiredTigerRecordStoreCursorBase::seekExact(const RecordId& id) {
@@ -257,6 +257,9 @@ public:
     // Returns false if the oplog was dropped while waiting for a deletion request.
     bool yieldAndAwaitOplogDeletionRequest(OperationContext* opCtx);
 
+    // Appends statistics about how the oplog has been truncated, for serverStatus.
+    void getOplogTruncateStats(BSONObjBuilder& builder) const;
+
     bool haveCappedWaiters();
 
     void notifyCappedWaitersIfNeeded();
@@ -287,6 +290,14 @@ private:
                           size_t nRecords);
 
     RecordId _nextId();
+
+    /**
+     * Reads the table to find the next RecordId to assign and, for an empty table, to reset the
+     * size information. This is done once, either by postConstructorInit() or, when
+     * 'wiredTigerLazyRecordStoreInit' is set, before the first write to the record store. Until
+     * then the size information is the last value recorded by the size storer.
+     */
+    void _initializeFromTableIfNeeded(OperationContext* opCtx);
     void _setId(RecordId id);
     bool cappedAndNeedDelete() const;
     RecordData _getData(const WiredTigerCursor& cursor) const;
@@ -358,6 +369,10 @@ private:
 
     AtomicWord<long long> _nextIdNum;
 
+    // Set once _initializeFromTableIfNeeded() has read the table.
+    AtomicWord<bool> _tableInitialized{false};
+    stdx::mutex _tableInitMutex;  // Serializes _initializeFromTableIfNeeded().
+
     WiredTigerSizeStorer* _sizeStorer;  // not owned, can be NULL
     std::shared_ptr<WiredTigerSizeStorer::SizeInfo> _sizeInfo;
     WiredTigerKVEngine* _kvEngine;  // not owned.
@@ -419,6 +434,8 @@ public:
 
     boost::optional<Record> next();
 
+    void nextBatch(std::vector<Record>* records, size_t maxRecords);
+
     boost::optional<Record> seekExact(const RecordId& id);
 
     void save();
@@ -461,6 +478,16 @@ protected:
 private:
     bool isVisible(const RecordId& id);
 
+    /**
+     * Moves the cursor to the next visible record, filling out 'id' and 'value' for it. Returns
+     * false at EOF.
+     */
+    bool advance(RecordId* id, WT_ITEM* value);
+
+    // The values of the records most recently returned by nextBatch(). WiredTiger only keeps the
+    // value at the cursor's current position in memory, so they are copied here.
+    std::vector<char> _batchData;
+
     /**
      * This value is used for visibility calculations on what oplog entries can be returned to a
      * client. This value *must* be initialized/updated *before* a WiredTiger snapshot is
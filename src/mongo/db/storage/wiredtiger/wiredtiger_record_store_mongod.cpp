@@ -38,7 +38,9 @@
 #include "mongo/db/catalog/collection.h"
 #include "mongo/db/catalog/database.h"
 #include "mongo/db/catalog/database_holder.h"
+#include "mongo/db/catalog_raii.h"
 #include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/concurrency/d_concurrency.h"
 #include "mongo/db/db_raii.h"
 #include "mongo/db/namespace_string.h"
@@ -166,6 +168,39 @@ bool initRsOplogBackgroundThread(StringData ns) {
     return true;
 }
 
+/**
+ * Reports how the replica set oplog was divided into stones at startup, and the cost of truncating
+ * it since.
+ */
+class OplogTruncationServerStatusSection : public ServerStatusSection {
+public:
+    OplogTruncationServerStatusSection() : ServerStatusSection("oplogTruncation") {}
+
+    bool includeByDefault() const override {
+        return true;
+    }
+
+    BSONObj generateSection(OperationContext* opCtx,
+                            const BSONElement& configElement) const override {
+        AutoGetCollection autoColl(opCtx, NamespaceString::kRsOplogNamespace, MODE_IS);
+        Collection* oplog = autoColl.getCollection();
+        if (!oplog) {
+            return BSONObj();
+        }
+
+        // The section is registered whenever WiredTiger is linked in, even if another storage
+        // engine is running.
+        auto rs = dynamic_cast<WiredTigerRecordStore*>(oplog->getRecordStore());
+        if (!rs) {
+            return BSONObj();
+        }
+
+        BSONObjBuilder builder;
+        rs->getOplogTruncateStats(builder);
+        return builder.obj();
+    }
+} oplogTruncationServerStatusSection;
+
 MONGO_INITIALIZER(SetInitRsOplogBackgroundThreadCallback)(InitializerContext* context) {
     WiredTigerKVEngine::setInitRsOplogBackgroundThreadCallback(initRsOplogBackgroundThread);
     return Status::OK();
@@ -35,6 +35,8 @@
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/condition_variable.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/util/duration.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -42,7 +44,8 @@ class OperationContext;
 class RecordId;
 
 // Keep "milestones" against the oplog to efficiently remove the old records when the collection
-// grows beyond its desired maximum size.
+// grows beyond its desired maximum size. When 'oplogMinRetentionHours' is set, a stone is only
+// removed once its last record is older than that, as measured by the record's optime.
 class WiredTigerRecordStore::OplogStones {
 public:
     struct Stone {
@@ -69,9 +72,15 @@ public:
 
     void awaitHasExcessStonesOrDead();
 
-    boost::optional<OplogStones::Stone> peekOldestStoneIfNeeded() const;
+    /**
+     * Returns a stone covering the oldest stones which may be truncated together: those whose
+     * removal still leaves the oplog above its maximum size, which are past the minimum retention
+     * period, and which end before 'mayTruncateUpTo'. Returns boost::none if there are none.
+     */
+    boost::optional<OplogStones::Stone> peekReclaimableStones(Timestamp mayTruncateUpTo) const;
 
-    void popOldestStone();
+    // Removes the oldest stones, up to and including the one ending at 'lastRecord'.
+    void popOldestStones(RecordId lastRecord);
 
     void createNewStoneIfNeeded(RecordId lastRecord);
 
@@ -90,6 +99,11 @@ public:
     // Resize oplog size
     void adjust(int64_t maxSize);
 
+    // Records the time taken by a truncation of the oplog, for serverStatus.
+    void recordTruncation(Microseconds elapsed);
+
+    void appendTruncationStats(BSONObjBuilder* builder) const;
+
     // The start point of where to truncate next. Used by the background reclaim thread to
     // efficiently truncate records with WiredTiger by skipping over tombstones, etc.
     RecordId firstRecord;
@@ -125,6 +139,9 @@ private:
 
     void _pokeReclaimThreadIfNeeded();
 
+    // Returns true if the records of 'stone' are older than the minimum retention period at 'now'.
+    static bool _isPastMinRetention(const Stone& stone, Date_t now);
+
     static const uint64_t kRandomSamplesPerStone = 10;
 
     WiredTigerRecordStore* _rs;
@@ -145,6 +162,13 @@ private:
 
     mutable stdx::mutex _mutex;  // Protects against concurrent access to the deque of oplog stones.
     std::deque<OplogStones::Stone> _stones;  // front = oldest, back = newest.
+
+    // How the initial stones were placed, either "scanning" or "sampling", and how long it took.
+    std::string _processingMethod;
+    Microseconds _totalTimeProcessing{0};
+
+    AtomicWord<long long> _totalTimeTruncatingMicros{0};
+    AtomicWord<long long> _truncateCount{0};
 };
 
 }  // namespace mongo
@@ -76,6 +76,11 @@ BSONObj WiredTigerServerStatusSection::generateSection(OperationContext* opCtx,
 
     WiredTigerKVEngine::appendGlobalStats(bob);
 
+    {
+        BSONObjBuilder sessionCacheBuilder(bob.subobjStart("sessionCache"));
+        WiredTigerRecoveryUnit::get(opCtx)->getSessionCache()->appendStats(&sessionCacheBuilder);
+    }
+
     WiredTigerUtil::appendSnapshotWindowSettings(_engine, session, &bob);
 
     return bob.obj();
@@ -34,6 +34,7 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 
 #include "mongo/base/error_codes.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/concurrency/write_conflict_exception.h"
 #include "mongo/db/global_settings.h"
 #include "mongo/db/repl/repl_settings.h"
@@ -44,6 +45,7 @@
 #include "mongo/stdx/memory.h"
 #include "mongo/stdx/thread.h"
 #include "mongo/util/log.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -136,15 +138,27 @@ void _openCursor(WT_SESSION* session,
 }  // namespace
 
 
+WiredTigerSession::CursorCache::iterator WiredTigerSession::_uncacheCursor(
+    CursorCache::iterator it) {
+    auto entry = _cursorIndex.find(it->_id);
+    invariant(entry != _cursorIndex.end());
+    auto& cursors = entry->second;
+    cursors.erase(std::find(cursors.begin(), cursors.end(), it));
+    if (cursors.empty()) {
+        _cursorIndex.erase(entry);
+    }
+    return _cursors.erase(it);
+}
+
 WT_CURSOR* WiredTigerSession::getCursor(const std::string& uri, uint64_t id, bool allowOverwrite) {
     // Find the most recently used cursor
-    for (CursorCache::iterator i = _cursors.begin(); i != _cursors.end(); ++i) {
-        if (i->_id == id) {
-            WT_CURSOR* c = i->_cursor;
-            _cursors.erase(i);
-            _cursorsOut++;
-            return c;
-        }
+    auto entry = _cursorIndex.find(id);
+    if (entry != _cursorIndex.end()) {
+        auto mostRecent = entry->second.back();
+        WT_CURSOR* c = mostRecent->_cursor;
+        _uncacheCursor(mostRecent);
+        _cursorsOut++;
+        return c;
     }
 
     WT_CURSOR* cursor = NULL;
@@ -171,13 +185,14 @@ void WiredTigerSession::releaseCursor(uint64_t id, WT_CURSOR* cursor) {
 
     // Cursors are pushed to the front of the list and removed from the back
     _cursors.push_front(WiredTigerCachedCursor(id, _cursorGen++, cursor));
+    _cursorIndex[id].push_back(_cursors.begin());
 
     // A negative value for wiredTigercursorCacheSize means to use hybrid caching.
     std::uint32_t cacheSize = abs(kWiredTigerCursorCacheSize.load());
 
     while (!_cursors.empty() && _cursorGen - _cursors.back()._gen > cacheSize) {
         cursor = _cursors.back()._cursor;
-        _cursors.pop_back();
+        _uncacheCursor(std::prev(_cursors.end()));
         invariantWTOK(cursor->close(cursor));
     }
 }
@@ -198,7 +213,7 @@ void WiredTigerSession::closeAllCursors(const std::string& uri) {
         WT_CURSOR* cursor = i->_cursor;
         if (cursor && (all || uri == cursor->uri)) {
             invariantWTOK(cursor->close(cursor));
-            i = _cursors.erase(i);
+            i = _uncacheCursor(i);
         } else
             ++i;
     }
@@ -209,6 +224,12 @@ void WiredTigerSession::closeCursorsForQueuedDrops(WiredTigerKVEngine* engine) {
 
     _cursorEpoch = _cache->getCursorEpoch();
     auto toDrop = engine->filterCursorsWithQueuedDrops(&_cursors);
+    if (!toDrop.empty()) {
+        _cursorIndex.clear();
+        for (auto i = _cursors.rbegin(); i != _cursors.rend(); ++i) {
+            _cursorIndex[i->_id].push_back(std::prev(i.base()));
+        }
+    }
 
     for (auto i = toDrop.begin(); i != toDrop.end(); i++) {
         WT_CURSOR* cursor = i->_cursor;
@@ -232,6 +253,7 @@ WiredTigerSessionCache::WiredTigerSessionCache(WiredTigerKVEngine* engine)
     : _engine(engine),
       _conn(engine->getConnection()),
       _clockSource(_engine->getClockSource()),
+      _shards(std::max(1U, ProcessInfo::getNumCores())),
       _shuttingDown(0),
       _prepareCommitOrAbortCounter(0) {}
 
@@ -239,6 +261,7 @@ WiredTigerSessionCache::WiredTigerSessionCache(WT_CONNECTION* conn, ClockSource*
     : _engine(nullptr),
       _conn(conn),
       _clockSource(cs),
+      _shards(std::max(1U, ProcessInfo::getNumCores())),
       _shuttingDown(0),
       _prepareCommitOrAbortCounter(0) {}
 
@@ -359,9 +382,11 @@ void WiredTigerSessionCache::notifyPreparedUnitOfWorkHasCommittedOrAborted() {
 
 
 void WiredTigerSessionCache::closeAllCursors(const std::string& uri) {
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeAllCursors(uri);
+    for (auto&& shard : _shards) {
+        auto lock = _lockShard(shard);
+        for (auto&& session : shard.sessions) {
+            session->closeAllCursors(uri);
+        }
     }
 }
 
@@ -369,15 +394,58 @@ void WiredTigerSessionCache::closeCursorsForQueuedDrops() {
     // Increment the cursor epoch so that all cursors from this epoch are closed.
     _cursorEpoch.fetchAndAdd(1);
 
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    for (SessionCache::iterator i = _sessions.begin(); i != _sessions.end(); i++) {
-        (*i)->closeCursorsForQueuedDrops(_engine);
+    for (auto&& shard : _shards) {
+        auto lock = _lockShard(shard);
+        for (auto&& session : shard.sessions) {
+            session->closeCursorsForQueuedDrops(_engine);
+        }
     }
 }
 
 size_t WiredTigerSessionCache::getIdleSessionsCount() {
-    stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-    return _sessions.size();
+    size_t count = 0;
+    for (auto&& shard : _shards) {
+        auto lock = _lockShard(shard);
+        count += shard.sessions.size();
+    }
+    return count;
+}
+
+void WiredTigerSessionCache::appendStats(BSONObjBuilder* builder) {
+    long long idleSessions = 0;
+    long long homeHits = 0;
+    long long steals = 0;
+    long long lockContended = 0;
+    for (auto&& shard : _shards) {
+        auto lock = _lockShard(shard);
+        idleSessions += shard.sessions.size();
+        homeHits += shard.homeHits;
+        steals += shard.steals;
+        lockContended += shard.lockContended;
+    }
+
+    builder->append("shards", static_cast<long long>(_shards.size()));
+    builder->append("idleSessions", idleSessions);
+    builder->append("sessionsFromHomeShard", homeHits);
+    builder->append("sessionsFromOtherShards", steals);
+    builder->append("sessionsOpened", _sessionsOpened.load());
+    builder->append("shardLockContended", lockContended);
+}
+
+WiredTigerSessionCache::SessionShard& WiredTigerSessionCache::_getHomeShard() {
+    // Threads are assigned home shards round-robin, which spreads them evenly over the shards.
+    static AtomicWord<unsigned> nextThreadIndex{0};
+    thread_local const unsigned threadIndex = nextThreadIndex.fetchAndAdd(1);
+    return _shards[threadIndex % _shards.size()];
+}
+
+stdx::unique_lock<stdx::mutex> WiredTigerSessionCache::_lockShard(SessionShard& shard) {
+    stdx::unique_lock<stdx::mutex> lock(shard.lock, stdx::try_to_lock);
+    if (!lock.owns_lock()) {
+        lock.lock();
+        ++shard.lockContended;
+    }
+    return lock;
 }
 
 void WiredTigerSessionCache::closeExpiredIdleSessions(int64_t idleTimeMillis) {
@@ -387,14 +455,14 @@ void WiredTigerSessionCache::closeExpiredIdleSessions(int64_t idleTimeMillis) {
     }
 
     auto cutoffTime = _clockSource->now() - Milliseconds(idleTimeMillis);
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
+    for (auto&& shard : _shards) {
+        auto lock = _lockShard(shard);
         // Discard all sessions that became idle before the cutoff time
-        for (auto it = _sessions.begin(); it != _sessions.end();) {
+        for (auto it = shard.sessions.begin(); it != shard.sessions.end();) {
             auto session = *it;
             invariant(session->getIdleExpireTime() != Date_t::min());
             if (session->getIdleExpireTime() < cutoffTime) {
-                it = _sessions.erase(it);
+                it = shard.sessions.erase(it);
                 delete (session);
             } else {
                 ++it;
@@ -404,17 +472,21 @@ void WiredTigerSessionCache::closeExpiredIdleSessions(int64_t idleTimeMillis) {
 }
 
 void WiredTigerSessionCache::closeAll() {
-    // Increment the epoch as we are now closing all sessions with this epoch.
-    SessionCache swap;
+    // Increment the epoch as we are now closing all sessions with this epoch. A session released
+    // concurrently is either rejected on its epoch or returned to its shard before the shard is
+    // emptied below, since the epoch is rechecked under the shard lock.
+    _epoch.fetchAndAdd(1);
 
-    {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        _epoch.fetchAndAdd(1);
-        _sessions.swap(swap);
-    }
+    for (auto&& shard : _shards) {
+        SessionCache swap;
+        {
+            auto lock = _lockShard(shard);
+            shard.sessions.swap(swap);
+        }
 
-    for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
-        delete (*i);
+        for (SessionCache::iterator i = swap.begin(); i != swap.end(); i++) {
+            delete (*i);
+        }
     }
 }
 
@@ -427,20 +499,40 @@ UniqueWiredTigerSession WiredTigerSessionCache::getSession() {
     // operations should be allowed to start.
     invariant(!(_shuttingDown.loadRelaxed() & kShuttingDownMask));
 
+    // Get the most recently used session so that if we discard sessions, we're discarding older
+    // ones
+    auto takeSession = [](SessionShard& shard) {
+        WiredTigerSession* cachedSession = shard.sessions.back();
+        shard.sessions.pop_back();
+        // Reset the idle time
+        cachedSession->setIdleExpireTime(Date_t::min());
+        return UniqueWiredTigerSession(cachedSession);
+    };
+
+    SessionShard& homeShard = _getHomeShard();
     {
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
-        if (!_sessions.empty()) {
-            // Get the most recently used session so that if we discard sessions, we're
-            // discarding older ones
-            WiredTigerSession* cachedSession = _sessions.back();
-            _sessions.pop_back();
-            // Reset the idle time
-            cachedSession->setIdleExpireTime(Date_t::min());
-            return UniqueWiredTigerSession(cachedSession);
+        auto lock = _lockShard(homeShard);
+        if (!homeShard.sessions.empty()) {
+            ++homeShard.homeHits;
+            return takeSession(homeShard);
+        }
+    }
+
+    // Look for an idle session in the other shards, skipping those which are in use rather than
+    // waiting for them.
+    for (auto&& shard : _shards) {
+        if (&shard == &homeShard) {
+            continue;
+        }
+        stdx::unique_lock<stdx::mutex> lock(shard.lock, stdx::try_to_lock);
+        if (lock.owns_lock() && !shard.sessions.empty()) {
+            ++shard.steals;
+            return takeSession(shard);
         }
     }
 
     // Outside of the cache partition lock, but on release will be put back on the cache
+    _sessionsOpened.fetchAndAdd(1);
     return UniqueWiredTigerSession(
         new WiredTigerSession(_conn, this, _epoch.load(), _cursorEpoch.load()));
 }
@@ -495,10 +587,11 @@ void WiredTigerSessionCache::releaseSession(WiredTigerSession* session) {
     session->setIdleExpireTime(_clockSource->now());
 
     if (session->_getEpoch() == currentEpoch) {  // check outside of lock to reduce contention
-        stdx::lock_guard<stdx::mutex> lock(_cacheLock);
+        SessionShard& shard = _getHomeShard();
+        auto lock = _lockShard(shard);
         if (session->_getEpoch() == _epoch.load()) {  // recheck inside the lock for correctness
             returnedToCache = true;
-            _sessions.push_back(session);
+            shard.sessions.push_back(session);
         }
     } else
         invariant(session->_getEpoch() < currentEpoch);
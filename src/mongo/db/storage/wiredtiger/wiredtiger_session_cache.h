@@ -29,8 +29,10 @@
 
 #pragma once
 
+#include <boost/align/aligned_allocator.hpp>
 #include <list>
 #include <string>
+#include <vector>
 
 #include <wiredtiger.h>
 
@@ -38,10 +40,13 @@
 #include "mongo/db/storage/wiredtiger/wiredtiger_snapshot_manager.h"
 #include "mongo/platform/atomic_word.h"
 #include "mongo/stdx/mutex.h"
+#include "mongo/stdx/unordered_map.h"
 #include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/with_alignment.h"
 
 namespace mongo {
 
+class BSONObjBuilder;
 class WiredTigerKVEngine;
 class WiredTigerSessionCache;
 
@@ -58,6 +63,8 @@ public:
 /**
  * This is a structure that caches 1 cursor for each uri.
  * The idea is that there is a pool of these somewhere.
+ * Cached cursors are looked up by table id through a hash index, while a list keeps them in
+ * most recently used order for aging out old cursors.
  * NOT THREADSAFE
  */
 class WiredTigerSession {
@@ -167,6 +174,16 @@ private:
     // The cursor cache is a list of pairs that contain an ID and cursor
     typedef std::list<WiredTigerCachedCursor> CursorCache;
 
+    // Maps table ids to the cached cursors on that table, least recently released first. A session
+    // rarely caches more than one cursor for the same table.
+    typedef stdx::unordered_map<uint64_t, std::vector<CursorCache::iterator>> CursorIndex;
+
+    /**
+     * Removes the cursor at 'it' from the cursor cache without closing it, and returns the
+     * iterator following it.
+     */
+    CursorCache::iterator _uncacheCursor(CursorCache::iterator it);
+
     // Used internally by WiredTigerSessionCache
     uint64_t _getEpoch() const {
         return _epoch;
@@ -182,6 +199,7 @@ private:
     WiredTigerSessionCache* _cache;  // not owned
     WT_SESSION* _session;            // owned
     CursorCache _cursors;            // owned
+    CursorIndex _cursorIndex;        // indexes _cursors
     uint64_t _cursorGen;
     int _cursorsOut;
     bool _dropQueuedIdentsAtSessionEnd = true;
@@ -191,6 +209,11 @@ private:
 /**
  *  This cache implements a shared pool of WiredTiger sessions with the goal to amortize the
  *  cost of session creation and destruction over multiple uses.
+ *
+ *  Idle sessions are spread over one shard per core. Each thread is assigned a home shard on
+ *  first use, from which it takes sessions and to which it returns them, so that threads rarely
+ *  contend for the same shard lock. A thread whose home shard is empty takes a session from any
+ *  other shard it can lock without waiting before opening a new one.
  */
 class WiredTigerSessionCache {
 public:
@@ -223,6 +246,11 @@ public:
      */
     size_t getIdleSessionsCount();
 
+    /**
+     * Appends statistics about the use of the session pool and contention on its shards.
+     */
+    void appendStats(BSONObjBuilder* builder);
+
     /**
      * Closes all cached sessions whose idle expiration time has been reached.
      */
@@ -317,9 +345,26 @@ private:
     AtomicWord<unsigned> _shuttingDown;
     static const uint32_t kShuttingDownMask = 1 << 31;
 
-    stdx::mutex _cacheLock;
     typedef std::vector<WiredTigerSession*> SessionCache;
-    SessionCache _sessions;
+
+    struct SessionShard {
+        stdx::mutex lock;
+        SessionCache sessions;  // Most recently released last.
+
+        // Statistics, protected by 'lock'.
+        long long homeHits = 0;       // Sessions taken from the shard by a thread it is home to.
+        long long steals = 0;         // Sessions taken from the shard by other threads.
+        long long lockContended = 0;  // Acquisitions of 'lock' which had to wait.
+    };
+
+    template <typename T>
+    using AlignedVector = std::vector<T, boost::alignment::aligned_allocator<T>>;
+
+    // Never resized after construction. Each shard is on its own cache line.
+    AlignedVector<CacheAligned<SessionShard>> _shards;
+
+    // The number of sessions opened because no idle session was available.
+    AtomicWord<long long> _sessionsOpened{0};
 
     // Bumped when all open sessions need to be closed
     AtomicWord<unsigned long long> _epoch;  // atomic so we can check it outside of the lock
@@ -349,6 +394,16 @@ private:
      * session and releasing it, the session is directly released. This method is thread safe.
      */
     void releaseSession(WiredTigerSession* session);
+
+    /**
+     * Returns the shard the calling thread takes sessions from and returns them to.
+     */
+    SessionShard& _getHomeShard();
+
+    /**
+     * Locks 'shard', counting the acquisition as contended if it had to wait.
+     */
+    static stdx::unique_lock<stdx::mutex> _lockShard(SessionShard& shard);
 };
 
 /**
@@ -33,8 +33,10 @@
 #include <string>
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_session_cache.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_util.h"
+#include "mongo/stdx/thread.h"
 #include "mongo/unittest/temp_dir.h"
 #include "mongo/unittest/unittest.h"
 #include "mongo/util/system_clock_source.h"
@@ -113,4 +115,64 @@ TEST(WiredTigerSessionCacheTest, CheckSessionCacheCleanup) {
     ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 0U);
 }
 
+TEST(WiredTigerSessionCacheTest, SessionsAreReusedAcrossThreads) {
+    WiredTigerSessionCacheHarnessHelper harnessHelper("");
+    WiredTigerSessionCache* sessionCache = harnessHelper.getSessionCache();
+    {
+        UniqueWiredTigerSession first = sessionCache->getSession();
+        UniqueWiredTigerSession second = sessionCache->getSession();
+    }
+    ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 2U);
+
+    // Other threads take the idle sessions before opening new ones, whichever shard they are in.
+    stdx::thread([&] {
+        UniqueWiredTigerSession first = sessionCache->getSession();
+        UniqueWiredTigerSession second = sessionCache->getSession();
+        ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 0U);
+    }).join();
+    ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 2U);
+
+    BSONObjBuilder builder;
+    sessionCache->appendStats(&builder);
+    BSONObj stats = builder.obj();
+    ASSERT_EQUALS(stats["idleSessions"].numberLong(), 2LL);
+    ASSERT_EQUALS(stats["sessionsOpened"].numberLong(), 2LL);
+    ASSERT_EQUALS(stats["sessionsFromHomeShard"].numberLong() +
+                      stats["sessionsFromOtherShards"].numberLong(),
+                  2LL);
+
+    sessionCache->closeAll();
+    ASSERT_EQUALS(sessionCache->getIdleSessionsCount(), 0U);
+}
+
+TEST(WiredTigerSessionCacheTest, CursorCacheReturnsCursorForTable) {
+    WiredTigerSessionCacheHarnessHelper harnessHelper("");
+    WiredTigerSessionCache* sessionCache = harnessHelper.getSessionCache();
+    UniqueWiredTigerSession session = sessionCache->getSession();
+    WT_SESSION* wtSession = session->getSession();
+    ASSERT_OK(wtRCToStatus(wtSession->create(wtSession, "table:a", "key_format=q,value_format=u")));
+    ASSERT_OK(wtRCToStatus(wtSession->create(wtSession, "table:b", "key_format=q,value_format=u")));
+
+    const uint64_t idA = WiredTigerSession::genTableId();
+    const uint64_t idB = WiredTigerSession::genTableId();
+    WT_CURSOR* cursorA = session->getCursor("table:a", idA, false);
+    WT_CURSOR* cursorB = session->getCursor("table:b", idB, false);
+    session->releaseCursor(idA, cursorA);
+    session->releaseCursor(idB, cursorB);
+    ASSERT_EQUALS(session->cachedCursors(), 2);
+
+    // Cached cursors are returned for the table they were opened on.
+    ASSERT_EQUALS(session->getCursor("table:a", idA, false), cursorA);
+    ASSERT_EQUALS(session->cachedCursors(), 1);
+    session->releaseCursor(idA, cursorA);
+
+    session->closeAllCursors("table:b");
+    ASSERT_EQUALS(session->cachedCursors(), 1);
+    ASSERT_EQUALS(session->getCursor("table:a", idA, false), cursorA);
+    session->releaseCursor(idA, cursorA);
+
+    session->closeAllCursors("");
+    ASSERT_EQUALS(session->cachedCursors(), 0);
+}
+
 }  // namespace mongo
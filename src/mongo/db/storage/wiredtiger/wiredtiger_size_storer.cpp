@@ -31,6 +31,7 @@
 
 #include "mongo/platform/basic.h"
 
+#include <algorithm>
 #include <wiredtiger.h>
 
 #include "mongo/bson/bsonobj.h"
@@ -123,55 +124,73 @@ std::shared_ptr<WiredTigerSizeStorer::SizeInfo> WiredTigerSizeStorer::load(Strin
 }
 
 void WiredTigerSizeStorer::flush(bool syncToDisk) {
-    Buffer buffer;
+    std::vector<Entry> entries;
     {
-        stdx::lock_guard<stdx::mutex> bufferLock(_bufferMutex);
-        _buffer.swap(buffer);
+        Buffer buffer;
+        {
+            stdx::lock_guard<stdx::mutex> bufferLock(_bufferMutex);
+            _buffer.swap(buffer);
+        }
+        entries.reserve(buffer.size());
+        for (auto& it : buffer)
+            entries.emplace_back(it.first, std::move(it.second));
     }
 
-    if (buffer.empty())
+    if (entries.empty())
         return;  // Nothing to do.
 
     Timer t;
-    stdx::lock_guard<stdx::mutex> cursorLock(_cursorMutex);
-    {
-        // On failure, place entries back into the map, unless a newer value already exists.
-        ON_BLOCK_EXIT([this, &buffer]() {
-            this->_cursor->reset(this->_cursor);
-            if (!buffer.empty()) {
-                stdx::lock_guard<stdx::mutex> bufferLock(this->_bufferMutex);
-                for (auto& it : buffer)
-                    this->_buffer.try_emplace(it.first, it.second);
-            }
-        });
-
-        WT_SESSION* session = _session.getSession();
-        WiredTigerBeginTxnBlock txnOpen(session, syncToDisk ? "sync=true" : nullptr);
-
-        for (auto it = buffer.begin(); it != buffer.end(); ++it) {
-
-            // Ordering is important here: when the store method checks if the SizeInfo
-            // is dirty and it returns true, the current values of numRecords and dataSize must
-            // still be written back. So, the required order is to clear the dirty flag first.
-            SizeInfo& sizeInfo = *it->second;
-            sizeInfo._dirty.store(false);
-            BSONObj data = BSON("numRecords" << sizeInfo.numRecords.load() << "dataSize"
-                                             << sizeInfo.dataSize.load());
-
-            auto& uri = it->first;
-            LOG(2) << "WiredTigerSizeStorer::flush " << uri << " -> " << redact(data);
-            WiredTigerItem key(uri.c_str(), uri.size());
-            WiredTigerItem value(data.objdata(), data.objsize());
-            _cursor->set_key(_cursor, key.Get());
-            _cursor->set_value(_cursor, value.Get());
-            invariantWTOK(_cursor->insert(_cursor));
+    auto flushed = entries.cbegin();
+
+    // On failure, place the entries not yet written back into the map, unless a newer value
+    // already exists.
+    ON_BLOCK_EXIT([this, &entries, &flushed]() {
+        if (flushed != entries.cend()) {
+            stdx::lock_guard<stdx::mutex> bufferLock(this->_bufferMutex);
+            for (auto it = flushed; it != entries.cend(); ++it)
+                this->_buffer.try_emplace(it->first, it->second);
         }
-        txnOpen.done();
-        invariantWTOK(session->commit_transaction(session, nullptr));
-        buffer.clear();
+    });
+
+    while (flushed != entries.cend()) {
+        auto batchEnd = flushed + std::min<size_t>(kMaxFlushBatchSize, entries.cend() - flushed);
+        // Syncing the log for the last batch makes all of the earlier batches durable as well.
+        _flushBatch(flushed, batchEnd, syncToDisk && batchEnd == entries.cend());
+        flushed = batchEnd;
     }
 
     auto micros = t.micros();
-    LOG(2) << "WiredTigerSizeStorer flush took " << micros << " µs";
+    LOG(2) << "WiredTigerSizeStorer flush of " << entries.size() << " entries took " << micros
+           << " µs";
+}
+
+void WiredTigerSizeStorer::_flushBatch(std::vector<Entry>::const_iterator begin,
+                                       std::vector<Entry>::const_iterator end,
+                                       bool syncToDisk) {
+    stdx::lock_guard<stdx::mutex> cursorLock(_cursorMutex);
+    ON_BLOCK_EXIT([this]() { this->_cursor->reset(this->_cursor); });
+
+    WT_SESSION* session = _session.getSession();
+    WiredTigerBeginTxnBlock txnOpen(session, syncToDisk ? "sync=true" : nullptr);
+
+    for (auto it = begin; it != end; ++it) {
+        // Ordering is important here: when the store method checks if the SizeInfo is dirty and
+        // it returns true, the current values of numRecords and dataSize must still be written
+        // back. So, the required order is to clear the dirty flag first.
+        SizeInfo& sizeInfo = *it->second;
+        sizeInfo._dirty.store(false);
+        BSONObj data = BSON("numRecords" << sizeInfo.numRecords.load() << "dataSize"
+                                         << sizeInfo.dataSize.load());
+
+        auto& uri = it->first;
+        LOG(2) << "WiredTigerSizeStorer::flush " << uri << " -> " << redact(data);
+        WiredTigerItem key(uri.c_str(), uri.size());
+        WiredTigerItem value(data.objdata(), data.objsize());
+        _cursor->set_key(_cursor, key.Get());
+        _cursor->set_value(_cursor, value.Get());
+        invariantWTOK(_cursor->insert(_cursor));
+    }
+    txnOpen.done();
+    invariantWTOK(session->commit_transaction(session, nullptr));
 }
 }  // namespace mongo
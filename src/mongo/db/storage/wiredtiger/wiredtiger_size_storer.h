@@ -30,6 +30,8 @@
 #pragma once
 
 #include <string>
+#include <utility>
+#include <vector>
 
 #include <wiredtiger.h>
 
@@ -87,11 +89,24 @@ public:
     std::shared_ptr<SizeInfo> load(StringData uri) const;
 
     /**
-     * Writes all changes to the underlying table.
+     * Writes all changes to the underlying table. Only entries stored since the previous flush are
+     * written, in transactions of at most kMaxFlushBatchSize entries. The cursor is released
+     * between batches, so loads are not held up for the duration of a large flush.
      */
     void flush(bool syncToDisk);
 
+    static constexpr size_t kMaxFlushBatchSize = 1000;
+
 private:
+    using Entry = std::pair<std::string, std::shared_ptr<SizeInfo>>;
+
+    /**
+     * Writes the entries in the range [begin, end) in a single transaction.
+     */
+    void _flushBatch(std::vector<Entry>::const_iterator begin,
+                     std::vector<Entry>::const_iterator end,
+                     bool syncToDisk);
+
     const WiredTigerSession _session;
     const bool _readOnly;
     // Guards _cursor. Acquire *before* _bufferMutex.
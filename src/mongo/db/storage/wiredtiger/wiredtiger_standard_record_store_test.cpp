@@ -48,6 +48,7 @@
 #include "mongo/db/storage/kv/kv_prefix.h"
 #include "mongo/db/storage/record_store_test_harness.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_kv_engine.h"
+#include "mongo/db/storage/wiredtiger/wiredtiger_parameters_gen.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_record_store_oplog_stones.h"
 #include "mongo/db/storage/wiredtiger/wiredtiger_recovery_unit.h"
@@ -297,6 +298,106 @@ TEST(WiredTigerRecordStoreTest, SizeStorer1) {
     rs.reset(nullptr);  // this has to be deleted before ss
 }
 
+TEST(WiredTigerRecordStoreTest, LazyInitAssignsRecordIdsAfterExistingRecords) {
+    unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+    unique_ptr<RecordStore> rs(harnessHelper->newNonCappedRecordStore());
+
+    string ident = rs->getIdent();
+    string sizeStorerUri = WiredTigerKVEngine::kTableUriPrefix + "sizeStorerLazyInit";
+    const bool readOnly = false;
+    WiredTigerSizeStorer ss(harnessHelper->conn(), sizeStorerUri, readOnly);
+    checked_cast<WiredTigerRecordStore*>(rs.get())->setSizeStorer(&ss);
+
+    const int N = 5;
+    RecordId lastId;
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        for (int i = 0; i < N; i++) {
+            StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), "a", 2, Timestamp());
+            ASSERT_OK(res.getStatus());
+            lastId = res.getValue();
+        }
+        uow.commit();
+    }
+    rs.reset(nullptr);
+
+    gWiredTigerLazyRecordStoreInit = true;
+    ON_BLOCK_EXIT([] { gWiredTigerLazyRecordStoreInit = false; });
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        WiredTigerRecordStore::Params params;
+        params.ns = "a.b"_sd;
+        params.ident = ident;
+        params.engineName = kWiredTigerEngineName;
+        params.isCapped = false;
+        params.isEphemeral = false;
+        params.cappedMaxSize = -1;
+        params.cappedMaxDocs = -1;
+        params.cappedCallback = nullptr;
+        params.sizeStorer = &ss;
+
+        auto ret = new StandardWiredTigerRecordStore(nullptr, opCtx.get(), params);
+        ret->postConstructorInit(opCtx.get());
+        rs.reset(ret);
+    }
+
+    // Before the first write the size and count come from the size storer.
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        ASSERT_EQUALS(N, rs->numRecords(opCtx.get()));
+        ASSERT_EQUALS(N * 2, rs->dataSize(opCtx.get()));
+    }
+
+    // The first write reads the table, so new records follow the existing ones.
+    {
+        ServiceContext::UniqueOperationContext opCtx(harnessHelper->newOperationContext());
+        WriteUnitOfWork uow(opCtx.get());
+        StatusWith<RecordId> res = rs->insertRecord(opCtx.get(), "a", 2, Timestamp());
+        ASSERT_OK(res.getStatus());
+        ASSERT_GT(res.getValue(), lastId);
+        uow.commit();
+        ASSERT_EQUALS(N + 1, rs->numRecords(opCtx.get()));
+    }
+
+    rs.reset(nullptr);  // this has to be deleted before ss
+}
+
+TEST(WiredTigerRecordStoreTest, SizeStorerFlushesInBatches) {
+    unique_ptr<WiredTigerHarnessHelper> harnessHelper(new WiredTigerHarnessHelper());
+    string sizeStorerUri = WiredTigerKVEngine::kTableUriPrefix + "sizeStorerBatches";
+    const bool readOnly = false;
+
+    // Store more entries than fit in a single flush transaction.
+    const int numEntries = 2 * WiredTigerSizeStorer::kMaxFlushBatchSize + 1;
+    std::vector<std::shared_ptr<WiredTigerSizeStorer::SizeInfo>> sizeInfos;
+    {
+        WiredTigerSizeStorer ss(harnessHelper->conn(), sizeStorerUri, readOnly);
+        for (int i = 0; i < numEntries; i++) {
+            auto sizeInfo = std::make_shared<WiredTigerSizeStorer::SizeInfo>();
+            sizeInfo->numRecords.store(i);
+            sizeInfo->dataSize.store(2 * i);
+            ss.store(std::string(str::stream() << "table:batch" << i), sizeInfo);
+            sizeInfos.push_back(sizeInfo);
+        }
+        ss.flush(true);
+
+        // Only entries stored since the last flush are written again.
+        sizeInfos[0]->numRecords.store(-1);
+        ss.flush(true);
+        sizeInfos[1]->numRecords.store(-1);
+        ss.store("table:batch1", sizeInfos[1]);
+        ss.flush(true);
+    }
+
+    WiredTigerSizeStorer ss(harnessHelper->conn(), sizeStorerUri, readOnly);
+    for (int i = 0; i < numEntries; i++) {
+        auto sizeInfo = ss.load(std::string(str::stream() << "table:batch" << i));
+        ASSERT_EQUALS(i == 1 ? -1 : i, sizeInfo->numRecords.load());
+        ASSERT_EQUALS(2 * i, sizeInfo->dataSize.load());
+    }
+}
+
 class GoodValidateAdaptor : public ValidateAdaptor {
 public:
     virtual Status validate(const RecordId& recordId, const RecordData& record, size_t* dataSize) {
@@ -560,6 +560,35 @@ TEST_F(QueryStageMultiPlanTest, MPSSummaryStats) {
     ASSERT_LTE(stats.totalKeysExamined, static_cast<size_t>(N));
 }
 
+TEST_F(QueryStageMultiPlanTest, MPSAbandonsPlansWhichFallFarBehind) {
+    const int N = 5000;
+    for (int i = 0; i < N; ++i) {
+        insert(BSON("foo" << (i % 10)));
+    }
+
+    addIndex(BSON("foo" << 1));
+
+    AutoGetCollectionForReadCommand ctx(_opCtx.get(), nss);
+    const Collection* coll = ctx.getCollection();
+
+    // By default the collection scan, which returns a tenth as many results as the index scan, is
+    // worked for as long as the index scan.
+    auto mps = runMultiPlanner(_opCtx.get(), nss, coll, 7);
+    auto ixScanWorks = mps->getChildren()[0]->getStats()->common.works;
+    auto collScanWorks = mps->getChildren()[1]->getStats()->common.works;
+    ASSERT_GTE(collScanWorks + 1, ixScanWorks);
+
+    internalQueryPlanEvaluationAbandonRatio.store(3.0);
+    ON_BLOCK_EXIT([] { internalQueryPlanEvaluationAbandonRatio.store(0.0); });
+
+    // Once the index scan has a tenth of the results it needs, the collection scan is abandoned
+    // and the index scan still wins.
+    mps = runMultiPlanner(_opCtx.get(), nss, coll, 7);
+    ixScanWorks = mps->getChildren()[0]->getStats()->common.works;
+    collScanWorks = mps->getChildren()[1]->getStats()->common.works;
+    ASSERT_LT(collScanWorks * 2, ixScanWorks);
+}
+
 TEST_F(QueryStageMultiPlanTest, ShouldReportErrorIfExceedsTimeLimitDuringPlanning) {
     const int N = 5000;
     for (int i = 0; i < N; ++i) {